@@ -83,6 +83,33 @@ void ngf_util_create_default_graphics_pipeline_data(ngf_util_graphics_pipeline_d
  */
 const char* ngf_util_get_error_name(const ngf_error err);
 
+/**
+ * \ingroup ngf_util
+ * 
+ * Loads pipeline cache data from the file at the given path and merges it into the pipeline cache
+ * of the given context. See \ref ngf_load_pipeline_cache for details.
+ * 
+ * @param ctx The context to load the pipeline cache data into.
+ * @param path Path to the file containing the pipeline cache data.
+ * @return \ref NGF_ERROR_INVALID_OPERATION if the file could not be read, \ref NGF_ERROR_OK if the
+ *         file is empty, as saved for an empty cache, otherwise the result of
+ *         \ref ngf_load_pipeline_cache.
+ */
+ngf_error ngf_util_load_pipeline_cache_file(ngf_context ctx, const char* path);
+
+/**
+ * \ingroup ngf_util
+ * 
+ * Writes the contents of the given context's pipeline cache into the file at the given path,
+ * replacing the file if it already exists. See \ref ngf_get_pipeline_cache_data for details.
+ * 
+ * @param ctx The context to save the pipeline cache data of.
+ * @param path Path to the file to write the pipeline cache data into.
+ * @return \ref NGF_ERROR_INVALID_OPERATION if the file could not be written, otherwise the result
+ *         of \ref ngf_get_pipeline_cache_data.
+ */
+ngf_error ngf_util_save_pipeline_cache_file(ngf_context ctx, const char* path);
+
 /**
  * \ingroup ngf_util
  * 
@@ -167,6 +167,9 @@ NGF_DEFINE_WRAPPER_MANAGEMENT_FUNCS(buffer);
 NGF_DEFINE_WRAPPER_MANAGEMENT_FUNCS(texel_buffer_view);
 NGF_DEFINE_WRAPPER_MANAGEMENT_FUNCS(context);
 NGF_DEFINE_WRAPPER_MANAGEMENT_FUNCS(cmd_buffer);
+NGF_DEFINE_WRAPPER_MANAGEMENT_FUNCS(bind_group);
+NGF_DEFINE_WRAPPER_MANAGEMENT_FUNCS(resource_table);
+NGF_DEFINE_WRAPPER_MANAGEMENT_FUNCS(query_pool);
 
 /**
  * \ingroup ngf_wrappers
@@ -238,6 +241,27 @@ NGF_DEFINE_WRAPPER_TYPE(context);
  */
 NGF_DEFINE_WRAPPER_TYPE(cmd_buffer);
 
+/**
+ * \ingroup ngf_wrappers
+ *
+ * A RAII wrapper for \ref ngf_bind_group.
+ */
+NGF_DEFINE_WRAPPER_TYPE(bind_group);
+
+/**
+ * \ingroup ngf_wrappers
+ *
+ * A RAII wrapper for \ref ngf_resource_table.
+ */
+NGF_DEFINE_WRAPPER_TYPE(resource_table);
+
+/**
+ * \ingroup ngf_wrappers
+ *
+ * A RAII wrapper for \ref ngf_query_pool.
+ */
+NGF_DEFINE_WRAPPER_TYPE(query_pool);
+
 /**
  * \ingroup ngf_wrappers
  *
@@ -588,6 +612,49 @@ template<uint32_t S> struct descriptor_set {
       return op;
     }
   };
+
+  /**
+   * Creates a persistent \ref ngf_bind_group for this set, using the set layout of the given
+   * graphics pipeline. Example usage:
+   *
+   * ```
+   * ngf::bind_group material;
+   * ngf::descriptor_set<1>::create_bind_group(
+   *     material,
+   *     your_pipeline,
+   *     ngf::descriptor_set<1>::binding<0>::texture(your_image),
+   *     ngf::descriptor_set<1>::binding<1>::sampler(your_sampler));
+   * ```
+   *
+   * @param group The wrapper that takes ownership of the newly created bind group.
+   * @param pipeline The pipeline whose layout for this set the group conforms to.
+   */
+  template<class... Args>
+  static ngf_error
+  create_bind_group(bind_group& group, ngf_graphics_pipeline pipeline, const Args&&... args) {
+    const ngf_resource_bind_op ops[] = {std::forward<const Args>(args)...};
+    return group.initialize(ngf_bind_group_info {
+        pipeline,
+        nullptr,
+        S,
+        ops,
+        sizeof(ops) / sizeof(ngf_resource_bind_op)});
+  }
+
+  /**
+   * Same as above, but uses the set layout of the given compute pipeline.
+   */
+  template<class... Args>
+  static ngf_error
+  create_bind_group(bind_group& group, ngf_compute_pipeline pipeline, const Args&&... args) {
+    const ngf_resource_bind_op ops[] = {std::forward<const Args>(args)...};
+    return group.initialize(ngf_bind_group_info {
+        nullptr,
+        pipeline,
+        S,
+        ops,
+        sizeof(ops) / sizeof(ngf_resource_bind_op)});
+  }
 };
 
 /**
@@ -625,10 +692,90 @@ template<class... Args> void cmd_bind_resources(ngf_compute_encoder enc, const A
   ngf_cmd_bind_compute_resources(enc, ops, sizeof(ops) / sizeof(ngf_resource_bind_op));
 }
 
+/**
+ * \ingroup ngf_wrappers
+ *
+ * Binds a persistent bind group within a render encoder. See \ref ngf_cmd_bind_group.
+ */
+inline void cmd_bind_group(ngf_render_encoder enc, const ngf_bind_group group) {
+  ngf_cmd_bind_group(enc, group);
+}
+
+/**
+ * \ingroup ngf_wrappers
+ *
+ * Binds a persistent bind group within a compute encoder. See \ref ngf_cmd_bind_compute_group.
+ */
+inline void cmd_bind_group(ngf_compute_encoder enc, const ngf_bind_group group) {
+  ngf_cmd_bind_compute_group(enc, group);
+}
+
+/**
+ * \ingroup ngf_wrappers
+ *
+ * Binds a resource table within a render encoder. See \ref ngf_cmd_bind_resource_table.
+ */
+inline void
+cmd_bind_resource_table(ngf_render_encoder enc, uint32_t set, const ngf_resource_table table) {
+  ngf_cmd_bind_resource_table(enc, set, table);
+}
+
+/**
+ * \ingroup ngf_wrappers
+ *
+ * Binds a resource table within a compute encoder. See
+ * \ref ngf_cmd_bind_compute_resource_table.
+ */
+inline void
+cmd_bind_resource_table(ngf_compute_encoder enc, uint32_t set, const ngf_resource_table table) {
+  ngf_cmd_bind_compute_resource_table(enc, set, table);
+}
+
+/**
+ * \ingroup ngf_wrappers
+ *
+ * A convenience function for updating push constants with the contents of a structure. Example
+ * usage:
+ *
+ * ```
+ * struct per_draw_data { uint32_t object_idx; float tint[3]; };
+ * ngf::cmd_push_constants(your_render_encoder, per_draw_data {idx, {1.0f, 0.0f, 0.0f}});
+ * ```
+ *
+ * @param enc The render encoder to record the command into.
+ * @param data The data to write.
+ * @param offset Offset (in bytes) into the push constant block at which to start writing.
+ */
+template<typename T>
+void cmd_push_constants(ngf_render_encoder enc, const T& data, uint32_t offset = 0u) {
+  static_assert(sizeof(T) % 4u == 0u, "push constant data size must be a multiple of 4");
+  static_assert(sizeof(T) <= NGF_MAX_PUSH_CONSTANTS_SIZE, "push constant data is too large");
+  ngf_cmd_push_constants(enc, offset, (uint32_t)sizeof(T), &data);
+}
+
+/**
+ * \ingroup ngf_wrappers
+ *
+ * A convenience function for updating push constants with the contents of a structure within a
+ * compute encoder. See \ref cmd_push_constants for details.
+ */
+template<typename T>
+void cmd_push_constants(ngf_compute_encoder enc, const T& data, uint32_t offset = 0u) {
+  static_assert(sizeof(T) % 4u == 0u, "push constant data size must be a multiple of 4");
+  static_assert(sizeof(T) <= NGF_MAX_PUSH_CONSTANTS_SIZE, "push constant data is too large");
+  ngf_cmd_push_compute_constants(enc, offset, (uint32_t)sizeof(T), &data);
+}
+
 /**
  * \ingroup ngf_wrappers
  *
  * A convenience class for dynamically updated structured uniform data.
+ *
+ * The underlying buffer is split into equally sized slots, and every write goes into the next
+ * slot, wrapping around at the end. By default, there is one slot per frame in flight, which suits
+ * data written once per frame. Use \ref initialize_ring to reserve several slots per frame for
+ * data that changes with every draw, and bind it with \ref dynamic_bind_op_at_current_offset so
+ * that the draws can share the same descriptor set.
  */
 template<typename T> class uniform_multibuffer {
   public:
@@ -642,18 +789,30 @@ template<typename T> class uniform_multibuffer {
   uniform_multibuffer& operator=(const uniform_multibuffer&)  = delete;
 
   ngf_error initialize(const uint32_t frames) {
-    initialize_n(frames, 1);
+    return initialize_n(frames, 1);
   }
 
   ngf_error initialize_n(const uint32_t frames, const uint32_t num_elements) {
+    return initialize_ring(frames, 1, num_elements);
+  }
+
+  /**
+   * Sets up the multibuffer to be written up to `writes_per_frame` times within each of the
+   * `frames` frames in flight.
+   */
+  ngf_error initialize_ring(
+      const uint32_t frames,
+      const uint32_t writes_per_frame,
+      const uint32_t num_elements = 1) {
     const size_t alignment    = ngf_get_device_capabilities()->uniform_buffer_offset_alignment;
     const size_t aligned_size = ngf_util_align_size(sizeof(T) * num_elements, alignment);
+    const uint32_t nslots     = frames * writes_per_frame;
     NGF_RETURN_IF_ERROR(buf_.initialize(ngf_buffer_info {
-        aligned_size * frames,
+        aligned_size * nslots,
         NGF_BUFFER_STORAGE_HOST_WRITEABLE,
         NGF_BUFFER_USAGE_UNIFORM_BUFFER}));
-    nframes_                = frames;
-    aligned_per_frame_size_ = aligned_size;
+    nslots_            = nslots;
+    aligned_slot_size_ = aligned_size;
     return NGF_ERROR_OK;
   }
 
@@ -662,12 +821,12 @@ template<typename T> class uniform_multibuffer {
   }
 
   void write_n(const T* const data, const uint32_t num_elements) {
-    current_offset_  = (frame_)*aligned_per_frame_size_;
-    void* mapped_buf = ngf_buffer_map_range(buf_.get(), current_offset_, aligned_per_frame_size_);
+    current_offset_  = slot_ * aligned_slot_size_;
+    void* mapped_buf = ngf_buffer_map_range(buf_.get(), current_offset_, aligned_slot_size_);
     memcpy(mapped_buf, (void*)data, sizeof(T) * num_elements);
-    ngf_buffer_flush_range(buf_.get(), 0, aligned_per_frame_size_);
+    ngf_buffer_flush_range(buf_.get(), 0, aligned_slot_size_);
     ngf_buffer_unmap(buf_.get());
-    frame_ = (frame_ + 1u) % nframes_;
+    slot_ = (slot_ + 1u) % nslots_;
   }
 
   ngf_resource_bind_op bind_op_at_current_offset(
@@ -681,16 +840,30 @@ template<typename T> class uniform_multibuffer {
     op.target_set         = set;
     op.info.buffer.buffer = buf_.get();
     op.info.buffer.offset = current_offset_ + additional_offset;
-    op.info.buffer.range  = (range == 0) ? aligned_per_frame_size_ : range;
+    op.info.buffer.range  = (range == 0) ? aligned_slot_size_ : range;
+    return op;
+  }
+
+  /**
+   * Same as \ref bind_op_at_current_offset, but produces a bind op for a uniform buffer with a
+   * dynamic offset, see \ref NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC.
+   */
+  ngf_resource_bind_op dynamic_bind_op_at_current_offset(
+      uint32_t set,
+      uint32_t binding,
+      size_t   additional_offset = 0,
+      size_t   range             = 0) const {
+    ngf_resource_bind_op op = bind_op_at_current_offset(set, binding, additional_offset, range);
+    op.type                 = NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC;
     return op;
   }
 
   private:
   buffer   buf_;
-  uint32_t frame_                  = 0;
-  size_t   current_offset_         = 0;
-  size_t   aligned_per_frame_size_ = 0;
-  uint32_t nframes_                = 0;
+  uint32_t slot_              = 0;
+  size_t   current_offset_    = 0;
+  size_t   aligned_slot_size_ = 0;
+  uint32_t nslots_            = 0;
 };
 
 }  // namespace ngf
@@ -345,7 +345,11 @@ typedef enum ngf_error {
 
   /** \ingroup ngf
    * The routine did not complete successfully. */
-  NGF_ERROR_INVALID_OPERATION
+  NGF_ERROR_INVALID_OPERATION,
+
+  /** \ingroup ngf
+   * The requested data is not available yet. The operation may be retried later. */
+  NGF_ERROR_NOT_READY
   /*..add new errors above this line */
 } ngf_error;
 
@@ -1338,6 +1342,17 @@ typedef struct ngf_input_assembly_info {
   bool                   enable_primitive_restart;
 } ngf_input_assembly_info;
 
+/**
+ * @struct ngf_binding_location
+ * \ingroup ngf
+ *
+ * Identifies a binding within a particular set.
+ */
+typedef struct ngf_binding_location {
+  uint32_t set;     /**< Set ID. */
+  uint32_t binding; /**< Binding ID. */
+} ngf_binding_location;
+
 /**
  * @struct ngf_graphics_pipeline_info
  * \ingroup ngf
@@ -1390,6 +1405,14 @@ typedef struct ngf_graphics_pipeline_info {
                             NGF_BLEND_FACTOR_ONE_MINUS_CONSTANT_ALPHA . */
 
   const char* debug_name;
+
+  /**
+   * A pointer to an array of uniform buffer bindings that shall be bound with
+   * \ref NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC instead of \ref NGF_DESCRIPTOR_UNIFORM_BUFFER.
+   * May be NULL if there are none.
+   */
+  const ngf_binding_location* dynamic_uniform_buffers;
+  uint32_t ndynamic_uniform_buffers; /**< Number of elements in dynamic_uniform_buffers. */
 } ngf_graphics_pipeline_info;
 
 /**
@@ -1413,6 +1436,12 @@ typedef struct ngf_compute_pipeline_info {
   ngf_shader_stage shader_stage; /**< The (only) stage for this pipeline. */
   const ngf_specialization_info*
       spec_info; /**< Specifies the value of  specialization consts used by this pipeline. */
+
+  /**
+   * Same as \ref ngf_graphics_pipeline_info::dynamic_uniform_buffers.
+   */
+  const ngf_binding_location* dynamic_uniform_buffers;
+  uint32_t ndynamic_uniform_buffers; /**< Number of elements in dynamic_uniform_buffers. */
 } ngf_compute_pipeline_info;
 
 /**
@@ -1483,6 +1512,19 @@ typedef enum ngf_descriptor_type {
    */
   NGF_DESCRIPTOR_STORAGE_IMAGE,
 
+  /**
+   * \ingroup ngf
+   *
+   * A uniform buffer with a dynamic offset. The binding has to be listed in the
+   * `dynamic_uniform_buffers` of the pipeline. For bind operations of this type,
+   * \ref ngf_buffer_bind_info::offset is applied when the descriptor set is bound, rather than
+   * being written into the set. Binding the same buffer and range at a different offset therefore
+   * reuses the same descriptor set, which makes this a good fit for per-draw constants
+   * sub-allocated from one large buffer. The offset must be a multiple of
+   * \ref ngf_device_capabilities::uniform_buffer_offset_alignment.
+   */
+  NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC,
+
   NGF_DESCRIPTOR_TYPE_COUNT
 } ngf_descriptor_type;
 
@@ -1730,6 +1772,19 @@ typedef struct ngf_image_ref {
                                       non-cubemap images.*/
 } ngf_image_ref;
 
+/**
+ * @struct ngf_image_write
+ * \ingroup ngf
+ * Describes a single region written by \ref ngf_cmd_write_images.
+ */
+typedef struct ngf_image_write {
+  size_t        src_offset; /**< Offset in the source buffer from which to start copying. */
+  ngf_image_ref dst;        /**< Reference to the image region that shall be written to. */
+  ngf_offset3d  offset;     /**< Offset within the target mip level to write to (in texels). */
+  ngf_extent3d  extent;     /**< Size of the region in the target mip level being overwritten. */
+  uint32_t      nlayers;    /**< Number of layers affected by the write. */
+} ngf_image_write;
+
 /**
  * @struct ngf_render_target_info
  * \ingroup ngf
@@ -2075,7 +2130,13 @@ typedef enum ngf_buffer_usage {
   /**
    * \ingroup ngf
    * The buffer may be bound as a storage buffer. */
-  NGF_BUFFER_USAGE_STORAGE_BUFFER = 0x40
+  NGF_BUFFER_USAGE_STORAGE_BUFFER = 0x40,
+
+  /**
+   * \ingroup ngf
+   * The buffer may be used as a source of arguments (or draw counts) for indirect draws and
+   * dispatches. See \ref ngf_cmd_draw_indirect and \ref ngf_cmd_dispatch_indirect. */
+  NGF_BUFFER_USAGE_INDIRECT = 0x80
 } ngf_buffer_usage;
 
 /**
@@ -2109,6 +2170,60 @@ typedef struct ngf_buffer_slice {
   size_t     range;  /**< Size of the subregion. */
 } ngf_buffer_slice;
 
+/**
+ * @struct ngf_upload_allocation
+ * \ingroup ngf
+ *
+ * A region of transient host-visible memory obtained from \ref ngf_upload_alloc.
+ */
+typedef struct ngf_upload_allocation {
+  ngf_buffer buffer; /**< The buffer that the region belongs to. */
+  size_t     offset; /**< Starting offset of the region within the buffer. */
+  void*      data;   /**< Host pointer to the start of the region. */
+} ngf_upload_allocation;
+
+/**
+ * @struct ngf_draw_indirect_args
+ * \ingroup ngf
+ *
+ * Layout of the arguments for a single non-indexed indirect draw, as read from the argument buffer
+ * by \ref ngf_cmd_draw_indirect.
+ */
+typedef struct ngf_draw_indirect_args {
+  uint32_t nvertices;      /**< Number of vertices to draw. */
+  uint32_t ninstances;     /**< Number of instances to draw. */
+  uint32_t first_vertex;   /**< Index of the first vertex to draw. */
+  uint32_t first_instance; /**< Instance ID of the first instance to draw. */
+} ngf_draw_indirect_args;
+
+/**
+ * @struct ngf_draw_indexed_indirect_args
+ * \ingroup ngf
+ *
+ * Layout of the arguments for a single indexed indirect draw, as read from the argument buffer by
+ * \ref ngf_cmd_draw_indirect.
+ */
+typedef struct ngf_draw_indexed_indirect_args {
+  uint32_t nindices;       /**< Number of indices to draw. */
+  uint32_t ninstances;     /**< Number of instances to draw. */
+  uint32_t first_index;    /**< Position of the first index within the bound index buffer. */
+  int32_t  vertex_offset;  /**< Value added to each index before fetching vertex data. */
+  uint32_t first_instance; /**< Instance ID of the first instance to draw. */
+} ngf_draw_indexed_indirect_args;
+
+/**
+ * @struct ngf_dispatch_indirect_args
+ * \ingroup ngf
+ *
+ * Layout of the arguments for an indirect compute dispatch, as read from the argument buffer by
+ * \ref ngf_cmd_dispatch_indirect.
+ */
+typedef struct ngf_dispatch_indirect_args {
+  uint32_t x_threadgroups; /**< Number of threadgroups along the X dimension of the grid. */
+  uint32_t y_threadgroups; /**< Number of threadgroups along the Y dimension of the grid. */
+  uint32_t z_threadgroups; /**< Number of threadgroups along the Z dimension of the grid. */
+} ngf_dispatch_indirect_args;
+
 /**
  * @struct ngf_texel_buffer_view
  * \ingroup ngf
@@ -2180,6 +2295,179 @@ typedef struct ngf_resource_bind_op {
   } info; /**< The details about the resource being bound, depending on type. */
 } ngf_resource_bind_op;
 
+/**
+ * @struct ngf_bind_group
+ * \ingroup ngf
+ *
+ * An opaque handle to a persistent bind group.
+ *
+ * A bind group captures the resources for an entire descriptor set at creation time. Unlike
+ * resources bound with \ref ngf_cmd_bind_resources, which are written into freshly allocated
+ * descriptor sets every frame, the contents of a bind group are written exactly once, so binding it
+ * costs no descriptor writes. This makes bind groups a good fit for data that changes rarely, such
+ * as per-material textures and constants.
+ *
+ * See also: \ref ngf_bind_group_info, \ref ngf_create_bind_group, \ref ngf_cmd_bind_group.
+ */
+typedef struct ngf_bind_group_t* ngf_bind_group;
+
+/**
+ * @struct ngf_bind_group_info
+ * \ingroup ngf
+ *
+ * Information required to create a bind group.
+ *
+ * The layout of the group is taken from the given set of the given pipeline. Exactly one of \ref
+ * ngf_bind_group_info::gfx_pipeline and \ref ngf_bind_group_info::compute_pipeline must be
+ * non-NULL. The resulting group may be bound with any pipeline whose layout for the same set is
+ * identical.
+ */
+typedef struct ngf_bind_group_info {
+  ngf_graphics_pipeline gfx_pipeline;     /**< Graphics pipeline to take the set layout from. */
+  ngf_compute_pipeline  compute_pipeline; /**< Compute pipeline to take the set layout from. */
+  uint32_t              set;              /**< Index of the set that the group provides. */
+
+  /**
+   * Resources to write into the group. The target set of every bind operation must match \ref
+   * ngf_bind_group_info::set. The referenced resources must outlive the group.
+   */
+  const ngf_resource_bind_op* bind_operations;
+  uint32_t                    nbind_operations; /**< Number of elements in bind_operations. */
+} ngf_bind_group_info;
+
+/**
+ * @struct ngf_resource_table
+ * \ingroup ngf
+ *
+ * An opaque handle to a resource table.
+ *
+ * A resource table is a large, device-global array of resources of a single type, which shaders
+ * index directly (a.k.a. "bindless" resources). Applications allocate slots in the table, write
+ * resources into them, and pass the slot indices to shaders, e.g. through push constants. The
+ * whole table is bound with a single command, regardless of how many resources it holds, which
+ * makes it possible to render many distinct materials without rebinding resources between draws.
+ *
+ * Shaders access a table through an unsized array declared at binding 0 of a set that contains no
+ * other bindings, for example:
+ *
+ * ```
+ * layout(set = 2, binding = 0) uniform texture2D textures[];
+ * ```
+ *
+ * Resource tables are only available if \ref ngf_device_capabilities::resource_tables_supported is
+ * set.
+ *
+ * See also: \ref ngf_resource_table_info, \ref ngf_create_resource_table,
+ * \ref ngf_cmd_bind_resource_table.
+ */
+typedef struct ngf_resource_table_t* ngf_resource_table;
+
+/**
+ * @struct ngf_resource_table_info
+ * \ingroup ngf
+ *
+ * Information required to create a resource table.
+ */
+typedef struct ngf_resource_table_info {
+  /**
+   * The type of resources held by the table. Must be either \ref NGF_DESCRIPTOR_IMAGE or \ref
+   * NGF_DESCRIPTOR_STORAGE_BUFFER.
+   */
+  ngf_descriptor_type type;
+
+  /**
+   * The number of slots in the table. Must not exceed \ref
+   * ngf_device_capabilities::max_resource_table_capacity.
+   */
+  uint32_t capacity;
+} ngf_resource_table_info;
+
+/**
+ * @struct ngf_query_pool
+ * \ingroup ngf
+ *
+ * An opaque handle to a query pool.
+ *
+ * A query pool is a fixed-size array of queries of a single type. Commands write results into the
+ * pool's queries on the rendering device, and the application reads them back later with \ref
+ * ngf_get_query_results, without waiting for the device.
+ *
+ * Query results are collected when the frame that wrote them is retired, i.e. once the rendering
+ * device has finished executing it, which typically happens a few frames after its submission. An
+ * application that writes queries every frame should therefore use a separate range of queries
+ * for each frame in flight, and read the results of a range back before reusing it.
+ *
+ * See also: \ref ngf_query_pool_info, \ref ngf_create_query_pool, \ref ngf_cmd_write_timestamp,
+ * \ref ngf_cmd_enable_pass_timestamps, \ref ngf_cmd_begin_query.
+ */
+typedef struct ngf_query_pool_t* ngf_query_pool;
+
+/**
+ * @enum ngf_query_type
+ * \ingroup ngf
+ *
+ * Enumerates the types of queries.
+ */
+typedef enum ngf_query_type {
+  /**
+   * \ingroup ngf
+   * Each query holds the time, in nanoseconds, at which the rendering device reached a certain
+   * point in the command stream. Only the differences between timestamps are meaningful. Timestamp
+   * queries are only available if \ref ngf_device_capabilities::timestamp_queries_supported is set.
+   */
+  NGF_QUERY_TYPE_TIMESTAMP = 0,
+
+  /**
+   * \ingroup ngf
+   * Each query holds the number of samples that passed the depth and stencil tests while the query
+   * was active. Devices that can't count samples precisely may report a different non-zero number,
+   * but the result is only zero if no samples have passed. Occlusion queries are only available if
+   * \ref ngf_device_capabilities::occlusion_queries_supported is set.
+   */
+  NGF_QUERY_TYPE_OCCLUSION,
+
+  /**
+   * \ingroup ngf
+   * Each query holds \ref NGF_PIPELINE_STATISTIC_COUNT counters of the work done by the rendering
+   * device while the query was active, indexed by \ref ngf_pipeline_statistic. Pipeline statistics
+   * queries are only available if \ref
+   * ngf_device_capabilities::pipeline_statistics_queries_supported is set.
+   */
+  NGF_QUERY_TYPE_PIPELINE_STATISTICS,
+
+  NGF_QUERY_TYPE_COUNT
+} ngf_query_type;
+
+/**
+ * @enum ngf_pipeline_statistic
+ * \ingroup ngf
+ *
+ * Enumerates the counters held by each \ref NGF_QUERY_TYPE_PIPELINE_STATISTICS query, in the order
+ * in which they are reported by \ref ngf_get_query_results.
+ */
+typedef enum ngf_pipeline_statistic {
+  /** \ingroup ngf
+   * Number of vertex shader invocations. */
+  NGF_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS = 0,
+
+  /** \ingroup ngf
+   * Number of fragment shader invocations. */
+  NGF_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS,
+
+  NGF_PIPELINE_STATISTIC_COUNT
+} ngf_pipeline_statistic;
+
+/**
+ * @struct ngf_query_pool_info
+ * \ingroup ngf
+ *
+ * Information required to create a query pool.
+ */
+typedef struct ngf_query_pool_info {
+  ngf_query_type type;     /**< The type of queries held by the pool. */
+  uint32_t       nqueries; /**< The number of queries in the pool. Must be greater than zero. */
+} ngf_query_pool_info;
+
 /**
  * @enum ngf_present_mode
  * \ingroup ngf
@@ -2261,6 +2549,35 @@ typedef struct ngf_swapchain_info {
  */
 typedef struct ngf_context_t* ngf_context;
 
+/**
+ * @struct ngf_descriptor_pool_info
+ * \ingroup ngf
+ * Controls how the backend sizes the pools it allocates descriptor sets (or their equivalent) from.
+ * Backends that do not use descriptor pools ignore this.
+ */
+typedef struct ngf_descriptor_pool_info {
+  /**
+   * The maximum number of descriptor sets that the first pool allocated for a frame can hold. If
+   * zero, a backend-specific default is used.
+   */
+  uint32_t initial_sets;
+
+  /**
+   * The number of descriptors of each type that the first pool allocated for a frame can hold. If
+   * zero, a backend-specific default is used.
+   */
+  uint32_t initial_descriptors_per_type;
+
+  /**
+   * If true, the pool sizes are adjusted automatically: when a pool runs out of space mid-frame,
+   * the next one is made geometrically larger, and at the beginning of each frame the pools are
+   * resized according to the highest usage observed during previous frames. Descriptors of each
+   * type are then provisioned in proportion to how often that type was actually used.
+   * If false, every pool is created with the initial capacity.
+   */
+  bool adaptive;
+} ngf_descriptor_pool_info;
+
 /**
  * @struct ngf_context_info
  * \ingroup ngf
@@ -2279,15 +2596,160 @@ typedef struct ngf_context_info {
    * (such as buffers and images) created within the given context, and vice versa Can be NULL.
    */
   const ngf_context shared_context;
+
+  /**
+   * Configures the sizing of descriptor pools used by the context. Can be NULL, in which case
+   * fixed-size pools with backend-specific default capacity are used.
+   */
+  const ngf_descriptor_pool_info* descriptor_pool_info;
+
+  /**
+   * If true, the context maintains a cache of compiled pipeline state that is consulted when
+   * creating new pipelines. The contents of the cache can be saved with
+   * \ref ngf_get_pipeline_cache_data and restored in a later run with
+   * \ref ngf_load_pipeline_cache, which avoids recompiling the same pipelines on every start.
+   */
+  bool enable_pipeline_cache;
+
+  /**
+   * If true, the context destroys resources released by the application on a dedicated background
+   * thread, once the GPU is done using them, instead of doing so inside \ref ngf_begin_frame. This
+   * smooths out frame start times when large numbers of resources are released at once. Any
+   * outstanding destruction work is completed by \ref ngf_destroy_context. Backends that have no
+   * use for a retirement thread ignore this option.
+   */
+  bool enable_background_retirement;
 } ngf_context_info;
 
+/**
+ * @struct ngf_context_stats
+ * \ingroup ngf
+ * Counters describing the internal behavior of a context, accumulated since the context was
+ * created. Counters that are not relevant for the current backend are always zero.
+ * See also: \ref ngf_get_context_stats.
+ */
+typedef struct ngf_context_stats {
+  /**
+   * Number of times a descriptor set with the required layout and contents had already been
+   * written earlier in the same frame and was reused instead of allocating and writing a new one.
+   */
+  uint64_t descriptor_set_cache_hits;
+
+  /**
+   * Number of times a new descriptor set had to be allocated and written because no matching
+   * descriptor set was found in the current frame's cache.
+   */
+  uint64_t descriptor_set_cache_misses;
+
+  /**
+   * Number of descriptor pools that have been created by the context.
+   */
+  uint64_t descriptor_pools_created;
+
+  /**
+   * Number of times a new backend command buffer object had to be allocated because none could be
+   * recycled. Once the application reaches a steady state, this should stop increasing.
+   */
+  uint64_t cmd_buffer_allocations;
+
+  /**
+   * Number of times a render pass began with a combination of render target and attachment
+   * load/store operations that had been used before, allowing a cached backend object to be
+   * reused.
+   */
+  uint64_t render_pass_cache_hits;
+
+  /**
+   * Number of times a render pass began with a combination of render target and attachment
+   * load/store operations that had not been used before, requiring a new backend object.
+   */
+  uint64_t render_pass_cache_misses;
+
+  /**
+   * Number of entries currently held in the render pass cache. Unlike the other members, this is
+   * not a cumulative counter.
+   */
+  uint64_t render_pass_cache_size;
+
+  /**
+   * Number of pipeline, vertex/index buffer, viewport, scissor and stencil state changes that were
+   * dropped because the requested state was already set in the command buffer.
+   */
+  uint64_t redundant_state_changes_elided;
+} ngf_context_stats;
+
+/**
+ * @enum ngf_cmd_buffer_flags
+ * \ingroup ngf
+ * Flags that may be specified when creating a command buffer.
+ */
+typedef enum ngf_cmd_buffer_flags {
+  /**
+   * \ingroup ngf
+   * The command buffer is executed on a dedicated transfer queue, concurrently with rendering work.
+   * Such command buffers may only record transfer passes, and only the \ref ngf_cmd_copy_buffer,
+   * \ref ngf_cmd_write_image and \ref ngf_cmd_write_images commands are supported within those
+   * passes.
+   *
+   * Work submitted with such command buffers is guaranteed to complete before any rendering or
+   * compute work recorded into regular command buffers and submitted during the same frame starts
+   * reading the written resources. Ownership of the written regions is handed over to the
+   * rendering queue automatically, and other encoders may not synchronize with the transfer
+   * encoders of such command buffers explicitly.
+   *
+   * The written resources must not be in use by any commands that may still be executing, so this
+   * is best suited for populating newly created resources, like the ones used by a streamed-in
+   * level. If the device doesn't have a dedicated transfer queue (see
+   * \ref ngf_device_capabilities::async_xfer_supported), the command buffer is executed on the
+   * rendering queue as usual.
+   */
+  NGF_CMD_BUFFER_ASYNC_XFER = 0x01,
+
+  /**
+   * \ingroup ngf
+   * The command buffer is executed on a dedicated compute queue, concurrently with rendering work.
+   * Such command buffers may only record compute passes. Those passes may only synchronize with
+   * compute encoders of other command buffers created with this flag.
+   *
+   * Render and compute passes of regular command buffers synchronize with the compute encoders of
+   * such command buffers via their \ref ngf_sync_compute_resources, as usual. Ownership of the
+   * listed resources is handed over to the rendering queue automatically, and the rendering queue
+   * waits for the async compute work starting at the first command buffer that does this. Work
+   * recorded in command buffers submitted before that one may overlap with the async compute work.
+   *
+   * Ownership is not handed over in the opposite direction, so async compute work may only read
+   * resources that were written by the host or by other async compute work, and must not access
+   * resources used by rendering commands that may still be executing. If the device doesn't have
+   * a dedicated compute queue (see
+   * \ref ngf_device_capabilities::async_compute_supported), the command buffer is executed on the
+   * rendering queue as usual.
+   */
+  NGF_CMD_BUFFER_ASYNC_COMPUTE = 0x02,
+
+  /**
+   * \ingroup ngf
+   * The command buffer records a portion of a render pass that has been begun with \ref
+   * ngf_cmd_begin_parallel_render_pass in another command buffer. Such command buffers are never
+   * started or submitted directly. Instead, recording is begun with \ref
+   * ngf_cmd_begin_secondary_render_pass and finished with \ref ngf_cmd_end_secondary_render_pass,
+   * after which the recorded commands are inserted into the render pass by \ref
+   * ngf_cmd_execute_secondary_cmd_buffers.
+   *
+   * Distinct secondary command buffers may be recorded concurrently on different threads, which
+   * don't need to have a context set as current. This flag may not be combined with any other
+   * flags, and is only supported if \ref ngf_device_capabilities::secondary_cmd_buffers_supported
+   * is set.
+   */
+  NGF_CMD_BUFFER_SECONDARY = 0x04
+} ngf_cmd_buffer_flags;
+
 /**
  * @struct ngf_cmd_buffer_info
  * \ingroup ngf
  * Information about a command buffer.
  */
 typedef struct ngf_cmd_buffer_info {
-  uint32_t reserved;
+  uint32_t flags; /**< A combination of flags from \ref ngf_cmd_buffer_flags. */
 } ngf_cmd_buffer_info;
 
 /**
@@ -2589,6 +3051,65 @@ typedef struct ngf_device_capabilities {
    * This value is derived from \ref texture_depth_sample_counts.
    */
   ngf_sample_count max_supported_texture_depth_sample_count;
+
+  /**
+   * The maximum number of draws that may be issued by a single call to
+   * \ref ngf_cmd_draw_indirect or \ref ngf_cmd_draw_indirect_count.
+   */
+  size_t max_draw_indirect_count;
+
+  /**
+   * This flag is set to true if the device supports sourcing the number of indirect draws from a
+   * GPU buffer, see \ref ngf_cmd_draw_indirect_count.
+   */
+  bool draw_indirect_count_supported;
+
+  /**
+   * This flag is set to true if the device supports resource tables, see \ref ngf_resource_table.
+   */
+  bool resource_tables_supported;
+
+  /**
+   * The maximum number of slots in a single \ref ngf_resource_table. This is also the size of the
+   * unsized array bindings in the pipeline layouts. Zero if resource tables are not supported.
+   */
+  uint32_t max_resource_table_capacity;
+
+  /**
+   * This flag is set to true if the device has a dedicated transfer queue, allowing command buffers
+   * created with \ref NGF_CMD_BUFFER_ASYNC_XFER to execute concurrently with rendering.
+   */
+  bool async_xfer_supported;
+
+  /**
+   * This flag is set to true if the device has a dedicated compute queue, allowing command buffers
+   * created with \ref NGF_CMD_BUFFER_ASYNC_COMPUTE to execute concurrently with rendering.
+   */
+  bool async_compute_supported;
+
+  /**
+   * This flag is set to true if the device supports timestamp queries on all of its queues, see
+   * \ref NGF_QUERY_TYPE_TIMESTAMP.
+   */
+  bool timestamp_queries_supported;
+
+  /**
+   * This flag is set to true if the device supports occlusion queries, see \ref
+   * NGF_QUERY_TYPE_OCCLUSION.
+   */
+  bool occlusion_queries_supported;
+
+  /**
+   * This flag is set to true if the device supports pipeline statistics queries, see \ref
+   * NGF_QUERY_TYPE_PIPELINE_STATISTICS.
+   */
+  bool pipeline_statistics_queries_supported;
+
+  /**
+   * This flag is set to true if render passes may be recorded in parallel into command buffers
+   * created with \ref NGF_CMD_BUFFER_SECONDARY, see \ref ngf_cmd_begin_parallel_render_pass.
+   */
+  bool secondary_cmd_buffers_supported;
 } ngf_device_capabilities;
 
 /**
@@ -2597,6 +3118,13 @@ typedef struct ngf_device_capabilities {
  */
 #define NGF_DEVICE_NAME_MAX_LENGTH (256u)
 
+/**
+ * Maximum size (in bytes) of the push constant block accessible to a pipeline.
+ * See \ref ngf_cmd_push_constants.
+ * \ingroup ngf
+ */
+#define NGF_MAX_PUSH_CONSTANTS_SIZE (128u)
+
 /**
  * @struct ngf_device
  * Information about a rendering device.
@@ -2710,6 +3238,59 @@ ngf_error ngf_resize_context(ngf_context ctx, uint32_t new_width, uint32_t new_h
  */
 ngf_error ngf_set_context(ngf_context ctx) NGF_NOEXCEPT;
 
+/**
+ * \ingroup ngf
+ *
+ * Obtains the internal counters of the given context.
+ *
+ * Counters gathered while recording a command buffer are added to the context's when the command
+ * buffer is handed over to the frame. For command buffers executed on the main graphics queue, that
+ * happens when the frame ends.
+ *
+ * @param ctx The context to query.
+ * @param stats A pointer to a \ref ngf_context_stats instance to write the counter values into.
+ */
+ngf_error ngf_get_context_stats(ngf_context ctx, ngf_context_stats* stats) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Merges previously saved pipeline cache data into the pipeline cache of the given context.
+ * Pipelines created afterwards may be able to skip compilation if they are found in the cache.
+ *
+ * The data is expected to have been obtained with \ref ngf_get_pipeline_cache_data, on the same
+ * device and driver. Data that was produced by a different device or driver is rejected.
+ * Backends that do not maintain a pipeline cache accept and ignore the data.
+ *
+ * @param ctx The context, which must have been created with
+ *            \ref ngf_context_info::enable_pipeline_cache set to `true`.
+ * @param data Pointer to the cache data.
+ * @param size Size of the cache data, in bytes.
+ * @return \ref NGF_ERROR_INVALID_FORMAT if the data was produced by a different device or driver,
+ *         \ref NGF_ERROR_INVALID_OPERATION if the context does not have a pipeline cache.
+ */
+ngf_error ngf_load_pipeline_cache(ngf_context ctx, const void* data, size_t size) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Retrieves the contents of the given context's pipeline cache, so that they can be saved and
+ * passed to \ref ngf_load_pipeline_cache later.
+ *
+ * If `data` is NULL, the size of the cache data (in bytes) is written into `size`. Otherwise,
+ * `size` must point to the size of the buffer pointed to by `data`; the cache data is written into
+ * the buffer, and the number of bytes actually written is stored into `size`.
+ * Backends that do not maintain a pipeline cache report a size of zero.
+ *
+ * @param ctx The context, which must have been created with
+ *            \ref ngf_context_info::enable_pipeline_cache set to `true`.
+ * @param data Pointer to the buffer to write the cache data into, or NULL.
+ * @param size Pointer to the size of the buffer.
+ * @return \ref NGF_ERROR_INVALID_SIZE if the buffer is too small to hold the cache data,
+ *         \ref NGF_ERROR_INVALID_OPERATION if the context does not have a pipeline cache.
+ */
+ngf_error ngf_get_pipeline_cache_data(ngf_context ctx, void* data, size_t* size) NGF_NOEXCEPT;
+
 /**
  * \ingroup ngf
  *
@@ -2766,6 +3347,10 @@ void ngf_destroy_shader_stage(ngf_shader_stage stage) NGF_NOEXCEPT;
  *
  * Creates a new graphics pipeline object.
  *
+ * This function may be called concurrently from multiple threads, provided that each of those
+ * threads has the same context set as current (see \ref ngf_set_context), and that the
+ * application's allocation callbacks (if any) are thread-safe.
+ *
  * @param info Information required to construct the graphics pipeline object.
  * @param result Pointer to where the handle to the newly created object will be returned.
  */
@@ -2773,6 +3358,27 @@ ngf_error ngf_create_graphics_pipeline(
     const ngf_graphics_pipeline_info* info,
     ngf_graphics_pipeline*            result) NGF_NOEXCEPT;
 
+/**
+ * \ingroup ngf
+ *
+ * Creates several graphics pipeline objects at once. The work may be spread across multiple
+ * worker threads, which makes this considerably faster than creating the same pipelines one by
+ * one on backends where pipeline creation is expensive.
+ *
+ * If any of the pipelines fails to be created, all the pipelines that were successfully created
+ * are destroyed, all the elements of `results` are set to NULL, and the error corresponding to the
+ * first failed pipeline is returned.
+ *
+ * @param infos Pointer to an array of `npipelines` pipeline descriptions.
+ * @param npipelines The number of pipelines to create.
+ * @param results Pointer to an array of `npipelines` elements, where the handles to the newly
+ *                created pipelines will be returned, in the same order as the descriptions.
+ */
+ngf_error ngf_create_graphics_pipelines(
+    const ngf_graphics_pipeline_info* infos,
+    uint32_t                          npipelines,
+    ngf_graphics_pipeline*            results) NGF_NOEXCEPT;
+
 /**
  * \ingroup ngf
  *
@@ -2948,6 +3554,26 @@ void ngf_buffer_flush_range(ngf_buffer buf, size_t offset, size_t size) NGF_NOEX
  */
 void ngf_buffer_unmap(ngf_buffer buf) NGF_NOEXCEPT;
 
+/**
+ * \ingroup ngf
+ *
+ * Allocates a region of transient, host-visible memory from the current frame's upload ring.
+ *
+ * The returned memory is persistently mapped and may be written into directly, it does not need to
+ * be flushed. The region may be used as a source of transfer operations, or bound as a uniform,
+ * storage, vertex or index buffer, by any command buffer submitted during the current frame.
+ * The memory is recycled automatically once the rendering device has finished executing the
+ * current frame, so the allocation must not be used after the call to \ref ngf_end_frame.
+ * The buffer handle in the result is owned by the context and must not be destroyed by the
+ * caller.
+ *
+ * @param size The size of the region, in bytes. Must be greater than zero.
+ * @param alignment Required alignment of the region's offset, in bytes. Must be a power of two.
+ * @param result Pointer to where the description of the allocated region will be written to.
+ */
+ngf_error
+ngf_upload_alloc(size_t size, size_t alignment, ngf_upload_allocation* result) NGF_NOEXCEPT;
+
 /**
  * \ingroup ngf
  * Creates a new texel buffer view object.
@@ -2968,6 +3594,133 @@ ngf_error ngf_create_texel_buffer_view(
  */
 void ngf_destroy_texel_buffer_view(ngf_texel_buffer_view buf_view) NGF_NOEXCEPT;
 
+/**
+ * \ingroup ngf
+ *
+ * Creates a new persistent bind group. See \ref ngf_bind_group for more details.
+ *
+ * @param info Information required to construct the bind group.
+ * @param result Pointer to where the handle to the newly created object will be written to.
+ */
+ngf_error
+ngf_create_bind_group(const ngf_bind_group_info* info, ngf_bind_group* result) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Destroys the given bind group. It is safe to destroy a bind group that is referenced by command
+ * buffers which have not finished executing yet.
+ *
+ * @param group The handle to the bind group to be destroyed.
+ */
+void ngf_destroy_bind_group(ngf_bind_group group) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Creates a new resource table. See \ref ngf_resource_table for more details.
+ *
+ * @param info Information required to construct the resource table.
+ * @param result Pointer to where the handle to the newly created object will be written to.
+ */
+ngf_error ngf_create_resource_table(
+    const ngf_resource_table_info* info,
+    ngf_resource_table*            result) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Destroys the given resource table.
+ *
+ * @param table The handle to the resource table to be destroyed.
+ */
+void ngf_destroy_resource_table(ngf_resource_table table) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Allocates an unused slot in the given resource table. The contents of a freshly allocated slot
+ * are undefined until they are written with \ref ngf_write_resource_table.
+ *
+ * @param table The table to allocate the slot from.
+ * @param slot Pointer to where the index of the allocated slot will be written to.
+ * \return NGF_ERROR_OUT_OF_MEM if all of the table's slots are in use.
+ */
+ngf_error ngf_alloc_resource_table_slot(ngf_resource_table table, uint32_t* slot) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Returns a slot to the given resource table. Since the slot may still be referenced by commands
+ * that are in flight, it only becomes available for allocation again once the current frame has
+ * finished executing.
+ *
+ * @param table The table that the slot was allocated from.
+ * @param slot The index of the slot to free.
+ */
+void ngf_free_resource_table_slot(ngf_resource_table table, uint32_t slot) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Writes a resource into an allocated slot of the given resource table. The slot must not be
+ * accessed by any commands that are in flight.
+ *
+ * @param table The table to write to.
+ * @param slot The index of the slot to write to.
+ * @param resource Describes the resource to write. Its type must match the type of the table, the
+ *                 target set and binding are ignored.
+ */
+ngf_error ngf_write_resource_table(
+    ngf_resource_table          table,
+    uint32_t                    slot,
+    const ngf_resource_bind_op* resource) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Creates a new query pool. See \ref ngf_query_pool for more details.
+ *
+ * @param info Information required to construct the query pool.
+ * @param result Pointer to where the handle to the newly created object will be written to.
+ */
+ngf_error
+ngf_create_query_pool(const ngf_query_pool_info* info, ngf_query_pool* result) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Destroys the given query pool. It is safe to destroy a query pool that is referenced by command
+ * buffers which have not finished executing yet.
+ *
+ * @param pool The handle to the query pool to be destroyed.
+ */
+void ngf_destroy_query_pool(ngf_query_pool pool) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Reads back the results of a range of queries from the given pool. This function never waits for
+ * the rendering device. The result of a query is available once a frame that wrote the query has
+ * been retired, and reflects the most recently retired write. If the result of any query in the
+ * range is not available yet, \ref NGF_ERROR_NOT_READY is returned and the contents of `results`
+ * are undefined, in which case the application may try again during a later frame. Since a
+ * query may be overwritten by a later frame before an earlier one is retired, applications that
+ * write the same queries every frame should use a separate range of queries per frame in flight.
+ *
+ * @param pool The pool to read the results from.
+ * @param first_query Index of the first query in the range.
+ * @param nqueries Number of queries in the range.
+ * @param results Pointer to where the results shall be written to. Each query produces a single
+ *                value, except for \ref NGF_QUERY_TYPE_PIPELINE_STATISTICS queries, which produce
+ *                \ref NGF_PIPELINE_STATISTIC_COUNT consecutive values each.
+ */
+ngf_error ngf_get_query_results(
+    ngf_query_pool pool,
+    uint32_t       first_query,
+    uint32_t       nqueries,
+    uint64_t*      results) NGF_NOEXCEPT;
+
 /**
  * \ingroup ngf
  *
@@ -2983,6 +3736,9 @@ void ngf_finish(void) NGF_NOEXCEPT;
  *
  * Creates a new command buffer.
  *
+ * The new command buffer belongs to the context that is current on the calling thread. It may only
+ * be used to record commands for frames of that context.
+ *
  * @param info The information required to create the new command buffer.
  * @param result Pointer to where the handle to the newly created command buffer will be returned.
  */
@@ -2999,6 +3755,9 @@ ngf_create_cmd_buffer(const ngf_cmd_buffer_info* info, ngf_cmd_buffer* result) N
  * the commands associated with the command buffer to finish before it can safely dispose of the
  * command buffer.
  *
+ * The command buffer must be destroyed on the thread that its context is current on, before the
+ * context itself is destroyed.
+ *
  * @param buffer The handle to the command buffer object to be destroyed.
  */
 void ngf_destroy_cmd_buffer(ngf_cmd_buffer buffer) NGF_NOEXCEPT;
@@ -3014,6 +3773,11 @@ void ngf_destroy_cmd_buffer(ngf_cmd_buffer buffer) NGF_NOEXCEPT;
  *
  * The command buffer is required to be in the "ready" state.
  *
+ * Command buffers may be started, recorded into and submitted on any thread, even one that has no
+ * current context. Different command buffers may be recorded concurrently on different threads,
+ * but a single command buffer must not be used by several threads at the same time. The frame
+ * identified by the token must be the one currently being recorded by the command buffer's context.
+ *
  * @param buf The handle to the command buffer to operate on
  * @param token The token for the frame within which the recorded commands are going to be
  *              submitted.
@@ -3027,12 +3791,55 @@ ngf_error ngf_start_cmd_buffer(ngf_cmd_buffer buf, ngf_frame_token token) NGF_NO
  * All command buffers must be in the "awaiting submission" state, and shall be transitioned to the
  * "submitted" state.
  *
+ * Commands for the main graphics queue are executed when the frame ends, in the order in which the
+ * command buffers have been submitted. This function may be called from any thread for such command
+ * buffers. Command buffers created with \ref NGF_CMD_BUFFER_ASYNC_XFER or
+ * \ref NGF_CMD_BUFFER_ASYNC_COMPUTE are submitted to their queue right away, and may only be
+ * submitted on the thread that their context is current on.
+ *
  * @param nbuffers The number of command buffers being submitted for execution.
  * @param bufs A pointer to a contiguous array of \ref nbuffers handles to command buffer objects to
  *             be submitted for execution.
  */
 ngf_error ngf_submit_cmd_buffers(uint32_t nbuffers, ngf_cmd_buffer* bufs) NGF_NOEXCEPT;
 
+/**
+ * \ingroup ngf
+ *
+ * Writes a timestamp into the given query once all previously recorded commands have completed.
+ * Any previous result of the query is discarded. Must not be called while a pass is being recorded
+ * into the command buffer, and is not supported for command buffers created with \ref
+ * NGF_CMD_BUFFER_ASYNC_XFER.
+ *
+ * @param buf The command buffer to record the command into. Must have been started.
+ * @param pool A pool of \ref NGF_QUERY_TYPE_TIMESTAMP queries.
+ * @param query Index of the query to write.
+ */
+ngf_error
+ngf_cmd_write_timestamp(ngf_cmd_buffer buf, ngf_query_pool pool, uint32_t query) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Enables automatic timestamps for the passes subsequently recorded into the given command buffer.
+ * Each render, compute or transfer pass writes a timestamp before its first command and after its
+ * last command into two consecutive queries of the given range, until the range is exhausted. For
+ * example, the duration of the first pass is the difference between the results of the queries
+ * `first_query + 1` and `first_query`. Pass timestamps are disabled when the command buffer is
+ * started, or when this function is called with a NULL pool.
+ *
+ * @param buf The command buffer to operate on. Must have been started, and must not be created
+ *            with \ref NGF_CMD_BUFFER_ASYNC_XFER.
+ * @param pool A pool of \ref NGF_QUERY_TYPE_TIMESTAMP queries, or NULL.
+ * @param first_query Index of the first query in the range.
+ * @param nqueries Number of queries in the range.
+ */
+ngf_error ngf_cmd_enable_pass_timestamps(
+    ngf_cmd_buffer buf,
+    ngf_query_pool pool,
+    uint32_t       first_query,
+    uint32_t       nqueries) NGF_NOEXCEPT;
+
 /**
  * \ingroup ngf
  *
@@ -3121,6 +3928,78 @@ ngf_error ngf_cmd_begin_render_pass_simple_with_sync(
  */
 ngf_error ngf_cmd_end_render_pass(ngf_render_encoder enc) NGF_NOEXCEPT;
 
+/**
+ * \ingroup ngf
+ *
+ * Begins a new render pass, the commands of which are recorded into secondary command buffers (see
+ * \ref NGF_CMD_BUFFER_SECONDARY). This allows splitting the work of recording a single render pass
+ * across multiple threads.
+ *
+ * The returned encoder may not be used to record rendering commands directly. It may only be used
+ * with \ref ngf_cmd_begin_secondary_render_pass, \ref ngf_cmd_execute_secondary_cmd_buffers and
+ * \ref ngf_cmd_end_render_pass.
+ *
+ * @param buf The command buffer to operate on. Same requirements as for \ref
+ *            ngf_cmd_begin_render_pass apply.
+ * @param pass_info Specifies the renderpass parameters, such as load and store operations.
+ * @param enc Pointer to memory into which a handle to the parent render encoder will be returned.
+ */
+ngf_error ngf_cmd_begin_parallel_render_pass(
+    ngf_cmd_buffer              buf,
+    const ngf_render_pass_info* pass_info,
+    ngf_render_encoder*         enc) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Starts recording a portion of a parallel render pass into the given secondary command buffer.
+ *
+ * This function may be called from any thread, concurrently with recording other secondary
+ * command buffers and with \ref ngf_cmd_execute_secondary_cmd_buffers, for as long as the parent
+ * render pass remains active. The returned encoder may be used with all the rendering commands,
+ * except for \ref ngf_cmd_begin_query.
+ *
+ * A secondary command buffer may be recorded several times within the same frame, but each
+ * recording may be executed only once.
+ *
+ * @param parent_enc An encoder returned by \ref ngf_cmd_begin_parallel_render_pass.
+ * @param buf A command buffer created with \ref NGF_CMD_BUFFER_SECONDARY. It must be in the "new",
+ *            "ready" or "submitted" state, and shall be transitioned to the "recording" state.
+ * @param enc Pointer to memory into which a handle to the secondary render encoder will be
+ *            returned.
+ */
+ngf_error ngf_cmd_begin_secondary_render_pass(
+    ngf_render_encoder  parent_enc,
+    ngf_cmd_buffer      buf,
+    ngf_render_encoder* enc) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Finishes recording into a secondary command buffer, transitioning it to the "awaiting
+ * submission" state. May be called from any thread.
+ *
+ * @param enc An encoder returned by \ref ngf_cmd_begin_secondary_render_pass.
+ */
+ngf_error ngf_cmd_end_secondary_render_pass(ngf_render_encoder enc) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Inserts the commands recorded into the given secondary command buffers into a parallel render
+ * pass, in the given order. Must be called on the thread that records the parent render pass. The
+ * secondary command buffers must have been recorded for the same render pass, and are transitioned
+ * to the "submitted" state.
+ *
+ * @param parent_enc An encoder returned by \ref ngf_cmd_begin_parallel_render_pass.
+ * @param nbuffers Number of secondary command buffers to execute.
+ * @param bufs Pointer to a contiguous array of `nbuffers` secondary command buffer handles.
+ */
+ngf_error ngf_cmd_execute_secondary_cmd_buffers(
+    ngf_render_encoder parent_enc,
+    uint32_t           nbuffers,
+    ngf_cmd_buffer*    bufs) NGF_NOEXCEPT;
+
 /**
  * \ingroup ngf
  *
@@ -3257,6 +4136,104 @@ void ngf_cmd_bind_compute_resources(
     const ngf_resource_bind_op* bind_operations,
     uint32_t                    nbind_operations) NGF_NOEXCEPT;
 
+/**
+ * \ingroup ngf
+ *
+ * Binds all the resources of a persistent bind group at once, to the set that the group was created
+ * for. A graphics pipeline must be bound before this call. Resources bound with \ref
+ * ngf_cmd_bind_resources to the same set are not merged with the group, whichever was bound last
+ * replaces the other.
+ *
+ * @param enc The handle to the render encoder object to record the command into.
+ * @param group The bind group to bind.
+ */
+void ngf_cmd_bind_group(ngf_render_encoder enc, const ngf_bind_group group) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Same as \ref ngf_cmd_bind_group, but for compute encoders. A compute pipeline must be bound
+ * before this call.
+ *
+ * @param enc The handle to the compute encoder object to record the command into.
+ * @param group The bind group to bind.
+ */
+void ngf_cmd_bind_compute_group(ngf_compute_encoder enc, const ngf_bind_group group) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Binds a resource table to the given set. The bound graphics pipeline must declare an unsized
+ * array of the table's resource type at binding 0 of that set. See \ref ngf_resource_table for
+ * more details.
+ *
+ * @param enc The handle to the render encoder object to record the command into.
+ * @param set The index of the set to bind the table to.
+ * @param table The resource table to bind.
+ */
+void ngf_cmd_bind_resource_table(
+    ngf_render_encoder       enc,
+    uint32_t                 set,
+    const ngf_resource_table table) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Same as \ref ngf_cmd_bind_resource_table, but for compute encoders.
+ *
+ * @param enc The handle to the compute encoder object to record the command into.
+ * @param set The index of the set to bind the table to.
+ * @param table The resource table to bind.
+ */
+void ngf_cmd_bind_compute_resource_table(
+    ngf_compute_encoder      enc,
+    uint32_t                 set,
+    const ngf_resource_table table) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Updates the contents of the push constant block - a small amount of data that shaders can read
+ * directly, without it having to be stored in a buffer and bound through a descriptor. This makes
+ * push constants well suited for small pieces of data that change with every draw, such as object
+ * indices or transforms.
+ *
+ * The written values are visible to all subsequent draws recorded into the same encoder, and
+ * persist across pipeline changes. The total size of the push constant blocks declared by a
+ * pipeline's shaders must not exceed \ref NGF_MAX_PUSH_CONSTANTS_SIZE.
+ *
+ * @param enc The handle to the render encoder object to record the command into.
+ * @param offset Offset (in bytes) into the push constant block at which to start writing. Must be
+ *               a multiple of 4.
+ * @param size Number of bytes to write. Must be a multiple of 4, and `offset + size` must not
+ *             exceed \ref NGF_MAX_PUSH_CONSTANTS_SIZE.
+ * @param data Pointer to the data to write.
+ */
+void ngf_cmd_push_constants(
+    ngf_render_encoder enc,
+    uint32_t           offset,
+    uint32_t           size,
+    const void*        data) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Same as \ref ngf_cmd_push_constants, but for compute encoders. The written values are visible
+ * to all subsequent dispatches recorded into the same encoder.
+ *
+ * @param enc The handle to the compute encoder object to record the command into.
+ * @param offset Offset (in bytes) into the push constant block at which to start writing. Must be
+ *               a multiple of 4.
+ * @param size Number of bytes to write. Must be a multiple of 4, and `offset + size` must not
+ *             exceed \ref NGF_MAX_PUSH_CONSTANTS_SIZE.
+ * @param data Pointer to the data to write.
+ */
+void ngf_cmd_push_compute_constants(
+    ngf_compute_encoder enc,
+    uint32_t            offset,
+    uint32_t            size,
+    const void*         data) NGF_NOEXCEPT;
+
 /**
  * \ingroup ngf
  *
@@ -3290,6 +4267,34 @@ void ngf_cmd_bind_index_buffer(
     uint32_t           offset,
     ngf_type           index_type) NGF_NOEXCEPT;
 
+/**
+ * \ingroup ngf
+ *
+ * Begins an occlusion or pipeline statistics query. The query is active until \ref
+ * ngf_cmd_end_query is called, which must happen before the end of the render pass. Only one query
+ * may be active in a command buffer at a time, and each query may be begun at most once per frame.
+ * Queries are not supported in parallel render passes (see \ref
+ * ngf_cmd_begin_parallel_render_pass).
+ *
+ * @param enc The render encoder to record the command into.
+ * @param pool A pool of \ref NGF_QUERY_TYPE_OCCLUSION or \ref NGF_QUERY_TYPE_PIPELINE_STATISTICS
+ *             queries.
+ * @param query Index of the query to begin.
+ * @return \ref NGF_ERROR_INVALID_OPERATION if the query has already been begun in the same command
+ *         buffer during the current frame.
+ */
+ngf_error
+ngf_cmd_begin_query(ngf_render_encoder enc, ngf_query_pool pool, uint32_t query) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Ends the query that is active in the given render encoder's command buffer.
+ *
+ * @param enc The render encoder to record the command into.
+ */
+ngf_error ngf_cmd_end_query(ngf_render_encoder enc) NGF_NOEXCEPT;
+
 /**
  * \ingroup ngf
  *
@@ -3309,6 +4314,65 @@ void ngf_cmd_draw(
     uint32_t           nelements,
     uint32_t           ninstances) NGF_NOEXCEPT;
 
+/**
+ * \ingroup ngf
+ *
+ * Executes one or more draws, sourcing their parameters from a buffer. This allows draw parameters
+ * to be generated on the GPU (for example, by a culling compute shader) without a round trip to
+ * the CPU. If the argument buffer is written by a compute pass, it must be listed among the
+ * resources to synchronize with when beginning the render pass.
+ *
+ * @param enc The render encoder to record the command into.
+ * @param indexed Indicates whether the draws use an index buffer or not. For indexed draws, the
+ *                arguments are laid out as \ref ngf_draw_indexed_indirect_args, otherwise as
+ *                \ref ngf_draw_indirect_args.
+ * @param args_buf The buffer to read the draw arguments from. Must have been created with
+ *                 \ref NGF_BUFFER_USAGE_INDIRECT.
+ * @param offset Offset (in bytes) of the arguments of the first draw. Must be a multiple of 4.
+ * @param ndraws Number of draws to execute. Must not exceed
+ *               \ref ngf_device_capabilities::max_draw_indirect_count.
+ * @param stride Distance (in bytes) between the arguments of consecutive draws. Must be a multiple
+ *               of 4, and no less than the size of the argument structure. May be 0 if `ndraws` is
+ *               1.
+ */
+void ngf_cmd_draw_indirect(
+    ngf_render_encoder enc,
+    bool               indexed,
+    const ngf_buffer   args_buf,
+    size_t             offset,
+    uint32_t           ndraws,
+    uint32_t           stride) NGF_NOEXCEPT;
+
+/**
+ * \ingroup ngf
+ *
+ * Same as \ref ngf_cmd_draw_indirect, but the number of draws to execute is also read from a
+ * buffer, so that it can be determined on the GPU. Only supported if
+ * \ref ngf_device_capabilities::draw_indirect_count_supported is set.
+ *
+ * @param enc The render encoder to record the command into.
+ * @param indexed Indicates whether the draws use an index buffer or not.
+ * @param args_buf The buffer to read the draw arguments from. Must have been created with
+ *                 \ref NGF_BUFFER_USAGE_INDIRECT.
+ * @param offset Offset (in bytes) of the arguments of the first draw. Must be a multiple of 4.
+ * @param count_buf The buffer to read the number of draws from, as a single 32-bit unsigned
+ *                  integer. Must have been created with \ref NGF_BUFFER_USAGE_INDIRECT.
+ * @param count_offset Offset (in bytes) of the draw count. Must be a multiple of 4.
+ * @param max_draws Upper bound on the number of draws. The actual number of draws is the lesser of
+ *                  this value and the one read from the count buffer.
+ * @param stride Distance (in bytes) between the arguments of consecutive draws. Must be a multiple
+ *               of 4, and no less than the size of the argument structure.
+ */
+void ngf_cmd_draw_indirect_count(
+    ngf_render_encoder enc,
+    bool               indexed,
+    const ngf_buffer   args_buf,
+    size_t             offset,
+    const ngf_buffer   count_buf,
+    size_t             count_offset,
+    uint32_t           max_draws,
+    uint32_t           stride) NGF_NOEXCEPT;
+
 /**
  * \ingroup ngf
  *
@@ -3326,6 +4390,22 @@ void ngf_cmd_dispatch(
     uint32_t            y_threadgroups,
     uint32_t            z_threadgroups) NGF_NOEXCEPT;
 
+/**
+ * \ingroup ngf
+ *
+ * Encodes a compute shader dispatch, sourcing the grid size from a buffer laid out as
+ * \ref ngf_dispatch_indirect_args.
+ *
+ * @param enc The encoder to record the command into.
+ * @param args_buf The buffer to read the dispatch arguments from. Must have been created with
+ *                 \ref NGF_BUFFER_USAGE_INDIRECT.
+ * @param offset Offset (in bytes) of the arguments within the buffer. Must be a multiple of 4.
+ */
+void ngf_cmd_dispatch_indirect(
+    ngf_compute_encoder enc,
+    const ngf_buffer    args_buf,
+    size_t              offset) NGF_NOEXCEPT;
+
 /**
  * \ingroup ngf
  *
@@ -3374,6 +4454,30 @@ void ngf_cmd_write_image(
     ngf_extent3d     extent,
     uint32_t         nlayers) NGF_NOEXCEPT;
 
+/**
+ * \ingroup ngf
+ *
+ * Copies data from a buffer into multiple image regions.
+ *
+ * This is equivalent to calling \ref ngf_cmd_write_image once for each of the given regions, but
+ * allows the backend to synchronize all of the writes at once, instead of doing so for each
+ * individual write. It should be preferred when uploading many regions at a time, for example, all
+ * the layers of an image array. The source data of each region is laid out as described for
+ * \ref ngf_cmd_write_image. Regions written within the same transfer pass should not overlap.
+ *
+ * @param enc The handle to the transfer encoder object to record the command into.
+ * @param src The handle to the buffer object to be copied from.
+ * @param writes Pointer to an array of `nwrites` regions to write.
+ * @param nwrites The number of regions to write.
+ * \return NGF_ERROR_INVALID_OPERATION if any of the destination images wasn't created with the
+ *         \ref NGF_IMAGE_USAGE_XFER_DST usage flag. Nothing is recorded in that case.
+ */
+ngf_error ngf_cmd_write_images(
+    ngf_xfer_encoder       enc,
+    const ngf_buffer       src,
+    const ngf_image_write* writes,
+    uint32_t               nwrites) NGF_NOEXCEPT;
+
 /**
  * \ingroup ngf
  *
@@ -66,8 +66,10 @@ void* sample_initialize(
    * Create the compute pipeline.
    */
   ngf_compute_pipeline_info pipeline_info;
-  pipeline_info.shader_stage = compute_shader.get();
-  pipeline_info.spec_info    = nullptr;
+  pipeline_info.shader_stage             = compute_shader.get();
+  pipeline_info.spec_info                = nullptr;
+  pipeline_info.dynamic_uniform_buffers  = nullptr;
+  pipeline_info.ndynamic_uniform_buffers = 0u;
   NGF_SAMPLES_CHECK_NGF_ERROR(state->compute_pipeline.initialize(pipeline_info));
 
   /**
@@ -47,27 +47,17 @@ mesh load_mesh_from_file(const char* mesh_file_name, ngf_xfer_encoder xfenc) {
   result.have_uvs     = header & 2;
 
   /**
-   * Read the total size of the vertex data, create a staging buffer, and
-   * read the vertex data directly into the staging buffer.
+   * Read the total size of the vertex data, grab a chunk of the frame's
+   * upload memory, and read the vertex data directly into it. The upload
+   * memory is recycled automatically once the frame is done.
    */
   uint32_t vertex_data_size = 0u;
   read_elements             = fread(&vertex_data_size, sizeof(vertex_data_size), 1u, mesh_file);
   NGF_SAMPLES_ASSERT(read_elements == 1u);
-  const ngf_buffer_info vertex_data_staging_buffer_info = {
-      .size         = vertex_data_size,
-      .storage_type = NGF_BUFFER_STORAGE_HOST_WRITEABLE,
-      .buffer_usage = NGF_BUFFER_USAGE_XFER_SRC,
-  };
-  ngf::buffer vertex_data_staging_buffer;
-  NGF_SAMPLES_CHECK_NGF_ERROR(
-      vertex_data_staging_buffer.initialize(vertex_data_staging_buffer_info));
-  void* mapped_vertex_data_staging_buffer =
-      ngf_buffer_map_range(vertex_data_staging_buffer.get(), 0u, vertex_data_size);
-  read_elements =
-      fread(mapped_vertex_data_staging_buffer, sizeof(char), vertex_data_size, mesh_file);
+  ngf_upload_allocation vertex_data_upload;
+  NGF_SAMPLES_CHECK_NGF_ERROR(ngf_upload_alloc(vertex_data_size, 16u, &vertex_data_upload));
+  read_elements = fread(vertex_data_upload.data, sizeof(char), vertex_data_size, mesh_file);
   NGF_SAMPLES_ASSERT(read_elements == vertex_data_size);
-  ngf_buffer_flush_range(vertex_data_staging_buffer.get(), 0, vertex_data_size);
-  ngf_buffer_unmap(vertex_data_staging_buffer.get());
 
   /**
    * Read the number of indices in the mesh. If number of indices is 0, the
@@ -78,46 +68,35 @@ mesh load_mesh_from_file(const char* mesh_file_name, ngf_xfer_encoder xfenc) {
   NGF_SAMPLES_ASSERT(read_elements == 1u);
 
   /**
-   * Allocate a staging buffer for the index data, and read the index data
-   * directly into that buffer.
+   * Allocate upload memory for the index data, and read the index data
+   * directly into it.
    */
 
-  ngf::buffer index_data_staging_buffer;
+  ngf_upload_allocation index_data_upload {};
   if (result.num_indices > 0) {
-    const ngf_buffer_info index_data_staging_buffer_info = {
-        .size         = sizeof(uint32_t) * result.num_indices,
-        .storage_type = NGF_BUFFER_STORAGE_HOST_WRITEABLE,
-        .buffer_usage = NGF_BUFFER_USAGE_XFER_SRC,
-    };
     NGF_SAMPLES_CHECK_NGF_ERROR(
-        index_data_staging_buffer.initialize(index_data_staging_buffer_info));
-    void* mapped_index_data_staging_buffer = ngf_buffer_map_range(
-        index_data_staging_buffer.get(),
-        0,
-        index_data_staging_buffer_info.size);
+        ngf_upload_alloc(sizeof(uint32_t) * result.num_indices, 16u, &index_data_upload));
     read_elements =
-        fread(mapped_index_data_staging_buffer, sizeof(uint32_t), result.num_indices, mesh_file);
+        fread(index_data_upload.data, sizeof(uint32_t), result.num_indices, mesh_file);
     NGF_SAMPLES_ASSERT(read_elements == result.num_indices);
-    ngf_buffer_flush_range(index_data_staging_buffer.get(), 0, index_data_staging_buffer_info.size);
-    ngf_buffer_unmap(index_data_staging_buffer.get());
   }
 
   /**
    * Create the GPU buffers mesh buffers, and record commands to upload the data
-   * from staging buffers into them.
+   * from the upload memory into them.
    */
   const ngf_buffer_info vertex_data_buffer_info = {
-      .size         = vertex_data_staging_buffer_info.size,
+      .size         = vertex_data_size,
       .storage_type = NGF_BUFFER_STORAGE_PRIVATE,
       .buffer_usage = NGF_BUFFER_USAGE_VERTEX_BUFFER | NGF_BUFFER_USAGE_XFER_DST,
   };
   NGF_SAMPLES_CHECK_NGF_ERROR(result.vertex_data.initialize(vertex_data_buffer_info));
   ngf_cmd_copy_buffer(
       xfenc,
-      vertex_data_staging_buffer.get(),
+      vertex_data_upload.buffer,
       result.vertex_data.get(),
       vertex_data_buffer_info.size,
-      0u,
+      vertex_data_upload.offset,
       0u);
   if (result.num_indices > 0) {
     const ngf_buffer_info index_data_buffer_info = {
@@ -128,10 +107,10 @@ mesh load_mesh_from_file(const char* mesh_file_name, ngf_xfer_encoder xfenc) {
     NGF_SAMPLES_CHECK_NGF_ERROR(result.index_data.initialize(index_data_buffer_info));
     ngf_cmd_copy_buffer(
         xfenc,
-        index_data_staging_buffer.get(),
+        index_data_upload.buffer,
         result.index_data.get(),
         index_data_buffer_info.size,
-        0u,
+        index_data_upload.offset,
         0u);
   }
 
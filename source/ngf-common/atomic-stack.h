@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2023 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "macros.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A lock-free, intrusive, multi-producer stack.
+ * Any number of threads may push nodes concurrently. Consumers detach the entire contents of the
+ * stack at once, so there is no per-node pop and the structure is not susceptible to the ABA
+ * problem. A zero-initialized stack is empty and ready for use.
+ */
+typedef struct ngfi_atomic_stack_node {
+  struct ngfi_atomic_stack_node* next;
+} ngfi_atomic_stack_node;
+
+typedef struct ngfi_atomic_stack {
+  ngfi_atomic_stack_node* volatile head;
+} ngfi_atomic_stack;
+
+/**
+ * Pushes the given node onto the stack. Safe to call concurrently from multiple threads.
+ */
+static inline void ngfi_atomic_stack_push(ngfi_atomic_stack* stack, ngfi_atomic_stack_node* node) {
+#if defined(_MSC_VER)
+  ngfi_atomic_stack_node* old_head;
+  do {
+    old_head   = stack->head;
+    node->next = old_head;
+  } while (InterlockedCompareExchangePointer((PVOID volatile*)&stack->head, node, old_head) !=
+           old_head);
+#else
+  ngfi_atomic_stack_node* old_head = __atomic_load_n(&stack->head, __ATOMIC_RELAXED);
+  do {
+    node->next = old_head;
+  } while (!__atomic_compare_exchange_n(
+      &stack->head,
+      &old_head,
+      node,
+      true,
+      __ATOMIC_RELEASE,
+      __ATOMIC_RELAXED));
+#endif
+}
+
+/**
+ * Atomically detaches all nodes from the stack and returns them as a singly-linked list, in the
+ * order in which they were pushed. If `count` is not NULL, the number of detached nodes is written
+ * to it. The caller takes ownership of the returned nodes.
+ */
+static inline ngfi_atomic_stack_node*
+ngfi_atomic_stack_take_all(ngfi_atomic_stack* stack, uint32_t* count) {
+#if defined(_MSC_VER)
+  ngfi_atomic_stack_node* node =
+      (ngfi_atomic_stack_node*)InterlockedExchangePointer((PVOID volatile*)&stack->head, NULL);
+#else
+  ngfi_atomic_stack_node* node = __atomic_exchange_n(&stack->head, NULL, __ATOMIC_ACQUIRE);
+#endif
+  // The nodes come out most-recent-first, reverse them to restore push order.
+  ngfi_atomic_stack_node* reversed = NULL;
+  uint32_t                n        = 0u;
+  while (node != NULL) {
+    ngfi_atomic_stack_node* next = node->next;
+    node->next                   = reversed;
+    reversed                     = node;
+    node                         = next;
+    ++n;
+  }
+  if (count) { *count = n; }
+  return reversed;
+}
+
+/**
+ * Obtains ptr to the structure containing the given stack node field.
+ */
+#define NGFI_ATOMIC_STACK_CONTAINER_OF(ptr, type, node_name) \
+  ((type*)((char*)(ptr)-offsetof(type, node_name)))
+
+#ifdef __cplusplus
+}
+#endif
@@ -22,6 +22,7 @@ SOFTWARE.
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define NGFI_DARRAY_OF(type) struct  { \
   type *data; \
@@ -79,6 +80,24 @@ SOFTWARE.
   a.endptr++; \
 }
 
+// Appends n elements copied from src, growing the capacity geometrically if required.
+#define NGFI_DARRAY_APPEND_N(a, src, n) { \
+  ptrdiff_t cur_size = a.endptr - a.data; \
+  size_t new_size = (size_t)cur_size + (size_t)(n); \
+  assert(cur_size >= 0);                                 \
+  if (new_size > a.capacity) { \
+    uint32_t new_capacity = a.capacity > 0u ? a.capacity : 1u; \
+    while (new_capacity < new_size) { new_capacity <<= 1u; } \
+    decltype(a.data) tmp = (decltype(a.data)) realloc(a.data, sizeof(a.data[0]) * new_capacity); \
+    assert(tmp != NULL); \
+    a.data = tmp; \
+    a.capacity = new_capacity; \
+    a.endptr = &a.data[cur_size]; \
+  } \
+  memcpy(a.endptr, (src), sizeof(a.data[0]) * (size_t)(n)); \
+  a.endptr += (n); \
+}
+
 #define NGFI_DARRAY_CLEAR(a) ((a).endptr = (a).data)
 #define NGFI_DARRAY_SIZE(a) ((uint32_t)((a).endptr - (a).data))
 #define NGFI_DARRAY_AT(a, i) ((a).data[(i)])
@@ -23,6 +23,9 @@
 #include "macros.h"
 
 #include <stdlib.h>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <unistd.h>
+#endif
 
 ngf_diagnostic_info ngfi_diag_info = {
     .verbosity = NGF_DIAGNOSTICS_VERBOSITY_DEFAULT,
@@ -58,4 +61,15 @@ ngf_sample_count ngfi_get_highest_sample_count(size_t counts_bitmap) {
         res >>= 1;
     }
     return (ngf_sample_count) res;
-}
\ No newline at end of file
+}
+
+uint32_t ngfi_get_hw_thread_count(void) {
+#if defined(_WIN32) || defined(_WIN64)
+  SYSTEM_INFO sysinfo;
+  GetSystemInfo(&sysinfo);
+  const long nthreads = (long)sysinfo.dwNumberOfProcessors;
+#else
+  const long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  return nthreads > 0 ? (uint32_t)nthreads : 1u;
+}
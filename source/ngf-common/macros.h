@@ -14,6 +14,41 @@ typedef CRITICAL_SECTION pthread_mutex_t;
 #define pthread_mutex_unlock(m)  (LeaveCriticalSection(m), 0)
 #define pthread_mutex_init(m, a) (InitializeCriticalSection(m), 0)
 #define pthread_mutex_destroy(m) (DeleteCriticalSection(m), 0)
+// emulate pthread condition variables
+typedef CONDITION_VARIABLE pthread_cond_t;
+#define pthread_cond_init(c, a)    (InitializeConditionVariable(c), 0)
+#define pthread_cond_destroy(c)    (0)
+#define pthread_cond_wait(c, m)    (SleepConditionVariableCS((c), (m), INFINITE), 0)
+#define pthread_cond_signal(c)     (WakeConditionVariable(c), 0)
+#define pthread_cond_broadcast(c)  (WakeAllConditionVariable(c), 0)
+// emulate pthread threads
+typedef HANDLE pthread_t;
+typedef struct ngfi_win32_thread_start {
+  void* (*fn)(void*);
+  void* arg;
+} ngfi_win32_thread_start;
+// CreateThread expects a WINAPI routine returning a DWORD, so the pthread-style entry point
+// is invoked through a trampoline.
+static inline DWORD WINAPI ngfi_win32_thread_trampoline(LPVOID param) {
+  const ngfi_win32_thread_start start = *(ngfi_win32_thread_start*)param;
+  free(param);
+  start.fn(start.arg);
+  return 0u;
+}
+static inline int ngfi_win32_pthread_create(pthread_t* t, void* (*fn)(void*), void* arg) {
+  ngfi_win32_thread_start* start = (ngfi_win32_thread_start*)malloc(sizeof(*start));
+  if (start == NULL) { return 1; }
+  start->fn  = fn;
+  start->arg = arg;
+  *t         = CreateThread(NULL, 0, ngfi_win32_thread_trampoline, start, 0, NULL);
+  if (*t == NULL) {
+    free(start);
+    return 1;
+  }
+  return 0;
+}
+#define pthread_create(t, a, fn, arg) ngfi_win32_pthread_create((t), (fn), (arg))
+#define pthread_join(t, r) (WaitForSingleObject((t), INFINITE), CloseHandle(t), 0)
 // dynamic module loading
 typedef HMODULE ngf_module_handle;
 #else
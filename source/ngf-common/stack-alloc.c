@@ -89,8 +89,9 @@ void ngfi_sa_destroy(ngfi_sa* allocator) {
   free(allocator);
 }
 
+static NGFI_THREADLOCAL ngfi_sa* temp_storage = NULL;
+
 ngfi_sa* ngfi_tmp_store(void) {
-  static NGFI_THREADLOCAL ngfi_sa* temp_storage = NULL;
   if (temp_storage == NULL) {
     const size_t sa_capacity = 1024 * 100;  // 100K
     temp_storage             = ngfi_sa_create(sa_capacity);
@@ -98,3 +99,10 @@ ngfi_sa* ngfi_tmp_store(void) {
   return temp_storage;
 }
 
+void ngfi_tmp_store_release(void) {
+  if (temp_storage != NULL) {
+    ngfi_sa_destroy(temp_storage);
+    temp_storage = NULL;
+  }
+}
+
@@ -65,6 +65,12 @@ void ngfi_sa_destroy(ngfi_sa* allocator);
  */
 ngfi_sa* ngfi_tmp_store(void);
 
+/**
+ * Tears down the calling thread's temporary storage, if it has been created. Threads that use
+ * temporary storage must call this before exiting to avoid leaking it.
+ */
+void ngfi_tmp_store_release(void);
+
 /**
  * Helper macro to allocate N objects from per-thread stack allocator.
  */
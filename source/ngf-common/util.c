@@ -24,6 +24,7 @@
 #include "nicegraf-util.h"
 
 #include <assert.h>
+#include <stdio.h>
 #include <string.h>
 
 #if defined(_WIN32) || defined(_WIN64)
@@ -85,7 +86,9 @@ void ngf_util_create_default_graphics_pipeline_data(ngf_util_graphics_pipeline_d
       .nshader_stages          = 0u,
       .rasterization           = &result->rasterization_info,
       .spec_info               = &result->spec_info,
-      .debug_name              = NULL};
+      .debug_name              = NULL,
+      .dynamic_uniform_buffers = NULL,
+      .ndynamic_uniform_buffers = 0u};
   result->pipeline_info = gpi;
 }
 
@@ -98,7 +101,71 @@ const char* ngf_util_get_error_name(const ngf_error err) {
       "NGF_ERROR_INVALID_FORMAT",
       "NGF_ERROR_INVALID_SIZE",
       "NGF_ERROR_INVALID_ENUM",
-      "NGF_ERROR_INVALID_OPERATION"};
+      "NGF_ERROR_INVALID_OPERATION",
+      "NGF_ERROR_NOT_READY"};
   if (err > NGFI_ARRAYSIZE(ngf_error_names)) { return "invalid error code"; }
   return ngf_error_names[err];
 }
+
+ngf_error ngf_util_load_pipeline_cache_file(ngf_context ctx, const char* path) {
+  assert(path);
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) { return NGF_ERROR_INVALID_OPERATION; }
+
+  ngf_error err  = NGF_ERROR_OK;
+  char*     data = NULL;
+  long      size = 0;
+  if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0) {
+    err = NGF_ERROR_INVALID_OPERATION;
+    goto ngf_util_load_pipeline_cache_file_cleanup;
+  }
+  // Empty caches are saved as empty files, and there's nothing to load from those.
+  if (size == 0) { goto ngf_util_load_pipeline_cache_file_cleanup; }
+  data = NGFI_ALLOCN(char, (size_t)size);
+  if (data == NULL) {
+    err = NGF_ERROR_OUT_OF_MEM;
+    goto ngf_util_load_pipeline_cache_file_cleanup;
+  }
+  if (fread(data, 1u, (size_t)size, file) != (size_t)size) {
+    err = NGF_ERROR_INVALID_OPERATION;
+    goto ngf_util_load_pipeline_cache_file_cleanup;
+  }
+  err = ngf_load_pipeline_cache(ctx, data, (size_t)size);
+
+ngf_util_load_pipeline_cache_file_cleanup:
+  if (data) { NGFI_FREEN(data, (size_t)size); }
+  fclose(file);
+  return err;
+}
+
+ngf_error ngf_util_save_pipeline_cache_file(ngf_context ctx, const char* path) {
+  assert(path);
+  size_t    size = 0u;
+  ngf_error err  = ngf_get_pipeline_cache_data(ctx, NULL, &size);
+  if (err != NGF_ERROR_OK) { return err; }
+
+  const size_t alloc_size = size;
+  char*        data       = NULL;
+  if (alloc_size > 0u) {
+    data = NGFI_ALLOCN(char, alloc_size);
+    if (data == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+    // The cache may have grown between the two calls, in which case the data is truncated to a
+    // valid, smaller cache.
+    err = ngf_get_pipeline_cache_data(ctx, data, &size);
+    if (err != NGF_ERROR_OK && err != NGF_ERROR_INVALID_SIZE) {
+      NGFI_FREEN(data, alloc_size);
+      return err;
+    }
+    err = NGF_ERROR_OK;
+  }
+
+  FILE* file = fopen(path, "wb");
+  if (file == NULL) {
+    err = NGF_ERROR_INVALID_OPERATION;
+  } else {
+    if (size > 0u && fwrite(data, 1u, size, file) != size) { err = NGF_ERROR_INVALID_OPERATION; }
+    if (fclose(file) != 0) { err = NGF_ERROR_INVALID_OPERATION; }
+  }
+  if (data) { NGFI_FREEN(data, alloc_size); }
+  return err;
+}
@@ -30,6 +30,7 @@
 #import <Metal/Metal.h>
 #import <QuartzCore/QuartzCore.h>
 #include <memory>
+#include <mutex>
 #include <new>
 #include <optional>
 #include <string>
@@ -60,6 +61,7 @@ using NGFMTL_VIEW_TYPE = UIView;
 //       etc. where N is the total number of uniform buffers consumed by the
 //       vertex stage.
 static constexpr uint32_t MAX_BUFFER_BINDINGS = 30u;
+static constexpr size_t   UPLOAD_CHUNK_SIZE   = 4u * 1024u * 1024u;
 
 // Metal device handle. We choose one upon initialization and always use that
 // one.
@@ -544,6 +546,8 @@ struct ngf_cmd_buffer_t {
   id<MTLBuffer>                bound_index_buffer  = nil;
   MTLIndexType                 bound_index_buffer_type;
   uint32_t                     bound_index_buffer_offset = 0u;
+  uint32_t                     flags                     = 0u;
+  ngf_context                  ctx                       = nullptr;  // Context it was created in.
 };
 #define NGFMTL_ENC2CMDBUF(enc) ((ngf_cmd_buffer)((void*)enc.pvt_data_donotuse.d0))
 
@@ -589,6 +593,12 @@ struct ngf_texel_buffer_view_t {
   id<MTLTexture> mtl_buffer_view = nil;
 };
 
+// Metal has no equivalent of a descriptor set that would map onto the nicegraf binding model
+// directly, so bind groups simply replay their bind operations.
+struct ngf_bind_group_t {
+  std::vector<ngf_resource_bind_op> bind_ops;
+};
+
 struct ngf_sampler_t {
   id<MTLSamplerState> sampler = nil;
 };
@@ -799,9 +809,19 @@ class ngfmtl_swapchain {
   std::unique_ptr<ngf_image[]>      multisample_images_;
 };
 
+// A buffer that transient uploads are suballocated from.
+struct ngfmtl_upload_chunk {
+  ngf_buffer buffer  = nullptr;
+  size_t     used    = 0u;  // Number of bytes handed out during the frame.
+  size_t     flushed = 0u;  // Number of bytes already made visible to the device.
+};
+
 struct ngf_context_t {
   ~ngf_context_t() {
     if (last_cmd_buffer) [last_cmd_buffer waitUntilCompleted];
+    for (auto& frame_chunks : upload_chunks) {
+      for (auto& chunk : frame_chunks) { ngf_destroy_buffer(chunk.buffer); }
+    }
   }
   id<MTLDevice>           device = nil;
   ngfmtl_swapchain        swapchain;
@@ -810,9 +830,14 @@ struct ngf_context_t {
   bool                    is_current = false;
   ngf_swapchain_info      swapchain_info;
   id<MTLCommandBuffer>    pending_cmd_buffer = nil;
+  std::mutex              pending_cmd_buffer_mutex;  // Submissions may come from any thread.
   id<MTLCommandBuffer>    last_cmd_buffer    = nil;
   dispatch_semaphore_t    frame_sync_sem     = nil;
   ngf_render_target       default_rt;
+
+  // Upload memory for each frame in flight, reused once the frame that used it has completed.
+  std::vector<std::vector<ngfmtl_upload_chunk>> upload_chunks;
+  uint32_t                                      upload_frame = 0u;
 };
 
 constexpr MTLGPUFamily NGFMTL_GPU_FAMILIES[] = {
@@ -921,6 +946,27 @@ static void ngfmtl_populate_ngf_device(uint32_t handle, ngf_device& ngfdev, id<M
                                   gpu_family_idx == ngfmtl_gpufam_idx(MTLGPUFamilyCommon3) ||
                                   gpu_family_idx >= ngfmtl_gpufam_idx(MTLGPUFamilyApple3);
 
+  // Metal has no equivalent of a GPU-sourced draw count outside of indirect command buffers, so
+  // multi-draws are issued as a sequence of single indirect draws.
+  caps.max_draw_indirect_count       = UINT32_MAX;
+  caps.draw_indirect_count_supported = false;
+
+  // Resource tables would need argument buffers, which this backend doesn't use yet.
+  caps.resource_tables_supported   = false;
+  caps.max_resource_table_capacity = 0u;
+
+  // Blit and compute encoders are executed in submission order along with everything else.
+  caps.async_xfer_supported    = false;
+  caps.async_compute_supported = false;
+
+  // Timestamps would need counter sample buffers, which this backend doesn't use yet.
+  caps.timestamp_queries_supported = false;
+  // Occlusion queries would map to visibility result buffers, and pipeline statistics have no
+  // Metal counterpart.
+  caps.occlusion_queries_supported           = false;
+  caps.pipeline_statistics_queries_supported = false;
+  caps.secondary_cmd_buffers_supported       = false;
+
   size_t supports_samples_bitmap = ([mtldev supportsTextureSampleCount:1] ? 1 : 0) |
                                    ([mtldev supportsTextureSampleCount:2] ? 2 : 0) |
                                    ([mtldev supportsTextureSampleCount:4] ? 4 : 0) |
@@ -1000,15 +1046,45 @@ void* NSPushAutoreleasePool(NSUInteger capacity);
 void  NSPopAutoreleasePool(void* token);
 }
 
+static void ngfmtl_flush_upload_chunks(std::vector<ngfmtl_upload_chunk>& chunks) {
+  for (auto& chunk : chunks) {
+#if TARGET_OS_OSX
+    if (chunk.used > chunk.flushed) {
+      [chunk.buffer->mtl_buffer
+          didModifyRange:NSMakeRange(chunk.flushed, chunk.used - chunk.flushed)];
+    }
+#endif
+    chunk.flushed = chunk.used;
+  }
+}
+
+// Chunks created to accommodate unusually large requests are released, the rest are reused.
+static void ngfmtl_recycle_upload_chunks(std::vector<ngfmtl_upload_chunk>& chunks) {
+  size_t nkept = 0u;
+  for (auto& chunk : chunks) {
+    if ([chunk.buffer->mtl_buffer length] > UPLOAD_CHUNK_SIZE) {
+      ngf_destroy_buffer(chunk.buffer);
+    } else {
+      chunks[nkept++] = ngfmtl_upload_chunk {chunk.buffer, 0u, 0u};
+    }
+  }
+  chunks.resize(nkept);
+}
+
 ngf_error ngf_begin_frame(ngf_frame_token* token) NGF_NOEXCEPT {
   *token = (uintptr_t)NSPushAutoreleasePool(0);
   dispatch_semaphore_wait(CURRENT_CONTEXT->frame_sync_sem, DISPATCH_TIME_FOREVER);
+  CURRENT_CONTEXT->upload_frame =
+      (CURRENT_CONTEXT->upload_frame + 1u) % (uint32_t)CURRENT_CONTEXT->upload_chunks.size();
+  ngfmtl_recycle_upload_chunks(CURRENT_CONTEXT->upload_chunks[CURRENT_CONTEXT->upload_frame]);
   CURRENT_CONTEXT->frame = CURRENT_CONTEXT->swapchain.next_frame();
   return (!CURRENT_CONTEXT->frame.color_drawable) ? NGF_ERROR_INVALID_OPERATION : NGF_ERROR_OK;
 }
 
 ngf_error ngf_end_frame(ngf_frame_token token) NGF_NOEXCEPT {
   ngf_context ctx = CURRENT_CONTEXT;
+  ngfmtl_flush_upload_chunks(ctx->upload_chunks[ctx->upload_frame]);
+  std::lock_guard<std::mutex> lock(ctx->pending_cmd_buffer_mutex);
   if (CURRENT_CONTEXT->frame.color_drawable && CURRENT_CONTEXT->pending_cmd_buffer) {
     [CURRENT_CONTEXT->pending_cmd_buffer addCompletedHandler:^(id<MTLCommandBuffer> _Nonnull) {
       dispatch_semaphore_signal(ctx->frame_sync_sem);
@@ -1088,6 +1164,7 @@ ngf_error ngf_create_context(const ngf_context_info* info, ngf_context* result)
     ctx->default_rt->is_default = true;
   }
 
+  ctx->upload_chunks.resize(NGFI_MAX(1u, ctx->swapchain_info.capacity_hint));
   ctx->frame_sync_sem = dispatch_semaphore_create(ctx->swapchain_info.capacity_hint);
   *result             = ctx.release();
 
@@ -1126,6 +1203,32 @@ ngf_error ngf_set_context(ngf_context ctx) NGF_NOEXCEPT {
   return NGF_ERROR_OK;
 }
 
+ngf_error ngf_get_context_stats(ngf_context ctx, ngf_context_stats* stats) NGF_NOEXCEPT {
+  assert(ctx);
+  assert(stats);
+  // None of the tracked counters apply to the Metal backend.
+  *stats = ngf_context_stats {};
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_load_pipeline_cache(ngf_context ctx, const void* data, size_t size) NGF_NOEXCEPT {
+  assert(ctx);
+  NGFI_IGNORE_VAR(ctx);
+  NGFI_IGNORE_VAR(data);
+  NGFI_IGNORE_VAR(size);
+  // The Metal backend does not maintain a pipeline cache.
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_get_pipeline_cache_data(ngf_context ctx, void* data, size_t* size) NGF_NOEXCEPT {
+  assert(ctx);
+  assert(size);
+  NGFI_IGNORE_VAR(ctx);
+  NGFI_IGNORE_VAR(data);
+  *size = 0u;
+  return NGF_ERROR_OK;
+}
+
 ngf_error
 ngf_create_shader_stage(const ngf_shader_stage_info* info, ngf_shader_stage* result) NGF_NOEXCEPT {
   assert(info);
@@ -1173,6 +1276,7 @@ void ngf_destroy_shader_stage(ngf_shader_stage stage) NGF_NOEXCEPT {
 }
 
 void ngfmtl_attachment_set_common(
+    ngf_context                        ctx,
     MTLRenderPassAttachmentDescriptor* attachment,
     uint32_t                           i,
     ngf_attachment_type                type,
@@ -1185,8 +1289,8 @@ void ngfmtl_attachment_set_common(
     attachment.slice   = rt->image_refs[i].layer;
   } else {
     attachment.texture = type == NGF_ATTACHMENT_COLOR
-                             ? CURRENT_CONTEXT->frame.color_attachment_texture()
-                             : CURRENT_CONTEXT->frame.depth_attachment_texture();
+                             ? ctx->frame.color_attachment_texture()
+                             : ctx->frame.depth_attachment_texture();
     attachment.level   = 0;
     attachment.slice   = 0;
   }
@@ -1562,6 +1666,26 @@ void ngf_destroy_graphics_pipeline(ngf_graphics_pipeline pipe) NGF_NOEXCEPT {
   }
 }
 
+ngf_error ngf_create_graphics_pipelines(
+    const ngf_graphics_pipeline_info* infos,
+    uint32_t                          npipelines,
+    ngf_graphics_pipeline*            results) NGF_NOEXCEPT {
+  assert(infos || npipelines == 0u);
+  assert(results || npipelines == 0u);
+  ngf_error err = NGF_ERROR_OK;
+  for (uint32_t i = 0u; i < npipelines; ++i) {
+    results[i] = NULL;
+    if (err == NGF_ERROR_OK) { err = ngf_create_graphics_pipeline(&infos[i], &results[i]); }
+  }
+  if (err != NGF_ERROR_OK) {
+    for (uint32_t i = 0u; i < npipelines; ++i) {
+      ngf_destroy_graphics_pipeline(results[i]);
+      results[i] = NULL;
+    }
+  }
+  return err;
+}
+
 void ngf_destroy_compute_pipeline(ngf_compute_pipeline pipe) NGF_NOEXCEPT {
   if (pipe != nullptr) {
     pipe->~ngf_compute_pipeline_t();
@@ -1628,6 +1752,107 @@ void ngf_destroy_texel_buffer_view(ngf_texel_buffer_view buf_view) NGF_NOEXCEPT
   }
 }
 
+ngf_error ngf_create_bind_group(const ngf_bind_group_info* info, ngf_bind_group* result)
+    NGF_NOEXCEPT {
+  if ((info->gfx_pipeline == nullptr) == (info->compute_pipeline == nullptr)) {
+    NGFI_DIAG_ERROR("Exactly one pipeline must be specified when creating a bind group.");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  for (uint32_t o = 0u; o < info->nbind_operations; ++o) {
+    if (info->bind_operations[o].target_set != info->set) {
+      NGFI_DIAG_ERROR("All bind operations in a bind group must target the group's set.");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+  }
+  NGFMTL_NURSERY(bind_group, group);
+  group->bind_ops.assign(info->bind_operations, info->bind_operations + info->nbind_operations);
+  *result = group.release();
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_bind_group(ngf_bind_group group) NGF_NOEXCEPT {
+  if (group) {
+    group->~ngf_bind_group_t();
+    NGFI_FREE(group);
+  }
+}
+
+ngf_error ngf_create_resource_table(const ngf_resource_table_info*, ngf_resource_table* result)
+    NGF_NOEXCEPT {
+  NGFI_DIAG_ERROR("Resource tables are not supported by the Metal backend.");
+  *result = nullptr;
+  return NGF_ERROR_INVALID_OPERATION;
+}
+
+void ngf_destroy_resource_table(ngf_resource_table) NGF_NOEXCEPT {
+}
+
+ngf_error ngf_alloc_resource_table_slot(ngf_resource_table, uint32_t*) NGF_NOEXCEPT {
+  return NGF_ERROR_INVALID_OPERATION;
+}
+
+void ngf_free_resource_table_slot(ngf_resource_table, uint32_t) NGF_NOEXCEPT {
+}
+
+ngf_error ngf_write_resource_table(ngf_resource_table, uint32_t, const ngf_resource_bind_op*)
+    NGF_NOEXCEPT {
+  return NGF_ERROR_INVALID_OPERATION;
+}
+
+ngf_error ngf_create_query_pool(const ngf_query_pool_info*, ngf_query_pool* result) NGF_NOEXCEPT {
+  NGFI_DIAG_ERROR("Query pools are not supported by the Metal backend.");
+  *result = nullptr;
+  return NGF_ERROR_INVALID_OPERATION;
+}
+
+void ngf_destroy_query_pool(ngf_query_pool) NGF_NOEXCEPT {
+}
+
+ngf_error ngf_get_query_results(ngf_query_pool, uint32_t, uint32_t, uint64_t*) NGF_NOEXCEPT {
+  return NGF_ERROR_INVALID_OPERATION;
+}
+
+ngf_error ngf_cmd_write_timestamp(ngf_cmd_buffer, ngf_query_pool, uint32_t) NGF_NOEXCEPT {
+  return NGF_ERROR_INVALID_OPERATION;
+}
+
+ngf_error ngf_cmd_enable_pass_timestamps(ngf_cmd_buffer, ngf_query_pool pool, uint32_t, uint32_t)
+    NGF_NOEXCEPT {
+  // Disabling pass timestamps is always allowed.
+  return pool == nullptr ? NGF_ERROR_OK : NGF_ERROR_INVALID_OPERATION;
+}
+
+ngf_error ngf_cmd_begin_query(ngf_render_encoder, ngf_query_pool, uint32_t) NGF_NOEXCEPT {
+  return NGF_ERROR_INVALID_OPERATION;
+}
+
+ngf_error ngf_cmd_end_query(ngf_render_encoder) NGF_NOEXCEPT {
+  return NGF_ERROR_INVALID_OPERATION;
+}
+
+ngf_error ngf_cmd_begin_parallel_render_pass(
+    ngf_cmd_buffer,
+    const ngf_render_pass_info*,
+    ngf_render_encoder*) NGF_NOEXCEPT {
+  return NGF_ERROR_INVALID_OPERATION;
+}
+
+ngf_error ngf_cmd_begin_secondary_render_pass(
+    ngf_render_encoder,
+    ngf_cmd_buffer,
+    ngf_render_encoder*) NGF_NOEXCEPT {
+  return NGF_ERROR_INVALID_OPERATION;
+}
+
+ngf_error ngf_cmd_end_secondary_render_pass(ngf_render_encoder) NGF_NOEXCEPT {
+  return NGF_ERROR_INVALID_OPERATION;
+}
+
+ngf_error
+ngf_cmd_execute_secondary_cmd_buffers(ngf_render_encoder, uint32_t, ngf_cmd_buffer*) NGF_NOEXCEPT {
+  return NGF_ERROR_INVALID_OPERATION;
+}
+
 ngf_error ngf_create_buffer(const ngf_buffer_info* info, ngf_buffer* result) NGF_NOEXCEPT {
   NGFMTL_NURSERY(buffer, buf);
   buf->mtl_buffer = ngfmtl_create_buffer(*info);
@@ -1659,6 +1884,47 @@ void ngf_buffer_flush_range(
 void ngf_buffer_unmap(ngf_buffer) NGF_NOEXCEPT {
 }
 
+ngf_error
+ngf_upload_alloc(size_t size, size_t alignment, ngf_upload_allocation* result) NGF_NOEXCEPT {
+  assert(result);
+  if (size == 0u || alignment == 0u || (alignment & (alignment - 1u)) != 0u) {
+    NGFI_DIAG_ERROR("upload allocation size must be nonzero and alignment a power of two");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+
+  auto&                chunks = CURRENT_CONTEXT->upload_chunks[CURRENT_CONTEXT->upload_frame];
+  ngfmtl_upload_chunk* chunk  = nullptr;
+  size_t               offset = 0u;
+  for (auto& candidate : chunks) {
+    offset = (candidate.used + alignment - 1u) & ~(alignment - 1u);
+    if (offset + size <= [candidate.buffer->mtl_buffer length]) {
+      chunk = &candidate;
+      break;
+    }
+  }
+
+  if (chunk == nullptr) {
+    const ngf_buffer_info chunk_info = {
+        NGFI_MAX(size, UPLOAD_CHUNK_SIZE),
+        NGF_BUFFER_STORAGE_HOST_WRITEABLE,
+        NGF_BUFFER_USAGE_XFER_SRC | NGF_BUFFER_USAGE_UNIFORM_BUFFER |
+            NGF_BUFFER_USAGE_VERTEX_BUFFER | NGF_BUFFER_USAGE_INDEX_BUFFER |
+            NGF_BUFFER_USAGE_STORAGE_BUFFER};
+    ngf_buffer      buf = nullptr;
+    const ngf_error err = ngf_create_buffer(&chunk_info, &buf);
+    if (err != NGF_ERROR_OK) { return err; }
+    chunks.push_back(ngfmtl_upload_chunk {buf, 0u, 0u});
+    chunk  = &chunks.back();
+    offset = 0u;
+  }
+
+  chunk->used    = offset + size;
+  result->buffer = chunk->buffer;
+  result->offset = offset;
+  result->data   = (uint8_t*)[chunk->buffer->mtl_buffer contents] + offset;
+  return NGF_ERROR_OK;
+}
+
 ngf_error ngf_create_sampler(const ngf_sampler_info* info, ngf_sampler* result) NGF_NOEXCEPT {
   auto*                                sampler_desc = [MTLSamplerDescriptor new];
   std::optional<MTLSamplerAddressMode> s            = get_mtl_address_mode(info->wrap_u),
@@ -1687,9 +1953,20 @@ void ngf_destroy_sampler(ngf_sampler sampler) NGF_NOEXCEPT {
   }
 }
 
-ngf_error ngf_create_cmd_buffer(const ngf_cmd_buffer_info*, ngf_cmd_buffer* result) NGF_NOEXCEPT {
+ngf_error
+ngf_create_cmd_buffer(const ngf_cmd_buffer_info* info, ngf_cmd_buffer* result) NGF_NOEXCEPT {
+  if ((info->flags & NGF_CMD_BUFFER_ASYNC_XFER) && (info->flags & NGF_CMD_BUFFER_ASYNC_COMPUTE)) {
+    NGFI_DIAG_ERROR("a cmd buffer can't be both an async transfer and an async compute one");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (info->flags & NGF_CMD_BUFFER_SECONDARY) {
+    NGFI_DIAG_ERROR("secondary cmd buffers are not supported by the Metal backend");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
   NGFMTL_NURSERY(cmd_buffer, cmd_buffer);
-  *result = cmd_buffer.release();
+  cmd_buffer->flags = info->flags;
+  cmd_buffer->ctx   = CURRENT_CONTEXT;
+  *result           = cmd_buffer.release();
   return NGF_ERROR_OK;
 }
 
@@ -1751,7 +2028,7 @@ void ngf_destroy_cmd_buffer(ngf_cmd_buffer cmd_buffer) NGF_NOEXCEPT {
 ngf_error ngf_start_cmd_buffer(ngf_cmd_buffer cmd_buffer, ngf_frame_token) NGF_NOEXCEPT {
   assert(cmd_buffer);
   cmd_buffer->mtl_cmd_buffer = nil;
-  cmd_buffer->mtl_cmd_buffer = [CURRENT_CONTEXT->queue commandBuffer];
+  cmd_buffer->mtl_cmd_buffer = [cmd_buffer->ctx->queue commandBuffer];
   cmd_buffer->active_rce     = nil;
   cmd_buffer->active_bce     = nil;
   NGFI_TRANSITION_CMD_BUF(cmd_buffer, NGFI_CMD_BUFFER_READY);
@@ -1759,16 +2036,19 @@ ngf_error ngf_start_cmd_buffer(ngf_cmd_buffer cmd_buffer, ngf_frame_token) NGF_N
 }
 
 ngf_error ngf_submit_cmd_buffers(uint32_t n, ngf_cmd_buffer* cmd_buffers) NGF_NOEXCEPT {
-  if (CURRENT_CONTEXT->pending_cmd_buffer) {
-    [CURRENT_CONTEXT->pending_cmd_buffer commit];
-    CURRENT_CONTEXT->pending_cmd_buffer = nil;
+  if (n == 0u) { return NGF_ERROR_OK; }
+  ngf_context                 ctx = cmd_buffers[0]->ctx;
+  std::lock_guard<std::mutex> lock(ctx->pending_cmd_buffer_mutex);
+  if (ctx->pending_cmd_buffer) {
+    [ctx->pending_cmd_buffer commit];
+    ctx->pending_cmd_buffer = nil;
   }
   for (uint32_t b = 0u; b < n; ++b) {
     NGFI_TRANSITION_CMD_BUF(cmd_buffers[b], NGFI_CMD_BUFFER_SUBMITTED);
     if (b < n - 1u) {
       [cmd_buffers[b]->mtl_cmd_buffer commit];
     } else {
-      CURRENT_CONTEXT->pending_cmd_buffer = cmd_buffers[b]->mtl_cmd_buffer;
+      ctx->pending_cmd_buffer = cmd_buffers[b]->mtl_cmd_buffer;
     }
     cmd_buffers[b]->mtl_cmd_buffer = nil;
   }
@@ -1865,6 +2145,10 @@ ngf_error ngf_cmd_begin_render_pass(
     ngf_cmd_buffer              cmd_buffer,
     const ngf_render_pass_info* pass_info,
     ngf_render_encoder*         enc) NGF_NOEXCEPT {
+  if (cmd_buffer->flags & (NGF_CMD_BUFFER_ASYNC_XFER | NGF_CMD_BUFFER_ASYNC_COMPUTE)) {
+    NGFI_DIAG_ERROR("render passes may not be recorded into async cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
   NGFI_TRANSITION_CMD_BUF(cmd_buffer, NGFI_CMD_BUFFER_RECORDING);
   assert(pass_info);
   const ngf_render_target rt = pass_info->render_target;
@@ -1890,7 +2174,14 @@ ngf_error ngf_cmd_begin_render_pass(
     switch (attachment_desc.type) {
     case NGF_ATTACHMENT_COLOR: {
       auto mtl_desc = [MTLRenderPassColorAttachmentDescriptor new];
-      ngfmtl_attachment_set_common(mtl_desc, i, attachment_desc.type, rt, load_op, store_op);
+      ngfmtl_attachment_set_common(
+          cmd_buffer->ctx,
+          mtl_desc,
+          i,
+          attachment_desc.type,
+          rt,
+          load_op,
+          store_op);
       if (clear_info) {
         mtl_desc.clearColor = MTLClearColorMake(
             clear_info->clear_color[0],
@@ -1901,7 +2192,7 @@ ngf_error ngf_cmd_begin_render_pass(
 
       if (attachment_desc.sample_count > NGF_SAMPLE_COUNT_1) {
         if (rt->is_default) {
-          mtl_desc.resolveTexture = CURRENT_CONTEXT->frame.resolve_attachment_texture();
+          mtl_desc.resolveTexture = cmd_buffer->ctx->frame.resolve_attachment_texture();
         } else if (rt->resolve_image_refs) {
           mtl_desc.resolveTexture = rt->resolve_image_refs[resolve_attachment_idx++].image->texture;
         }
@@ -1912,18 +2203,33 @@ ngf_error ngf_cmd_begin_render_pass(
     }
     case NGF_ATTACHMENT_DEPTH: {
       auto mtl_desc = [MTLRenderPassDepthAttachmentDescriptor new];
-      ngfmtl_attachment_set_common(mtl_desc, i, attachment_desc.type, rt, load_op, store_op);
+      ngfmtl_attachment_set_common(
+          cmd_buffer->ctx,
+          mtl_desc,
+          i,
+          attachment_desc.type,
+          rt,
+          load_op,
+          store_op);
       if (clear_info) { mtl_desc.clearDepth = clear_info->clear_depth_stencil.clear_depth; }
       pass_descriptor.depthAttachment = mtl_desc;
       break;
     }
     case NGF_ATTACHMENT_DEPTH_STENCIL: {
       auto mtl_depth_desc = [MTLRenderPassDepthAttachmentDescriptor new];
-      ngfmtl_attachment_set_common(mtl_depth_desc, i, attachment_desc.type, rt, load_op, store_op);
+      ngfmtl_attachment_set_common(
+          cmd_buffer->ctx,
+          mtl_depth_desc,
+          i,
+          attachment_desc.type,
+          rt,
+          load_op,
+          store_op);
       if (clear_info) { mtl_depth_desc.clearDepth = clear_info->clear_depth_stencil.clear_depth; }
       pass_descriptor.depthAttachment = mtl_depth_desc;
       auto mtl_stencil_desc           = [MTLRenderPassStencilAttachmentDescriptor new];
       ngfmtl_attachment_set_common(
+          cmd_buffer->ctx,
           mtl_stencil_desc,
           i,
           attachment_desc.type,
@@ -1963,6 +2269,10 @@ ngf_error ngf_cmd_end_render_pass(ngf_render_encoder enc) NGF_NOEXCEPT {
 ngf_error
 ngf_cmd_begin_xfer_pass(ngf_cmd_buffer cmd_buf, const ngf_xfer_pass_info*, ngf_xfer_encoder* enc)
     NGF_NOEXCEPT {
+  if (cmd_buf->flags & NGF_CMD_BUFFER_ASYNC_COMPUTE) {
+    NGFI_DIAG_ERROR("transfer passes may not be recorded into async compute cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
   NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_RECORDING);
   ngfmtl_finish_pending_encoders(cmd_buf);
   enc->pvt_data_donotuse.d0 = (uintptr_t)cmd_buf;
@@ -1984,6 +2294,10 @@ ngf_error ngf_cmd_begin_compute_pass(
     ngf_cmd_buffer cmd_buf,
     const ngf_compute_pass_info*,
     ngf_compute_encoder* enc) NGF_NOEXCEPT {
+  if (cmd_buf->flags & NGF_CMD_BUFFER_ASYNC_XFER) {
+    NGFI_DIAG_ERROR("compute passes may not be recorded into async transfer cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
   NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_RECORDING);
   enc->pvt_data_donotuse.d0 = (uintptr_t)cmd_buf;
   cmd_buf->active_cce       = [cmd_buf->mtl_cmd_buffer computeCommandEncoder];
@@ -2041,6 +2355,32 @@ void ngf_cmd_dispatch(
                                 threadgroup_size[2])];
 }
 
+void ngf_cmd_dispatch_indirect(
+    ngf_compute_encoder enc,
+    const ngf_buffer    args_buf,
+    size_t              offset) NGF_NOEXCEPT {
+  auto cmd_buf = NGFMTL_ENC2CMDBUF(enc);
+  assert(cmd_buf->active_cce);
+  if (!cmd_buf->active_cce) {
+    NGFI_DIAG_ERROR("Attempt to perform a compute dispatch without an active compute encoder.");
+    return;
+  }
+  assert(cmd_buf->active_compute_pipe);
+  if (!cmd_buf->active_compute_pipe) {
+    NGFI_DIAG_ERROR("Attempt to perform a compute dispatch without a bound compute pipeline.");
+    return;
+  }
+  const uint32_t* threadgroup_size =
+      cmd_buf->active_compute_pipe->niceshade_metadata.threadgroup_size;
+  [cmd_buf->active_cce
+      dispatchThreadgroupsWithIndirectBuffer:args_buf->mtl_buffer
+                        indirectBufferOffset:offset
+                       threadsPerThreadgroup:MTLSizeMake(
+                                                 threadgroup_size[0],
+                                                 threadgroup_size[1],
+                                                 threadgroup_size[2])];
+}
+
 void ngf_cmd_bind_gfx_pipeline(ngf_render_encoder enc, const ngf_graphics_pipeline pipeline)
     NGF_NOEXCEPT {
   auto buf = NGFMTL_ENC2CMDBUF(enc);
@@ -2112,6 +2452,44 @@ void ngf_cmd_draw(
   }
 }
 
+void ngf_cmd_draw_indirect(
+    ngf_render_encoder enc,
+    bool               indexed,
+    const ngf_buffer   args_buf,
+    size_t             offset,
+    uint32_t           ndraws,
+    uint32_t           stride) NGF_NOEXCEPT {
+  auto             buf       = NGFMTL_ENC2CMDBUF(enc);
+  MTLPrimitiveType prim_type = buf->active_gfx_pipe->primitive_type;
+  for (uint32_t d = 0u; d < ndraws; ++d) {
+    const size_t draw_offset = offset + (size_t)d * stride;
+    if (!indexed) {
+      [buf->active_rce drawPrimitives:prim_type
+                       indirectBuffer:args_buf->mtl_buffer
+                 indirectBufferOffset:draw_offset];
+    } else {
+      [buf->active_rce drawIndexedPrimitives:prim_type
+                                   indexType:buf->bound_index_buffer_type
+                                 indexBuffer:buf->bound_index_buffer
+                           indexBufferOffset:buf->bound_index_buffer_offset
+                              indirectBuffer:args_buf->mtl_buffer
+                        indirectBufferOffset:draw_offset];
+    }
+  }
+}
+
+void ngf_cmd_draw_indirect_count(
+    ngf_render_encoder,
+    bool,
+    const ngf_buffer,
+    size_t,
+    const ngf_buffer,
+    size_t,
+    uint32_t,
+    uint32_t) NGF_NOEXCEPT {
+  NGFI_DIAG_ERROR("Indirect draws with a GPU-sourced count are not supported on Metal.");
+}
+
 void ngf_cmd_bind_attrib_buffer(
     ngf_render_encoder enc,
     const ngf_buffer   buf,
@@ -2171,7 +2549,8 @@ void ngf_cmd_bind_resources(
       break;
     }
     case NGF_DESCRIPTOR_STORAGE_BUFFER:
-    case NGF_DESCRIPTOR_UNIFORM_BUFFER: {
+    case NGF_DESCRIPTOR_UNIFORM_BUFFER:
+    case NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC: {
       const ngf_buffer_bind_info& buf_bind_op = bind_op.info.buffer;
       const ngf_buffer            buf         = buf_bind_op.buffer;
       size_t                      offset      = buf_bind_op.offset;
@@ -2212,6 +2591,15 @@ void ngf_cmd_bind_resources(
   }
 }
 
+void ngf_cmd_push_constants(ngf_render_encoder, uint32_t, uint32_t, const void*) NGF_NOEXCEPT {
+  NGFI_DIAG_ERROR("Push constants are not supported by the Metal backend yet.");
+}
+
+void ngf_cmd_push_compute_constants(ngf_compute_encoder, uint32_t, uint32_t, const void*)
+    NGF_NOEXCEPT {
+  NGFI_DIAG_ERROR("Push constants are not supported by the Metal backend yet.");
+}
+
 void ngf_cmd_bind_compute_resources(
     ngf_compute_encoder         enc,
     const ngf_resource_bind_op* bind_ops,
@@ -2247,7 +2635,8 @@ void ngf_cmd_bind_compute_resources(
       break;
     }
     case NGF_DESCRIPTOR_STORAGE_BUFFER:
-    case NGF_DESCRIPTOR_UNIFORM_BUFFER: {
+    case NGF_DESCRIPTOR_UNIFORM_BUFFER:
+    case NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC: {
       const ngf_buffer_bind_info& buf_bind_op = bind_op.info.buffer;
       const ngf_buffer            buf         = buf_bind_op.buffer;
       size_t                      offset      = buf_bind_op.offset;
@@ -2277,6 +2666,24 @@ void ngf_cmd_bind_compute_resources(
   }
 }
 
+void ngf_cmd_bind_group(ngf_render_encoder enc, const ngf_bind_group group) NGF_NOEXCEPT {
+  ngf_cmd_bind_resources(enc, group->bind_ops.data(), (uint32_t)group->bind_ops.size());
+}
+
+void ngf_cmd_bind_compute_group(ngf_compute_encoder enc, const ngf_bind_group group) NGF_NOEXCEPT {
+  ngf_cmd_bind_compute_resources(enc, group->bind_ops.data(), (uint32_t)group->bind_ops.size());
+}
+
+void ngf_cmd_bind_resource_table(ngf_render_encoder, uint32_t, const ngf_resource_table)
+    NGF_NOEXCEPT {
+  NGFI_DIAG_ERROR("Resource tables are not supported by the Metal backend.");
+}
+
+void ngf_cmd_bind_compute_resource_table(ngf_compute_encoder, uint32_t, const ngf_resource_table)
+    NGF_NOEXCEPT {
+  NGFI_DIAG_ERROR("Resource tables are not supported by the Metal backend.");
+}
+
 void ngfmtl_cmd_copy_buffer(
     ngf_xfer_encoder enc,
     id<MTLBuffer>    src,
@@ -2336,6 +2743,31 @@ void ngf_cmd_write_image(
   }
 }
 
+ngf_error ngf_cmd_write_images(
+    ngf_xfer_encoder       enc,
+    const ngf_buffer       src,
+    const ngf_image_write* writes,
+    uint32_t               nwrites) NGF_NOEXCEPT {
+  // Blit encoders track hazards between the writes automatically, so there is nothing to batch.
+  for (uint32_t i = 0u; i < nwrites; ++i) {
+    if (!(writes[i].dst.image->usage_flags & NGF_IMAGE_USAGE_XFER_DST)) {
+      NGFI_DIAG_ERROR("image written to was created without the NGF_IMAGE_USAGE_XFER_DST flag");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+  }
+  for (uint32_t i = 0u; i < nwrites; ++i) {
+    ngf_cmd_write_image(
+        enc,
+        src,
+        writes[i].src_offset,
+        writes[i].dst,
+        writes[i].offset,
+        writes[i].extent,
+        writes[i].nlayers);
+  }
+  return NGF_ERROR_OK;
+}
+
 void ngf_cmd_copy_image_to_buffer(
     ngf_xfer_encoder    enc,
     const ngf_image_ref src,
@@ -2396,7 +2828,7 @@ void ngf_cmd_stencil_compare_mask(ngf_render_encoder enc, uint32_t front, uint32
   cmd_buf->active_gfx_pipe->depth_stencil_desc.frontFaceStencil.readMask = front;
   cmd_buf->active_gfx_pipe->depth_stencil_desc.backFaceStencil.readMask  = back;
   [cmd_buf->active_rce
-      setDepthStencilState:[CURRENT_CONTEXT->device
+      setDepthStencilState:[cmd_buf->ctx->device
                                newDepthStencilStateWithDescriptor:cmd_buf->active_gfx_pipe->
                                                                   depth_stencil_desc]];
 }
@@ -2407,16 +2839,19 @@ void ngf_cmd_stencil_write_mask(ngf_render_encoder enc, uint32_t front, uint32_t
   cmd_buf->active_gfx_pipe->depth_stencil_desc.frontFaceStencil.writeMask = front;
   cmd_buf->active_gfx_pipe->depth_stencil_desc.backFaceStencil.writeMask  = back;
   [cmd_buf->active_rce
-      setDepthStencilState:[CURRENT_CONTEXT->device
+      setDepthStencilState:[cmd_buf->ctx->device
                                newDepthStencilStateWithDescriptor:cmd_buf->active_gfx_pipe->
                                                                   depth_stencil_desc]];
 }
 
 void ngf_finish() NGF_NOEXCEPT {
-  if (CURRENT_CONTEXT->pending_cmd_buffer != nil) {
-    [CURRENT_CONTEXT->pending_cmd_buffer commit];
-    CURRENT_CONTEXT->last_cmd_buffer    = CURRENT_CONTEXT->pending_cmd_buffer;
-    CURRENT_CONTEXT->pending_cmd_buffer = nil;
+  {
+    std::lock_guard<std::mutex> lock(CURRENT_CONTEXT->pending_cmd_buffer_mutex);
+    if (CURRENT_CONTEXT->pending_cmd_buffer != nil) {
+      [CURRENT_CONTEXT->pending_cmd_buffer commit];
+      CURRENT_CONTEXT->last_cmd_buffer    = CURRENT_CONTEXT->pending_cmd_buffer;
+      CURRENT_CONTEXT->pending_cmd_buffer = nil;
+    }
   }
 
   if (CURRENT_CONTEXT->last_cmd_buffer != nil) {
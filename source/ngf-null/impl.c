@@ -0,0 +1,2184 @@
+/**
+ * Copyright (c) 2023 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * The null backend implements the entire nicegraf API without talking to a GPU.
+ * Commands are recorded into in-memory streams that are retired when the frame
+ * that they were submitted in comes around again, exactly like the native
+ * backends retire their command buffers. It exists to measure the CPU overhead of
+ * nicegraf's front-end (state tracking, bind op bookkeeping, allocators) in
+ * isolation, and to run API-level tests on machines without a GPU.
+ */
+
+#include "ngf-common/atomic-stack.h"
+#include "ngf-common/cmdbuf-state.h"
+#include "ngf-common/dynamic-array.h"
+#include "ngf-common/frame-token.h"
+#include "ngf-common/macros.h"
+#include "ngf-common/stack-alloc.h"
+#include "nicegraf.h"
+
+#include <assert.h>
+#include <string.h>
+
+#pragma region constants
+
+#define NGFNULL_BIND_OP_ARENA_CAPACITY      (64u)
+#define NGFNULL_DEFAULT_MAX_INFLIGHT_FRAMES (3u)
+#define NGFNULL_MAX_DIMENSION               (16384u)
+#define NGFNULL_MAX_RESOURCE_TABLE_CAPACITY (1u << 16u)
+#define NGFNULL_UPLOAD_CHUNK_SIZE           (64u * 1024u)
+
+#pragma endregion
+
+#pragma region internal_struct_definitions
+
+// Types of commands that can be recorded into a command stream.
+typedef enum ngfnull_cmd_type {
+  NGFNULL_CMD_BEGIN_RENDER_PASS = 0,
+  NGFNULL_CMD_END_RENDER_PASS,
+  NGFNULL_CMD_BEGIN_XFER_PASS,
+  NGFNULL_CMD_END_XFER_PASS,
+  NGFNULL_CMD_BEGIN_COMPUTE_PASS,
+  NGFNULL_CMD_END_COMPUTE_PASS,
+  NGFNULL_CMD_SYNC,
+  NGFNULL_CMD_BIND_GFX_PIPELINE,
+  NGFNULL_CMD_BIND_COMPUTE_PIPELINE,
+  NGFNULL_CMD_BIND_RESOURCE,
+  NGFNULL_CMD_BIND_GROUP,
+  NGFNULL_CMD_BIND_RESOURCE_TABLE,
+  NGFNULL_CMD_PUSH_CONSTANTS,
+  NGFNULL_CMD_VIEWPORT,
+  NGFNULL_CMD_SCISSOR,
+  NGFNULL_CMD_STENCIL_REFERENCE,
+  NGFNULL_CMD_STENCIL_COMPARE_MASK,
+  NGFNULL_CMD_STENCIL_WRITE_MASK,
+  NGFNULL_CMD_BIND_ATTRIB_BUFFER,
+  NGFNULL_CMD_BIND_INDEX_BUFFER,
+  NGFNULL_CMD_DRAW,
+  NGFNULL_CMD_DRAW_INDEXED,
+  NGFNULL_CMD_DISPATCH,
+  NGFNULL_CMD_DRAW_INDIRECT,
+  NGFNULL_CMD_DRAW_INDEXED_INDIRECT,
+  NGFNULL_CMD_DISPATCH_INDIRECT,
+  NGFNULL_CMD_COPY_BUFFER,
+  NGFNULL_CMD_WRITE_IMAGE,
+  NGFNULL_CMD_COPY_IMAGE_TO_BUFFER,
+  NGFNULL_CMD_GENERATE_MIPMAPS,
+  NGFNULL_CMD_WRITE_TIMESTAMP,
+  NGFNULL_CMD_BEGIN_QUERY,
+  NGFNULL_CMD_END_QUERY
+} ngfnull_cmd_type;
+
+// A single recorded command. The meaning of the arguments depends on the command type.
+typedef struct ngfnull_cmd {
+  ngfnull_cmd_type type;
+  const void*      obj;  // Object that the command operates on (pipeline, buffer, image...), if any.
+  union {
+    uint32_t             u32[4];
+    size_t               sz[3];
+    ngf_irect2d          rect;
+    ngf_resource_bind_op bind_op;
+    struct {
+      size_t      offset;
+      size_t      count_offset;
+      const void* count_buf;  // NULL unless the draw count is sourced from a buffer.
+      uint32_t    ndraws;
+      uint32_t    stride;
+    } indirect;
+  } args;
+} ngfnull_cmd;
+
+// An in-memory command stream. Streams are owned by the cmd buffer that records into them, and are
+// only borrowed by the frame they are submitted in until that frame is retired.
+typedef struct ngfnull_cmd_stream {
+  ngfi_atomic_stack_node node;
+  NGFI_DARRAY_OF(ngfnull_cmd) cmds;
+} ngfnull_cmd_stream;
+
+// Streams that a cmd buffer records into during frames with a particular id. They are recycled when
+// first used in a new frame, by which point the previous frame with the same id has been retired.
+typedef struct ngfnull_cmd_buffer_frame_res {
+  NGFI_DARRAY_OF(ngfnull_cmd_stream*) streams;
+  uint32_t nused_streams;
+  uint64_t frame_serial;  // Frame that the streams were last recycled for.
+} ngfnull_cmd_buffer_frame_res;
+
+// A resource table slot that has been freed, and may be reused once its frame is retired.
+typedef struct ngfnull_retired_table_slot {
+  struct ngf_resource_table_t* table;
+  uint32_t                     slot;
+} ngfnull_retired_table_slot;
+
+// A buffer that transient uploads are suballocated from.
+typedef struct ngfnull_upload_chunk {
+  struct ngf_buffer_t* buffer;
+  size_t               used;  // Number of bytes handed out during the current frame.
+} ngfnull_upload_chunk;
+
+// Resources associated with a particular frame.
+typedef struct ngfnull_frame_resources {
+  // Streams submitted during the frame, possibly from different threads. They are moved into
+  // `submitted_streams` on the thread that the context is current on.
+  ngfi_atomic_stack submissions;
+  NGFI_DARRAY_OF(ngfnull_cmd_stream*) submitted_streams;
+  NGFI_DARRAY_OF(ngfnull_cmd_stream*) retire_streams;  // Freed once the frame is retired.
+  NGFI_DARRAY_OF(struct ngf_buffer_t*) retire_buffers;
+  NGFI_DARRAY_OF(struct ngf_image_t*) retire_images;
+  NGFI_DARRAY_OF(ngfnull_retired_table_slot) retire_table_slots;
+  NGFI_DARRAY_OF(ngfnull_upload_chunk) upload_chunks;  // Reused once the frame is retired.
+} ngfnull_frame_resources;
+
+#define NGFNULL_ENC2CMDBUF(enc) ((ngf_cmd_buffer)((void*)enc.pvt_data_donotuse.d0))
+
+#pragma endregion
+
+#pragma region external_struct_definitions
+
+typedef struct ngf_cmd_buffer_t {
+  ngf_context           ctx;  // The context that the cmd buffer was created in.
+  ngf_frame_token       parent_frame;
+  uint64_t              frame_serial;  // Serial of the frame being recorded for.
+  ngfi_cmd_buffer_state state;
+  ngfnull_cmd_stream*   stream;
+  ngf_graphics_pipeline active_gfx_pipe;
+  ngf_compute_pipeline  active_compute_pipe;
+  ngf_render_target     active_rt;
+  uint32_t              flags;
+  bool                  renderpass_active;
+  bool                  compute_pass_active;
+  ngf_query_pool        pass_timestamp_pool;  // NULL if pass timestamps are disabled.
+  uint32_t              next_pass_timestamp;  // Query for the next pass' begin timestamp.
+  uint32_t              pass_timestamps_end;  // One past the last query of the range.
+  uint32_t              active_pass_end_timestamp;  // Query for the active pass' end, or ~0u.
+  ngf_query_pool        active_query_pool;  // Pool of the query begun in the active pass, if any.
+  bool                  parallel_renderpass;  // Set while a parallel render pass is active.
+  // Bind ops to be resolved before the next draw or dispatch. The storage is kept for the lifetime
+  // of the command buffer.
+  NGFI_DARRAY_OF(ngf_resource_bind_op) pending_bind_ops;
+  ngfnull_cmd_buffer_frame_res* frame_res;  // One per frame in flight, NULL for secondaries.
+  uint32_t                      nframe_res;
+} ngf_cmd_buffer_t;
+
+typedef struct ngf_sampler_t {
+  ngf_sampler_info info;
+} ngf_sampler_t;
+
+typedef struct ngf_buffer_t {
+  uint8_t*               data;
+  size_t                 size;
+  ngf_buffer_storage_type storage_type;
+  uint32_t               usage_flags;
+} ngf_buffer_t;
+
+typedef struct ngf_texel_buffer_view_t {
+  ngf_texel_buffer_view_info info;
+} ngf_texel_buffer_view_t;
+
+typedef struct ngf_bind_group_t {
+  ngf_resource_bind_op* bind_ops;  // Copy of the bind ops that the group was created with.
+  uint32_t              nbind_ops;
+  uint32_t              set;
+} ngf_bind_group_t;
+
+typedef struct ngf_resource_table_t {
+  ngf_descriptor_type type;
+  uint32_t            capacity;
+  uint32_t            nused_slots;  // Slots at or past this index have never been handed out.
+  NGFI_DARRAY_OF(uint32_t) free_slots;  // Slots that have been freed and are safe to reuse.
+} ngf_resource_table_t;
+
+typedef struct ngf_query_pool_t {
+  ngf_query_type type;
+  uint32_t       nqueries;
+  uint32_t       nvalues;    // Number of values produced by each query.
+  uint64_t*      results;    // nvalues consecutive values per query.
+  bool*          available;  // Set once a command writing the query's result has been retired.
+} ngf_query_pool_t;
+
+typedef struct ngf_image_t {
+  ngf_image_type   type;
+  ngf_extent3d     extent;
+  uint32_t         nmips;
+  uint32_t         nlayers;
+  ngf_image_format format;
+  uint32_t         usage_flags;
+} ngf_image_t;
+
+typedef struct ngf_context_t {
+  ngfnull_frame_resources*    frame_res;
+  ngf_swapchain_info          swapchain_info;
+  ngf_render_target           default_render_target;
+  ngf_attachment_descriptions default_attachment_descriptions_list;
+  ngf_frame_token             current_frame_token;
+  uint32_t                    frame_id;
+  uint32_t                    max_inflight_frames;
+  uint64_t                    cmd_buffer_counter;
+  uint64_t                    frame_serial;  // Incremented whenever a new frame begins.
+  uint64_t                    timestamp_counter;  // Fake clock that timestamp queries read.
+  ngf_context_stats           stats;
+} ngf_context_t;
+
+typedef struct ngf_shader_stage_t {
+  ngf_stage_type type;
+} ngf_shader_stage_t;
+
+typedef struct ngf_graphics_pipeline_t {
+  uint32_t stage_mask;
+} ngf_graphics_pipeline_t;
+
+typedef struct ngf_compute_pipeline_t {
+  uint32_t stage_mask;
+} ngf_compute_pipeline_t;
+
+typedef struct ngf_render_target_t {
+  ngf_attachment_description* attachment_descs;
+  uint32_t                    nattachments;
+  bool                        is_default;
+  uint32_t                    width;
+  uint32_t                    height;
+} ngf_render_target_t;
+
+#pragma endregion
+
+#pragma region global_vars
+
+NGFI_THREADLOCAL ngf_context CURRENT_CONTEXT = NULL;
+
+static ngf_device_capabilities DEVICE_CAPS;
+static ngf_device              NGFNULL_DEVICE;
+static bool                    NGFNULL_INITIALIZED = false;
+
+#pragma endregion
+
+#pragma region internal_funcs
+
+void             ngfi_set_allocation_callbacks(const ngf_allocation_callbacks* callbacks);
+ngf_sample_count ngfi_get_highest_sample_count(size_t counts_bitmap);
+
+static void ngfnull_init_device_if_necessary(void) {
+  if (NGFNULL_DEVICE.name[0] != '\0') { return; }
+  const size_t all_sample_counts = NGF_SAMPLE_COUNT_1 | NGF_SAMPLE_COUNT_2 | NGF_SAMPLE_COUNT_4 |
+                                   NGF_SAMPLE_COUNT_8 | NGF_SAMPLE_COUNT_16;
+  ngf_device_capabilities* devcaps                  = &NGFNULL_DEVICE.capabilities;
+  devcaps->uniform_buffer_offset_alignment          = 256u;
+  devcaps->max_uniform_buffer_range                 = 65536u;
+  devcaps->texel_buffer_offset_alignment            = 16u;
+  devcaps->max_vertex_input_attributes_per_pipeline = 16u;
+  devcaps->max_sampled_images_per_stage             = 1024u;
+  devcaps->max_samplers_per_stage                   = 1024u;
+  devcaps->max_uniform_buffers_per_stage            = 16u;
+  devcaps->max_fragment_input_components            = 128u;
+  devcaps->max_fragment_inputs                      = 32u;
+  devcaps->max_1d_image_dimension                   = NGFNULL_MAX_DIMENSION;
+  devcaps->max_2d_image_dimension                   = NGFNULL_MAX_DIMENSION;
+  devcaps->max_3d_image_dimension                   = 2048u;
+  devcaps->max_cube_image_dimension                 = NGFNULL_MAX_DIMENSION;
+  devcaps->max_image_layers                         = 2048u;
+  devcaps->max_color_attachments_per_pass           = 8u;
+  devcaps->max_sampler_anisotropy                   = 16.0f;
+  devcaps->clipspace_z_zero_to_one                  = true;
+  devcaps->cubemap_arrays_supported                 = true;
+  devcaps->draw_indirect_count_supported            = true;
+  devcaps->max_draw_indirect_count                  = UINT32_MAX;
+  devcaps->resource_tables_supported                = true;
+  devcaps->max_resource_table_capacity              = NGFNULL_MAX_RESOURCE_TABLE_CAPACITY;
+  devcaps->async_xfer_supported                     = false;
+  devcaps->async_compute_supported                  = false;
+  devcaps->timestamp_queries_supported              = true;
+  devcaps->occlusion_queries_supported              = true;
+  devcaps->pipeline_statistics_queries_supported    = true;
+  devcaps->secondary_cmd_buffers_supported          = true;
+  devcaps->framebuffer_color_sample_counts          = all_sample_counts;
+  devcaps->framebuffer_depth_sample_counts          = all_sample_counts;
+  devcaps->texture_color_sample_counts              = all_sample_counts;
+  devcaps->texture_depth_sample_counts              = all_sample_counts;
+  devcaps->max_supported_framebuffer_color_sample_count =
+      ngfi_get_highest_sample_count(devcaps->framebuffer_color_sample_counts);
+  devcaps->max_supported_framebuffer_depth_sample_count =
+      ngfi_get_highest_sample_count(devcaps->framebuffer_depth_sample_counts);
+  devcaps->max_supported_texture_color_sample_count =
+      ngfi_get_highest_sample_count(devcaps->texture_color_sample_counts);
+  devcaps->max_supported_texture_depth_sample_count =
+      ngfi_get_highest_sample_count(devcaps->texture_depth_sample_counts);
+  NGFNULL_DEVICE.performance_tier = NGF_DEVICE_PERFORMANCE_TIER_UNKNOWN;
+  NGFNULL_DEVICE.handle           = 0u;
+  strncpy(NGFNULL_DEVICE.name, "nicegraf null device", NGF_DEVICE_NAME_MAX_LENGTH - 1u);
+}
+
+// Appends a new command to the given command buffer's stream and returns a pointer to it.
+static ngfnull_cmd* ngfnull_record(ngf_cmd_buffer cmd_buf, ngfnull_cmd_type type, const void* obj) {
+  assert(cmd_buf->stream);
+  NGFI_DARRAY_APPEND_EMPTY(cmd_buf->stream->cmds);
+  ngfnull_cmd* cmd = NGFI_DARRAY_BACKPTR(cmd_buf->stream->cmds);
+  memset(cmd, 0, sizeof(ngfnull_cmd));
+  cmd->type = type;
+  cmd->obj  = obj;
+  return cmd;
+}
+
+static void ngfnull_destroy_stream(ngfnull_cmd_stream* stream) {
+  NGFI_DARRAY_DESTROY(stream->cmds);
+  NGFI_FREE(stream);
+}
+
+static ngfnull_cmd_stream* ngfnull_create_stream(void) {
+  ngfnull_cmd_stream* stream = NGFI_ALLOC(ngfnull_cmd_stream);
+  if (stream) {
+    stream->node.next = NULL;
+    NGFI_DARRAY_RESET(stream->cmds, 64u);
+  }
+  return stream;
+}
+
+// Obtains a command stream for recording commands for the cmd buffer's frame, recycling one of the
+// cmd buffer's streams if possible.
+static ngfnull_cmd_stream* ngfnull_stream_for_frame(ngf_cmd_buffer cmd_buf) {
+  ngfnull_cmd_buffer_frame_res* res = &cmd_buf->frame_res[ngfi_frame_id(cmd_buf->parent_frame)];
+  if (res->frame_serial != cmd_buf->frame_serial) {
+    res->nused_streams = 0u;
+    res->frame_serial  = cmd_buf->frame_serial;
+  }
+  if (res->nused_streams == NGFI_DARRAY_SIZE(res->streams)) {
+    ngfnull_cmd_stream* new_stream = ngfnull_create_stream();
+    if (new_stream == NULL) { return NULL; }
+    NGFI_DARRAY_APPEND(res->streams, new_stream);
+  }
+  ngfnull_cmd_stream* stream = NGFI_DARRAY_AT(res->streams, res->nused_streams++);
+  NGFI_DARRAY_CLEAR(stream->cmds);
+  return stream;
+}
+
+// Moves the streams that have been submitted during the given frame into its resources. Must be
+// called on the thread that the context is current on.
+static void ngfnull_collect_submissions(ngf_context ctx, ngfnull_frame_resources* frame_res) {
+  ngfi_atomic_stack_node* node = ngfi_atomic_stack_take_all(&frame_res->submissions, NULL);
+  while (node != NULL) {
+    ngfnull_cmd_stream* stream = NGFI_ATOMIC_STACK_CONTAINER_OF(node, ngfnull_cmd_stream, node);
+    node                       = node->next;
+    NGFI_DARRAY_APPEND(frame_res->submitted_streams, stream);
+    ctx->cmd_buffer_counter++;
+  }
+}
+
+static void ngfnull_destroy_buffer_storage(ngf_buffer buf) {
+  if (buf->data) { NGFI_FREEN(buf->data, buf->size); }
+  NGFI_FREE(buf);
+}
+
+// Stores the result of an occlusion or pipeline statistics query. The null device doesn't
+// rasterize anything, so every vertex is counted as a single passing sample and no fragment shader
+// invocations are reported.
+static void ngfnull_resolve_query(ngf_query_pool pool, uint32_t query, uint64_t nvertices) {
+  uint64_t* values = &pool->results[query * pool->nvalues];
+  if (pool->type == NGF_QUERY_TYPE_OCCLUSION) {
+    values[0] = nvertices;
+  } else {
+    values[NGF_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS]   = nvertices;
+    values[NGF_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS] = 0u;
+  }
+  pool->available[query] = true;
+}
+
+static void ngfnull_retire_resources(ngf_context ctx, ngfnull_frame_resources* frame_res) {
+  ngfnull_collect_submissions(ctx, frame_res);
+  NGFI_DARRAY_FOREACH(frame_res->submitted_streams, s) {
+    ngfnull_cmd_stream* stream = NGFI_DARRAY_AT(frame_res->submitted_streams, s);
+    // The frame's commands are considered executed once it's retired, which is when the results
+    // of its queries become available.
+    ngf_query_pool active_pool  = NULL;
+    uint32_t       active_query = 0u;
+    uint64_t       nvertices    = 0u;
+    NGFI_DARRAY_FOREACH(stream->cmds, c) {
+      const ngfnull_cmd* cmd = &NGFI_DARRAY_AT(stream->cmds, c);
+      switch (cmd->type) {
+      case NGFNULL_CMD_WRITE_TIMESTAMP:
+        if (cmd->obj != NULL) {
+          ngf_query_pool pool               = (ngf_query_pool)cmd->obj;
+          pool->results[cmd->args.u32[0]]   = ++ctx->timestamp_counter;
+          pool->available[cmd->args.u32[0]] = true;
+        }
+        break;
+      case NGFNULL_CMD_BEGIN_QUERY:
+        active_pool  = (ngf_query_pool)cmd->obj;
+        active_query = cmd->args.u32[0];
+        nvertices    = 0u;
+        break;
+      case NGFNULL_CMD_DRAW:
+      case NGFNULL_CMD_DRAW_INDEXED:
+        nvertices += (uint64_t)cmd->args.u32[1] * cmd->args.u32[2];
+        break;
+      case NGFNULL_CMD_END_QUERY:
+        if (active_pool != NULL) { ngfnull_resolve_query(active_pool, active_query, nvertices); }
+        active_pool = NULL;
+        break;
+      default:
+        break;
+      }
+    }
+  }
+  NGFI_DARRAY_FOREACH(frame_res->retire_streams, s) {
+    ngfnull_destroy_stream(NGFI_DARRAY_AT(frame_res->retire_streams, s));
+  }
+  NGFI_DARRAY_FOREACH(frame_res->retire_buffers, b) {
+    ngfnull_destroy_buffer_storage(NGFI_DARRAY_AT(frame_res->retire_buffers, b));
+  }
+  NGFI_DARRAY_FOREACH(frame_res->retire_images, i) {
+    NGFI_FREE(NGFI_DARRAY_AT(frame_res->retire_images, i));
+  }
+  NGFI_DARRAY_FOREACH(frame_res->retire_table_slots, t) {
+    const ngfnull_retired_table_slot* retired = &NGFI_DARRAY_AT(frame_res->retire_table_slots, t);
+    NGFI_DARRAY_APPEND(retired->table->free_slots, retired->slot);
+  }
+  uint32_t nkept_chunks = 0u;
+  NGFI_DARRAY_FOREACH(frame_res->upload_chunks, c) {
+    ngfnull_upload_chunk chunk = NGFI_DARRAY_AT(frame_res->upload_chunks, c);
+    if (chunk.buffer->size > NGFNULL_UPLOAD_CHUNK_SIZE) {
+      ngfnull_destroy_buffer_storage(chunk.buffer);
+    } else {
+      chunk.used                                              = 0u;
+      NGFI_DARRAY_AT(frame_res->upload_chunks, nkept_chunks++) = chunk;
+    }
+  }
+  NGFI_DARRAY_RESIZE(frame_res->upload_chunks, nkept_chunks);
+  NGFI_DARRAY_CLEAR(frame_res->submitted_streams);
+  NGFI_DARRAY_CLEAR(frame_res->retire_streams);
+  NGFI_DARRAY_CLEAR(frame_res->retire_buffers);
+  NGFI_DARRAY_CLEAR(frame_res->retire_images);
+  NGFI_DARRAY_CLEAR(frame_res->retire_table_slots);
+}
+
+static void ngfnull_cleanup_pending_binds(ngf_cmd_buffer cmd_buf) {
+  NGFI_DARRAY_CLEAR(cmd_buf->pending_bind_ops);
+}
+
+static void ngfnull_cmd_bind_resources(
+    ngf_cmd_buffer              buf,
+    const ngf_resource_bind_op* bind_operations,
+    uint32_t                    nbind_operations) {
+  if (nbind_operations > 0u) {
+    NGFI_DARRAY_APPEND_N(buf->pending_bind_ops, bind_operations, nbind_operations);
+  }
+}
+
+// Resolves the pending bind operations into the command stream. Like the native backends, only
+// the last bind operation targeting any given (set, binding) pair takes effect.
+static void ngfnull_execute_pending_binds(ngf_cmd_buffer cmd_buf) {
+  if (cmd_buf->renderpass_active == cmd_buf->compute_pass_active) {
+    NGFI_DIAG_ERROR("binding resources requires either a render or a compute pass to be active");
+    ngfnull_cleanup_pending_binds(cmd_buf);
+    return;
+  }
+  const uint32_t npending_ops = NGFI_DARRAY_SIZE(cmd_buf->pending_bind_ops);
+  if (npending_ops == 0u) { return; }
+
+  ngfi_sa_reset(ngfi_tmp_store());
+  const ngf_resource_bind_op** resolved_ops =
+      ngfi_sa_alloc(ngfi_tmp_store(), sizeof(ngf_resource_bind_op*) * npending_ops);
+  if (resolved_ops == NULL) {
+    NGFI_DIAG_ERROR("failed memory allocation while executing pending binds");
+    ngfnull_cleanup_pending_binds(cmd_buf);
+    return;
+  }
+
+  size_t nresolved_ops = 0u;
+  NGFI_DARRAY_FOREACH(cmd_buf->pending_bind_ops, i) {
+    const ngf_resource_bind_op* bind_op = &NGFI_DARRAY_AT(cmd_buf->pending_bind_ops, i);
+    size_t                      j       = 0u;
+    for (; j < nresolved_ops; ++j) {
+      if (resolved_ops[j]->target_set == bind_op->target_set &&
+          resolved_ops[j]->target_binding == bind_op->target_binding) {
+        break;
+      }
+    }
+    resolved_ops[j] = bind_op;
+    if (j == nresolved_ops) { ++nresolved_ops; }
+  }
+
+  for (size_t i = 0u; i < nresolved_ops; ++i) {
+    ngfnull_cmd* cmd  = ngfnull_record(cmd_buf, NGFNULL_CMD_BIND_RESOURCE, NULL);
+    cmd->args.bind_op = *resolved_ops[i];
+  }
+
+  ngfnull_cleanup_pending_binds(cmd_buf);
+}
+
+static ngf_error ngfnull_execute_sync_op(ngf_cmd_buffer cmd_buf, uint32_t nsync_resources) {
+  if (cmd_buf->state != NGFI_CMD_BUFFER_READY &&
+      cmd_buf->state != NGFI_CMD_BUFFER_AWAITING_SUBMIT) {
+    NGFI_DIAG_ERROR("synchronization can only be performed outside of an active pass");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (nsync_resources > 0u) {
+    ngfnull_cmd* cmd     = ngfnull_record(cmd_buf, NGFNULL_CMD_SYNC, NULL);
+    cmd->args.u32[0] = nsync_resources;
+  }
+  return NGF_ERROR_OK;
+}
+
+// Checks whether a timestamp from the given pool may be recorded into the given cmd buffer.
+static ngf_error ngfnull_validate_timestamp_cmd(ngf_cmd_buffer cmd_buf, ngf_query_pool pool) {
+  if (cmd_buf->state != NGFI_CMD_BUFFER_READY &&
+      cmd_buf->state != NGFI_CMD_BUFFER_AWAITING_SUBMIT) {
+    NGFI_DIAG_ERROR("timestamps may only be recorded into started cmd buffers, outside of passes");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (cmd_buf->flags & (NGF_CMD_BUFFER_ASYNC_XFER | NGF_CMD_BUFFER_SECONDARY)) {
+    NGFI_DIAG_ERROR("timestamps may not be recorded into async transfer or secondary cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (pool != NULL && pool->type != NGF_QUERY_TYPE_TIMESTAMP) {
+    NGFI_DIAG_ERROR("timestamps may only be written to timestamp query pools");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  return NGF_ERROR_OK;
+}
+
+// Records a timestamp write. The query keeps its previous result until this write is retired.
+static void
+ngfnull_cmd_write_timestamp(ngf_cmd_buffer cmd_buf, ngf_query_pool pool, uint32_t query) {
+  ngfnull_record(cmd_buf, NGFNULL_CMD_WRITE_TIMESTAMP, pool)->args.u32[0] = query;
+}
+
+static ngf_error ngfnull_encoder_start(
+    ngf_cmd_buffer                    cmd_buf,
+    struct ngfi_private_encoder_data* enc,
+    ngfnull_cmd_type                  begin_cmd,
+    const void*                       obj) {
+  NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_RECORDING);
+  enc->d0 = (uintptr_t)cmd_buf;
+  enc->d1 = 0u;
+  cmd_buf->active_pass_end_timestamp = ~0u;
+  if (cmd_buf->pass_timestamp_pool != NULL &&
+      cmd_buf->pass_timestamps_end - cmd_buf->next_pass_timestamp >= 2u) {
+    ngfnull_cmd_write_timestamp(
+        cmd_buf,
+        cmd_buf->pass_timestamp_pool,
+        cmd_buf->next_pass_timestamp);
+    cmd_buf->active_pass_end_timestamp = cmd_buf->next_pass_timestamp + 1u;
+    cmd_buf->next_pass_timestamp += 2u;
+  }
+  ngfnull_record(cmd_buf, begin_cmd, obj);
+  return NGF_ERROR_OK;
+}
+
+static ngf_error ngfnull_encoder_end(ngf_cmd_buffer cmd_buf, ngfnull_cmd_type end_cmd) {
+  ngfnull_cleanup_pending_binds(cmd_buf);
+  NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_AWAITING_SUBMIT);
+  ngfnull_record(cmd_buf, end_cmd, NULL);
+  if (cmd_buf->active_pass_end_timestamp != ~0u) {
+    ngfnull_cmd_write_timestamp(
+        cmd_buf,
+        cmd_buf->pass_timestamp_pool,
+        cmd_buf->active_pass_end_timestamp);
+    cmd_buf->active_pass_end_timestamp = ~0u;
+  }
+  return NGF_ERROR_OK;
+}
+
+static ngf_error ngfnull_create_default_render_target(ngf_context ctx) {
+  const ngf_swapchain_info* swapchain_info = &ctx->swapchain_info;
+  const bool     has_depth = swapchain_info->depth_format != NGF_IMAGE_FORMAT_UNDEFINED;
+  const uint32_t nattachments = has_depth ? 2u : 1u;
+
+  ngf_render_target rt = NGFI_ALLOC(ngf_render_target_t);
+  if (rt == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  rt->attachment_descs = NGFI_ALLOCN(ngf_attachment_description, nattachments);
+  if (rt->attachment_descs == NULL) {
+    NGFI_FREE(rt);
+    return NGF_ERROR_OUT_OF_MEM;
+  }
+  rt->nattachments                     = nattachments;
+  rt->is_default                       = true;
+  rt->width                            = swapchain_info->width;
+  rt->height                           = swapchain_info->height;
+  rt->attachment_descs[0].type         = NGF_ATTACHMENT_COLOR;
+  rt->attachment_descs[0].format       = swapchain_info->color_format;
+  rt->attachment_descs[0].sample_count = swapchain_info->sample_count;
+  rt->attachment_descs[0].is_sampled   = false;
+  rt->attachment_descs[0].is_resolve   = false;
+  if (has_depth) {
+    rt->attachment_descs[1].type         = NGF_ATTACHMENT_DEPTH;
+    rt->attachment_descs[1].format       = swapchain_info->depth_format;
+    rt->attachment_descs[1].sample_count = swapchain_info->sample_count;
+    rt->attachment_descs[1].is_sampled   = false;
+    rt->attachment_descs[1].is_resolve   = false;
+  }
+  ctx->default_render_target = rt;
+  return NGF_ERROR_OK;
+}
+
+#pragma endregion
+
+#pragma region external_funcs
+
+ngf_error ngf_get_device_list(const ngf_device** devices, uint32_t* ndevices) {
+  ngfnull_init_device_if_necessary();
+  if (devices) { *devices = &NGFNULL_DEVICE; }
+  if (ndevices) { *ndevices = 1u; }
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_initialize(const ngf_init_info* init_info) {
+  // Sanity checks.
+  if (!init_info) { return NGF_ERROR_INVALID_OPERATION; }
+  if (NGFNULL_INITIALIZED) {
+    // Disallow double initialization.
+    NGFI_DIAG_ERROR("double-initialization detected. `ngf_initialize` may only be called once.")
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+
+  // Install user-provided diagnostic callbacks and set preferred log verbosity.
+  if (init_info->diag_info != NULL) {
+    ngfi_diag_info = *init_info->diag_info;
+  } else {
+    ngfi_diag_info.callback  = NULL;
+    ngfi_diag_info.userdata  = NULL;
+    ngfi_diag_info.verbosity = NGF_DIAGNOSTICS_VERBOSITY_DEFAULT;
+  }
+  NGFI_DIAG_INFO("Initializing nicegraf (null backend).");
+
+  // Install user-provided allocation callbacks.
+  ngfi_set_allocation_callbacks(init_info->allocation_callbacks);
+
+  if (init_info->device != NGFNULL_DEVICE.handle) {
+    NGFI_DIAG_ERROR("the null backend only exposes a single device.");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  ngfnull_init_device_if_necessary();
+  DEVICE_CAPS         = NGFNULL_DEVICE.capabilities;
+  NGFNULL_INITIALIZED = true;
+
+  return NGF_ERROR_OK;
+}
+
+void ngf_shutdown(void) {
+  NGFI_DIAG_INFO("Shutting down nicegraf.");
+  NGFNULL_INITIALIZED = false;
+}
+
+const ngf_device_capabilities* ngf_get_device_capabilities(void) {
+  return &DEVICE_CAPS;
+}
+
+ngf_error ngf_create_context(const ngf_context_info* info, ngf_context* result) {
+  assert(info);
+  assert(result);
+
+  ngf_error   err = NGF_ERROR_OK;
+  ngf_context ctx = NGFI_ALLOC(ngf_context_t);
+  if (ctx == NULL) {
+    err = NGF_ERROR_OUT_OF_MEM;
+    goto ngf_create_context_cleanup;
+  }
+  memset(ctx, 0, sizeof(ngf_context_t));
+  *result = ctx;
+
+  if (info->swapchain_info) {
+    ctx->swapchain_info      = *info->swapchain_info;
+    ctx->max_inflight_frames = NGFI_MAX(2u, info->swapchain_info->capacity_hint);
+    err                      = ngfnull_create_default_render_target(ctx);
+    if (err != NGF_ERROR_OK) { goto ngf_create_context_cleanup; }
+  } else {
+    ctx->max_inflight_frames = NGFNULL_DEFAULT_MAX_INFLIGHT_FRAMES;
+  }
+
+  ctx->frame_res = NGFI_ALLOCN(ngfnull_frame_resources, ctx->max_inflight_frames);
+  if (ctx->frame_res == NULL) {
+    err = NGF_ERROR_OUT_OF_MEM;
+    goto ngf_create_context_cleanup;
+  }
+  for (uint32_t f = 0u; f < ctx->max_inflight_frames; ++f) {
+    NGFI_DARRAY_RESET(ctx->frame_res[f].submitted_streams, 8u);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].retire_streams, 8u);
+    ctx->frame_res[f].submissions.head = NULL;
+    NGFI_DARRAY_RESET(ctx->frame_res[f].retire_buffers, 8u);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].retire_images, 8u);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].retire_table_slots, 8u);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].upload_chunks, 4u);
+  }
+
+  ctx->frame_id            = 0u;
+  ctx->current_frame_token = ~0u;
+  ctx->cmd_buffer_counter  = 0u;
+  ctx->frame_serial        = 0u;
+
+ngf_create_context_cleanup:
+  if (err != NGF_ERROR_OK) { ngf_destroy_context(ctx); }
+  return err;
+}
+
+ngf_error ngf_resize_context(ngf_context ctx, uint32_t new_width, uint32_t new_height) {
+  assert(ctx);
+  if (ctx->default_render_target == NULL) { return NGF_ERROR_INVALID_OPERATION; }
+  ctx->swapchain_info.width          = new_width;
+  ctx->swapchain_info.height         = new_height;
+  ctx->default_render_target->width  = new_width;
+  ctx->default_render_target->height = new_height;
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_context(ngf_context ctx) {
+  if (ctx == NULL) { return; }
+  if (ctx->frame_res != NULL) {
+    // Frames are retired oldest first, like they would have been had rendering continued.
+    const uint32_t nframes = ctx->max_inflight_frames;
+    for (uint32_t i = 1u; i <= nframes; ++i) {
+      ngfnull_retire_resources(ctx, &ctx->frame_res[(ctx->frame_id + i) % nframes]);
+    }
+    for (uint32_t f = 0u; f < ctx->max_inflight_frames; ++f) {
+      ngfnull_frame_resources* frame_res = &ctx->frame_res[f];
+      NGFI_DARRAY_DESTROY(frame_res->submitted_streams);
+      NGFI_DARRAY_DESTROY(frame_res->retire_streams);
+      NGFI_DARRAY_DESTROY(frame_res->retire_buffers);
+      NGFI_DARRAY_DESTROY(frame_res->retire_images);
+      NGFI_DARRAY_DESTROY(frame_res->retire_table_slots);
+      NGFI_DARRAY_FOREACH(frame_res->upload_chunks, c) {
+        ngfnull_destroy_buffer_storage(NGFI_DARRAY_AT(frame_res->upload_chunks, c).buffer);
+      }
+      NGFI_DARRAY_DESTROY(frame_res->upload_chunks);
+    }
+    NGFI_FREEN(ctx->frame_res, ctx->max_inflight_frames);
+  }
+  if (ctx->default_render_target) {
+    NGFI_FREEN(
+        ctx->default_render_target->attachment_descs,
+        ctx->default_render_target->nattachments);
+    NGFI_FREE(ctx->default_render_target);
+  }
+  if (CURRENT_CONTEXT == ctx) CURRENT_CONTEXT = NULL;
+  NGFI_FREE(ctx);
+}
+
+ngf_error ngf_set_context(ngf_context ctx) {
+  CURRENT_CONTEXT = ctx;
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_get_context_stats(ngf_context ctx, ngf_context_stats* stats) {
+  assert(ctx);
+  assert(stats);
+  *stats = ctx->stats;
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_load_pipeline_cache(ngf_context ctx, const void* data, size_t size) {
+  assert(ctx);
+  NGFI_IGNORE_VAR(ctx);
+  NGFI_IGNORE_VAR(data);
+  NGFI_IGNORE_VAR(size);
+  // The null backend does not compile pipelines, so there is nothing to cache.
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_get_pipeline_cache_data(ngf_context ctx, void* data, size_t* size) {
+  assert(ctx);
+  assert(size);
+  NGFI_IGNORE_VAR(ctx);
+  NGFI_IGNORE_VAR(data);
+  *size = 0u;
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_begin_frame(ngf_frame_token* token) {
+  // increment frame id.
+  const uint32_t fi = (CURRENT_CONTEXT->frame_id + 1u) % CURRENT_CONTEXT->max_inflight_frames;
+  CURRENT_CONTEXT->frame_id = fi;
+  CURRENT_CONTEXT->frame_serial++;
+
+  // reset stack allocator.
+  ngfi_sa_reset(ngfi_tmp_store());
+
+  // Retire resources. Nothing is ever actually in flight, so there is no need to wait.
+  ngfnull_retire_resources(CURRENT_CONTEXT, &CURRENT_CONTEXT->frame_res[fi]);
+
+  CURRENT_CONTEXT->current_frame_token = ngfi_encode_frame_token(
+      (uint16_t)((uintptr_t)CURRENT_CONTEXT & 0xffff),
+      (uint8_t)CURRENT_CONTEXT->max_inflight_frames,
+      (uint8_t)CURRENT_CONTEXT->frame_id);
+
+  *token = CURRENT_CONTEXT->current_frame_token;
+
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_end_frame(ngf_frame_token token) {
+  if (token != CURRENT_CONTEXT->current_frame_token) {
+    NGFI_DIAG_ERROR("ending a frame with an unexpected frame token");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  ngfnull_frame_resources* frame_res = &CURRENT_CONTEXT->frame_res[CURRENT_CONTEXT->frame_id];
+  ngfnull_collect_submissions(CURRENT_CONTEXT, frame_res);
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_create_cmd_buffer(const ngf_cmd_buffer_info* info, ngf_cmd_buffer* result) {
+  assert(info);
+  assert(result);
+
+  if ((info->flags & NGF_CMD_BUFFER_ASYNC_XFER) && (info->flags & NGF_CMD_BUFFER_ASYNC_COMPUTE)) {
+    NGFI_DIAG_ERROR("a cmd buffer can't be both an async transfer and an async compute one");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if ((info->flags & NGF_CMD_BUFFER_SECONDARY) && info->flags != NGF_CMD_BUFFER_SECONDARY) {
+    NGFI_DIAG_ERROR("secondary cmd buffers can't be combined with other flags");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+
+  ngf_cmd_buffer cmd_buf = NGFI_ALLOC(ngf_cmd_buffer_t);
+  if (cmd_buf == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  *result                         = cmd_buf;
+  cmd_buf->ctx                    = CURRENT_CONTEXT;
+  cmd_buf->flags                  = info->flags;
+  cmd_buf->parent_frame           = ~0u;
+  cmd_buf->frame_serial           = 0u;
+  cmd_buf->state                  = NGFI_CMD_BUFFER_NEW;
+  cmd_buf->stream                 = NULL;
+  cmd_buf->active_gfx_pipe        = NULL;
+  cmd_buf->active_compute_pipe    = NULL;
+  cmd_buf->active_rt              = NULL;
+  cmd_buf->renderpass_active      = false;
+  cmd_buf->compute_pass_active    = false;
+  cmd_buf->pass_timestamp_pool    = NULL;
+  cmd_buf->active_pass_end_timestamp = ~0u;
+  cmd_buf->active_query_pool      = NULL;
+  cmd_buf->parallel_renderpass    = false;
+  cmd_buf->frame_res              = NULL;
+  cmd_buf->nframe_res             = 0u;
+  NGFI_DARRAY_RESET(cmd_buf->pending_bind_ops, NGFNULL_BIND_OP_ARENA_CAPACITY);
+
+  // Secondary cmd buffers record into a single stream of their own, which gets spliced into the
+  // parent's stream on execution. Other cmd buffers hand their streams over to the frame.
+  if (info->flags & NGF_CMD_BUFFER_SECONDARY) {
+    cmd_buf->stream = ngfnull_create_stream();
+    if (cmd_buf->stream == NULL) {
+      ngf_destroy_cmd_buffer(cmd_buf);
+      *result = NULL;
+      return NGF_ERROR_OUT_OF_MEM;
+    }
+  } else {
+    const uint32_t nframes = CURRENT_CONTEXT->max_inflight_frames;
+    cmd_buf->frame_res     = NGFI_ALLOCN(ngfnull_cmd_buffer_frame_res, nframes);
+    if (cmd_buf->frame_res == NULL) {
+      ngf_destroy_cmd_buffer(cmd_buf);
+      *result = NULL;
+      return NGF_ERROR_OUT_OF_MEM;
+    }
+    cmd_buf->nframe_res = nframes;
+    for (uint32_t f = 0u; f < cmd_buf->nframe_res; ++f) {
+      NGFI_DARRAY_RESET(cmd_buf->frame_res[f].streams, 2u);
+      cmd_buf->frame_res[f].nused_streams = 0u;
+      cmd_buf->frame_res[f].frame_serial  = 0u;
+    }
+  }
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_start_cmd_buffer(ngf_cmd_buffer cmd_buf, ngf_frame_token token) {
+  assert(cmd_buf);
+
+  if (cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY) {
+    NGFI_DIAG_ERROR("secondary cmd buffers are started by ngf_cmd_begin_secondary_render_pass");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (token != cmd_buf->ctx->current_frame_token) {
+    NGFI_DIAG_ERROR("starting a command buffer for a frame that isn't being recorded");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_READY);
+
+  cmd_buf->parent_frame        = token;
+  cmd_buf->frame_serial        = cmd_buf->ctx->frame_serial;
+  cmd_buf->active_rt           = NULL;
+  cmd_buf->pass_timestamp_pool = NULL;
+  cmd_buf->active_query_pool   = NULL;
+  cmd_buf->parallel_renderpass = false;
+  cmd_buf->stream              = ngfnull_stream_for_frame(cmd_buf);
+  return cmd_buf->stream ? NGF_ERROR_OK : NGF_ERROR_OUT_OF_MEM;
+}
+
+void ngf_destroy_cmd_buffer(ngf_cmd_buffer buffer) {
+  assert(buffer);
+  if (buffer->frame_res != NULL) {
+    // Submitted streams may still be waiting for their frame to be retired, so they're freed along
+    // with the current frame, which is retired last.
+    ngf_context              ctx       = buffer->ctx;
+    ngfnull_frame_resources* frame_res = &ctx->frame_res[ctx->frame_id];
+    for (uint32_t f = 0u; f < buffer->nframe_res; ++f) {
+      ngfnull_cmd_buffer_frame_res* res = &buffer->frame_res[f];
+      NGFI_DARRAY_FOREACH(res->streams, s) {
+        NGFI_DARRAY_APPEND(frame_res->retire_streams, NGFI_DARRAY_AT(res->streams, s));
+      }
+      NGFI_DARRAY_DESTROY(res->streams);
+    }
+    NGFI_FREEN(buffer->frame_res, buffer->nframe_res);
+  } else if (buffer->stream) {
+    ngfnull_destroy_stream(buffer->stream);
+  }
+  NGFI_DARRAY_DESTROY(buffer->pending_bind_ops);
+  NGFI_FREE(buffer);
+}
+
+ngf_error ngf_submit_cmd_buffers(uint32_t nbuffers, ngf_cmd_buffer* cmd_bufs) {
+  assert(cmd_bufs);
+  for (uint32_t i = 0u; i < nbuffers; ++i) {
+    ngf_cmd_buffer cmd_buf = cmd_bufs[i];
+    if (cmd_buf->parent_frame != cmd_buf->ctx->current_frame_token) {
+      NGFI_DIAG_ERROR("submitting a command buffer for the wrong frame");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+    if (cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY) {
+      NGFI_DIAG_ERROR("secondary cmd buffers may not be submitted directly");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+    NGFI_TRANSITION_CMD_BUF(cmd_bufs[i], NGFI_CMD_BUFFER_SUBMITTED);
+    ngfi_atomic_stack_push(
+        &cmd_buf->ctx->frame_res[ngfi_frame_id(cmd_buf->parent_frame)].submissions,
+        &cmd_buf->stream->node);
+
+    cmd_buf->stream              = NULL;
+    cmd_buf->active_gfx_pipe     = NULL;
+    cmd_buf->active_compute_pipe = NULL;
+    cmd_buf->active_rt           = NULL;
+  }
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_write_timestamp(ngf_cmd_buffer cmd_buf, ngf_query_pool pool, uint32_t query) {
+  assert(cmd_buf);
+  assert(pool);
+  const ngf_error err = ngfnull_validate_timestamp_cmd(cmd_buf, pool);
+  if (err != NGF_ERROR_OK) { return err; }
+  if (query >= pool->nqueries) {
+    NGFI_DIAG_ERROR("timestamp query %u is out of the pool's bounds", query);
+    return NGF_ERROR_OUT_OF_BOUNDS;
+  }
+  ngfnull_cmd_write_timestamp(cmd_buf, pool, query);
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_enable_pass_timestamps(
+    ngf_cmd_buffer cmd_buf,
+    ngf_query_pool pool,
+    uint32_t       first_query,
+    uint32_t       nqueries) {
+  assert(cmd_buf);
+  const ngf_error err = ngfnull_validate_timestamp_cmd(cmd_buf, pool);
+  if (err != NGF_ERROR_OK) { return err; }
+  if (pool != NULL && (first_query > pool->nqueries || nqueries > pool->nqueries - first_query)) {
+    NGFI_DIAG_ERROR("pass timestamp queries are out of the pool's bounds");
+    return NGF_ERROR_OUT_OF_BOUNDS;
+  }
+  cmd_buf->pass_timestamp_pool = pool;
+  cmd_buf->next_pass_timestamp = first_query;
+  cmd_buf->pass_timestamps_end = first_query + nqueries;
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_begin_render_pass_simple_with_sync(
+    ngf_cmd_buffer                   cmd_buf,
+    ngf_render_target                rt,
+    float                            clear_color_r,
+    float                            clear_color_g,
+    float                            clear_color_b,
+    float                            clear_color_a,
+    float                            clear_depth,
+    uint32_t                         clear_stencil,
+    uint32_t                         nsync_compute_resources,
+    const ngf_sync_compute_resource* sync_compute_resources,
+    ngf_render_encoder*              enc) {
+  ngfi_sa_reset(ngfi_tmp_store());
+  ngf_attachment_load_op* load_ops =
+      ngfi_sa_alloc(ngfi_tmp_store(), sizeof(ngf_attachment_load_op) * rt->nattachments);
+  ngf_attachment_store_op* store_ops =
+      ngfi_sa_alloc(ngfi_tmp_store(), sizeof(ngf_attachment_store_op) * rt->nattachments);
+  ngf_clear* clears = ngfi_sa_alloc(ngfi_tmp_store(), sizeof(ngf_clear) * rt->nattachments);
+
+  for (size_t i = 0u; i < rt->nattachments; ++i) {
+    load_ops[i] = NGF_LOAD_OP_CLEAR;
+    if (rt->attachment_descs[i].type == NGF_ATTACHMENT_COLOR) {
+      clears[i].clear_color[0] = clear_color_r;
+      clears[i].clear_color[1] = clear_color_g;
+      clears[i].clear_color[2] = clear_color_b;
+      clears[i].clear_color[3] = clear_color_a;
+    } else {
+      clears[i].clear_depth_stencil.clear_depth   = clear_depth;
+      clears[i].clear_depth_stencil.clear_stencil = clear_stencil;
+    }
+    store_ops[i] =
+        rt->attachment_descs[i].is_sampled ? NGF_STORE_OP_STORE : NGF_STORE_OP_DONTCARE;
+  }
+  const ngf_render_pass_info pass_info = {
+      .render_target          = rt,
+      .load_ops               = load_ops,
+      .store_ops              = store_ops,
+      .clears                 = clears,
+      .sync_compute_resources = {
+          .nsync_resources = nsync_compute_resources,
+          .sync_resources  = sync_compute_resources}};
+  return ngf_cmd_begin_render_pass(cmd_buf, &pass_info, enc);
+}
+
+ngf_error ngf_cmd_begin_render_pass_simple(
+    ngf_cmd_buffer      cmd_buf,
+    ngf_render_target   rt,
+    float               clear_color_r,
+    float               clear_color_g,
+    float               clear_color_b,
+    float               clear_color_a,
+    float               clear_depth,
+    uint32_t            clear_stencil,
+    ngf_render_encoder* enc) {
+  return ngf_cmd_begin_render_pass_simple_with_sync(
+      cmd_buf,
+      rt,
+      clear_color_r,
+      clear_color_g,
+      clear_color_b,
+      clear_color_a,
+      clear_depth,
+      clear_stencil,
+      0u,
+      NULL,
+      enc);
+}
+
+static ngf_error ngfnull_begin_render_pass(
+    ngf_cmd_buffer              cmd_buf,
+    const ngf_render_pass_info* pass_info,
+    bool                        parallel,
+    ngf_render_encoder*         enc) {
+  if (cmd_buf->flags & (NGF_CMD_BUFFER_ASYNC_XFER | NGF_CMD_BUFFER_ASYNC_COMPUTE)) {
+    NGFI_DIAG_ERROR("render passes may not be recorded into async cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY) {
+    NGFI_DIAG_ERROR("secondary cmd buffers may only record parts of parallel render passes");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  ngf_error err =
+      ngfnull_execute_sync_op(cmd_buf, pass_info->sync_compute_resources.nsync_resources);
+  if (err != NGF_ERROR_OK) return err;
+
+  err = ngfnull_encoder_start(
+      cmd_buf,
+      &enc->pvt_data_donotuse,
+      NGFNULL_CMD_BEGIN_RENDER_PASS,
+      pass_info->render_target);
+  if (err != NGF_ERROR_OK) return err;
+
+  cmd_buf->active_rt           = pass_info->render_target;
+  cmd_buf->renderpass_active   = true;
+  cmd_buf->parallel_renderpass = parallel;
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_begin_render_pass(
+    ngf_cmd_buffer              cmd_buf,
+    const ngf_render_pass_info* pass_info,
+    ngf_render_encoder*         enc) {
+  return ngfnull_begin_render_pass(cmd_buf, pass_info, false, enc);
+}
+
+ngf_error ngf_cmd_begin_parallel_render_pass(
+    ngf_cmd_buffer              cmd_buf,
+    const ngf_render_pass_info* pass_info,
+    ngf_render_encoder*         enc) {
+  return ngfnull_begin_render_pass(cmd_buf, pass_info, true, enc);
+}
+
+ngf_error ngf_cmd_begin_xfer_pass(
+    ngf_cmd_buffer            cmd_buf,
+    const ngf_xfer_pass_info* pass_info,
+    ngf_xfer_encoder*         enc) {
+  if (cmd_buf->flags & NGF_CMD_BUFFER_ASYNC_COMPUTE) {
+    NGFI_DIAG_ERROR("transfer passes may not be recorded into async compute cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  ngf_error err =
+      ngfnull_execute_sync_op(cmd_buf, pass_info->sync_compute_resources.nsync_resources);
+  if (err != NGF_ERROR_OK) return err;
+
+  return ngfnull_encoder_start(
+      cmd_buf,
+      &enc->pvt_data_donotuse,
+      NGFNULL_CMD_BEGIN_XFER_PASS,
+      NULL);
+}
+
+ngf_error ngf_cmd_begin_compute_pass(
+    ngf_cmd_buffer               cmd_buf,
+    const ngf_compute_pass_info* pass_info,
+    ngf_compute_encoder*         enc) {
+  if (cmd_buf->flags & NGF_CMD_BUFFER_ASYNC_XFER) {
+    NGFI_DIAG_ERROR("compute passes may not be recorded into async transfer cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  ngf_error err = ngfnull_execute_sync_op(
+      cmd_buf,
+      pass_info->sync_compute_resources.nsync_resources +
+          pass_info->sync_render_resources.nsync_resources +
+          pass_info->sync_xfer_resources.nsync_resources);
+  if (err != NGF_ERROR_OK) return err;
+
+  err = ngfnull_encoder_start(
+      cmd_buf,
+      &enc->pvt_data_donotuse,
+      NGFNULL_CMD_BEGIN_COMPUTE_PASS,
+      NULL);
+  if (err != NGF_ERROR_OK) return err;
+
+  cmd_buf->compute_pass_active = true;
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_end_render_pass(ngf_render_encoder enc) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  if (buf->flags & NGF_CMD_BUFFER_SECONDARY) {
+    NGFI_DIAG_ERROR("secondary render encoders are ended by ngf_cmd_end_secondary_render_pass");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (buf->active_query_pool != NULL) {
+    NGFI_DIAG_ERROR("a query was still active at the end of the render pass");
+    ngf_cmd_end_query(enc);
+  }
+  buf->renderpass_active   = false;
+  buf->parallel_renderpass = false;
+  return ngfnull_encoder_end(buf, NGFNULL_CMD_END_RENDER_PASS);
+}
+
+ngf_error ngf_cmd_begin_secondary_render_pass(
+    ngf_render_encoder  parent_enc,
+    ngf_cmd_buffer      cmd_buf,
+    ngf_render_encoder* enc) {
+  assert(cmd_buf);
+  assert(enc);
+  const ngf_cmd_buffer parent = NGFNULL_ENC2CMDBUF(parent_enc);
+  if (!(cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY)) {
+    NGFI_DIAG_ERROR("only secondary cmd buffers may record parts of parallel render passes");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (!parent->parallel_renderpass) {
+    NGFI_DIAG_ERROR("the parent encoder doesn't belong to a parallel render pass");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_READY);
+  NGFI_DARRAY_CLEAR(cmd_buf->stream->cmds);
+  cmd_buf->parent_frame      = parent->parent_frame;
+  cmd_buf->active_rt         = parent->active_rt;
+  cmd_buf->active_gfx_pipe   = NULL;
+  cmd_buf->active_query_pool = NULL;
+  ngfnull_cleanup_pending_binds(cmd_buf);
+  NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_RECORDING);
+  cmd_buf->renderpass_active = true;
+  enc->pvt_data_donotuse.d0  = (uintptr_t)cmd_buf;
+  enc->pvt_data_donotuse.d1  = 0u;
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_end_secondary_render_pass(ngf_render_encoder enc) {
+  ngf_cmd_buffer cmd_buf = NGFNULL_ENC2CMDBUF(enc);
+  if (!(cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY)) {
+    NGFI_DIAG_ERROR("the encoder doesn't belong to a secondary cmd buffer");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  ngfnull_cleanup_pending_binds(cmd_buf);
+  cmd_buf->renderpass_active = false;
+  NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_AWAITING_SUBMIT);
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_execute_secondary_cmd_buffers(
+    ngf_render_encoder parent_enc,
+    uint32_t           nbuffers,
+    ngf_cmd_buffer*    bufs) {
+  ngf_cmd_buffer parent = NGFNULL_ENC2CMDBUF(parent_enc);
+  if (!parent->parallel_renderpass) {
+    NGFI_DIAG_ERROR("the parent encoder doesn't belong to a parallel render pass");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (nbuffers == 0u) { return NGF_ERROR_OK; }
+  assert(bufs);
+  for (uint32_t i = 0u; i < nbuffers; ++i) {
+    const ngf_cmd_buffer buf = bufs[i];
+    if (!(buf->flags & NGF_CMD_BUFFER_SECONDARY) || buf->state != NGFI_CMD_BUFFER_AWAITING_SUBMIT) {
+      NGFI_DIAG_ERROR("only finished secondary cmd buffers may be executed");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+    if (buf->parent_frame != parent->parent_frame || buf->active_rt != parent->active_rt) {
+      NGFI_DIAG_ERROR("the secondary cmd buffer was recorded for a different render pass");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+  }
+  // The secondary commands are spliced into the parent's stream, in the order of execution.
+  for (uint32_t i = 0u; i < nbuffers; ++i) {
+    NGFI_TRANSITION_CMD_BUF(bufs[i], NGFI_CMD_BUFFER_SUBMITTED);
+    const ngfnull_cmd_stream* stream = bufs[i]->stream;
+    if (NGFI_DARRAY_SIZE(stream->cmds) > 0u) {
+      NGFI_DARRAY_APPEND_N(parent->stream->cmds, stream->cmds.data, NGFI_DARRAY_SIZE(stream->cmds));
+    }
+  }
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_end_xfer_pass(ngf_xfer_encoder enc) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  return ngfnull_encoder_end(buf, NGFNULL_CMD_END_XFER_PASS);
+}
+
+ngf_error ngf_cmd_end_compute_pass(ngf_compute_encoder enc) {
+  ngf_cmd_buffer cmd_buf       = NGFNULL_ENC2CMDBUF(enc);
+  cmd_buf->compute_pass_active = false;
+  return ngfnull_encoder_end(cmd_buf, NGFNULL_CMD_END_COMPUTE_PASS);
+}
+
+ngf_error ngf_create_shader_stage(const ngf_shader_stage_info* info, ngf_shader_stage* result) {
+  assert(info);
+  assert(result);
+
+  if (info->content == NULL || info->content_length == 0u) {
+    return NGF_ERROR_OBJECT_CREATION_FAILED;
+  }
+  *result                = NGFI_ALLOC(ngf_shader_stage_t);
+  ngf_shader_stage stage = *result;
+  if (stage == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  stage->type = info->type;
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_shader_stage(ngf_shader_stage stage) {
+  if (stage) { NGFI_FREE(stage); }
+}
+
+ngf_error ngf_create_graphics_pipeline(
+    const ngf_graphics_pipeline_info* info,
+    ngf_graphics_pipeline*            result) {
+  assert(info);
+  assert(result);
+
+  *result                        = NGFI_ALLOC(ngf_graphics_pipeline_t);
+  ngf_graphics_pipeline pipeline = *result;
+  if (pipeline == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  pipeline->stage_mask = 0u;
+  for (uint32_t s = 0u; s < info->nshader_stages; ++s) {
+    pipeline->stage_mask |= 1u << (uint32_t)info->shader_stages[s]->type;
+  }
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_graphics_pipeline(ngf_graphics_pipeline p) {
+  if (p != NULL) { NGFI_FREE(p); }
+}
+
+ngf_error ngf_create_graphics_pipelines(
+    const ngf_graphics_pipeline_info* infos,
+    uint32_t                          npipelines,
+    ngf_graphics_pipeline*            results) {
+  assert(infos || npipelines == 0u);
+  assert(results || npipelines == 0u);
+  ngf_error err = NGF_ERROR_OK;
+  for (uint32_t i = 0u; i < npipelines; ++i) {
+    results[i] = NULL;
+    if (err == NGF_ERROR_OK) { err = ngf_create_graphics_pipeline(&infos[i], &results[i]); }
+  }
+  if (err != NGF_ERROR_OK) {
+    for (uint32_t i = 0u; i < npipelines; ++i) {
+      ngf_destroy_graphics_pipeline(results[i]);
+      results[i] = NULL;
+    }
+  }
+  return err;
+}
+
+ngf_error
+ngf_create_compute_pipeline(const ngf_compute_pipeline_info* info, ngf_compute_pipeline* result) {
+  assert(info);
+  assert(result);
+
+  if (info->shader_stage == NULL || info->shader_stage->type != NGF_STAGE_COMPUTE) {
+    return NGF_ERROR_OBJECT_CREATION_FAILED;
+  }
+  *result                       = NGFI_ALLOC(ngf_compute_pipeline_t);
+  ngf_compute_pipeline pipeline = *result;
+  if (pipeline == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  pipeline->stage_mask = 1u << (uint32_t)NGF_STAGE_COMPUTE;
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_compute_pipeline(ngf_compute_pipeline p) {
+  if (p != NULL) { NGFI_FREE(p); }
+}
+
+ngf_render_target ngf_default_render_target() {
+  if (CURRENT_CONTEXT) {
+    return CURRENT_CONTEXT->default_render_target;
+  } else {
+    return NULL;
+  }
+}
+
+const ngf_attachment_descriptions* ngf_default_render_target_attachment_descs() {
+  if (CURRENT_CONTEXT->default_render_target) {
+    CURRENT_CONTEXT->default_attachment_descriptions_list.ndescs =
+        CURRENT_CONTEXT->default_render_target->nattachments;
+    CURRENT_CONTEXT->default_attachment_descriptions_list.descs =
+        CURRENT_CONTEXT->default_render_target->attachment_descs;
+    return &CURRENT_CONTEXT->default_attachment_descriptions_list;
+  } else {
+    return NULL;
+  }
+}
+
+ngf_error ngf_create_render_target(const ngf_render_target_info* info, ngf_render_target* result) {
+  assert(info);
+  assert(result);
+
+  const uint32_t nattachments = info->attachment_descriptions->ndescs;
+  if (nattachments == 0u) { return NGF_ERROR_INVALID_OPERATION; }
+
+  uint32_t ncolor_attachments   = 0u;
+  uint32_t nresolve_attachments = 0u;
+  for (uint32_t a = 0u; a < nattachments; ++a) {
+    if (info->attachment_descriptions->descs[a].type == NGF_ATTACHMENT_COLOR) {
+      if (info->attachment_descriptions->descs[a].is_resolve) {
+        ++nresolve_attachments;
+      } else {
+        ++ncolor_attachments;
+      }
+    }
+  }
+  if (nresolve_attachments > 0 && ncolor_attachments != nresolve_attachments) {
+    NGFI_DIAG_ERROR("the same number of resolve and color attachments must be provided");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+
+  ngf_render_target rt = NGFI_ALLOC(ngf_render_target_t);
+  if (rt == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  rt->attachment_descs = NGFI_ALLOCN(ngf_attachment_description, nattachments);
+  if (rt->attachment_descs == NULL) {
+    NGFI_FREE(rt);
+    return NGF_ERROR_OUT_OF_MEM;
+  }
+  memcpy(
+      rt->attachment_descs,
+      info->attachment_descriptions->descs,
+      sizeof(ngf_attachment_description) * nattachments);
+  rt->nattachments = nattachments;
+  rt->is_default   = false;
+  rt->width        = info->attachment_image_refs[0].image->extent.width;
+  rt->height       = info->attachment_image_refs[0].image->extent.height;
+  *result          = rt;
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_render_target(ngf_render_target target) {
+  if (target) {
+    NGFI_FREEN(target->attachment_descs, target->nattachments);
+    NGFI_FREE(target);
+  }
+}
+
+void ngf_cmd_dispatch(
+    ngf_compute_encoder enc,
+    uint32_t            x_threadgroups,
+    uint32_t            y_threadgroups,
+    uint32_t            z_threadgroups) {
+  ngf_cmd_buffer cmd_buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_execute_pending_binds(cmd_buf);
+
+  ngfnull_cmd* cmd = ngfnull_record(cmd_buf, NGFNULL_CMD_DISPATCH, cmd_buf->active_compute_pipe);
+  cmd->args.u32[0] = x_threadgroups;
+  cmd->args.u32[1] = y_threadgroups;
+  cmd->args.u32[2] = z_threadgroups;
+}
+
+ngf_error ngf_cmd_begin_query(ngf_render_encoder enc, ngf_query_pool pool, uint32_t query) {
+  ngf_cmd_buffer cmd_buf = NGFNULL_ENC2CMDBUF(enc);
+  assert(pool);
+  if (pool->type != NGF_QUERY_TYPE_OCCLUSION && pool->type != NGF_QUERY_TYPE_PIPELINE_STATISTICS) {
+    NGFI_DIAG_ERROR("only occlusion and pipeline statistics queries can be begun");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (query >= pool->nqueries) {
+    NGFI_DIAG_ERROR("query %u is out of the pool's bounds", query);
+    return NGF_ERROR_OUT_OF_BOUNDS;
+  }
+  if (cmd_buf->active_query_pool != NULL) {
+    NGFI_DIAG_ERROR("only one query may be active at a time");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (cmd_buf->parallel_renderpass || (cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY)) {
+    NGFI_DIAG_ERROR("queries are not supported in parallel render passes");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  ngfnull_record(cmd_buf, NGFNULL_CMD_BEGIN_QUERY, pool)->args.u32[0] = query;
+  cmd_buf->active_query_pool = pool;
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_end_query(ngf_render_encoder enc) {
+  ngf_cmd_buffer cmd_buf = NGFNULL_ENC2CMDBUF(enc);
+  if (cmd_buf->active_query_pool == NULL) {
+    NGFI_DIAG_ERROR("no query is active");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  ngfnull_record(cmd_buf, NGFNULL_CMD_END_QUERY, NULL);
+  cmd_buf->active_query_pool = NULL;
+  return NGF_ERROR_OK;
+}
+
+void ngf_cmd_draw(
+    ngf_render_encoder enc,
+    bool               indexed,
+    uint32_t           first_element,
+    uint32_t           nelements,
+    uint32_t           ninstances) {
+  ngf_cmd_buffer cmd_buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_execute_pending_binds(cmd_buf);
+
+  ngfnull_cmd* cmd = ngfnull_record(
+      cmd_buf,
+      indexed ? NGFNULL_CMD_DRAW_INDEXED : NGFNULL_CMD_DRAW,
+      cmd_buf->active_gfx_pipe);
+  cmd->args.u32[0] = first_element;
+  cmd->args.u32[1] = nelements;
+  cmd->args.u32[2] = ninstances;
+}
+
+static bool ngfnull_validate_indirect_buffer(const ngf_buffer buf, size_t offset) {
+  if (buf == NULL || !(buf->usage_flags & NGF_BUFFER_USAGE_INDIRECT)) {
+    NGFI_DIAG_ERROR("Indirect arguments must come from a buffer with NGF_BUFFER_USAGE_INDIRECT.");
+    return false;
+  }
+  if (offset % 4u != 0u || offset >= buf->size) {
+    NGFI_DIAG_ERROR("Invalid offset %zu into indirect argument buffer.", offset);
+    return false;
+  }
+  return true;
+}
+
+void ngf_cmd_dispatch_indirect(
+    ngf_compute_encoder enc,
+    const ngf_buffer    args_buf,
+    size_t              offset) {
+  ngf_cmd_buffer cmd_buf = NGFNULL_ENC2CMDBUF(enc);
+  if (!ngfnull_validate_indirect_buffer(args_buf, offset)) { return; }
+  ngfnull_execute_pending_binds(cmd_buf);
+
+  ngfnull_cmd* cmd =
+      ngfnull_record(cmd_buf, NGFNULL_CMD_DISPATCH_INDIRECT, cmd_buf->active_compute_pipe);
+  cmd->args.indirect.offset       = offset;
+  cmd->args.indirect.count_offset = 0u;
+  cmd->args.indirect.count_buf    = NULL;
+  cmd->args.indirect.ndraws       = 1u;
+  cmd->args.indirect.stride       = 0u;
+}
+
+void ngf_cmd_draw_indirect(
+    ngf_render_encoder enc,
+    bool               indexed,
+    const ngf_buffer   args_buf,
+    size_t             offset,
+    uint32_t           ndraws,
+    uint32_t           stride) {
+  ngf_cmd_buffer cmd_buf = NGFNULL_ENC2CMDBUF(enc);
+  if (!ngfnull_validate_indirect_buffer(args_buf, offset)) { return; }
+  ngfnull_execute_pending_binds(cmd_buf);
+
+  ngfnull_cmd* cmd = ngfnull_record(
+      cmd_buf,
+      indexed ? NGFNULL_CMD_DRAW_INDEXED_INDIRECT : NGFNULL_CMD_DRAW_INDIRECT,
+      cmd_buf->active_gfx_pipe);
+  cmd->args.indirect.offset       = offset;
+  cmd->args.indirect.count_offset = 0u;
+  cmd->args.indirect.count_buf    = NULL;
+  cmd->args.indirect.ndraws       = ndraws;
+  cmd->args.indirect.stride       = stride;
+}
+
+void ngf_cmd_draw_indirect_count(
+    ngf_render_encoder enc,
+    bool               indexed,
+    const ngf_buffer   args_buf,
+    size_t             offset,
+    const ngf_buffer   count_buf,
+    size_t             count_offset,
+    uint32_t           max_draws,
+    uint32_t           stride) {
+  ngf_cmd_buffer cmd_buf = NGFNULL_ENC2CMDBUF(enc);
+  if (!ngfnull_validate_indirect_buffer(args_buf, offset) ||
+      !ngfnull_validate_indirect_buffer(count_buf, count_offset)) {
+    return;
+  }
+  ngfnull_execute_pending_binds(cmd_buf);
+
+  ngfnull_cmd* cmd = ngfnull_record(
+      cmd_buf,
+      indexed ? NGFNULL_CMD_DRAW_INDEXED_INDIRECT : NGFNULL_CMD_DRAW_INDIRECT,
+      cmd_buf->active_gfx_pipe);
+  cmd->args.indirect.offset       = offset;
+  cmd->args.indirect.count_offset = count_offset;
+  cmd->args.indirect.count_buf    = count_buf;
+  cmd->args.indirect.ndraws       = max_draws;
+  cmd->args.indirect.stride       = stride;
+}
+
+void ngf_cmd_bind_gfx_pipeline(ngf_render_encoder enc, const ngf_graphics_pipeline pipeline) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  if (buf->active_gfx_pipe && !NGFI_DARRAY_EMPTY(buf->pending_bind_ops)) {
+    ngfnull_execute_pending_binds(buf);
+  }
+  buf->active_gfx_pipe = pipeline;
+  ngfnull_record(buf, NGFNULL_CMD_BIND_GFX_PIPELINE, pipeline);
+}
+
+void ngf_cmd_bind_resources(
+    ngf_render_encoder          enc,
+    const ngf_resource_bind_op* bind_operations,
+    uint32_t                    nbind_operations) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_cmd_bind_resources(buf, bind_operations, nbind_operations);
+}
+
+void ngf_cmd_bind_compute_resources(
+    ngf_compute_encoder         enc,
+    const ngf_resource_bind_op* bind_operations,
+    uint32_t                    nbind_operations) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_cmd_bind_resources(buf, bind_operations, nbind_operations);
+}
+
+static void ngfnull_cmd_push_constants(
+    ngf_cmd_buffer cmd_buf,
+    const void*    pipeline,
+    uint32_t       offset,
+    uint32_t       size,
+    const void*    data) {
+  NGFI_IGNORE_VAR(data);
+  if (pipeline == NULL) {
+    NGFI_DIAG_ERROR("attempt to push constants without a bound pipeline");
+    return;
+  }
+  if ((offset & 3u) != 0u || (size & 3u) != 0u) {
+    NGFI_DIAG_ERROR("push constant offset and size must be multiples of 4");
+    return;
+  }
+  if (offset > NGF_MAX_PUSH_CONSTANTS_SIZE || size > NGF_MAX_PUSH_CONSTANTS_SIZE - offset) {
+    NGFI_DIAG_ERROR("push constant range exceeds the maximum push constant block size");
+    return;
+  }
+  ngfnull_cmd* cmd = ngfnull_record(cmd_buf, NGFNULL_CMD_PUSH_CONSTANTS, pipeline);
+  cmd->args.u32[0] = offset;
+  cmd->args.u32[1] = size;
+}
+
+static void ngfnull_cmd_bind_group(
+    ngf_cmd_buffer       cmd_buf,
+    const void*          pipeline,
+    const ngf_bind_group group) {
+  if (pipeline == NULL) {
+    NGFI_DIAG_ERROR("attempt to bind a bind group without a bound pipeline");
+    return;
+  }
+  // Resources bound earlier are resolved first, so that the group takes precedence over them.
+  if (!NGFI_DARRAY_EMPTY(cmd_buf->pending_bind_ops)) { ngfnull_execute_pending_binds(cmd_buf); }
+  ngfnull_record(cmd_buf, NGFNULL_CMD_BIND_GROUP, group)->args.u32[0] = group->set;
+}
+
+void ngf_cmd_bind_group(ngf_render_encoder enc, const ngf_bind_group group) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_cmd_bind_group(buf, buf->active_gfx_pipe, group);
+}
+
+void ngf_cmd_bind_compute_group(ngf_compute_encoder enc, const ngf_bind_group group) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_cmd_bind_group(buf, buf->active_compute_pipe, group);
+}
+
+static void ngfnull_cmd_bind_resource_table(
+    ngf_cmd_buffer           cmd_buf,
+    const void*              pipeline,
+    uint32_t                 set,
+    const ngf_resource_table table) {
+  if (pipeline == NULL) {
+    NGFI_DIAG_ERROR("attempt to bind a resource table without a bound pipeline");
+    return;
+  }
+  if (!NGFI_DARRAY_EMPTY(cmd_buf->pending_bind_ops)) { ngfnull_execute_pending_binds(cmd_buf); }
+  ngfnull_record(cmd_buf, NGFNULL_CMD_BIND_RESOURCE_TABLE, table)->args.u32[0] = set;
+}
+
+void ngf_cmd_bind_resource_table(
+    ngf_render_encoder       enc,
+    uint32_t                 set,
+    const ngf_resource_table table) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_cmd_bind_resource_table(buf, buf->active_gfx_pipe, set, table);
+}
+
+void ngf_cmd_bind_compute_resource_table(
+    ngf_compute_encoder      enc,
+    uint32_t                 set,
+    const ngf_resource_table table) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_cmd_bind_resource_table(buf, buf->active_compute_pipe, set, table);
+}
+
+void ngf_cmd_push_constants(
+    ngf_render_encoder enc,
+    uint32_t           offset,
+    uint32_t           size,
+    const void*        data) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_cmd_push_constants(buf, buf->active_gfx_pipe, offset, size, data);
+}
+
+void ngf_cmd_push_compute_constants(
+    ngf_compute_encoder enc,
+    uint32_t            offset,
+    uint32_t            size,
+    const void*         data) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_cmd_push_constants(buf, buf->active_compute_pipe, offset, size, data);
+}
+
+void ngf_cmd_bind_compute_pipeline(ngf_compute_encoder enc, const ngf_compute_pipeline pipeline) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  if (buf->active_compute_pipe && !NGFI_DARRAY_EMPTY(buf->pending_bind_ops)) {
+    ngfnull_execute_pending_binds(buf);
+  }
+  buf->active_compute_pipe = pipeline;
+  ngfnull_record(buf, NGFNULL_CMD_BIND_COMPUTE_PIPELINE, pipeline);
+}
+
+void ngf_cmd_viewport(ngf_render_encoder enc, const ngf_irect2d* r) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_record(buf, NGFNULL_CMD_VIEWPORT, NULL)->args.rect = *r;
+}
+
+void ngf_cmd_scissor(ngf_render_encoder enc, const ngf_irect2d* r) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  assert(buf->active_rt);
+  ngfnull_record(buf, NGFNULL_CMD_SCISSOR, NULL)->args.rect = *r;
+}
+
+void ngf_cmd_stencil_reference(ngf_render_encoder enc, uint32_t front, uint32_t back) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_cmd*   cmd = ngfnull_record(buf, NGFNULL_CMD_STENCIL_REFERENCE, NULL);
+  cmd->args.u32[0]   = front;
+  cmd->args.u32[1]   = back;
+}
+
+void ngf_cmd_stencil_compare_mask(ngf_render_encoder enc, uint32_t front, uint32_t back) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_cmd*   cmd = ngfnull_record(buf, NGFNULL_CMD_STENCIL_COMPARE_MASK, NULL);
+  cmd->args.u32[0]   = front;
+  cmd->args.u32[1]   = back;
+}
+
+void ngf_cmd_stencil_write_mask(ngf_render_encoder enc, uint32_t front, uint32_t back) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_cmd*   cmd = ngfnull_record(buf, NGFNULL_CMD_STENCIL_WRITE_MASK, NULL);
+  cmd->args.u32[0]   = front;
+  cmd->args.u32[1]   = back;
+}
+
+void ngf_cmd_bind_attrib_buffer(
+    ngf_render_encoder enc,
+    const ngf_buffer   abuf,
+    uint32_t           binding,
+    uint32_t           offset) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  ngfnull_cmd*   cmd = ngfnull_record(buf, NGFNULL_CMD_BIND_ATTRIB_BUFFER, abuf);
+  cmd->args.u32[0]   = binding;
+  cmd->args.u32[1]   = offset;
+}
+
+void ngf_cmd_bind_index_buffer(
+    ngf_render_encoder enc,
+    const ngf_buffer   ibuf,
+    uint32_t           offset,
+    ngf_type           index_type) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  assert(index_type == NGF_TYPE_UINT16 || index_type == NGF_TYPE_UINT32);
+  ngfnull_cmd* cmd = ngfnull_record(buf, NGFNULL_CMD_BIND_INDEX_BUFFER, ibuf);
+  cmd->args.u32[0] = offset;
+  cmd->args.u32[1] = (uint32_t)index_type;
+}
+
+void ngf_cmd_copy_buffer(
+    ngf_xfer_encoder enc,
+    const ngf_buffer src,
+    ngf_buffer       dst,
+    size_t           size,
+    size_t           src_offset,
+    size_t           dst_offset) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  assert(buf);
+  NGFI_IGNORE_VAR(src);
+  ngfnull_cmd* cmd = ngfnull_record(buf, NGFNULL_CMD_COPY_BUFFER, dst);
+  cmd->args.sz[0]  = size;
+  cmd->args.sz[1]  = src_offset;
+  cmd->args.sz[2]  = dst_offset;
+}
+
+void ngf_cmd_write_image(
+    ngf_xfer_encoder enc,
+    const ngf_buffer src,
+    size_t           src_offset,
+    ngf_image_ref    dst,
+    ngf_offset3d     offset,
+    ngf_extent3d     extent,
+    uint32_t         nlayers) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  assert(buf);
+  NGFI_IGNORE_VAR(src);
+  NGFI_IGNORE_VAR(offset);
+  NGFI_IGNORE_VAR(extent);
+  NGFI_IGNORE_VAR(src_offset);
+  ngfnull_cmd* cmd = ngfnull_record(buf, NGFNULL_CMD_WRITE_IMAGE, dst.image);
+  cmd->args.u32[0] = dst.mip_level;
+  cmd->args.u32[1] = dst.layer;
+  cmd->args.u32[2] = nlayers;
+}
+
+ngf_error ngf_cmd_write_images(
+    ngf_xfer_encoder       enc,
+    const ngf_buffer       src,
+    const ngf_image_write* writes,
+    uint32_t               nwrites) {
+  for (uint32_t i = 0u; i < nwrites; ++i) {
+    if (!(writes[i].dst.image->usage_flags & NGF_IMAGE_USAGE_XFER_DST)) {
+      NGFI_DIAG_ERROR("image written to was created without the NGF_IMAGE_USAGE_XFER_DST flag");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+  }
+  for (uint32_t i = 0u; i < nwrites; ++i) {
+    ngf_cmd_write_image(
+        enc,
+        src,
+        writes[i].src_offset,
+        writes[i].dst,
+        writes[i].offset,
+        writes[i].extent,
+        writes[i].nlayers);
+  }
+  return NGF_ERROR_OK;
+}
+
+void ngf_cmd_copy_image_to_buffer(
+    ngf_xfer_encoder    enc,
+    const ngf_image_ref src,
+    ngf_offset3d        src_offset,
+    ngf_extent3d        src_extent,
+    uint32_t            nlayers,
+    ngf_buffer          dst,
+    size_t              dst_offset) {
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(enc);
+  assert(buf);
+  NGFI_IGNORE_VAR(src_offset);
+  NGFI_IGNORE_VAR(src_extent);
+  NGFI_IGNORE_VAR(nlayers);
+  if (buf->flags & NGF_CMD_BUFFER_ASYNC_XFER) {
+    NGFI_DIAG_ERROR("images can't be read back within async transfer cmd buffers");
+    return;
+  }
+  ngfnull_cmd* cmd = ngfnull_record(buf, NGFNULL_CMD_COPY_IMAGE_TO_BUFFER, dst);
+  cmd->args.u32[0] = src.mip_level;
+  cmd->args.u32[1] = src.layer;
+  cmd->args.u32[2] = (uint32_t)dst_offset;
+}
+
+ngf_error ngf_cmd_generate_mipmaps(ngf_xfer_encoder xfenc, ngf_image img) {
+  if (!(img->usage_flags & NGF_IMAGE_USAGE_MIPMAP_GENERATION)) {
+    NGFI_DIAG_ERROR("mipmap generation was requested for an image that was created without "
+                    "the NGF_IMAGE_USAGE_MIPMAP_GENERATION usage flag.");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+
+  ngf_cmd_buffer buf = NGFNULL_ENC2CMDBUF(xfenc);
+  assert(buf);
+  if (buf->flags & NGF_CMD_BUFFER_ASYNC_XFER) {
+    NGFI_DIAG_ERROR("mipmaps can't be generated within async transfer cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  ngfnull_record(buf, NGFNULL_CMD_GENERATE_MIPMAPS, img)->args.u32[0] = img->nmips;
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_create_texel_buffer_view(
+    const ngf_texel_buffer_view_info* info,
+    ngf_texel_buffer_view*            result) {
+  assert(info);
+  assert(result);
+
+  ngf_texel_buffer_view buf_view = NGFI_ALLOC(ngf_texel_buffer_view_t);
+  if (buf_view == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  buf_view->info = *info;
+  *result        = buf_view;
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_texel_buffer_view(ngf_texel_buffer_view buf_view) {
+  if (buf_view) { NGFI_FREE(buf_view); }
+}
+
+ngf_error ngf_create_bind_group(const ngf_bind_group_info* info, ngf_bind_group* result) {
+  assert(info);
+  assert(result);
+
+  if ((info->gfx_pipeline == NULL) == (info->compute_pipeline == NULL)) {
+    NGFI_DIAG_ERROR("exactly one pipeline must be specified when creating a bind group");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  for (uint32_t i = 0u; i < info->nbind_operations; ++i) {
+    if (info->bind_operations[i].target_set != info->set) {
+      NGFI_DIAG_ERROR("all bind operations in a bind group must target the group's set");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+  }
+
+  ngf_bind_group group = NGFI_ALLOC(ngf_bind_group_t);
+  if (group == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  group->set       = info->set;
+  group->nbind_ops = info->nbind_operations;
+  group->bind_ops  = NULL;
+  if (info->nbind_operations > 0u) {
+    group->bind_ops = NGFI_ALLOCN(ngf_resource_bind_op, info->nbind_operations);
+    if (group->bind_ops == NULL) {
+      NGFI_FREE(group);
+      return NGF_ERROR_OUT_OF_MEM;
+    }
+    memcpy(
+        group->bind_ops,
+        info->bind_operations,
+        sizeof(ngf_resource_bind_op) * info->nbind_operations);
+  }
+  *result = group;
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_bind_group(ngf_bind_group group) {
+  if (group) {
+    if (group->bind_ops) { NGFI_FREEN(group->bind_ops, group->nbind_ops); }
+    NGFI_FREE(group);
+  }
+}
+
+ngf_error ngf_create_query_pool(const ngf_query_pool_info* info, ngf_query_pool* result) {
+  assert(info);
+  assert(result);
+
+  if (info->type >= NGF_QUERY_TYPE_COUNT) {
+    NGFI_DIAG_ERROR("invalid query type");
+    return NGF_ERROR_INVALID_ENUM;
+  }
+  if (info->nqueries == 0u) {
+    NGFI_DIAG_ERROR("query pools must hold at least one query");
+    return NGF_ERROR_INVALID_SIZE;
+  }
+
+  ngf_query_pool pool = NGFI_ALLOC(ngf_query_pool_t);
+  if (pool == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  pool->type      = info->type;
+  pool->nqueries  = info->nqueries;
+  pool->nvalues =
+      info->type == NGF_QUERY_TYPE_PIPELINE_STATISTICS ? NGF_PIPELINE_STATISTIC_COUNT : 1u;
+  pool->results   = NGFI_ALLOCN(uint64_t, info->nqueries * pool->nvalues);
+  pool->available = NGFI_ALLOCN(bool, info->nqueries);
+  if (pool->results == NULL || pool->available == NULL) {
+    ngf_destroy_query_pool(pool);
+    return NGF_ERROR_OUT_OF_MEM;
+  }
+  memset(pool->available, 0, sizeof(bool) * info->nqueries);
+  *result = pool;
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_query_pool(ngf_query_pool pool) {
+  if (pool) {
+    // Drop any of the pool's queries that are waiting to be written by submitted commands.
+    for (uint32_t f = 0u; f < CURRENT_CONTEXT->max_inflight_frames; ++f) {
+      ngfnull_frame_resources* frame_res = &CURRENT_CONTEXT->frame_res[f];
+      ngfnull_collect_submissions(CURRENT_CONTEXT, frame_res);
+      NGFI_DARRAY_FOREACH(frame_res->submitted_streams, s) {
+        ngfnull_cmd_stream* stream = NGFI_DARRAY_AT(frame_res->submitted_streams, s);
+        NGFI_DARRAY_FOREACH(stream->cmds, c) {
+          ngfnull_cmd* cmd = &NGFI_DARRAY_AT(stream->cmds, c);
+          if (cmd->obj == pool && (cmd->type == NGFNULL_CMD_WRITE_TIMESTAMP ||
+                                   cmd->type == NGFNULL_CMD_BEGIN_QUERY)) {
+            cmd->obj = NULL;
+          }
+        }
+      }
+    }
+    if (pool->results) { NGFI_FREEN(pool->results, pool->nqueries * pool->nvalues); }
+    if (pool->available) { NGFI_FREEN(pool->available, pool->nqueries); }
+    NGFI_FREE(pool);
+  }
+}
+
+ngf_error ngf_get_query_results(
+    ngf_query_pool pool,
+    uint32_t       first_query,
+    uint32_t       nqueries,
+    uint64_t*      results) {
+  assert(pool);
+  assert(results);
+  if (first_query > pool->nqueries || nqueries > pool->nqueries - first_query) {
+    NGFI_DIAG_ERROR("requested query results are out of the pool's bounds");
+    return NGF_ERROR_OUT_OF_BOUNDS;
+  }
+  for (uint32_t q = first_query; q < first_query + nqueries; ++q) {
+    if (!pool->available[q]) { return NGF_ERROR_NOT_READY; }
+  }
+  memcpy(
+      results,
+      &pool->results[first_query * pool->nvalues],
+      sizeof(uint64_t) * nqueries * pool->nvalues);
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_create_resource_table(
+    const ngf_resource_table_info* info,
+    ngf_resource_table*            result) {
+  assert(info);
+  assert(result);
+
+  if (info->type != NGF_DESCRIPTOR_IMAGE && info->type != NGF_DESCRIPTOR_STORAGE_BUFFER) {
+    NGFI_DIAG_ERROR("resource tables may only hold images or storage buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (info->capacity == 0u || info->capacity > NGFNULL_MAX_RESOURCE_TABLE_CAPACITY) {
+    NGFI_DIAG_ERROR("resource table capacity %u is out of range", info->capacity);
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+
+  ngf_resource_table table = NGFI_ALLOC(ngf_resource_table_t);
+  if (table == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  table->type        = info->type;
+  table->capacity    = info->capacity;
+  table->nused_slots = 0u;
+  NGFI_DARRAY_RESET(table->free_slots, 8u);
+  *result = table;
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_resource_table(ngf_resource_table table) {
+  if (table) {
+    // Drop any of the table's slots that are waiting to be retired.
+    for (uint32_t f = 0u; f < CURRENT_CONTEXT->max_inflight_frames; ++f) {
+      ngfnull_frame_resources* frame_res = &CURRENT_CONTEXT->frame_res[f];
+      uint32_t                 nkept     = 0u;
+      NGFI_DARRAY_FOREACH(frame_res->retire_table_slots, t) {
+        const ngfnull_retired_table_slot retired = NGFI_DARRAY_AT(frame_res->retire_table_slots, t);
+        if (retired.table != table) {
+          NGFI_DARRAY_AT(frame_res->retire_table_slots, nkept++) = retired;
+        }
+      }
+      NGFI_DARRAY_RESIZE(frame_res->retire_table_slots, nkept);
+    }
+    NGFI_DARRAY_DESTROY(table->free_slots);
+    NGFI_FREE(table);
+  }
+}
+
+ngf_error ngf_alloc_resource_table_slot(ngf_resource_table table, uint32_t* slot) {
+  assert(table);
+  assert(slot);
+  if (!NGFI_DARRAY_EMPTY(table->free_slots)) {
+    *slot = *NGFI_DARRAY_BACKPTR(table->free_slots);
+    NGFI_DARRAY_POP(table->free_slots);
+    return NGF_ERROR_OK;
+  }
+  if (table->nused_slots < table->capacity) {
+    *slot = table->nused_slots++;
+    return NGF_ERROR_OK;
+  }
+  return NGF_ERROR_OUT_OF_MEM;
+}
+
+void ngf_free_resource_table_slot(ngf_resource_table table, uint32_t slot) {
+  assert(table);
+  if (slot >= table->nused_slots) {
+    NGFI_DIAG_ERROR("attempt to free resource table slot %u, which was never allocated", slot);
+    return;
+  }
+  const ngfnull_retired_table_slot retired = {.table = table, .slot = slot};
+  const uint32_t                   fi      = CURRENT_CONTEXT->frame_id;
+  NGFI_DARRAY_APPEND(CURRENT_CONTEXT->frame_res[fi].retire_table_slots, retired);
+}
+
+ngf_error ngf_write_resource_table(
+    ngf_resource_table          table,
+    uint32_t                    slot,
+    const ngf_resource_bind_op* resource) {
+  assert(table);
+  assert(resource);
+  if (slot >= table->nused_slots || resource->type != table->type) {
+    NGFI_DIAG_ERROR("invalid resource table write");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_create_buffer(const ngf_buffer_info* info, ngf_buffer* result) {
+  assert(info);
+  assert(result);
+
+  ngf_buffer buf = NGFI_ALLOC(ngf_buffer_t);
+  if (buf == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  buf->size         = info->size;
+  buf->storage_type = info->storage_type;
+  buf->usage_flags  = info->buffer_usage;
+  buf->data         = NULL;
+
+  // Only host-visible buffers need backing memory, since nothing is ever executed.
+  if (info->storage_type != NGF_BUFFER_STORAGE_PRIVATE) {
+    buf->data = NGFI_ALLOCN(uint8_t, info->size);
+    if (buf->data == NULL) {
+      NGFI_FREE(buf);
+      return NGF_ERROR_OUT_OF_MEM;
+    }
+  }
+  *result = buf;
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_buffer(ngf_buffer buffer) {
+  if (buffer) {
+    const uint32_t fi = CURRENT_CONTEXT->frame_id;
+    NGFI_DARRAY_APPEND(CURRENT_CONTEXT->frame_res[fi].retire_buffers, buffer);
+  }
+}
+
+void* ngf_buffer_map_range(ngf_buffer buf, size_t offset, size_t size) {
+  NGFI_IGNORE_VAR(size);
+  return buf->data ? buf->data + offset : NULL;
+}
+
+void ngf_buffer_flush_range(ngf_buffer buf, size_t offset, size_t size) {
+  NGFI_IGNORE_VAR(buf);
+  NGFI_IGNORE_VAR(offset);
+  NGFI_IGNORE_VAR(size);
+}
+
+void ngf_buffer_unmap(ngf_buffer buf) {
+  NGFI_IGNORE_VAR(buf);
+}
+
+ngf_error ngf_upload_alloc(size_t size, size_t alignment, ngf_upload_allocation* result) {
+  assert(result);
+  if (size == 0u || alignment == 0u || (alignment & (alignment - 1u)) != 0u) {
+    NGFI_DIAG_ERROR("upload allocation size must be nonzero and alignment a power of two");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+
+  ngfnull_frame_resources* frame_res = &CURRENT_CONTEXT->frame_res[CURRENT_CONTEXT->frame_id];
+  ngfnull_upload_chunk*    chunk     = NULL;
+  size_t                   offset    = 0u;
+  NGFI_DARRAY_FOREACH(frame_res->upload_chunks, c) {
+    ngfnull_upload_chunk* candidate = &NGFI_DARRAY_AT(frame_res->upload_chunks, c);
+    offset = (candidate->used + alignment - 1u) & ~(alignment - 1u);
+    if (offset + size <= candidate->buffer->size) {
+      chunk = candidate;
+      break;
+    }
+  }
+
+  if (chunk == NULL) {
+    const ngf_buffer_info chunk_info = {
+        .size         = NGFI_MAX(size, NGFNULL_UPLOAD_CHUNK_SIZE),
+        .storage_type = NGF_BUFFER_STORAGE_HOST_WRITEABLE,
+        .buffer_usage = NGF_BUFFER_USAGE_XFER_SRC | NGF_BUFFER_USAGE_UNIFORM_BUFFER |
+                        NGF_BUFFER_USAGE_VERTEX_BUFFER | NGF_BUFFER_USAGE_INDEX_BUFFER |
+                        NGF_BUFFER_USAGE_STORAGE_BUFFER};
+    ngfnull_upload_chunk new_chunk = {.buffer = NULL, .used = 0u};
+    const ngf_error      err       = ngf_create_buffer(&chunk_info, &new_chunk.buffer);
+    if (err != NGF_ERROR_OK) { return err; }
+    NGFI_DARRAY_APPEND(frame_res->upload_chunks, new_chunk);
+    chunk  = NGFI_DARRAY_BACKPTR(frame_res->upload_chunks);
+    offset = 0u;
+  }
+
+  chunk->used    = offset + size;
+  result->buffer = chunk->buffer;
+  result->offset = offset;
+  result->data   = chunk->buffer->data + offset;
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_create_image(const ngf_image_info* info, ngf_image* result) {
+  assert(info);
+  assert(result);
+
+  if (info->extent.width == 0u || info->extent.height == 0u || info->extent.depth == 0u) {
+    return NGF_ERROR_INVALID_SIZE;
+  }
+  ngf_image img = NGFI_ALLOC(ngf_image_t);
+  if (img == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  img->type        = info->type;
+  img->extent      = info->extent;
+  img->nmips       = info->nmips;
+  img->nlayers     = info->nlayers;
+  img->format      = info->format;
+  img->usage_flags = info->usage_hint;
+  *result          = img;
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_image(ngf_image img) {
+  if (img != NULL) {
+    const uint32_t fi = CURRENT_CONTEXT->frame_id;
+    NGFI_DARRAY_APPEND(CURRENT_CONTEXT->frame_res[fi].retire_images, img);
+  }
+}
+
+ngf_error ngf_create_sampler(const ngf_sampler_info* info, ngf_sampler* result) {
+  assert(info);
+  assert(result);
+
+  ngf_sampler sampler = NGFI_ALLOC(ngf_sampler_t);
+  if (sampler == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  sampler->info = *info;
+  *result       = sampler;
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_sampler(ngf_sampler sampler) {
+  if (sampler) { NGFI_FREE(sampler); }
+}
+
+void ngf_finish(void) {
+  // Nothing is ever in flight.
+}
+
+void ngf_renderdoc_capture_next_frame() {
+}
+
+void ngf_renderdoc_capture_begin() {
+}
+
+void ngf_renderdoc_capture_end() {
+}
+
+#pragma endregion
@@ -21,7 +21,7 @@
  */
 
 #define _CRT_SECURE_NO_WARNINGS
-#include "ngf-common/block-alloc.h"
+#include "ngf-common/atomic-stack.h"
 #include "ngf-common/cmdbuf-state.h"
 #include "ngf-common/dynamic-array.h"
 #include "ngf-common/frame-token.h"
@@ -40,19 +40,41 @@
 
 #define NGFVK_INVALID_IDX                      (~0u)
 #define NGFVK_MAX_PHYS_DEV                     (64u)  // 64 GPUs oughta be enough for everybody.
-#define NGFVK_BIND_OP_CHUNK_SIZE               (10u)
+#define NGFVK_BIND_OP_ARENA_INITIAL_CAPACITY   (64u)
 #define NGFVK_MAX_COLOR_ATTACHMENTS            16u
 #define NGFVK_IMAGE_USAGE_TRANSIENT_ATTACHMENT (1u << 31u)
+#define NGFVK_DESC_SET_CACHE_INITIAL_CAPACITY  (64u)
+#define NGFVK_DESC_SET_CACHE_KEY_STORAGE_SIZE  (16u * 1024u)
+#define NGFVK_DESC_POOL_DEFAULT_SETS           (100u)
+#define NGFVK_DESC_POOL_DEFAULT_DESCRIPTORS    (100u)
+#define NGFVK_DESC_POOL_MIN_DESCRIPTORS        (16u)
+#define NGFVK_BIND_GROUP_POOL_SETS             (64u)
+#define NGFVK_BIND_GROUP_POOL_DESCRIPTORS      (128u)
+#define NGFVK_RENDERPASS_CACHE_INITIAL_CAPACITY (16u)
+#define NGFVK_RETIRE_QUEUE_CAPACITY             (4u)
+#define NGFVK_MAX_SHADOWED_ATTRIB_BINDINGS      (16u)
+#define NGFVK_MAX_RESOURCE_TABLE_CAPACITY       (1u << 16u)
+#define NGFVK_MAX_DYNAMIC_UNIFORM_BUFFERS_PER_SET (8u)
+#define NGFVK_UPLOAD_CHUNK_SIZE                   (4u * 1024u * 1024u)
 
 #define NGFVK_GFX_PIPELINE_STAGE_MASK                                                   \
   (VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |           \
    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | \
-   VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT)
+   VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | \
+   VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT)
 
 #pragma endregion
 
 #pragma region internal_struct_definitions
 
+// Queues that command buffers may be submitted to.
+typedef enum ngfvk_queue {
+  NGFVK_QUEUE_GFX = 0,
+  NGFVK_QUEUE_XFER,
+  NGFVK_QUEUE_COMPUTE,
+  NGFVK_QUEUE_COUNT
+} ngfvk_queue;
+
 // Singleton for holding vulkan instance, device and queue handles.
 // This is shared by all contexts.
 struct {
@@ -61,12 +83,22 @@ struct {
   VkDevice                 device;
   VkQueue                  gfx_queue;
   VkQueue                  present_queue;
+  VkQueue                  xfer_queue;     // < VK_NULL_HANDLE if there's no dedicated family.
+  VkQueue                  compute_queue;  // < VK_NULL_HANDLE if there's no dedicated family.
   uint32_t                 gfx_family_idx;
   uint32_t                 present_family_idx;
+  uint32_t                 xfer_family_idx;
+  uint32_t                 compute_family_idx;
   VkExtensionProperties*   supported_phys_dev_exts;
   uint32_t                 nsupported_phys_dev_exts;
   bool                     validation_enabled;
   VkDebugUtilsMessengerEXT debug_messenger;
+  uint32_t                 device_list_idx;  // < Index of the device in NGFVK_DEVICE_ID_LIST.
+  uint8_t                  pipeline_cache_uuid[VK_UUID_SIZE];
+  bool                     desc_update_templates_enabled;
+  float                    timestamp_period;  // < Nanoseconds per timestamp query tick.
+  uint64_t                 timestamp_masks[NGFVK_QUEUE_COUNT];  // < Valid bits of timestamps.
+  bool                     precise_occlusion_queries;
 #if defined(__linux__)
   xcb_connection_t* xcb_connection;
   xcb_visualid_t    xcb_visualid;
@@ -109,11 +141,40 @@ typedef struct {
   ngfvk_desc_count descriptors;
 } ngfvk_desc_pool_capacity;
 
+// Describes one entry of a descriptor update template: the binding it writes to and the type of
+// descriptor the binding expects.
+typedef struct {
+  uint32_t            binding;
+  ngf_descriptor_type type;
+} ngfvk_desc_template_entry;
+
+// A single element of the payload passed to vkUpdateDescriptorSetWithTemplate. Every binding in
+// the set gets one, in the same order as the template entries.
+typedef union {
+  VkDescriptorImageInfo  image;
+  VkDescriptorBufferInfo buffer;
+  VkBufferView           texel_buffer_view;
+} ngfvk_desc_template_slot;
+
 typedef struct {
-  VkDescriptorSetLayout vk_handle;
-  ngfvk_desc_count      counts;
+  VkDescriptorSetLayout      vk_handle;
+  ngfvk_desc_count           counts;
+  VkDescriptorUpdateTemplate update_template;  // < VK_NULL_HANDLE if templates are unsupported.
+  ngfvk_desc_template_entry* template_entries;  // < Sorted by binding.
+  uint32_t                   ntemplate_entries;
+  bool                       resource_table;  // < Set is reserved for binding a resource table.
+  ngf_descriptor_type        resource_table_type;
+  // Bindings of dynamic uniform buffers, sorted. Dynamic offsets are supplied in the same order.
+  uint32_t                   dynamic_bindings[NGFVK_MAX_DYNAMIC_UNIFORM_BUFFERS_PER_SET];
+  uint32_t                   ndynamic_bindings;
 } ngfvk_desc_set_layout;
 
+// Controls the sizing of descriptor pools, derived from ngf_descriptor_pool_info.
+typedef struct ngfvk_desc_pool_config {
+  ngfvk_desc_pool_capacity initial_capacity;
+  bool                     adaptive;
+} ngfvk_desc_pool_config;
+
 typedef struct ngfvk_desc_pool {
   struct ngfvk_desc_pool*  next;
   VkDescriptorPool         vk_pool;
@@ -121,33 +182,81 @@ typedef struct ngfvk_desc_pool {
   ngfvk_desc_pool_capacity utilization;
 } ngfvk_desc_pool;
 
+// A single entry of a descriptor set cache key, derived from a bind operation.
+typedef struct ngfvk_desc_cache_key_entry {
+  uint32_t binding;
+  uint32_t type;
+  uint64_t handles[2];  // < Native handles of the bound buffer/image view and sampler.
+  uint64_t offset;
+  uint64_t range;
+} ngfvk_desc_cache_key_entry;
+
+typedef struct ngfvk_desc_cache_slot {
+  uint64_t                          hash;
+  VkDescriptorSetLayout             set_layout;
+  VkDescriptorSet                   set;  // < VK_NULL_HANDLE for unoccupied slots.
+  const ngfvk_desc_cache_key_entry* key;
+  uint32_t                          nkey_entries;
+} ngfvk_desc_cache_slot;
+
+// Maps (set layout, sorted bind ops) to descriptor sets that have already been written during
+// the current frame. Uses open addressing with linear probing.
+typedef struct ngfvk_desc_set_cache {
+  ngfvk_desc_cache_slot* slots;
+  uint32_t               capacity;  // < Always a power of two.
+  uint32_t               nentries;
+  ngfi_sa*               key_storage;
+} ngfvk_desc_set_cache;
+
 typedef struct ngfvk_desc_pools_t {
-  ngfvk_desc_pool* active_pool;
-  ngfvk_desc_pool* list;
+  ngfvk_desc_pool*         active_pool;
+  ngfvk_desc_pool*         list;
+  ngfvk_desc_set_cache     set_cache;  // < Sets allocated from this list, reset along with it.
+  ngfvk_desc_pool_config   config;
+  ngfvk_desc_pool_capacity frame_usage;  // < Usage across all pools in the list this frame.
+  ngfvk_desc_pool_capacity high_water;   // < Highest per-frame usage observed so far.
 } ngfvk_desc_pools_list;
 
-typedef struct ngfvk_desc_superpool_t {
-  uint16_t               ctx_id;
-  ngfvk_desc_pools_list* pools_lists;
-  uint8_t                num_lists;
-} ngfvk_desc_superpool;
-
-typedef struct ngfvk_bind_op_chunk {
-  struct ngfvk_bind_op_chunk* next;
-  ngf_resource_bind_op        data[NGFVK_BIND_OP_CHUNK_SIZE];
-  size_t                      last_idx;
-} ngfvk_bind_op_chunk;
-
-typedef struct ngfvk_bind_op_chunk_list {
-  ngfvk_bind_op_chunk* first;
-  ngfvk_bind_op_chunk* last;
-  uint32_t             size;
-} ngfvk_bind_op_chunk_list;
+// A resource table slot that was freed, and may be reused once the frame that freed it completes.
+typedef struct ngfvk_retired_table_slot {
+  struct ngf_resource_table_t* table;
+  uint32_t                     slot;
+} ngfvk_retired_table_slot;
+
+// The descriptor set of a destroyed bind group, which may be freed once the frame that destroyed
+// the group completes.
+typedef struct ngfvk_retired_bind_group_set {
+  VkDescriptorPool vk_pool;
+  VkDescriptorSet  vk_set;
+} ngfvk_retired_bind_group_set;
+
+// A range of consecutive queries written by a cmd buffer. Queries written inside of a render pass
+// can't be reset in place, so they're reset at the start of the frame's submission instead.
+typedef struct ngfvk_query_range {
+  struct ngf_query_pool_t* pool;
+  uint32_t                 first;
+  uint32_t                 count;
+  bool                     deferred_reset;
+  ngfvk_queue              queue;  // < Queue that the queries are written on.
+} ngfvk_query_range;
+
+// A buffer copy whose recording is deferred by a transfer pass.
+typedef struct ngfvk_buffer_copy {
+  VkBuffer     src;
+  VkBuffer     dst;
+  VkBufferCopy region;
+} ngfvk_buffer_copy;
+
+// A persistently mapped buffer that transient uploads are suballocated from.
+typedef struct ngfvk_upload_chunk {
+  ngf_buffer buffer;
+  size_t     used;     // < Number of bytes handed out during the current frame.
+  size_t     flushed;  // < Number of bytes already made visible to the device.
+} ngfvk_upload_chunk;
 
 // Vulkan resources associated with a given frame.
 typedef struct ngfvk_frame_resources {
   NGFI_DARRAY_OF(VkCommandBuffer) cmd_bufs;  // < Submitted vulkan command buffers.
-  NGFI_DARRAY_OF(VkCommandPool) cmd_pools;   // < The parent command pools of each  cmd buffer.
   VkSemaphore semaphore;                     // < Signalled when the last cmd buffer finishes.
 
   // Resources that should be disposed of at some point after this
@@ -160,11 +269,56 @@ typedef struct ngfvk_frame_resources {
   NGFI_DARRAY_OF(VkSampler) retire_samplers;
   NGFI_DARRAY_OF(VkImageView) retire_image_views;
   NGFI_DARRAY_OF(VkBufferView) retire_buffer_views;
+  NGFI_DARRAY_OF(VkDescriptorPool) retire_desc_pools;
+  NGFI_DARRAY_OF(VkQueryPool) retire_query_pools;
+  NGFI_DARRAY_OF(VkCommandPool) retire_cmd_pools;
   NGFI_DARRAY_OF(VkEvent) retire_events;
   NGFI_DARRAY_OF(VkEvent) real_retire_events;
   NGFI_DARRAY_OF(ngfvk_alloc) retire_images;
   NGFI_DARRAY_OF(ngfvk_alloc) retire_buffers;
-  NGFI_DARRAY_OF(ngfvk_desc_pools_list*) reset_desc_pools_lists;
+  NGFI_DARRAY_OF(ngfvk_retired_table_slot) retire_table_slots;
+  NGFI_DARRAY_OF(ngfvk_retired_bind_group_set) retire_bind_group_sets;
+
+  // Graphics queue cmd buffers submitted during this frame, possibly from different threads. They
+  // are moved into `cmd_bufs` when the frame ends.
+  ngfi_atomic_stack submissions;
+
+  // Queries written by the cmd buffers submitted during this frame. Their results are read back
+  // once the frame is retired.
+  NGFI_DARRAY_OF(ngfvk_query_range) written_queries;
+
+  // Queries that have to be reset before the next submission to the graphics queue.
+  NGFI_DARRAY_OF(ngfvk_query_range) query_resets;
+
+  // Upload memory handed out during this frame, reused once the frame's submissions complete.
+  NGFI_DARRAY_OF(ngfvk_upload_chunk) upload_chunks;
+
+  // Semaphores ordering this frame's submissions to different queues. They're handed out in order,
+  // and each one that gets signaled is waited on by a later submission of the same frame.
+  NGFI_DARRAY_OF(VkSemaphore) queue_semaphores;
+  uint32_t nused_queue_semaphores;
+
+  // Semaphores signaled by submissions to the transfer queue that the next submission to the
+  // graphics queue has to wait on.
+  NGFI_DARRAY_OF(VkSemaphore) gfx_wait_semaphores;
+
+  // Barriers acquiring ownership of the resources released by the transfer queue, recorded at the
+  // start of the next submission to the graphics queue.
+  NGFI_DARRAY_OF(VkBufferMemoryBarrier) xfer_acquire_buf_barriers;
+  NGFI_DARRAY_OF(VkImageMemoryBarrier) xfer_acquire_img_barriers;
+
+  // Barriers releasing ownership of the resources written on the compute queue, recorded after the
+  // frame's work on the compute queue. The matching acquire barriers are recorded directly into the
+  // graphics queue cmd buffers that synchronize with the compute work.
+  NGFI_DARRAY_OF(VkBufferMemoryBarrier) compute_release_buf_barriers;
+  NGFI_DARRAY_OF(VkImageMemoryBarrier) compute_release_img_barriers;
+
+  // Set if cmd buffers have been submitted to the compute queue since the last submission to the
+  // graphics queue.
+  bool compute_work_pending;
+
+  // Index of the first element of `cmd_bufs` that has to wait on the compute queue's work, or ~0u.
+  uint32_t compute_wait_cmd_buf_idx;
 
   // Fences that will be signaled at the end of the frame.
   VkFence fences[2];
@@ -174,10 +328,58 @@ typedef struct ngfvk_frame_resources {
   uint32_t nwait_fences;
 } ngfvk_frame_resources;
 
+// Destroys retired objects on a dedicated thread. Batches of retired objects are handed to the
+// worker once the fences of the frame that retired them have signaled. Queue slots are frame
+// resource structs, only the lists of destroyable objects are used.
+typedef struct ngfvk_retire_worker {
+  pthread_t             thread;
+  pthread_mutex_t       lock;
+  pthread_cond_t        cond;  // < Signaled whenever the state of the queue changes.
+  ngfvk_frame_resources queue[NGFVK_RETIRE_QUEUE_CAPACITY];
+  uint32_t              head;     // < Index of the batch that is processed next.
+  uint32_t              nqueued;  // < Includes the batch that is being processed.
+  bool                  stop;
+} ngfvk_retire_worker;
+
+// A command pool along with all the command buffers ever allocated from it. Command buffers are
+// never freed individually; instead, the entire pool is reset once the frame that used it has
+// completed, and its command buffers are handed out again.
+typedef struct ngfvk_cmd_pool {
+  VkCommandPool vk_pool;
+  NGFI_DARRAY_OF(VkCommandBuffer) cmd_bufs;
+  uint32_t             nused;  // < Number of command buffers handed out since the last reset.
+  VkCommandBufferLevel level;  // < Level of the command buffers allocated from the pool.
+} ngfvk_cmd_pool;
+
+// A graphics queue cmd buffer submission, along with everything that has to be handed over to the
+// frame it was submitted in.
+typedef struct ngfvk_submission {
+  ngfi_atomic_stack_node node;
+  VkCommandBuffer        vk_cmd_buffer;
+  bool                   waits_on_compute;
+  NGFI_DARRAY_OF(ngfvk_query_range) written_queries;
+  NGFI_DARRAY_OF(VkBufferMemoryBarrier) release_buf_barriers;
+  NGFI_DARRAY_OF(VkImageMemoryBarrier) release_img_barriers;
+  NGFI_DARRAY_OF(VkEvent) events;
+  ngf_context_stats stats;
+} ngfvk_submission;
+
+// Resources that a cmd buffer uses while recording for frames with a particular id. Each cmd buffer
+// owns these instead of sharing the context's, so that distinct cmd buffers may be recorded and
+// submitted on different threads. They are reset when first used in a new frame, by which point
+// the previous frame with the same id has been retired.
+typedef struct ngfvk_cmd_buffer_frame_res {
+  ngfvk_cmd_pool        cmd_pool;
+  ngfvk_desc_pools_list desc_pools;
+  NGFI_DARRAY_OF(ngfvk_submission*) submissions;
+  uint32_t              nused_submissions;
+  uint64_t              frame_serial;  // < Frame that the resources were last reset for.
+} ngfvk_cmd_buffer_frame_res;
+
 typedef struct {
-  uint16_t       ctx_id;
-  uint8_t        num_pools;
-  VkCommandPool* cmd_pools;
+  uint16_t        ctx_id;
+  uint8_t         num_pools;
+  ngfvk_cmd_pool* cmd_pools[NGFVK_QUEUE_COUNT];  // < One pool per frame, NULL for absent queues.
 } ngfvk_command_superpool;
 
 typedef struct ngfvk_attachment_pass_desc {
@@ -192,9 +394,17 @@ typedef struct ngfvk_attachment_pass_desc {
 typedef struct ngfvk_renderpass_cache_entry {
   ngf_render_target rt;
   uint64_t          ops_key;
-  VkRenderPass      renderpass;
+  VkRenderPass      renderpass;  // < VK_NULL_HANDLE for unoccupied slots.
 } ngfvk_renderpass_cache_entry;
 
+// Maps (render target, attachment ops) to render pass objects. Uses open addressing with linear
+// probing.
+typedef struct ngfvk_renderpass_cache {
+  ngfvk_renderpass_cache_entry* slots;
+  uint32_t                      capacity;  // < Always a power of two.
+  uint32_t                      nentries;
+} ngfvk_renderpass_cache;
+
 #define NGFVK_ENC2CMDBUF(enc) ((ngf_cmd_buffer)((void*)enc.pvt_data_donotuse.d0))
 
 typedef struct ngfvk_device_id {
@@ -209,22 +419,96 @@ typedef struct ngfvk_generic_pipeline {
   VkSpecializationInfo vk_spec_info;
 } ngfvk_generic_pipeline;
 
+// Pieces of state tracked by ngfvk_cmd_shadow_state.
+typedef enum {
+  NGFVK_SHADOW_GFX_PIPELINE         = 1u << 0u,
+  NGFVK_SHADOW_INDEX_BUFFER         = 1u << 1u,
+  NGFVK_SHADOW_VIEWPORT             = 1u << 2u,
+  NGFVK_SHADOW_SCISSOR              = 1u << 3u,
+  NGFVK_SHADOW_STENCIL_REFERENCE    = 1u << 4u,
+  NGFVK_SHADOW_STENCIL_COMPARE_MASK = 1u << 5u,
+  NGFVK_SHADOW_STENCIL_WRITE_MASK   = 1u << 6u
+} ngfvk_shadow_state_bit;
+
+// A copy of the state last recorded into a command buffer, used to drop commands that would set a
+// piece of state to the value it already has. A piece of state is only considered known if its
+// bit is set in `valid_mask`.
+typedef struct ngfvk_cmd_shadow_state {
+  VkPipeline   gfx_pipeline;
+  VkBuffer     attrib_bufs[NGFVK_MAX_SHADOWED_ATTRIB_BINDINGS];
+  VkDeviceSize attrib_buf_offsets[NGFVK_MAX_SHADOWED_ATTRIB_BINDINGS];
+  uint32_t     valid_attrib_bufs;  // < Bit i is set if attrib_bufs[i] is known.
+  VkBuffer     index_buf;
+  VkDeviceSize index_buf_offset;
+  VkIndexType  index_type;
+  VkViewport   viewport;
+  VkRect2D     scissor;
+  uint32_t     stencil_reference[2];  // < Front and back face values.
+  uint32_t     stencil_compare_mask[2];
+  uint32_t     stencil_write_mask[2];
+  uint32_t     valid_mask;  // < Combination of ngfvk_shadow_state_bit.
+} ngfvk_cmd_shadow_state;
+
 #pragma endregion
 
 #pragma region external_struct_definitions
 
 typedef struct ngf_cmd_buffer_t {
+  ngf_context              ctx;              // < The context that the cmd buffer was created in.
   ngf_frame_token          parent_frame;     // < The frame this cmd buffer is associated with.
   ngfi_cmd_buffer_state    state;            // < State of the cmd buffer (i.e. new/recording/etc.)
   VkCommandBuffer          vk_cmd_buffer;    // < Active vulkan command buffer.
-  VkCommandPool            vk_cmd_pool;      // < Active vulkan command pool.
   ngf_graphics_pipeline    active_gfx_pipe;  // < The bound graphics pipeline.
   ngf_compute_pipeline     active_compute_pipe;  // < The bound compute pipeline.
   ngf_render_target        active_rt;            // < Active render target.
-  ngfvk_bind_op_chunk_list pending_bind_ops;     // < Bind ops to be performed before the next draw.
-  ngfvk_desc_pools_list* desc_pools_list;  // < List of descriptor pools used in the buffer's frame.
+  // Bind ops to be performed before the next draw or dispatch. This is a contiguous arena that
+  // retains its storage for the lifetime of the command buffer.
+  NGFI_DARRAY_OF(ngf_resource_bind_op) pending_bind_ops;
+  ngfvk_cmd_shadow_state shadow_state;  // < State already recorded into vk_cmd_buffer.
+  // Halves of queue ownership transfers that have to be recorded on another queue at submission
+  // time. For transfer queue cmd buffers, these are the graphics queue's acquire barriers. For
+  // graphics queue cmd buffers, these are the compute queue's release barriers.
+  NGFI_DARRAY_OF(VkBufferMemoryBarrier) ownership_buf_barriers;
+  NGFI_DARRAY_OF(VkImageMemoryBarrier) ownership_img_barriers;
+  // Barriers that make the results of transfer commands visible to their consumers. These are
+  // accumulated while a transfer pass is recorded, and flushed in a single batch at the end of the
+  // pass, or earlier, if a subsequent transfer command touches one of the affected resources.
+  NGFI_DARRAY_OF(VkBufferMemoryBarrier) pending_xfer_buf_barriers;
+  NGFI_DARRAY_OF(VkImageMemoryBarrier) pending_xfer_img_barriers;
+  VkPipelineStageFlags pending_xfer_dst_stages;  // < Stages waiting on the pending barriers.
+  // Buffer copies that haven't been recorded yet, along with the barriers that make their
+  // destinations available for the transfer. Consecutive copies are recorded together, after a
+  // single barrier for all of them.
+  NGFI_DARRAY_OF(ngfvk_buffer_copy) pending_buf_copies;
+  NGFI_DARRAY_OF(VkBufferMemoryBarrier) xfer_pre_buf_barriers;
+  VkPipelineStageFlags pending_copy_src_stages;  // < Stages that the pending copies wait on.
+  // Scratch storage for batched image writes, retained for the lifetime of the command buffer.
+  NGFI_DARRAY_OF(VkImageMemoryBarrier) xfer_pre_img_barriers;
+  NGFI_DARRAY_OF(VkBufferImageCopy) xfer_copy_regions;
+  uint32_t               flags;                // < Flags from ngf_cmd_buffer_flags.
+  ngfvk_queue            queue;                // < The queue that the cmd buffer is submitted to.
+  bool                   waits_on_compute;     // < Acquires resources from the compute queue.
   bool                   renderpass_active;    // < Has an active renderpass.
   bool                   compute_pass_active;  // < Has an active compute pass.
+  // Timestamp queries that subsequently recorded passes write their begin and end timestamps to.
+  ngf_query_pool         pass_timestamp_pool;  // < NULL if pass timestamps are disabled.
+  uint32_t               next_pass_timestamp;  // < Query for the next pass' begin timestamp.
+  uint32_t               pass_timestamps_end;  // < One past the last query of the range.
+  uint32_t               active_pass_end_timestamp;  // < Query for the active pass' end, or ~0u.
+  ngf_query_pool         active_query_pool;  // < Pool of the active query, NULL if there's none.
+  uint32_t               active_query;
+  NGFI_DARRAY_OF(ngfvk_query_range) written_queries;  // < Handed over to the frame on submission.
+  NGFI_DARRAY_OF(VkEvent) events;  // < Events set by the recorded passes, retired on submission.
+  uint64_t               frame_serial;  // < Serial of the frame being recorded for.
+  // Render pass and framebuffer of the active render pass, inherited by secondary cmd buffers.
+  VkRenderPass           active_vk_renderpass;
+  VkFramebuffer          active_vk_framebuffer;
+  bool                   parallel_renderpass;  // < The active pass is recorded into secondaries.
+  ngfvk_cmd_buffer_frame_res* frame_res;  // < One per frame in flight.
+  uint32_t                    nframe_res;
+  // Statistics gathered while recording, added to the context's once the commands are submitted
+  // (or executed, for secondary cmd buffers).
+  ngf_context_stats stats;
 } ngf_cmd_buffer_t;
 
 typedef struct ngf_sampler_t {
@@ -243,6 +527,34 @@ typedef struct ngf_texel_buffer_view_t {
   VkBufferView vk_buf_view;
 } ngf_texel_buffer_view_t;
 
+typedef struct ngf_resource_table_t {
+  VkDescriptorSetLayout vk_set_layout;
+  VkDescriptorPool      vk_pool;
+  VkDescriptorSet       vk_set;
+  ngf_descriptor_type   type;
+  uint32_t              capacity;
+  uint32_t              nused_slots;  // < Slots at or past this index have never been handed out.
+  NGFI_DARRAY_OF(uint32_t) free_slots;  // < Slots that have been freed and are safe to reuse.
+} ngf_resource_table_t;
+
+typedef struct ngf_query_pool_t {
+  VkQueryPool    vk_pool;
+  ngf_query_type type;
+  uint32_t       nqueries;
+  uint32_t       nvalues;  // < Number of values produced by each query.
+  // Results read back from retired frames. Each query's values are followed by a non-zero value if
+  // the query's result is available.
+  uint64_t*      results;
+} ngf_query_pool_t;
+
+typedef struct ngf_bind_group_t {
+  VkDescriptorPool vk_pool;  // < The context's bind group pool that vk_set was allocated from.
+  VkDescriptorSet  vk_set;
+  uint32_t         set;
+  uint32_t         dynamic_offsets[NGFVK_MAX_DYNAMIC_UNIFORM_BUFFERS_PER_SET];
+  uint32_t         ndynamic_offsets;
+} ngf_bind_group_t;
+
 typedef struct ngf_image_t {
   ngfvk_alloc    alloc;
   ngf_image_type type;
@@ -268,14 +580,19 @@ typedef struct ngf_context_t {
   VkSurfaceKHR                surface;
   uint32_t                    frame_id;
   uint32_t                    max_inflight_frames;
-  ngfi_block_allocator*       bind_op_chunk_allocator;
   ngf_frame_token             current_frame_token;
   ngf_attachment_descriptions default_attachment_descriptions_list;
   ngf_render_target           default_render_target;
   uint64_t                    cmd_buffer_counter;
+  uint64_t                    frame_serial;  // < Incremented whenever a new frame begins.
   NGFI_DARRAY_OF(ngfvk_command_superpool) command_superpools;
-  NGFI_DARRAY_OF(ngfvk_desc_superpool) desc_superpools;
-  NGFI_DARRAY_OF(ngfvk_renderpass_cache_entry) renderpass_cache;
+  NGFI_DARRAY_OF(VkDescriptorPool) bind_group_pools;  // < Shared by all bind groups.
+  ngfvk_desc_pool_config desc_pool_config;
+  VkPipelineCache        pipeline_cache;  // < VK_NULL_HANDLE unless enabled at context creation.
+  ngfvk_renderpass_cache renderpass_cache;
+  pthread_mutex_t        renderpass_cache_lock;  // < Render passes may be begun on any thread.
+  ngfvk_retire_worker*   retire_worker;  // < NULL unless enabled at context creation.
+  ngf_context_stats stats;
 } ngf_context_t;
 
 typedef struct ngf_shader_stage_t {
@@ -311,15 +628,19 @@ typedef struct ngf_event_t {
   VkEvent event;
 } ngf_event_t;
 
+typedef struct ngfvk_pending_img_barrier {
+  ngfi_atomic_stack_node node;
+  VkImageMemoryBarrier   barrier;
+} ngfvk_pending_img_barrier;
+
 #pragma endregion
 
 #pragma region               global_vars
 NGFI_THREADLOCAL ngf_context CURRENT_CONTEXT = NULL;
 
-static struct {
-  pthread_mutex_t lock;
-  NGFI_DARRAY_OF(VkImageMemoryBarrier) barriers;
-} NGFVK_PENDING_IMG_BARRIER_QUEUE;
+// Layout transitions for newly created images, to be recorded at the next submission. Images may
+// be created from any thread, so this is a lock-free stack rather than a mutex-guarded array.
+static ngfi_atomic_stack NGFVK_PENDING_IMG_BARRIER_QUEUE;
 
 uint32_t         NGFVK_DEVICE_COUNT   = 0u;
 ngf_device*      NGFVK_DEVICE_LIST    = NULL;
@@ -381,7 +702,8 @@ static VkDescriptorType get_vk_descriptor_type(ngf_descriptor_type type) {
       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
       VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,
       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-      VK_DESCRIPTOR_TYPE_STORAGE_IMAGE};
+      VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+      VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC};
   return types[type];
 }
 
@@ -670,6 +992,7 @@ static VkBufferUsageFlags get_vk_buffer_usage(uint32_t usage) {
   if (usage & NGF_BUFFER_USAGE_VERTEX_BUFFER) flags |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
   if (usage & NGF_BUFFER_USAGE_TEXEL_BUFFER) flags |= VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT;
   if (usage & NGF_BUFFER_USAGE_STORAGE_BUFFER) flags |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+  if (usage & NGF_BUFFER_USAGE_INDIRECT) flags |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
   return flags;
 }
 
@@ -708,6 +1031,7 @@ static VkAccessFlags get_vk_buffer_access_flags(ngf_buffer buf) {
     result |= (VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
   if (buf->usage_flags & NGF_BUFFER_USAGE_XFER_DST) result |= VK_ACCESS_TRANSFER_WRITE_BIT;
   if (buf->usage_flags & NGF_BUFFER_USAGE_XFER_SRC) result |= VK_ACCESS_TRANSFER_READ_BIT;
+  if (buf->usage_flags & NGF_BUFFER_USAGE_INDIRECT) result |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
   if (buf->storage_type == NGF_BUFFER_STORAGE_HOST_READABLE) result |= VK_ACCESS_HOST_READ_BIT;
   if (buf->storage_type == NGF_BUFFER_STORAGE_HOST_WRITEABLE) result |= VK_ACCESS_HOST_WRITE_BIT;
   if (buf->storage_type == NGF_BUFFER_STORAGE_HOST_READABLE_WRITEABLE)
@@ -756,6 +1080,7 @@ static VkPipelineStageFlags get_vk_buffer_pipeline_stage_flags(ngf_buffer buf) {
          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
   if (buf->usage_flags & NGF_BUFFER_USAGE_XFER_DST || buf->usage_flags & NGF_BUFFER_USAGE_XFER_SRC)
     result |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+  if (buf->usage_flags & NGF_BUFFER_USAGE_INDIRECT) result |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
   return result;
 }
 
@@ -765,6 +1090,7 @@ static VkPipelineStageFlags get_vk_buffer_pipeline_stage_flags(ngf_buffer buf) {
 
 void             ngfi_set_allocation_callbacks(const ngf_allocation_callbacks* callbacks);
 ngf_sample_count ngfi_get_highest_sample_count(size_t counts_bitmap);
+uint32_t         ngfi_get_hw_thread_count(void);
 
 // Handler for messages from validation layers, etc.
 // All messages are forwarded to the user-provided debug callback.
@@ -826,6 +1152,22 @@ ngfvk_query_presentation_support(VkPhysicalDevice phys_dev, uint32_t queue_famil
 #endif
 }
 
+// Returns the index of the first queue family that supports all of the required capabilities and
+// none of the excluded ones, or NGFVK_INVALID_IDX if there is no such family.
+static uint32_t ngfvk_find_dedicated_queue_family(
+    const VkQueueFamilyProperties* families,
+    uint32_t                       nfamilies,
+    VkQueueFlags                   required,
+    VkQueueFlags                   excluded) {
+  for (uint32_t q = 0u; q < nfamilies; ++q) {
+    const VkQueueFlags flags = families[q].queueFlags;
+    if (families[q].queueCount > 0u && (flags & required) == required && (flags & excluded) == 0u) {
+      return q;
+    }
+  }
+  return NGFVK_INVALID_IDX;
+}
+
 static ngf_error ngfvk_create_vk_image_view(
     VkImage         image,
     VkImageViewType image_type,
@@ -1184,21 +1526,231 @@ ngfvk_create_swapchain_cleanup:
   return err;
 }
 
-static void ngfvk_retire_resources(ngfvk_frame_resources* frame_res) {
-  if (frame_res->nwait_fences > 0u) {
-    VkResult wait_status = VK_SUCCESS;
-    do {
-      wait_status = vkWaitForFences(
-          _vk.device,
-          frame_res->nwait_fences,
-          frame_res->fences,
-          VK_TRUE,
-          0x3B9ACA00ul);
-    } while (wait_status == VK_TIMEOUT);
-    vkResetFences(_vk.device, frame_res->nwait_fences, frame_res->fences);
-    frame_res->nwait_fences = 0;
+static uint64_t ngfvk_hash_bytes(uint64_t hash, const void* data, size_t nbytes) {
+  // FNV-1a.
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t i = 0u; i < nbytes; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+static uint64_t ngfvk_desc_set_cache_hash(
+    VkDescriptorSetLayout             set_layout,
+    const ngfvk_desc_cache_key_entry* key,
+    uint32_t                          nkey_entries) {
+  const uint64_t hash = ngfvk_hash_bytes(0xcbf29ce484222325ull, &set_layout, sizeof(set_layout));
+  return ngfvk_hash_bytes(hash, key, sizeof(ngfvk_desc_cache_key_entry) * nkey_entries);
+}
+
+static bool ngfvk_desc_cache_slot_matches(
+    const ngfvk_desc_cache_slot*      slot,
+    uint64_t                          hash,
+    VkDescriptorSetLayout             set_layout,
+    const ngfvk_desc_cache_key_entry* key,
+    uint32_t                          nkey_entries) {
+  return slot->hash == hash && slot->set_layout == set_layout &&
+         slot->nkey_entries == nkey_entries &&
+         memcmp(slot->key, key, sizeof(ngfvk_desc_cache_key_entry) * nkey_entries) == 0;
+}
+
+static VkDescriptorSet ngfvk_desc_set_cache_lookup(
+    const ngfvk_desc_set_cache*       cache,
+    uint64_t                          hash,
+    VkDescriptorSetLayout             set_layout,
+    const ngfvk_desc_cache_key_entry* key,
+    uint32_t                          nkey_entries) {
+  if (cache->nentries == 0u) { return VK_NULL_HANDLE; }
+  const uint32_t mask = cache->capacity - 1u;
+  for (uint32_t i = (uint32_t)hash & mask;; i = (i + 1u) & mask) {
+    const ngfvk_desc_cache_slot* slot = &cache->slots[i];
+    if (slot->set == VK_NULL_HANDLE) { return VK_NULL_HANDLE; }
+    if (ngfvk_desc_cache_slot_matches(slot, hash, set_layout, key, nkey_entries)) {
+      return slot->set;
+    }
+  }
+}
+
+static void
+ngfvk_desc_set_cache_place(ngfvk_desc_set_cache* cache, const ngfvk_desc_cache_slot* new_slot) {
+  const uint32_t mask = cache->capacity - 1u;
+  uint32_t       i    = (uint32_t)new_slot->hash & mask;
+  while (cache->slots[i].set != VK_NULL_HANDLE) { i = (i + 1u) & mask; }
+  cache->slots[i] = *new_slot;
+  cache->nentries++;
+}
+
+// Inserts a newly written descriptor set into the cache. Failing to insert is not an error, the
+// set simply won't be reused.
+static void ngfvk_desc_set_cache_insert(
+    ngfvk_desc_set_cache*             cache,
+    uint64_t                          hash,
+    VkDescriptorSetLayout             set_layout,
+    const ngfvk_desc_cache_key_entry* key,
+    uint32_t                          nkey_entries,
+    VkDescriptorSet                   set) {
+  // Keep the load factor at or below 1/2.
+  if (2u * (cache->nentries + 1u) > cache->capacity) {
+    const uint32_t new_capacity =
+        cache->capacity == 0u ? NGFVK_DESC_SET_CACHE_INITIAL_CAPACITY : cache->capacity * 2u;
+    ngfvk_desc_cache_slot* new_slots = NGFI_ALLOCN(ngfvk_desc_cache_slot, new_capacity);
+    if (new_slots == NULL) { return; }
+    memset(new_slots, 0, sizeof(ngfvk_desc_cache_slot) * new_capacity);
+    ngfvk_desc_cache_slot* old_slots    = cache->slots;
+    const uint32_t         old_capacity = cache->capacity;
+    cache->slots                        = new_slots;
+    cache->capacity                     = new_capacity;
+    cache->nentries                     = 0u;
+    for (uint32_t i = 0u; i < old_capacity; ++i) {
+      if (old_slots[i].set != VK_NULL_HANDLE) { ngfvk_desc_set_cache_place(cache, &old_slots[i]); }
+    }
+    if (old_slots) { NGFI_FREEN(old_slots, old_capacity); }
+  }
+
+  if (cache->key_storage == NULL) {
+    cache->key_storage = ngfi_sa_create(NGFVK_DESC_SET_CACHE_KEY_STORAGE_SIZE);
+    if (cache->key_storage == NULL) { return; }
+  }
+  const size_t                key_size = sizeof(ngfvk_desc_cache_key_entry) * nkey_entries;
+  ngfvk_desc_cache_key_entry* key_copy =
+      nkey_entries > 0u ? ngfi_sa_alloc(cache->key_storage, key_size) : NULL;
+  if (nkey_entries > 0u && key_copy == NULL) { return; }
+  if (key_copy) { memcpy(key_copy, key, key_size); }
+
+  const ngfvk_desc_cache_slot new_slot = {
+      .hash         = hash,
+      .set_layout   = set_layout,
+      .set          = set,
+      .key          = key_copy,
+      .nkey_entries = nkey_entries};
+  ngfvk_desc_set_cache_place(cache, &new_slot);
+}
+
+static void ngfvk_desc_set_cache_clear(ngfvk_desc_set_cache* cache) {
+  if (cache->nentries > 0u) {
+    memset(cache->slots, 0, sizeof(ngfvk_desc_cache_slot) * cache->capacity);
+    cache->nentries = 0u;
+  }
+  if (cache->key_storage) { ngfi_sa_reset(cache->key_storage); }
+}
+
+static void ngfvk_desc_set_cache_destroy(ngfvk_desc_set_cache* cache) {
+  if (cache->slots) { NGFI_FREEN(cache->slots, cache->capacity); }
+  if (cache->key_storage) { ngfi_sa_destroy(cache->key_storage); }
+  memset(cache, 0, sizeof(ngfvk_desc_set_cache));
+}
+
+static void ngfvk_init_desc_pool_config(
+    const ngf_descriptor_pool_info* info,
+    ngfvk_desc_pool_config*         config) {
+  const bool     have_info   = info != NULL;
+  const uint32_t sets        = have_info ? info->initial_sets : 0u;
+  const uint32_t descriptors = have_info ? info->initial_descriptors_per_type : 0u;
+  config->initial_capacity.sets = sets > 0u ? sets : NGFVK_DESC_POOL_DEFAULT_SETS;
+  for (int i = 0; i < NGF_DESCRIPTOR_TYPE_COUNT; ++i) {
+    config->initial_capacity.descriptors[i] =
+        descriptors > 0u ? descriptors : NGFVK_DESC_POOL_DEFAULT_DESCRIPTORS;
+  }
+  config->adaptive = have_info && info->adaptive;
+}
+
+// Computes the capacity of a new descriptor pool that is about to be appended to the given list in
+// order to service an allocation of a set with the given layout.
+static void ngfvk_desc_pool_capacity_for_new_pool(
+    const ngfvk_desc_pools_list* pools,
+    const ngfvk_desc_set_layout* set_layout,
+    ngfvk_desc_pool_capacity*    capacity) {
+  const ngfvk_desc_pool_config* config    = &pools->config;
+  const ngfvk_desc_pool*        last_pool = pools->active_pool;
+
+  if (!config->adaptive) {
+    *capacity = config->initial_capacity;
+  } else {
+    // Expect to need at least as much as the worst of the previous frames, or as much as the
+    // current frame has used so far, whichever is larger.
+    ngfvk_desc_pool_capacity expected;
+    expected.sets = NGFI_MAX(pools->high_water.sets, pools->frame_usage.sets);
+    for (int i = 0; i < NGF_DESCRIPTOR_TYPE_COUNT; ++i) {
+      expected.descriptors[i] =
+          NGFI_MAX(pools->high_water.descriptors[i], pools->frame_usage.descriptors[i]);
+    }
+
+    if (last_pool == NULL) {
+      // First pool for the frame: fit the whole expected usage, with some headroom.
+      capacity->sets = NGFI_MAX(config->initial_capacity.sets, expected.sets + expected.sets / 4u);
+    } else {
+      // The previous pool ran out of space mid-frame: grow geometrically.
+      capacity->sets = 2u * last_pool->capacity.sets;
+    }
+
+    for (int i = 0; i < NGF_DESCRIPTOR_TYPE_COUNT; ++i) {
+      if (expected.sets > 0u) {
+        // Provision descriptors of each type in proportion to their observed usage per set.
+        const uint64_t scaled =
+            ((uint64_t)capacity->sets * expected.descriptors[i] + expected.sets - 1u) /
+            expected.sets;
+        capacity->descriptors[i] = NGFI_MAX((uint32_t)scaled, NGFVK_DESC_POOL_MIN_DESCRIPTORS);
+      } else {
+        // No usage data yet, keep the initial proportions.
+        capacity->descriptors[i] = (uint32_t)(
+            (uint64_t)config->initial_capacity.descriptors[i] * capacity->sets /
+            config->initial_capacity.sets);
+      }
+      if (last_pool != NULL && last_pool->utilization.descriptors[i] + set_layout->counts[i] >
+                                   last_pool->capacity.descriptors[i]) {
+        capacity->descriptors[i] =
+            NGFI_MAX(capacity->descriptors[i], 2u * last_pool->capacity.descriptors[i]);
+      }
+    }
+  }
+
+  // Make sure that the set which triggered the creation of the new pool fits into it.
+  for (int i = 0; i < NGF_DESCRIPTOR_TYPE_COUNT; ++i) {
+    capacity->descriptors[i] = NGFI_MAX(capacity->descriptors[i], set_layout->counts[i]);
+  }
+}
+
+static void ngfvk_desc_pools_list_destroy_pools(ngfvk_desc_pools_list* pools) {
+  ngfvk_desc_pool* p = pools->list;
+  while (p) {
+    vkDestroyDescriptorPool(_vk.device, p->vk_pool, NULL);
+    ngfvk_desc_pool* next = p->next;
+    NGFI_FREE(p);
+    p = next;
+  }
+  pools->list        = NULL;
+  pools->active_pool = NULL;
+}
+
+static void ngfvk_desc_pools_list_reset(ngfvk_desc_pools_list* pools) {
+  // Lists that haven't been used during the frame carry no usage data.
+  if (pools->frame_usage.sets > 0u) {
+    pools->high_water.sets = NGFI_MAX(pools->high_water.sets, pools->frame_usage.sets);
+    for (int i = 0; i < NGF_DESCRIPTOR_TYPE_COUNT; ++i) {
+      pools->high_water.descriptors[i] =
+          NGFI_MAX(pools->high_water.descriptors[i], pools->frame_usage.descriptors[i]);
+    }
+    memset(&pools->frame_usage, 0, sizeof(pools->frame_usage));
+  }
+
+  if (pools->config.adaptive && pools->list != NULL && pools->list->next != NULL) {
+    // The frame needed more than one pool. Release the whole chain so that a single pool, sized to
+    // fit the high-water mark, gets created next time around.
+    ngfvk_desc_pools_list_destroy_pools(pools);
+  } else {
+    for (ngfvk_desc_pool* pool = pools->list; pool; pool = pool->next) {
+      vkResetDescriptorPool(_vk.device, pool->vk_pool, 0u);
+      memset(&pool->utilization, 0, sizeof(pool->utilization));
+    }
+    pools->active_pool = pools->list;
   }
+  ngfvk_desc_set_cache_clear(&pools->set_cache);
+}
 
+// Destroys the objects in the given frame's retire lists and clears the lists. Does not touch any
+// context state, so it may be called from the retirement worker thread.
+static void ngfvk_destroy_retired_objects(ngfvk_frame_resources* frame_res) {
   NGFI_DARRAY_FOREACH(frame_res->retire_pipelines, p) {
     vkDestroyPipeline(_vk.device, NGFI_DARRAY_AT(frame_res->retire_pipelines, p), NULL);
   }
@@ -1242,12 +1794,16 @@ static void ngfvk_retire_resources(ngfvk_frame_resources* frame_res) {
     vkDestroyBufferView(_vk.device, NGFI_DARRAY_AT(frame_res->retire_buffer_views, s), NULL);
   }
 
-  NGFI_DARRAY_FOREACH(frame_res->real_retire_events, s) {
-    vkDestroyEvent(_vk.device, NGFI_DARRAY_AT(frame_res->real_retire_events, s), NULL);
+  NGFI_DARRAY_FOREACH(frame_res->retire_desc_pools, s) {
+    vkDestroyDescriptorPool(_vk.device, NGFI_DARRAY_AT(frame_res->retire_desc_pools, s), NULL);
   }
-  NGFI_DARRAY_CLEAR(frame_res->real_retire_events);
-  NGFI_DARRAY_FOREACH(frame_res->retire_events, s) {
-    NGFI_DARRAY_APPEND(frame_res->real_retire_events, NGFI_DARRAY_AT(frame_res->retire_events, s));
+
+  NGFI_DARRAY_FOREACH(frame_res->retire_query_pools, s) {
+    vkDestroyQueryPool(_vk.device, NGFI_DARRAY_AT(frame_res->retire_query_pools, s), NULL);
+  }
+
+  NGFI_DARRAY_FOREACH(frame_res->retire_cmd_pools, s) {
+    vkDestroyCommandPool(_vk.device, NGFI_DARRAY_AT(frame_res->retire_cmd_pools, s), NULL);
   }
 
   NGFI_DARRAY_FOREACH(frame_res->retire_buffers, a) {
@@ -1255,69 +1811,486 @@ static void ngfvk_retire_resources(ngfvk_frame_resources* frame_res) {
     vmaDestroyBuffer(b->parent_allocator, (VkBuffer)b->obj_handle, b->vma_alloc);
   }
 
-  NGFI_DARRAY_FOREACH(frame_res->reset_desc_pools_lists, p) {
-    ngfvk_desc_pools_list* superpool = NGFI_DARRAY_AT(frame_res->reset_desc_pools_lists, p);
-    for (ngfvk_desc_pool* pool = superpool->list; pool; pool = pool->next) {
-      vkResetDescriptorPool(_vk.device, pool->vk_pool, 0u);
-      memset(&pool->utilization, 0, sizeof(pool->utilization));
+  NGFI_DARRAY_CLEAR(frame_res->retire_pipelines);
+  NGFI_DARRAY_CLEAR(frame_res->retire_dset_layouts);
+  NGFI_DARRAY_CLEAR(frame_res->retire_framebuffers);
+  NGFI_DARRAY_CLEAR(frame_res->retire_render_passes);
+  NGFI_DARRAY_CLEAR(frame_res->retire_samplers);
+  NGFI_DARRAY_CLEAR(frame_res->retire_image_views);
+  NGFI_DARRAY_CLEAR(frame_res->retire_buffer_views);
+  NGFI_DARRAY_CLEAR(frame_res->retire_desc_pools);
+  NGFI_DARRAY_CLEAR(frame_res->retire_query_pools);
+  NGFI_DARRAY_CLEAR(frame_res->retire_cmd_pools);
+  NGFI_DARRAY_CLEAR(frame_res->retire_images);
+  NGFI_DARRAY_CLEAR(frame_res->retire_pipeline_layouts);
+  NGFI_DARRAY_CLEAR(frame_res->retire_buffers);
+}
+
+static void* ngfvk_retire_worker_main(void* arg) {
+  ngfvk_retire_worker* worker = (ngfvk_retire_worker*)arg;
+  pthread_mutex_lock(&worker->lock);
+  for (;;) {
+    while (worker->nqueued == 0u && !worker->stop) {
+      pthread_cond_wait(&worker->cond, &worker->lock);
+    }
+    if (worker->nqueued == 0u) { break; }
+    ngfvk_frame_resources* batch = &worker->queue[worker->head];
+    pthread_mutex_unlock(&worker->lock);
+    ngfvk_destroy_retired_objects(batch);
+    pthread_mutex_lock(&worker->lock);
+    worker->head = (worker->head + 1u) % NGFVK_RETIRE_QUEUE_CAPACITY;
+    worker->nqueued--;
+    pthread_cond_broadcast(&worker->cond);
+  }
+  pthread_mutex_unlock(&worker->lock);
+  return NULL;
+}
+
+// Hands the retired objects of the given frame over to the worker, blocking if the queue is full.
+// The frame's lists are swapped with the (empty) lists of a free queue slot, so no copying or
+// allocation takes place.
+static void
+ngfvk_retire_worker_enqueue(ngfvk_retire_worker* worker, ngfvk_frame_resources* frame_res) {
+  pthread_mutex_lock(&worker->lock);
+  while (worker->nqueued == NGFVK_RETIRE_QUEUE_CAPACITY) {
+    pthread_cond_wait(&worker->cond, &worker->lock);
+  }
+  ngfvk_frame_resources* batch =
+      &worker->queue[(worker->head + worker->nqueued) % NGFVK_RETIRE_QUEUE_CAPACITY];
+  const ngfvk_frame_resources empty_lists = *batch;
+#define NGFVK_SWAP_RETIRE_LIST(name) \
+  batch->name     = frame_res->name; \
+  frame_res->name = empty_lists.name;
+  NGFVK_SWAP_RETIRE_LIST(retire_pipelines);
+  NGFVK_SWAP_RETIRE_LIST(retire_pipeline_layouts);
+  NGFVK_SWAP_RETIRE_LIST(retire_dset_layouts);
+  NGFVK_SWAP_RETIRE_LIST(retire_framebuffers);
+  NGFVK_SWAP_RETIRE_LIST(retire_render_passes);
+  NGFVK_SWAP_RETIRE_LIST(retire_samplers);
+  NGFVK_SWAP_RETIRE_LIST(retire_image_views);
+  NGFVK_SWAP_RETIRE_LIST(retire_buffer_views);
+  NGFVK_SWAP_RETIRE_LIST(retire_desc_pools);
+  NGFVK_SWAP_RETIRE_LIST(retire_query_pools);
+  NGFVK_SWAP_RETIRE_LIST(retire_cmd_pools);
+  NGFVK_SWAP_RETIRE_LIST(retire_images);
+  NGFVK_SWAP_RETIRE_LIST(retire_buffers);
+#undef NGFVK_SWAP_RETIRE_LIST
+  worker->nqueued++;
+  pthread_cond_broadcast(&worker->cond);
+  pthread_mutex_unlock(&worker->lock);
+}
+
+static ngfvk_retire_worker* ngfvk_retire_worker_create(void) {
+  ngfvk_retire_worker* worker = NGFI_ALLOC(ngfvk_retire_worker);
+  if (worker == NULL) { return NULL; }
+  memset(worker, 0, sizeof(ngfvk_retire_worker));
+  for (uint32_t i = 0u; i < NGFVK_RETIRE_QUEUE_CAPACITY; ++i) {
+    ngfvk_frame_resources* batch = &worker->queue[i];
+    NGFI_DARRAY_RESET(batch->retire_pipelines, 8);
+    NGFI_DARRAY_RESET(batch->retire_pipeline_layouts, 8);
+    NGFI_DARRAY_RESET(batch->retire_dset_layouts, 8);
+    NGFI_DARRAY_RESET(batch->retire_framebuffers, 8);
+    NGFI_DARRAY_RESET(batch->retire_render_passes, 8);
+    NGFI_DARRAY_RESET(batch->retire_samplers, 8);
+    NGFI_DARRAY_RESET(batch->retire_image_views, 8);
+    NGFI_DARRAY_RESET(batch->retire_buffer_views, 8);
+    NGFI_DARRAY_RESET(batch->retire_desc_pools, 8);
+    NGFI_DARRAY_RESET(batch->retire_query_pools, 8);
+    NGFI_DARRAY_RESET(batch->retire_cmd_pools, 8);
+    NGFI_DARRAY_RESET(batch->retire_images, 8);
+    NGFI_DARRAY_RESET(batch->retire_buffers, 8);
+  }
+  pthread_mutex_init(&worker->lock, NULL);
+  pthread_cond_init(&worker->cond, NULL);
+  if (pthread_create(&worker->thread, NULL, ngfvk_retire_worker_main, worker) != 0) {
+    pthread_cond_destroy(&worker->cond);
+    pthread_mutex_destroy(&worker->lock);
+    for (uint32_t i = 0u; i < NGFVK_RETIRE_QUEUE_CAPACITY; ++i) {
+      ngfvk_frame_resources* batch = &worker->queue[i];
+      NGFI_DARRAY_DESTROY(batch->retire_pipelines);
+      NGFI_DARRAY_DESTROY(batch->retire_pipeline_layouts);
+      NGFI_DARRAY_DESTROY(batch->retire_dset_layouts);
+      NGFI_DARRAY_DESTROY(batch->retire_framebuffers);
+      NGFI_DARRAY_DESTROY(batch->retire_render_passes);
+      NGFI_DARRAY_DESTROY(batch->retire_samplers);
+      NGFI_DARRAY_DESTROY(batch->retire_image_views);
+      NGFI_DARRAY_DESTROY(batch->retire_buffer_views);
+      NGFI_DARRAY_DESTROY(batch->retire_desc_pools);
+      NGFI_DARRAY_DESTROY(batch->retire_query_pools);
+      NGFI_DARRAY_DESTROY(batch->retire_cmd_pools);
+      NGFI_DARRAY_DESTROY(batch->retire_images);
+      NGFI_DARRAY_DESTROY(batch->retire_buffers);
+    }
+    NGFI_FREE(worker);
+    return NULL;
+  }
+  return worker;
+}
+
+// Waits for the worker to destroy all the objects queued up so far, then stops it and releases
+// its resources.
+static void ngfvk_retire_worker_destroy(ngfvk_retire_worker* worker) {
+  pthread_mutex_lock(&worker->lock);
+  worker->stop = true;
+  pthread_cond_broadcast(&worker->cond);
+  pthread_mutex_unlock(&worker->lock);
+  pthread_join(worker->thread, NULL);
+  pthread_cond_destroy(&worker->cond);
+  pthread_mutex_destroy(&worker->lock);
+  for (uint32_t i = 0u; i < NGFVK_RETIRE_QUEUE_CAPACITY; ++i) {
+    ngfvk_frame_resources* batch = &worker->queue[i];
+    NGFI_DARRAY_DESTROY(batch->retire_pipelines);
+    NGFI_DARRAY_DESTROY(batch->retire_pipeline_layouts);
+    NGFI_DARRAY_DESTROY(batch->retire_dset_layouts);
+    NGFI_DARRAY_DESTROY(batch->retire_framebuffers);
+    NGFI_DARRAY_DESTROY(batch->retire_render_passes);
+    NGFI_DARRAY_DESTROY(batch->retire_samplers);
+    NGFI_DARRAY_DESTROY(batch->retire_image_views);
+    NGFI_DARRAY_DESTROY(batch->retire_buffer_views);
+    NGFI_DARRAY_DESTROY(batch->retire_desc_pools);
+    NGFI_DARRAY_DESTROY(batch->retire_query_pools);
+    NGFI_DARRAY_DESTROY(batch->retire_cmd_pools);
+    NGFI_DARRAY_DESTROY(batch->retire_images);
+    NGFI_DARRAY_DESTROY(batch->retire_buffers);
+  }
+  NGFI_FREE(worker);
+}
+
+static void ngfvk_destroy_upload_chunk(ngfvk_upload_chunk* chunk) {
+  ngfvk_alloc* a = &chunk->buffer->alloc;
+  vmaDestroyBuffer(a->parent_allocator, (VkBuffer)a->obj_handle, a->vma_alloc);
+  NGFI_FREE(chunk->buffer);
+}
+
+// Carves out a region with the given size and alignment at the end of the chunk's used space.
+// Returns false if the chunk doesn't have enough room left.
+static bool ngfvk_upload_chunk_suballoc(
+    ngfvk_upload_chunk* chunk,
+    size_t              size,
+    size_t              alignment,
+    size_t*             offset) {
+  const size_t aligned = (chunk->used + alignment - 1u) & ~(alignment - 1u);
+  if (aligned + size > chunk->buffer->size) { return false; }
+  chunk->used = aligned + size;
+  *offset     = aligned;
+  return true;
+}
+
+// Makes the upload memory written since the last submission visible to the device.
+static void ngfvk_flush_upload_chunks(ngfvk_frame_resources* frame_res) {
+  NGFI_DARRAY_FOREACH(frame_res->upload_chunks, c) {
+    ngfvk_upload_chunk* chunk = &NGFI_DARRAY_AT(frame_res->upload_chunks, c);
+    if (chunk->used > chunk->flushed) {
+      vmaFlushAllocation(
+          CURRENT_CONTEXT->allocator,
+          chunk->buffer->alloc.vma_alloc,
+          chunk->flushed,
+          chunk->used - chunk->flushed);
+      chunk->flushed = chunk->used;
     }
-    superpool->active_pool = superpool->list;
   }
+}
 
-  NGFI_DARRAY_FOREACH(frame_res->cmd_bufs, i) {
-    if (frame_res->cmd_pools.data[i]) {
-      vkFreeCommandBuffers(
-          _vk.device,
-          frame_res->cmd_pools.data[i],
-          1,
-          &(frame_res->cmd_bufs.data[i]));
+// Copies the results of the queries written by the given frame into their pools. Must be called
+// after the frame's submissions have completed.
+static void ngfvk_read_back_query_results(ngfvk_frame_resources* frame_res) {
+  NGFI_DARRAY_FOREACH(frame_res->written_queries, r) {
+    const ngfvk_query_range* range  = &NGFI_DARRAY_AT(frame_res->written_queries, r);
+    const ngf_query_pool     pool   = range->pool;
+    const size_t             stride = sizeof(uint64_t) * (pool->nvalues + 1u);
+    // Results are read without waiting, so a query that was reset but never written (e.g. because
+    // its cmd buffer didn't reach the end of the pass) just reports being unavailable.
+    vkGetQueryPoolResults(
+        _vk.device,
+        pool->vk_pool,
+        range->first,
+        range->count,
+        stride * range->count,
+        &pool->results[range->first * (pool->nvalues + 1u)],
+        stride,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    // Timestamps may only have some of their bits be valid, depending on the queue that wrote them.
+    if (pool->type == NGF_QUERY_TYPE_TIMESTAMP) {
+      const uint64_t mask = _vk.timestamp_masks[range->queue];
+      for (uint32_t q = range->first; q < range->first + range->count; ++q) {
+        pool->results[q * (pool->nvalues + 1u)] &= mask;
+      }
     }
   }
+  NGFI_DARRAY_CLEAR(frame_res->written_queries);
+}
 
-  NGFI_DARRAY_FOREACH(frame_res->cmd_pools, i) {
-    if (frame_res->cmd_pools.data[i]) {
-      vkResetCommandPool(
+// Waits for the given frame's submissions to complete and recycles its resources. Retired objects
+// are handed off to `worker` for destruction if it's not NULL, otherwise they're destroyed inline.
+static void
+ngfvk_retire_resources(ngfvk_frame_resources* frame_res, ngfvk_retire_worker* worker) {
+  if (frame_res->nwait_fences > 0u) {
+    VkResult wait_status = VK_SUCCESS;
+    do {
+      wait_status = vkWaitForFences(
           _vk.device,
-          frame_res->cmd_pools.data[i],
-          VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT);
+          frame_res->nwait_fences,
+          frame_res->fences,
+          VK_TRUE,
+          0x3B9ACA00ul);
+    } while (wait_status == VK_TIMEOUT);
+    vkResetFences(_vk.device, frame_res->nwait_fences, frame_res->fences);
+    frame_res->nwait_fences = 0;
+  }
+  ngfvk_read_back_query_results(frame_res);
+
+  if (worker != NULL) {
+    ngfvk_retire_worker_enqueue(worker, frame_res);
+  } else {
+    ngfvk_destroy_retired_objects(frame_res);
+  }
+
+  NGFI_DARRAY_FOREACH(frame_res->real_retire_events, s) {
+    vkDestroyEvent(_vk.device, NGFI_DARRAY_AT(frame_res->real_retire_events, s), NULL);
+  }
+  NGFI_DARRAY_CLEAR(frame_res->real_retire_events);
+  NGFI_DARRAY_FOREACH(frame_res->retire_events, s) {
+    NGFI_DARRAY_APPEND(frame_res->real_retire_events, NGFI_DARRAY_AT(frame_res->retire_events, s));
+  }
+
+  NGFI_DARRAY_FOREACH(frame_res->retire_table_slots, s) {
+    const ngfvk_retired_table_slot* retired = &NGFI_DARRAY_AT(frame_res->retire_table_slots, s);
+    NGFI_DARRAY_APPEND(retired->table->free_slots, retired->slot);
+  }
+
+  // Bind group pools are also allocated from on the thread that the context is current on, so
+  // their sets are freed here rather than by the retirement thread.
+  NGFI_DARRAY_FOREACH(frame_res->retire_bind_group_sets, s) {
+    const ngfvk_retired_bind_group_set* retired =
+        &NGFI_DARRAY_AT(frame_res->retire_bind_group_sets, s);
+    vkFreeDescriptorSets(_vk.device, retired->vk_pool, 1u, &retired->vk_set);
+  }
+
+  // Upload chunks are kept around for reuse, except for the ones that were created to accommodate
+  // unusually large requests.
+  uint32_t nkept_chunks = 0u;
+  NGFI_DARRAY_FOREACH(frame_res->upload_chunks, c) {
+    ngfvk_upload_chunk chunk = NGFI_DARRAY_AT(frame_res->upload_chunks, c);
+    if (chunk.buffer->size > NGFVK_UPLOAD_CHUNK_SIZE) {
+      ngfvk_destroy_upload_chunk(&chunk);
+    } else {
+      chunk.used = chunk.flushed = 0u;
+      NGFI_DARRAY_AT(frame_res->upload_chunks, nkept_chunks++) = chunk;
     }
   }
+  NGFI_DARRAY_RESIZE(frame_res->upload_chunks, nkept_chunks);
+
+  // All of the frame's semaphores have been waited on by its submissions, so they're unsignaled
+  // again.
+  frame_res->nused_queue_semaphores   = 0u;
+  frame_res->compute_work_pending     = false;
+  frame_res->compute_wait_cmd_buf_idx = ~0u;
+  NGFI_DARRAY_CLEAR(frame_res->gfx_wait_semaphores);
+  NGFI_DARRAY_CLEAR(frame_res->xfer_acquire_buf_barriers);
+  NGFI_DARRAY_CLEAR(frame_res->xfer_acquire_img_barriers);
+  NGFI_DARRAY_CLEAR(frame_res->compute_release_buf_barriers);
+  NGFI_DARRAY_CLEAR(frame_res->compute_release_img_barriers);
 
   NGFI_DARRAY_CLEAR(frame_res->cmd_bufs);
-  NGFI_DARRAY_CLEAR(frame_res->cmd_pools);
-  NGFI_DARRAY_CLEAR(frame_res->retire_pipelines);
-  NGFI_DARRAY_CLEAR(frame_res->retire_dset_layouts);
-  NGFI_DARRAY_CLEAR(frame_res->retire_framebuffers);
-  NGFI_DARRAY_CLEAR(frame_res->retire_render_passes);
-  NGFI_DARRAY_CLEAR(frame_res->retire_samplers);
-  NGFI_DARRAY_CLEAR(frame_res->retire_image_views);
-  NGFI_DARRAY_CLEAR(frame_res->retire_buffer_views);
+  NGFI_DARRAY_CLEAR(frame_res->query_resets);
   NGFI_DARRAY_CLEAR(frame_res->retire_events);
-  NGFI_DARRAY_CLEAR(frame_res->retire_images);
-  NGFI_DARRAY_CLEAR(frame_res->retire_pipeline_layouts);
-  NGFI_DARRAY_CLEAR(frame_res->retire_buffers);
-  NGFI_DARRAY_CLEAR(frame_res->reset_desc_pools_lists);
+  NGFI_DARRAY_CLEAR(frame_res->retire_table_slots);
+  NGFI_DARRAY_CLEAR(frame_res->retire_bind_group_sets);
 }
 
+// Drops all pending bind ops. The storage is kept around to be reused by subsequent binds.
 static void ngfvk_cleanup_pending_binds(ngf_cmd_buffer cmd_buf) {
-  ngfvk_bind_op_chunk* chunk = cmd_buf->pending_bind_ops.first;
-  while (chunk) {
-    ngfvk_bind_op_chunk* next = chunk->next;
-    ngfi_blkalloc_free(CURRENT_CONTEXT->bind_op_chunk_allocator, chunk);
-    chunk = next;
+  NGFI_DARRAY_CLEAR(cmd_buf->pending_bind_ops);
+}
+
+// Checks whether a timestamp from the given pool may be recorded into the given cmd buffer.
+static ngf_error ngfvk_validate_timestamp_cmd(ngf_cmd_buffer cmd_buf, ngf_query_pool pool) {
+  if (cmd_buf->state != NGFI_CMD_BUFFER_READY &&
+      cmd_buf->state != NGFI_CMD_BUFFER_AWAITING_SUBMIT) {
+    NGFI_DIAG_ERROR("timestamps may only be recorded into started cmd buffers, outside of passes");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (cmd_buf->flags & (NGF_CMD_BUFFER_ASYNC_XFER | NGF_CMD_BUFFER_SECONDARY)) {
+    NGFI_DIAG_ERROR("timestamps may not be recorded into async transfer or secondary cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (pool != NULL && pool->type != NGF_QUERY_TYPE_TIMESTAMP) {
+    NGFI_DIAG_ERROR("timestamps may only be written to timestamp query pools");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  return NGF_ERROR_OK;
+}
+
+// Remembers that the given query is written by the cmd buffer, so that its result can be read back
+// once the cmd buffer's frame is retired.
+static void ngfvk_track_query(
+    ngf_cmd_buffer cmd_buf,
+    ngf_query_pool pool,
+    uint32_t       query,
+    bool           deferred_reset) {
+  if (!NGFI_DARRAY_EMPTY(cmd_buf->written_queries)) {
+    ngfvk_query_range* last = NGFI_DARRAY_BACKPTR(cmd_buf->written_queries);
+    if (last->pool == pool && last->deferred_reset == deferred_reset &&
+        last->first + last->count == query) {
+      last->count++;
+      return;
+    }
+  }
+  const ngfvk_query_range range = {
+      .pool           = pool,
+      .first          = query,
+      .count          = 1u,
+      .deferred_reset = deferred_reset,
+      .queue          = cmd_buf->queue};
+  NGFI_DARRAY_APPEND(cmd_buf->written_queries, range);
+}
+
+// Checks whether the given query has already been begun in the cmd buffer. Such queries are only
+// reset once at the start of the frame's submission, so they may not be begun again before then.
+static bool ngfvk_query_begun(ngf_cmd_buffer cmd_buf, ngf_query_pool pool, uint32_t query) {
+  NGFI_DARRAY_FOREACH(cmd_buf->written_queries, r) {
+    const ngfvk_query_range* range = &NGFI_DARRAY_AT(cmd_buf->written_queries, r);
+    if (range->pool == pool && range->deferred_reset && query >= range->first &&
+        query < range->first + range->count) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Records a timestamp write into the given queries, discarding their previous results. Queries
+// may not be reset inside of a render pass, so this must be recorded outside of one.
+static void ngfvk_cmd_write_timestamp(
+    ngf_cmd_buffer          cmd_buf,
+    ngf_query_pool          pool,
+    uint32_t                query,
+    uint32_t                nreset_queries,
+    VkPipelineStageFlagBits stage) {
+  vkCmdResetQueryPool(cmd_buf->vk_cmd_buffer, pool->vk_pool, query, nreset_queries);
+  vkCmdWriteTimestamp(cmd_buf->vk_cmd_buffer, stage, pool->vk_pool, query);
+  ngfvk_track_query(cmd_buf, pool, query, false);
+}
+
+static bool ngfvk_subresource_ranges_overlap(
+    const VkImageSubresourceRange* a,
+    const VkImageSubresourceRange* b) {
+  return a->baseMipLevel < b->baseMipLevel + b->levelCount &&
+         b->baseMipLevel < a->baseMipLevel + a->levelCount &&
+         a->baseArrayLayer < b->baseArrayLayer + b->layerCount &&
+         b->baseArrayLayer < a->baseArrayLayer + a->layerCount;
+}
+
+// Records the buffer copies deferred by the cmd buffer so far, preceded by a single barrier for all
+// of their destinations.
+static void ngfvk_flush_buffer_copies(ngf_cmd_buffer cmd_buf) {
+  if (NGFI_DARRAY_EMPTY(cmd_buf->pending_buf_copies)) { return; }
+  vkCmdPipelineBarrier(
+      cmd_buf->vk_cmd_buffer,
+      cmd_buf->pending_copy_src_stages,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0u,
+      0u,
+      NULL,
+      NGFI_DARRAY_SIZE(cmd_buf->xfer_pre_buf_barriers),
+      cmd_buf->xfer_pre_buf_barriers.data,
+      0u,
+      NULL);
+  NGFI_DARRAY_FOREACH(cmd_buf->pending_buf_copies, c) {
+    const ngfvk_buffer_copy* copy = &NGFI_DARRAY_AT(cmd_buf->pending_buf_copies, c);
+    vkCmdCopyBuffer(cmd_buf->vk_cmd_buffer, copy->src, copy->dst, 1u, &copy->region);
+  }
+  NGFI_DARRAY_CLEAR(cmd_buf->pending_buf_copies);
+  NGFI_DARRAY_CLEAR(cmd_buf->xfer_pre_buf_barriers);
+  cmd_buf->pending_copy_src_stages = 0u;
+}
+
+// Records all of the transfer barriers accumulated by the cmd buffer so far, in a single call.
+// The deferred copies that the barriers apply to are recorded first.
+static void ngfvk_flush_xfer_barriers(ngf_cmd_buffer cmd_buf) {
+  ngfvk_flush_buffer_copies(cmd_buf);
+  const uint32_t nbuf_barriers = NGFI_DARRAY_SIZE(cmd_buf->pending_xfer_buf_barriers);
+  const uint32_t nimg_barriers = NGFI_DARRAY_SIZE(cmd_buf->pending_xfer_img_barriers);
+  if (nbuf_barriers == 0u && nimg_barriers == 0u) { return; }
+  vkCmdPipelineBarrier(
+      cmd_buf->vk_cmd_buffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      cmd_buf->pending_xfer_dst_stages,
+      0u,
+      0u,
+      NULL,
+      nbuf_barriers,
+      cmd_buf->pending_xfer_buf_barriers.data,
+      nimg_barriers,
+      cmd_buf->pending_xfer_img_barriers.data);
+  NGFI_DARRAY_CLEAR(cmd_buf->pending_xfer_buf_barriers);
+  NGFI_DARRAY_CLEAR(cmd_buf->pending_xfer_img_barriers);
+  cmd_buf->pending_xfer_dst_stages = 0u;
+}
+
+// Flushes the pending transfer barriers if any of them affects the given range of a buffer, so
+// that a subsequent transfer command may access it. A size of VK_WHOLE_SIZE covers the remainder
+// of the buffer.
+static void ngfvk_xfer_sync_buffer(
+    ngf_cmd_buffer cmd_buf,
+    VkBuffer       buffer,
+    VkDeviceSize   offset,
+    VkDeviceSize   size) {
+  const VkDeviceSize end = size == VK_WHOLE_SIZE ? UINT64_MAX : offset + size;
+  NGFI_DARRAY_FOREACH(cmd_buf->pending_xfer_buf_barriers, b) {
+    const VkBufferMemoryBarrier* barrier = &NGFI_DARRAY_AT(cmd_buf->pending_xfer_buf_barriers, b);
+    if (barrier->buffer == buffer && barrier->offset < end &&
+        offset < barrier->offset + barrier->size) {
+      ngfvk_flush_xfer_barriers(cmd_buf);
+      return;
+    }
+  }
+}
+
+// Same as above, for a range of image subresources.
+static void ngfvk_xfer_sync_image(
+    ngf_cmd_buffer                 cmd_buf,
+    VkImage                        image,
+    const VkImageSubresourceRange* range) {
+  NGFI_DARRAY_FOREACH(cmd_buf->pending_xfer_img_barriers, b) {
+    const VkImageMemoryBarrier* barrier = &NGFI_DARRAY_AT(cmd_buf->pending_xfer_img_barriers, b);
+    if (barrier->image == image &&
+        ngfvk_subresource_ranges_overlap(&barrier->subresourceRange, range)) {
+      ngfvk_flush_xfer_barriers(cmd_buf);
+      return;
+    }
   }
-  cmd_buf->pending_bind_ops.first = cmd_buf->pending_bind_ops.last = NULL;
-  cmd_buf->pending_bind_ops.size                                   = 0u;
 }
 
 static ngf_error ngfvk_encoder_start(ngf_cmd_buffer cmd_buf) {
+  if (cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY) {
+    NGFI_DIAG_ERROR("secondary cmd buffers may only record parts of parallel render passes");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
   NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_RECORDING);
+  // Both of the pass' queries are reset here, since the end timestamp of a render pass is written
+  // right after the pass, when there's no opportunity to record a reset before it.
+  cmd_buf->active_pass_end_timestamp = ~0u;
+  if (cmd_buf->pass_timestamp_pool != NULL &&
+      cmd_buf->pass_timestamps_end - cmd_buf->next_pass_timestamp >= 2u) {
+    ngfvk_cmd_write_timestamp(
+        cmd_buf,
+        cmd_buf->pass_timestamp_pool,
+        cmd_buf->next_pass_timestamp,
+        2u,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    cmd_buf->active_pass_end_timestamp = cmd_buf->next_pass_timestamp + 1u;
+    cmd_buf->next_pass_timestamp += 2u;
+  }
   return NGF_ERROR_OK;
 }
 
 static ngf_error
 ngfvk_initialize_generic_encoder(ngf_cmd_buffer cmd_buf, struct ngfi_private_encoder_data* enc) {
-  enc->d0                          = (uintptr_t)cmd_buf;
+  enc->d0 = (uintptr_t)cmd_buf;
+  enc->d1 = (uintptr_t)VK_NULL_HANDLE;
+  // Events can't be set on the transfer queue. Work done there is synchronized with the graphics
+  // queue by semaphores at submission time instead.
+  if (cmd_buf->queue == NGFVK_QUEUE_XFER) { return NGF_ERROR_OK; }
   const VkEventCreateInfo event_ci = {
       .sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO,
       .pNext = NULL,
@@ -1334,16 +2307,31 @@ static ngf_error ngfvk_encoder_end(
     ngf_cmd_buffer                    cmd_buf,
     struct ngfi_private_encoder_data* generic_enc,
     VkPipelineStageFlags              stage_mask) {
-  vkCmdSetEvent(cmd_buf->vk_cmd_buffer, (VkEvent)generic_enc->d1, stage_mask);
   ngfvk_cleanup_pending_binds(cmd_buf);
-  const size_t fi = CURRENT_CONTEXT->frame_id;
-  NGFI_DARRAY_APPEND(CURRENT_CONTEXT->frame_res[fi].retire_events, (VkEvent)generic_enc->d1);
+  ngfvk_flush_xfer_barriers(cmd_buf);
+  if ((VkEvent)generic_enc->d1 != VK_NULL_HANDLE) {
+    vkCmdSetEvent(cmd_buf->vk_cmd_buffer, (VkEvent)generic_enc->d1, stage_mask);
+    NGFI_DARRAY_APPEND(cmd_buf->events, (VkEvent)generic_enc->d1);
+  }
+  if (cmd_buf->active_pass_end_timestamp != ~0u) {
+    vkCmdWriteTimestamp(
+        cmd_buf->vk_cmd_buffer,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        cmd_buf->pass_timestamp_pool->vk_pool,
+        cmd_buf->active_pass_end_timestamp);
+    ngfvk_track_query(
+        cmd_buf,
+        cmd_buf->pass_timestamp_pool,
+        cmd_buf->active_pass_end_timestamp,
+        false);
+    cmd_buf->active_pass_end_timestamp = ~0u;
+  }
   NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_AWAITING_SUBMIT);
   return NGF_ERROR_OK;
 }
 
 static void ngfvk_cmd_copy_buffer(
-    VkCommandBuffer      vkcmdbuf,
+    ngf_cmd_buffer       cmd_buf,
     VkBuffer             src,
     VkBuffer             dst,
     size_t               size,
@@ -1351,9 +2339,24 @@ static void ngfvk_cmd_copy_buffer(
     size_t               dst_offset,
     VkAccessFlags        usage_access_mask,
     VkPipelineStageFlags usage_stage_mask) {
-  const VkBufferCopy copy_region = {.srcOffset = src_offset, .dstOffset = dst_offset, .size = size};
-
-  VkBufferMemoryBarrier pre_xfer_mem_bar = {
+  // Copies that touch the results of the pending ones flush them, along with their barriers.
+  ngfvk_xfer_sync_buffer(cmd_buf, src, src_offset, size);
+  ngfvk_xfer_sync_buffer(cmd_buf, dst, dst_offset, size);
+  // Copies that overwrite the sources of the pending ones have to be ordered after them by a
+  // separate barrier.
+  NGFI_DARRAY_FOREACH(cmd_buf->pending_buf_copies, c) {
+    const ngfvk_buffer_copy* other = &NGFI_DARRAY_AT(cmd_buf->pending_buf_copies, c);
+    if (other->src == dst && other->region.srcOffset < dst_offset + size &&
+        dst_offset < other->region.srcOffset + other->region.size) {
+      ngfvk_flush_buffer_copies(cmd_buf);
+      break;
+    }
+  }
+  const ngfvk_buffer_copy copy = {
+      .src    = src,
+      .dst    = dst,
+      .region = {.srcOffset = src_offset, .dstOffset = dst_offset, .size = size}};
+  const VkBufferMemoryBarrier pre_xfer_mem_bar = {
       .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
       .pNext               = NULL,
       .buffer              = dst,
@@ -1363,20 +2366,11 @@ static void ngfvk_cmd_copy_buffer(
       .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
       .offset              = dst_offset,
       .size                = size};
-  vkCmdPipelineBarrier(
-      vkcmdbuf,
-      usage_stage_mask,
-      VK_PIPELINE_STAGE_TRANSFER_BIT,
-      0,
-      0u,
-      NULL,
-      1u,
-      &pre_xfer_mem_bar,
-      0,
-      NULL);
-  vkCmdCopyBuffer(vkcmdbuf, src, dst, 1u, &copy_region);
+  NGFI_DARRAY_APPEND(cmd_buf->xfer_pre_buf_barriers, pre_xfer_mem_bar);
+  NGFI_DARRAY_APPEND(cmd_buf->pending_buf_copies, copy);
+  cmd_buf->pending_copy_src_stages |= usage_stage_mask;
 
-  VkBufferMemoryBarrier post_xfer_mem_bar = {
+  const VkBufferMemoryBarrier post_xfer_mem_bar = {
       .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
       .pNext               = NULL,
       .buffer              = dst,
@@ -1386,46 +2380,148 @@ static void ngfvk_cmd_copy_buffer(
       .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
       .offset              = dst_offset,
       .size                = size};
-
-  vkCmdPipelineBarrier(
-      vkcmdbuf,
-      VK_PIPELINE_STAGE_TRANSFER_BIT,
-      usage_stage_mask,
-      0,
-      0u,
-      NULL,
-      1u,
-      &post_xfer_mem_bar,
-      0,
-      NULL);
-}
-
-static void ngfvk_destroy_cmd_pools(VkCommandPool* pools, uint32_t npools) {
+  NGFI_DARRAY_APPEND(cmd_buf->pending_xfer_buf_barriers, post_xfer_mem_bar);
+  cmd_buf->pending_xfer_dst_stages |= usage_stage_mask;
+}
+
+// Populates a pair of barriers that hand the ownership of a buffer range written on the queue
+// family `src_family` over to the graphics queue. The release barrier is recorded on the source
+// queue, and the matching acquire barrier on the graphics queue.
+static void ngfvk_buffer_ownership_barriers(
+    uint32_t               src_family,
+    VkAccessFlags          src_access_mask,
+    VkBuffer               buffer,
+    size_t                 offset,
+    size_t                 size,
+    VkAccessFlags          dst_access_mask,
+    VkBufferMemoryBarrier* release,
+    VkBufferMemoryBarrier* acquire) {
+  *release = (VkBufferMemoryBarrier){
+      .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      .pNext               = NULL,
+      .srcAccessMask       = src_access_mask,
+      .dstAccessMask       = 0u,
+      .srcQueueFamilyIndex = src_family,
+      .dstQueueFamilyIndex = _vk.gfx_family_idx,
+      .buffer              = buffer,
+      .offset              = offset,
+      .size                = size};
+  *acquire               = *release;
+  acquire->srcAccessMask = 0u;
+  acquire->dstAccessMask = dst_access_mask;
+}
+
+// Same as above, but for image subresources. The layout transition is specified identically in
+// both barriers, and is performed only once.
+static void ngfvk_image_ownership_barriers(
+    uint32_t                       src_family,
+    VkAccessFlags                  src_access_mask,
+    VkImage                        image,
+    const VkImageSubresourceRange* range,
+    VkImageLayout                  old_layout,
+    VkImageLayout                  new_layout,
+    VkAccessFlags                  dst_access_mask,
+    VkImageMemoryBarrier*          release,
+    VkImageMemoryBarrier*          acquire) {
+  *release = (VkImageMemoryBarrier){
+      .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      .pNext               = NULL,
+      .srcAccessMask       = src_access_mask,
+      .dstAccessMask       = 0u,
+      .oldLayout           = old_layout,
+      .newLayout           = new_layout,
+      .srcQueueFamilyIndex = src_family,
+      .dstQueueFamilyIndex = _vk.gfx_family_idx,
+      .image               = image,
+      .subresourceRange    = *range};
+  *acquire               = *release;
+  acquire->srcAccessMask = 0u;
+  acquire->dstAccessMask = dst_access_mask;
+}
+
+static void ngfvk_destroy_cmd_pools(ngfvk_cmd_pool* pools, uint32_t npools) {
   if (pools) {
     for (size_t i = 0; i < npools; ++i) {
-      if (pools[i]) { vkDestroyCommandPool(_vk.device, pools[i], NULL); }
+      // Destroying the pool frees all of its command buffers.
+      if (pools[i].vk_pool) { vkDestroyCommandPool(_vk.device, pools[i].vk_pool, NULL); }
+      NGFI_DARRAY_DESTROY(pools[i].cmd_bufs);
     }
     NGFI_FREEN(pools, npools);
   }
 }
 
 static ngf_error
-ngfvk_initialize_cmd_pools(uint32_t queue_family_idx, VkCommandPool* pools, uint32_t npools) {
-  memset(pools, 0, sizeof(VkCommandPool) * npools);
+ngfvk_initialize_cmd_pools(uint32_t queue_family_idx, ngfvk_cmd_pool* pools, uint32_t npools) {
+  memset(pools, 0, sizeof(ngfvk_cmd_pool) * npools);
   for (uint32_t i = 0; i < npools; ++i) {
     const VkCommandPoolCreateInfo pool_ci = {
         .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
         .pNext            = NULL,
         .queueFamilyIndex = queue_family_idx,
         .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT};
-    if (vkCreateCommandPool(_vk.device, &pool_ci, NULL, &pools[i]) != VK_SUCCESS)
+    NGFI_DARRAY_RESET(pools[i].cmd_bufs, 4u);
+    if (vkCreateCommandPool(_vk.device, &pool_ci, NULL, &pools[i].vk_pool) != VK_SUCCESS)
       return NGF_ERROR_OBJECT_CREATION_FAILED;
   }
   return NGF_ERROR_OK;
 }
 
+// Hands out a command buffer from the given pool, reusing one that has been returned by a
+// previous reset if possible.
+static ngf_error ngfvk_cmd_pool_acquire(
+    ngfvk_cmd_pool*    pool,
+    ngf_context_stats* stats,
+    VkCommandBuffer*   cmd_buf) {
+  if (pool->nused < NGFI_DARRAY_SIZE(pool->cmd_bufs)) {
+    *cmd_buf = NGFI_DARRAY_AT(pool->cmd_bufs, pool->nused++);
+    return NGF_ERROR_OK;
+  }
+  const VkCommandBufferAllocateInfo vk_cmdbuf_info = {
+      .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+      .pNext              = NULL,
+      .commandPool        = pool->vk_pool,
+      .level              = pool->level,
+      .commandBufferCount = 1u};
+  const VkResult vk_err = vkAllocateCommandBuffers(_vk.device, &vk_cmdbuf_info, cmd_buf);
+  if (vk_err != VK_SUCCESS) {
+    NGFI_DIAG_ERROR("Failed to allocate cmd buffer, VK error: %d", vk_err);
+    return NGF_ERROR_OBJECT_CREATION_FAILED;
+  }
+  NGFI_DARRAY_APPEND(pool->cmd_bufs, *cmd_buf);
+  pool->nused++;
+  stats->cmd_buffer_allocations++;
+  return NGF_ERROR_OK;
+}
+
+// Returns all command buffers handed out by the pool back to it. Memory held by the command
+// buffers is kept around to be reused by subsequent recordings.
+static void ngfvk_cmd_pool_reset(ngfvk_cmd_pool* pool) {
+  if (pool->nused > 0u) {
+    vkResetCommandPool(_vk.device, pool->vk_pool, 0u);
+    pool->nused = 0u;
+  }
+}
+
+// Resets the command pools that the given context's frame allocated its command buffers from.
+// Must only be called once all of that frame's submissions have completed.
+static void ngfvk_reset_cmd_pools_for_frame(ngf_context ctx, uint32_t frame_id) {
+  const uint16_t ctx_id = (uint16_t)((uintptr_t)ctx & 0xffff);
+  NGFI_DARRAY_FOREACH(ctx->command_superpools, i) {
+    ngfvk_command_superpool* superpool = &NGFI_DARRAY_AT(ctx->command_superpools, i);
+    if (superpool->ctx_id != ctx_id || frame_id >= superpool->num_pools) { continue; }
+    for (uint32_t q = 0u; q < NGFVK_QUEUE_COUNT; ++q) {
+      if (superpool->cmd_pools[q] != NULL) {
+        ngfvk_cmd_pool_reset(&superpool->cmd_pools[q][frame_id]);
+      }
+    }
+  }
+}
+
 static void ngfvk_destroy_command_superpool(ngfvk_command_superpool* superpool) {
-  ngfvk_destroy_cmd_pools(superpool->cmd_pools, superpool->num_pools);
+  for (uint32_t q = 0u; q < NGFVK_QUEUE_COUNT; ++q) {
+    ngfvk_destroy_cmd_pools(superpool->cmd_pools[q], superpool->num_pools);
+    superpool->cmd_pools[q] = NULL;
+  }
 }
 
 static ngf_error ngfvk_initialize_command_superpool(
@@ -1435,15 +2531,25 @@ static ngf_error ngfvk_initialize_command_superpool(
   ngf_error err        = NGF_ERROR_OK;
   superpool->ctx_id    = ctx_id;
   superpool->num_pools = npools;
-  superpool->cmd_pools = NGFI_ALLOCN(VkCommandPool, npools);
-  if (superpool->cmd_pools == NULL) {
-    err = NGF_ERROR_OUT_OF_MEM;
-    goto ngfvk_initialize_command_superpool_cleanup;
-  }
-  if (ngfvk_initialize_cmd_pools(_vk.gfx_family_idx, superpool->cmd_pools, npools) !=
-      NGF_ERROR_OK) {
-    err = NGF_ERROR_OBJECT_CREATION_FAILED;
-    goto ngfvk_initialize_command_superpool_cleanup;
+  const uint32_t family_idxs[NGFVK_QUEUE_COUNT] = {
+      [NGFVK_QUEUE_GFX]     = _vk.gfx_family_idx,
+      [NGFVK_QUEUE_XFER]    = _vk.xfer_queue != VK_NULL_HANDLE ? _vk.xfer_family_idx
+                                                                : NGFVK_INVALID_IDX,
+      [NGFVK_QUEUE_COMPUTE] = _vk.compute_queue != VK_NULL_HANDLE ? _vk.compute_family_idx
+                                                                  : NGFVK_INVALID_IDX};
+  for (uint32_t q = 0u; q < NGFVK_QUEUE_COUNT; ++q) {
+    superpool->cmd_pools[q] = NULL;
+    if (family_idxs[q] == NGFVK_INVALID_IDX) { continue; }
+    superpool->cmd_pools[q] = NGFI_ALLOCN(ngfvk_cmd_pool, npools);
+    if (superpool->cmd_pools[q] == NULL) {
+      err = NGF_ERROR_OUT_OF_MEM;
+      goto ngfvk_initialize_command_superpool_cleanup;
+    }
+    if (ngfvk_initialize_cmd_pools(family_idxs[q], superpool->cmd_pools[q], npools) !=
+        NGF_ERROR_OK) {
+      err = NGF_ERROR_OBJECT_CREATION_FAILED;
+      goto ngfvk_initialize_command_superpool_cleanup;
+    }
   }
 
 ngfvk_initialize_command_superpool_cleanup:
@@ -1478,28 +2584,20 @@ static ngfvk_command_superpool* ngfvk_find_command_superpool(uint16_t ctx_id, ui
 
 static ngf_error ngfvk_cmd_buffer_allocate_for_frame(
     ngf_frame_token  frame_token,
-    VkCommandPool*   pool,
+    ngfvk_queue      queue,
     VkCommandBuffer* cmd_buf) {
   const ngfvk_command_superpool* superpool = ngfvk_find_command_superpool(
       ngfi_frame_ctx_id(frame_token),
       ngfi_frame_max_inflight_frames(frame_token));
-  if (superpool == NULL || superpool->cmd_pools == NULL) {
+  if (superpool == NULL || superpool->cmd_pools[queue] == NULL) {
     NGFI_DIAG_ERROR("failed to allocate command buffer");
     return NGF_ERROR_OBJECT_CREATION_FAILED;
   }
-  const VkCommandPool* pools                       = superpool->cmd_pools;
-  *pool                                            = pools[ngfi_frame_id(frame_token)];
-  const VkCommandBufferAllocateInfo vk_cmdbuf_info = {
-      .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-      .pNext              = NULL,
-      .commandPool        = *pool,
-      .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-      .commandBufferCount = 1u};
-  const VkResult vk_err = vkAllocateCommandBuffers(_vk.device, &vk_cmdbuf_info, cmd_buf);
-  if (vk_err != VK_SUCCESS) {
-    NGFI_DIAG_ERROR("Failed to allocate cmd buffer, VK error: %d", vk_err);
-    return NGF_ERROR_OBJECT_CREATION_FAILED;
-  }
+  const ngf_error err = ngfvk_cmd_pool_acquire(
+      &superpool->cmd_pools[queue][ngfi_frame_id(frame_token)],
+      &CURRENT_CONTEXT->stats,
+      cmd_buf);
+  if (err != NGF_ERROR_OK) { return err; }
   const VkCommandBufferBeginInfo cmd_buf_begin = {
       .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
       .pNext            = NULL,
@@ -1509,57 +2607,10 @@ static ngf_error ngfvk_cmd_buffer_allocate_for_frame(
   return NGF_ERROR_OK;
 }
 
-static ngf_error
-ngfvk_create_desc_superpool(ngfvk_desc_superpool* superpool, uint8_t pools_lists, uint16_t ctx_id) {
-  superpool->ctx_id      = ctx_id;
-  superpool->pools_lists = NGFI_ALLOCN(ngfvk_desc_pools_list, pools_lists);
-  superpool->num_lists   = pools_lists;
-  memset(superpool->pools_lists, 0, pools_lists * sizeof(ngfvk_desc_pools_list));
-  return NGF_ERROR_OK;
-}
-
-static void ngfvk_destroy_desc_superpool(ngfvk_desc_superpool* superpool) {
-  for (uint8_t i = 0u; i < superpool->num_lists; ++i) {
-    ngfvk_desc_pool* p = superpool->pools_lists[i].list;
-    while (p) {
-      vkDestroyDescriptorPool(_vk.device, p->vk_pool, NULL);
-      ngfvk_desc_pool* next = p->next;
-      NGFI_FREE(p);
-      p = next;
-    }
-  }
-  NGFI_FREEN(superpool->pools_lists, superpool->num_lists);
-}
-
-static ngfvk_desc_pools_list* ngfvk_find_desc_pools_list(ngf_frame_token token) {
-  const uint16_t ctx_id   = ngfi_frame_ctx_id(token);
-  const uint8_t  nframes  = ngfi_frame_max_inflight_frames(token);
-  const uint8_t  frame_id = ngfi_frame_id(token);
-
-  ngfvk_desc_superpool* superpool = NULL;
-  NGFI_DARRAY_FOREACH(CURRENT_CONTEXT->desc_superpools, i) {
-    if (CURRENT_CONTEXT->desc_superpools.data[i].ctx_id == ctx_id) {
-      superpool = &CURRENT_CONTEXT->desc_superpools.data[i];
-      break;
-    }
-  }
-
-  if (superpool == NULL) {
-    ngfvk_desc_superpool new_superpool = {
-        .ctx_id      = (uint16_t)~0,
-        .num_lists   = 0,
-        .pools_lists = NULL};
-    NGFI_DARRAY_APPEND(CURRENT_CONTEXT->desc_superpools, new_superpool);
-    superpool = NGFI_DARRAY_BACKPTR(CURRENT_CONTEXT->desc_superpools);
-    ngfvk_create_desc_superpool(superpool, nframes, ctx_id);
-  }
-
-  return &superpool->pools_lists[frame_id];
-}
-
 static VkDescriptorSet ngfvk_desc_pools_list_allocate_set(
     ngfvk_desc_pools_list*       pools,
-    const ngfvk_desc_set_layout* set_layout) {
+    const ngfvk_desc_set_layout* set_layout,
+    ngf_context_stats*           stats) {
   // Ensure we have an active desriptor pool that is able to service the
   // request.
   const bool have_active_pool    = (pools->active_pool != NULL);
@@ -1573,16 +2624,14 @@ static VkDescriptorSet ngfvk_desc_pools_list_allocate_set(
     ngfvk_desc_pool_capacity*       usage    = &pool->utilization;
     for (ngf_descriptor_type i = 0; !fresh_pool_required && i < NGF_DESCRIPTOR_TYPE_COUNT; ++i) {
       fresh_pool_required |=
-          (usage->descriptors[i] + set_layout->counts[i] >= capacity->descriptors[i]);
+          (usage->descriptors[i] + set_layout->counts[i] > capacity->descriptors[i]);
     }
-    fresh_pool_required |= (usage->sets + 1u >= capacity->sets);
+    fresh_pool_required |= (usage->sets + 1u > capacity->sets);
   }
   if (fresh_pool_required) {
     if (!have_active_pool || pools->active_pool->next == NULL) {
-      // TODO: make this tweakable
       ngfvk_desc_pool_capacity capacity;
-      capacity.sets = 100u;
-      for (int i = 0; i < NGF_DESCRIPTOR_TYPE_COUNT; ++i) capacity.descriptors[i] = 100u;
+      ngfvk_desc_pool_capacity_for_new_pool(pools, set_layout, &capacity);
 
       // Prepare descriptor counts.
       VkDescriptorPoolSize* vk_pool_sizes =
@@ -1617,6 +2666,7 @@ static VkDescriptorSet ngfvk_desc_pools_list_allocate_set(
           assert(false);
         }
         pools->active_pool = new_pool;
+        stats->descriptor_pools_created++;
       } else {
         NGFI_FREE(new_pool);
         assert(false);
@@ -1643,12 +2693,220 @@ static VkDescriptorSet ngfvk_desc_pools_list_allocate_set(
   // Update usage counters for the active descriptor pool.
   for (ngf_descriptor_type i = 0; i < NGF_DESCRIPTOR_TYPE_COUNT; ++i) {
     pool->utilization.descriptors[i] += set_layout->counts[i];
+    pools->frame_usage.descriptors[i] += set_layout->counts[i];
   }
   pool->utilization.sets++;
+  pools->frame_usage.sets++;
 
   return result;
 }
 
+// A pending bind operation along with its position in the command buffer.
+typedef struct ngfvk_sorted_bind_op {
+  const ngf_resource_bind_op* op;
+  uint32_t                    seq;
+} ngfvk_sorted_bind_op;
+
+static int ngfvk_sorted_bind_op_comparator(const void* a, const void* b) {
+  const ngfvk_sorted_bind_op* a_op = a;
+  const ngfvk_sorted_bind_op* b_op = b;
+  if (a_op->op->target_set != b_op->op->target_set)
+    return a_op->op->target_set < b_op->op->target_set ? -1 : 1;
+  if (a_op->op->target_binding != b_op->op->target_binding)
+    return a_op->op->target_binding < b_op->op->target_binding ? -1 : 1;
+  return a_op->seq < b_op->seq ? -1 : (a_op->seq > b_op->seq ? 1 : 0);
+}
+
+// Produces the descriptor set cache key entry corresponding to the given bind op. Native handles
+// are used instead of nicegraf object pointers because the latter may be reused within a frame
+// after the objects are destroyed, while the native handles stay alive until the frame retires.
+static void
+ngfvk_desc_cache_key_entry_for_op(const ngf_resource_bind_op* op, ngfvk_desc_cache_key_entry* e) {
+  memset(e, 0, sizeof(ngfvk_desc_cache_key_entry));
+  e->binding = op->target_binding;
+  e->type    = (uint32_t)op->type;
+  switch (op->type) {
+  case NGF_DESCRIPTOR_STORAGE_BUFFER:
+  case NGF_DESCRIPTOR_UNIFORM_BUFFER:
+    e->handles[0] = (uint64_t)op->info.buffer.buffer->alloc.obj_handle;
+    e->offset     = (uint64_t)op->info.buffer.offset;
+    e->range      = (uint64_t)op->info.buffer.range;
+    break;
+  case NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC:
+    // The offset is supplied when binding the set, so sets differing only in offset are shared.
+    e->handles[0] = (uint64_t)op->info.buffer.buffer->alloc.obj_handle;
+    e->range      = (uint64_t)op->info.buffer.range;
+    break;
+  case NGF_DESCRIPTOR_TEXEL_BUFFER:
+    memcpy(
+        &e->handles[0],
+        &op->info.texel_buffer_view->vk_buf_view,
+        sizeof(op->info.texel_buffer_view->vk_buf_view));
+    break;
+  case NGF_DESCRIPTOR_IMAGE:
+  case NGF_DESCRIPTOR_STORAGE_IMAGE:
+    memcpy(&e->handles[0], &op->info.image_sampler.image->vkview, sizeof(VkImageView));
+    break;
+  case NGF_DESCRIPTOR_SAMPLER:
+    memcpy(&e->handles[1], &op->info.image_sampler.sampler->vksampler, sizeof(VkSampler));
+    break;
+  case NGF_DESCRIPTOR_IMAGE_AND_SAMPLER:
+    memcpy(&e->handles[0], &op->info.image_sampler.image->vkview, sizeof(VkImageView));
+    memcpy(&e->handles[1], &op->info.image_sampler.sampler->vksampler, sizeof(VkSampler));
+    break;
+  default:
+    assert(false);
+  }
+}
+
+// Fills out the vulkan descriptor buffer info for the given buffer bind operation.
+static void ngfvk_desc_buffer_info_for_op(
+    const ngf_resource_bind_op* bind_op,
+    VkDescriptorBufferInfo*     vk_bind_info) {
+  const ngf_buffer_bind_info* bind_info = &bind_op->info.buffer;
+  vk_bind_info->buffer                  = (VkBuffer)bind_info->buffer->alloc.obj_handle;
+  vk_bind_info->offset =
+      bind_op->type == NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC ? 0u : bind_info->offset;
+  vk_bind_info->range = bind_info->range;
+}
+
+// Fills out the vulkan descriptor image info for the given image or sampler bind operation.
+static void ngfvk_desc_image_info_for_op(
+    const ngf_resource_bind_op* bind_op,
+    VkDescriptorImageInfo*      vk_bind_info) {
+  const ngf_image_sampler_bind_info* bind_info = &bind_op->info.image_sampler;
+  vk_bind_info->imageView                      = VK_NULL_HANDLE;
+  vk_bind_info->imageLayout                    = VK_IMAGE_LAYOUT_UNDEFINED;
+  vk_bind_info->sampler                        = VK_NULL_HANDLE;
+  if (bind_op->type == NGF_DESCRIPTOR_IMAGE || bind_op->type == NGF_DESCRIPTOR_IMAGE_AND_SAMPLER) {
+    vk_bind_info->imageView     = bind_info->image->vkview;
+    const bool is_storage_image = bind_info->image->usage_flags & NGF_IMAGE_USAGE_STORAGE;
+    vk_bind_info->imageLayout   = (is_storage_image) ? VK_IMAGE_LAYOUT_GENERAL
+                                                     : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  } else if (bind_op->type == NGF_DESCRIPTOR_STORAGE_IMAGE) {
+    vk_bind_info->imageView   = bind_info->image->vkview;
+    vk_bind_info->imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+  }
+  if (bind_op->type == NGF_DESCRIPTOR_SAMPLER ||
+      bind_op->type == NGF_DESCRIPTOR_IMAGE_AND_SAMPLER) {
+    vk_bind_info->sampler = bind_info->sampler->vksampler;
+  }
+}
+
+// Constructs a vulkan descriptor set write corresponding to the given bind operation.
+static void ngfvk_write_for_bind_op(
+    const ngf_resource_bind_op* bind_op,
+    VkDescriptorSet             set,
+    VkWriteDescriptorSet*       vk_write) {
+  vk_write->sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  vk_write->pNext            = NULL;
+  vk_write->dstSet           = set;
+  vk_write->dstBinding       = bind_op->target_binding;
+  vk_write->descriptorCount  = 1u;
+  vk_write->dstArrayElement  = 0u;
+  vk_write->descriptorType   = get_vk_descriptor_type(bind_op->type);
+  vk_write->pBufferInfo      = NULL;
+  vk_write->pImageInfo       = NULL;
+  vk_write->pTexelBufferView = NULL;
+
+  switch (bind_op->type) {
+  case NGF_DESCRIPTOR_STORAGE_BUFFER:
+  case NGF_DESCRIPTOR_UNIFORM_BUFFER:
+  case NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC: {
+    VkDescriptorBufferInfo* vk_bind_info =
+        ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkDescriptorBufferInfo));
+    ngfvk_desc_buffer_info_for_op(bind_op, vk_bind_info);
+    vk_write->pBufferInfo = vk_bind_info;
+    break;
+  }
+  case NGF_DESCRIPTOR_TEXEL_BUFFER: {
+    vk_write->pTexelBufferView = &(bind_op->info.texel_buffer_view->vk_buf_view);
+    break;
+  }
+  case NGF_DESCRIPTOR_STORAGE_IMAGE:
+  case NGF_DESCRIPTOR_IMAGE:
+  case NGF_DESCRIPTOR_SAMPLER:
+  case NGF_DESCRIPTOR_IMAGE_AND_SAMPLER: {
+    VkDescriptorImageInfo* vk_bind_info =
+        ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkDescriptorImageInfo));
+    ngfvk_desc_image_info_for_op(bind_op, vk_bind_info);
+    vk_write->pImageInfo = vk_bind_info;
+    break;
+  }
+
+  default:
+    assert(false);
+  }
+}
+
+// Fills out the payload for updating a descriptor set with the given set layout's update
+// template. The bind ops must be sorted by binding. Returns false if the template can't be used
+// for the given bind ops, which is the case unless they cover every binding in the set exactly
+// once, with matching descriptor types.
+static bool ngfvk_desc_template_payload_for_ops(
+    const ngfvk_desc_set_layout*       set_layout,
+    const ngf_resource_bind_op* const* ops,
+    uint32_t                           nops,
+    ngfvk_desc_template_slot*          payload) {
+  if (nops != set_layout->ntemplate_entries) { return false; }
+  for (uint32_t i = 0u; i < nops; ++i) {
+    if (ops[i]->target_binding != set_layout->template_entries[i].binding ||
+        ops[i]->type != set_layout->template_entries[i].type) {
+      return false;
+    }
+  }
+  for (uint32_t i = 0u; i < nops; ++i) {
+    switch (ops[i]->type) {
+    case NGF_DESCRIPTOR_STORAGE_BUFFER:
+    case NGF_DESCRIPTOR_UNIFORM_BUFFER:
+    case NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC:
+      ngfvk_desc_buffer_info_for_op(ops[i], &payload[i].buffer);
+      break;
+    case NGF_DESCRIPTOR_TEXEL_BUFFER:
+      payload[i].texel_buffer_view = ops[i]->info.texel_buffer_view->vk_buf_view;
+      break;
+    case NGF_DESCRIPTOR_STORAGE_IMAGE:
+    case NGF_DESCRIPTOR_IMAGE:
+    case NGF_DESCRIPTOR_SAMPLER:
+    case NGF_DESCRIPTOR_IMAGE_AND_SAMPLER:
+      ngfvk_desc_image_info_for_op(ops[i], &payload[i].image);
+      break;
+    default:
+      assert(false);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the position of the dynamic offset for the given binding among the dynamic offsets of the
+// given set layout, or ~0u if the binding isn't a dynamic uniform buffer.
+static uint32_t
+ngfvk_dynamic_offset_index(const ngfvk_desc_set_layout* set_layout, uint32_t binding) {
+  for (uint32_t i = 0u; i < set_layout->ndynamic_bindings; ++i) {
+    if (set_layout->dynamic_bindings[i] == binding) { return i; }
+  }
+  return ~0u;
+}
+
+// Records the offset of the given bind op into the array of dynamic offsets for its set. Returns
+// false if the op targets a binding which isn't a dynamic uniform buffer.
+static bool ngfvk_dynamic_offset_for_op(
+    const ngfvk_desc_set_layout* set_layout,
+    const ngf_resource_bind_op*  op,
+    uint32_t*                    dynamic_offsets) {
+  const uint32_t idx = ngfvk_dynamic_offset_index(set_layout, op->target_binding);
+  if (idx == ~0u) {
+    NGFI_DIAG_ERROR(
+        "binding %u of set %u is not a dynamic uniform buffer",
+        op->target_binding,
+        op->target_set);
+    return false;
+  }
+  dynamic_offsets[idx] = (uint32_t)op->info.buffer.offset;
+  return true;
+}
+
 static void ngfvk_execute_pending_binds(ngf_cmd_buffer cmd_buf) {
   // Binding resources requires an active pipeline.
   ngfvk_generic_pipeline* pipeline_data = NULL;
@@ -1669,138 +2927,154 @@ static void ngfvk_execute_pending_binds(ngf_cmd_buffer cmd_buf) {
   ngfi_sa_reset(ngfi_tmp_store());
 
   // Allocate an array of descriptor set handles from temporary storage and
-  // set them all to null. As we process bind operations, we'll allocate
+  // set them all to null. As we process bind operations, we'll find or allocate
   // descriptor sets and put them into the array as necessary.
   const size_t     vk_desc_sets_size_bytes = sizeof(VkDescriptorSet) * ndesc_set_layouts;
   VkDescriptorSet* vk_desc_sets = ngfi_sa_alloc(ngfi_tmp_store(), vk_desc_sets_size_bytes);
   memset(vk_desc_sets, (uintptr_t)VK_NULL_HANDLE, vk_desc_sets_size_bytes);
 
-  const uint32_t nbind_operations = cmd_buf->pending_bind_ops.size;
+  // Dynamic offsets for each set, in the order expected by the set's layout.
+  const size_t dynamic_offsets_size_bytes =
+      sizeof(uint32_t) * NGFVK_MAX_DYNAMIC_UNIFORM_BUFFERS_PER_SET * ndesc_set_layouts;
+  uint32_t* dynamic_offsets = ngfi_sa_alloc(ngfi_tmp_store(), dynamic_offsets_size_bytes);
+  memset(dynamic_offsets, 0, dynamic_offsets_size_bytes);
+
+  const uint32_t nbind_operations = NGFI_DARRAY_SIZE(cmd_buf->pending_bind_ops);
+
+  // Gather all pending bind ops and sort them by set and binding, so that the ops targeting
+  // the same set can be turned into a cache key.
+  ngfvk_sorted_bind_op* sorted_ops =
+      ngfi_sa_alloc(ngfi_tmp_store(), nbind_operations * sizeof(ngfvk_sorted_bind_op));
+  uint32_t nsorted_ops = 0u;
+  NGFI_DARRAY_FOREACH(cmd_buf->pending_bind_ops, boi) {
+    const ngf_resource_bind_op* bind_op = &NGFI_DARRAY_AT(cmd_buf->pending_bind_ops, boi);
+
+    // Ensure that a valid descriptor set is referenced by this
+    // bind operation.
+    if (bind_op->target_set >= ndesc_set_layouts) {
+      NGFI_DIAG_ERROR(
+          "invalid descriptor set %d referenced by bind operation (max. "
+          "allowed is %d)",
+          bind_op->target_set,
+          ndesc_set_layouts);
+      return;
+    }
+    if (NGFI_DARRAY_AT(pipeline_data->descriptor_set_layouts, bind_op->target_set)
+            .resource_table) {
+      NGFI_DIAG_ERROR(
+          "set %d is reserved for resource tables, bind one with ngf_cmd_bind_resource_table",
+          bind_op->target_set);
+      return;
+    }
+    sorted_ops[nsorted_ops].op  = bind_op;
+    sorted_ops[nsorted_ops].seq = nsorted_ops;
+    ++nsorted_ops;
+  }
+  qsort(sorted_ops, nsorted_ops, sizeof(ngfvk_sorted_bind_op), ngfvk_sorted_bind_op_comparator);
 
-  // Allocate an array of vulkan descriptor set writes from temp storage, one write per
+  // Allocate an array of vulkan descriptor set writes from temp storage, at most one write per
   // pending bind op.
   VkWriteDescriptorSet* vk_writes =
       ngfi_sa_alloc(ngfi_tmp_store(), nbind_operations * sizeof(VkWriteDescriptorSet));
-
-  // Find a descriptor pools list to allocate from.
-  ngfvk_desc_pools_list* pools = ngfvk_find_desc_pools_list(cmd_buf->parent_frame);
-  cmd_buf->desc_pools_list     = pools;
-
-  // Process each bind operation, constructing a corresponding
-  // vulkan descriptor set write operation.
-  ngfvk_bind_op_chunk* chunk                = cmd_buf->pending_bind_ops.first;
-  uint32_t             descriptor_write_idx = 0u;
-  while (chunk) {
-    for (size_t boi = 0; boi < chunk->last_idx; ++boi) {
-      const ngf_resource_bind_op* bind_op = &chunk->data[boi];
-
-      // Ensure that a valid descriptor set is referenced by this
-      // bind operation.
-      if (bind_op->target_set >= ndesc_set_layouts) {
-        NGFI_DIAG_ERROR(
-            "invalid descriptor set %d referenced by bind operation (max. "
-            "allowed is %d)",
-            bind_op->target_set,
-            ndesc_set_layouts);
-        return;
+  const ngf_resource_bind_op** write_ops =
+      ngfi_sa_alloc(ngfi_tmp_store(), nbind_operations * sizeof(ngf_resource_bind_op*));
+  ngfvk_desc_cache_key_entry* key =
+      ngfi_sa_alloc(ngfi_tmp_store(), nbind_operations * sizeof(ngfvk_desc_cache_key_entry));
+
+  ngfvk_desc_pools_list* pools =
+      &cmd_buf->frame_res[ngfi_frame_id(cmd_buf->parent_frame)].desc_pools;
+
+  // Process the bind operations one set at a time. For each set, either reuse an identical
+  // descriptor set written earlier in the frame, or allocate a new one and write to it.
+  uint32_t descriptor_write_idx = 0u;
+  uint32_t first_op_in_set      = 0u;
+  while (first_op_in_set < nsorted_ops) {
+    const uint32_t set_idx        = sorted_ops[first_op_in_set].op->target_set;
+    uint32_t       end_op_in_set  = first_op_in_set;
+    uint32_t       nkey_entries   = 0u;
+    const uint32_t set_write_base = descriptor_write_idx;
+    const ngfvk_desc_set_layout* set_layout =
+        &NGFI_DARRAY_AT(pipeline_data->descriptor_set_layouts, set_idx);
+    uint32_t* set_dynamic_offsets =
+        &dynamic_offsets[set_idx * NGFVK_MAX_DYNAMIC_UNIFORM_BUFFERS_PER_SET];
+    while (end_op_in_set < nsorted_ops && sorted_ops[end_op_in_set].op->target_set == set_idx) {
+      const ngf_resource_bind_op* bind_op = sorted_ops[end_op_in_set++].op;
+
+      // If the same binding is written several times, only the last write matters.
+      if (end_op_in_set < nsorted_ops && sorted_ops[end_op_in_set].op->target_set == set_idx &&
+          sorted_ops[end_op_in_set].op->target_binding == bind_op->target_binding) {
+        continue;
       }
-
-      // Allocate a new descriptor set if necessary.
-      const bool need_new_desc_set = vk_desc_sets[bind_op->target_set] == VK_NULL_HANDLE;
-      if (need_new_desc_set) {
-        // Find the corresponding descriptor set layout.
-        const ngfvk_desc_set_layout* set_layout =
-            &NGFI_DARRAY_AT(pipeline_data->descriptor_set_layouts, bind_op->target_set);
-        VkDescriptorSet set = ngfvk_desc_pools_list_allocate_set(pools, set_layout);
-        if (set == VK_NULL_HANDLE) {
-          NGFI_DIAG_WARNING(
-              "Failed to bind graphics resources - could not allocate descriptor set");
-          return;
-        }
-        vk_desc_sets[bind_op->target_set] = set;
+      if (bind_op->type == NGF_DESCRIPTOR_STORAGE_IMAGE && cmd_buf->renderpass_active) {
+        NGFI_DIAG_ERROR("Binding storage images to non-compute shader is currently unsupported.");
+        continue;
       }
-
-      // At this point, we have a valid descriptor set in the `vk_sets` array.
-      // We'll use it in the write operation corresponding to the current bind_op.
-      VkDescriptorSet set = vk_desc_sets[bind_op->target_set];
-
-      // Construct a vulkan descriptor set write corresponding to this bind
-      // operation.
-      VkWriteDescriptorSet* vk_write = &vk_writes[descriptor_write_idx++];
-
-      vk_write->sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-      vk_write->pNext           = NULL;
-      vk_write->dstSet          = set;
-      vk_write->dstBinding      = bind_op->target_binding;
-      vk_write->descriptorCount = 1u;
-      vk_write->dstArrayElement = 0u;
-      vk_write->descriptorType  = get_vk_descriptor_type(bind_op->type);
-
-      switch (bind_op->type) {
-      case NGF_DESCRIPTOR_STORAGE_BUFFER:
-      case NGF_DESCRIPTOR_UNIFORM_BUFFER: {
-        const ngf_buffer_bind_info* bind_info = &bind_op->info.buffer;
-        VkDescriptorBufferInfo*     vk_bind_info =
-            ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkDescriptorBufferInfo));
-
-        vk_bind_info->buffer = (VkBuffer)bind_info->buffer->alloc.obj_handle;
-        vk_bind_info->offset = bind_info->offset;
-        vk_bind_info->range  = bind_info->range;
-
-        vk_write->pBufferInfo = vk_bind_info;
-        break;
+      if (bind_op->type == NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC &&
+          !ngfvk_dynamic_offset_for_op(set_layout, bind_op, set_dynamic_offsets)) {
+        continue;
       }
-      case NGF_DESCRIPTOR_TEXEL_BUFFER: {
-        vk_write->pTexelBufferView = &(bind_op->info.texel_buffer_view->vk_buf_view);
-        break;
+      ngfvk_desc_cache_key_entry_for_op(bind_op, &key[nkey_entries++]);
+
+      // The actual write is only constructed if the set is not found in the cache.
+      write_ops[descriptor_write_idx++] = bind_op;
+    }
+
+    const uint64_t hash = ngfvk_desc_set_cache_hash(set_layout->vk_handle, key, nkey_entries);
+    VkDescriptorSet set = ngfvk_desc_set_cache_lookup(
+        &pools->set_cache,
+        hash,
+        set_layout->vk_handle,
+        key,
+        nkey_entries);
+    if (set != VK_NULL_HANDLE) {
+      cmd_buf->stats.descriptor_set_cache_hits++;
+      descriptor_write_idx = set_write_base;
+    } else {
+      cmd_buf->stats.descriptor_set_cache_misses++;
+      set = ngfvk_desc_pools_list_allocate_set(pools, set_layout, &cmd_buf->stats);
+      if (set == VK_NULL_HANDLE) {
+        NGFI_DIAG_WARNING("Failed to bind graphics resources - could not allocate descriptor set");
+        return;
       }
-      case NGF_DESCRIPTOR_STORAGE_IMAGE:
-        if (cmd_buf->renderpass_active) {
-          NGFI_DIAG_ERROR("Binding storage images to non-compute shader is currently unsupported.");
-          continue;
-        }
-      /* break omitted intentionally */
-      case NGF_DESCRIPTOR_IMAGE:
-      case NGF_DESCRIPTOR_SAMPLER:
-      case NGF_DESCRIPTOR_IMAGE_AND_SAMPLER: {
-        const ngf_image_sampler_bind_info* bind_info = &bind_op->info.image_sampler;
-        VkDescriptorImageInfo*             vk_bind_info =
-            ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkDescriptorImageInfo));
-        vk_bind_info->imageView   = VK_NULL_HANDLE;
-        vk_bind_info->imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        vk_bind_info->sampler     = VK_NULL_HANDLE;
-        if (bind_op->type == NGF_DESCRIPTOR_IMAGE ||
-            bind_op->type == NGF_DESCRIPTOR_IMAGE_AND_SAMPLER) {
-          vk_bind_info->imageView     = bind_info->image->vkview;
-          const bool is_storage_image = bind_info->image->usage_flags & NGF_IMAGE_USAGE_STORAGE;
-          vk_bind_info->imageLayout   = (is_storage_image) ? VK_IMAGE_LAYOUT_GENERAL
-                                                           : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        } else if (bind_op->type == NGF_DESCRIPTOR_STORAGE_IMAGE) {
-          vk_bind_info->imageView   = bind_info->image->vkview;
-          vk_bind_info->imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-        } else if (
-            bind_op->type == NGF_DESCRIPTOR_SAMPLER ||
-            bind_op->type == NGF_DESCRIPTOR_IMAGE_AND_SAMPLER) {
-          vk_bind_info->sampler = bind_info->sampler->vksampler;
+      // Prefer writing the whole set at once with the layout's update template. Otherwise, fall
+      // back to individual writes, which are batched up and performed after all sets have been
+      // processed.
+      const uint32_t            nset_writes = descriptor_write_idx - set_write_base;
+      ngfvk_desc_template_slot* payload =
+          set_layout->update_template != VK_NULL_HANDLE
+              ? ngfi_sa_alloc(ngfi_tmp_store(), nset_writes * sizeof(ngfvk_desc_template_slot))
+              : NULL;
+      if (payload != NULL && ngfvk_desc_template_payload_for_ops(
+                                 set_layout,
+                                 &write_ops[set_write_base],
+                                 nset_writes,
+                                 payload)) {
+        vkUpdateDescriptorSetWithTemplateKHR(_vk.device, set, set_layout->update_template, payload);
+        descriptor_write_idx = set_write_base;
+      } else {
+        for (uint32_t w = set_write_base; w < descriptor_write_idx; ++w) {
+          ngfvk_write_for_bind_op(write_ops[w], set, &vk_writes[w]);
         }
-        vk_write->pImageInfo = vk_bind_info;
-        break;
-      }
-
-      default:
-        assert(false);
       }
+      ngfvk_desc_set_cache_insert(
+          &pools->set_cache,
+          hash,
+          set_layout->vk_handle,
+          key,
+          nkey_entries,
+          set);
     }
-    ngfvk_bind_op_chunk* prev_chunk = chunk;
-    chunk                           = prev_chunk->next;
-    ngfi_blkalloc_free(CURRENT_CONTEXT->bind_op_chunk_allocator, prev_chunk);
+    vk_desc_sets[set_idx] = set;
+    first_op_in_set       = end_op_in_set;
   }
-  cmd_buf->pending_bind_ops.first = cmd_buf->pending_bind_ops.last = NULL;
-  cmd_buf->pending_bind_ops.size                                   = 0u;
+
+  ngfvk_cleanup_pending_binds(cmd_buf);
 
   // perform all the vulkan descriptor set write operations to populate the
   // newly allocated descriptor sets.
-  vkUpdateDescriptorSets(_vk.device, nbind_operations, vk_writes, 0, NULL);
+  if (descriptor_write_idx > 0u) {
+    vkUpdateDescriptorSets(_vk.device, descriptor_write_idx, vk_writes, 0, NULL);
+  }
 
   // bind each of the descriptor sets individually (this ensures that desc.
   // sets bound for a compatible pipeline earlier in this command buffer
@@ -1815,8 +3089,8 @@ static void ngfvk_execute_pending_binds(ngf_cmd_buffer cmd_buf) {
           s,
           1,
           &vk_desc_sets[s],
-          0,
-          NULL);
+          NGFI_DARRAY_AT(pipeline_data->descriptor_set_layouts, s).ndynamic_bindings,
+          &dynamic_offsets[s * NGFVK_MAX_DYNAMIC_UNIFORM_BUFFERS_PER_SET]);
     }
   }
 }
@@ -2004,20 +3278,120 @@ static uint64_t ngfvk_renderpass_ops_key(
 #define NGFVK_ATTACHMENT_STORE_OP_FROM_KEY(idx, ops_key) \
   (get_vk_store_op((ngf_attachment_store_op)(NGFVK_ATTACHMENT_OPS_COMBO(idx, ops_key) & 3u)))
 
-// Looks up a renderpass object from the current context's renderpass cache, and creates
-// one if it doesn't exist.
-static VkRenderPass ngfvk_lookup_renderpass(ngf_render_target rt, uint64_t ops_key) {
-  VkRenderPass result = VK_NULL_HANDLE;
-  NGFI_DARRAY_FOREACH(CURRENT_CONTEXT->renderpass_cache, r) {
-    const ngfvk_renderpass_cache_entry* cache_entry =
-        &NGFI_DARRAY_AT(CURRENT_CONTEXT->renderpass_cache, r);
-    if (cache_entry->rt == rt && cache_entry->ops_key == ops_key) {
-      result = cache_entry->renderpass;
-      break;
+static uint32_t ngfvk_renderpass_cache_home_slot(
+    const ngfvk_renderpass_cache* cache,
+    ngf_render_target             rt,
+    uint64_t                      ops_key) {
+  const uint64_t key[2] = {(uint64_t)(uintptr_t)rt, ops_key};
+  const uint64_t hash   = ngfvk_hash_bytes(0xcbf29ce484222325ull, key, sizeof(key));
+  return (uint32_t)(hash & (cache->capacity - 1u));
+}
+
+static VkRenderPass ngfvk_renderpass_cache_find(
+    const ngfvk_renderpass_cache* cache,
+    ngf_render_target             rt,
+    uint64_t                      ops_key) {
+  if (cache->capacity == 0u) { return VK_NULL_HANDLE; }
+  const uint32_t mask = cache->capacity - 1u;
+  for (uint32_t i = ngfvk_renderpass_cache_home_slot(cache, rt, ops_key);
+       cache->slots[i].renderpass != VK_NULL_HANDLE;
+       i = (i + 1u) & mask) {
+    const ngfvk_renderpass_cache_entry* entry = &cache->slots[i];
+    if (entry->rt == rt && entry->ops_key == ops_key) { return entry->renderpass; }
+  }
+  return VK_NULL_HANDLE;
+}
+
+static void ngfvk_renderpass_cache_place(
+    ngfvk_renderpass_cache*             cache,
+    const ngfvk_renderpass_cache_entry* entry) {
+  const uint32_t mask = cache->capacity - 1u;
+  uint32_t       i    = ngfvk_renderpass_cache_home_slot(cache, entry->rt, entry->ops_key);
+  while (cache->slots[i].renderpass != VK_NULL_HANDLE) { i = (i + 1u) & mask; }
+  cache->slots[i] = *entry;
+  cache->nentries++;
+}
+
+static bool ngfvk_renderpass_cache_insert(
+    ngfvk_renderpass_cache*             cache,
+    const ngfvk_renderpass_cache_entry* entry) {
+  // Keep the load factor at or below 1/2.
+  if (2u * (cache->nentries + 1u) > cache->capacity) {
+    const uint32_t new_capacity =
+        cache->capacity == 0u ? NGFVK_RENDERPASS_CACHE_INITIAL_CAPACITY : cache->capacity * 2u;
+    ngfvk_renderpass_cache_entry* new_slots =
+        NGFI_ALLOCN(ngfvk_renderpass_cache_entry, new_capacity);
+    if (new_slots == NULL) { return false; }
+    memset(new_slots, 0, sizeof(ngfvk_renderpass_cache_entry) * new_capacity);
+    ngfvk_renderpass_cache_entry* old_slots    = cache->slots;
+    const uint32_t                old_capacity = cache->capacity;
+    cache->slots                               = new_slots;
+    cache->capacity                            = new_capacity;
+    cache->nentries                            = 0u;
+    for (uint32_t i = 0u; i < old_capacity; ++i) {
+      if (old_slots[i].renderpass != VK_NULL_HANDLE) {
+        ngfvk_renderpass_cache_place(cache, &old_slots[i]);
+      }
+    }
+    if (old_slots) { NGFI_FREEN(old_slots, old_capacity); }
+  }
+  ngfvk_renderpass_cache_place(cache, entry);
+  return true;
+}
+
+// Empties the given slot, shifting back the entries that follow it in the same cluster so that
+// the probe sequences of the remaining entries don't get broken up. Entries following the removed
+// one may thus end up in the given slot.
+static void ngfvk_renderpass_cache_remove_at(ngfvk_renderpass_cache* cache, uint32_t slot) {
+  const uint32_t mask = cache->capacity - 1u;
+  uint32_t       hole = slot;
+  for (uint32_t i = (hole + 1u) & mask; cache->slots[i].renderpass != VK_NULL_HANDLE;
+       i = (i + 1u) & mask) {
+    const ngfvk_renderpass_cache_entry* entry = &cache->slots[i];
+    const uint32_t home = ngfvk_renderpass_cache_home_slot(cache, entry->rt, entry->ops_key);
+    // The entry may be moved into the hole only if its home slot does not lie cyclically within
+    // (hole, i].
+    const bool home_after_hole =
+        hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+    if (!home_after_hole) {
+      cache->slots[hole] = *entry;
+      hole               = i;
+    }
+  }
+  memset(&cache->slots[hole], 0, sizeof(ngfvk_renderpass_cache_entry));
+  cache->nentries--;
+}
+
+// Removes all the entries associated with the given render target from the cache, scheduling
+// their render pass objects for destruction when the given frame's resources are retired.
+static void ngfvk_renderpass_cache_evict(
+    ngfvk_renderpass_cache* cache,
+    ngf_render_target       rt,
+    ngfvk_frame_resources*  res) {
+  for (uint32_t i = 0u; i < cache->capacity;) {
+    const ngfvk_renderpass_cache_entry* entry = &cache->slots[i];
+    if (entry->renderpass != VK_NULL_HANDLE && entry->rt == rt) {
+      NGFI_DARRAY_APPEND(res->retire_render_passes, entry->renderpass);
+      // Another entry might have been moved into this slot, so it needs to be checked again.
+      ngfvk_renderpass_cache_remove_at(cache, i);
+    } else {
+      ++i;
     }
   }
+}
 
-  if (result == VK_NULL_HANDLE) {
+// Looks up a renderpass object from the renderpass cache of the given cmd buffer's context, and
+// creates one if it doesn't exist.
+static VkRenderPass
+ngfvk_lookup_renderpass(ngf_cmd_buffer cmd_buf, ngf_render_target rt, uint64_t ops_key) {
+  ngf_context ctx = cmd_buf->ctx;
+  pthread_mutex_lock(&ctx->renderpass_cache_lock);
+  VkRenderPass result = ngfvk_renderpass_cache_find(&ctx->renderpass_cache, rt, ops_key);
+
+  if (result != VK_NULL_HANDLE) {
+    cmd_buf->stats.render_pass_cache_hits++;
+  } else {
+    cmd_buf->stats.render_pass_cache_misses++;
     const uint32_t nattachments               = rt->nattachments;
     const size_t   attachment_pass_descs_size = sizeof(ngfvk_attachment_pass_desc) * nattachments;
     ngfvk_attachment_pass_desc* attachment_compat_pass_descs =
@@ -2043,8 +3417,15 @@ static VkRenderPass ngfvk_lookup_renderpass(ngf_render_target rt, uint64_t ops_k
         .rt         = rt,
         .ops_key    = ops_key,
         .renderpass = result};
-    NGFI_DARRAY_APPEND(CURRENT_CONTEXT->renderpass_cache, cache_entry);
+    if (result != VK_NULL_HANDLE &&
+        !ngfvk_renderpass_cache_insert(&ctx->renderpass_cache, &cache_entry)) {
+      // The render pass can't be kept track of, so it can't be used either.
+      NGFI_DIAG_ERROR("failed to insert a render pass into the cache");
+      vkDestroyRenderPass(_vk.device, result, NULL);
+      result = VK_NULL_HANDLE;
+    }
   }
+  pthread_mutex_unlock(&ctx->renderpass_cache_lock);
 
   return result;
 }
@@ -2080,6 +3461,8 @@ ngfvk_get_ngf_descriptor_type(SpvReflectDescriptorType spv_reflect_type) {
     return NGF_DESCRIPTOR_STORAGE_BUFFER;
   case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_IMAGE:
     return NGF_DESCRIPTOR_STORAGE_IMAGE;
+  case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+    return NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC;
   default:
     return NGF_DESCRIPTOR_TYPE_COUNT;
   }
@@ -2213,10 +3596,210 @@ void ngfvk_populate_vk_shader_stages(
   }
 }
 
+// Checks whether the given pipeline cache data was produced by a device with the given IDs and
+// pipeline cache UUID. The header fields are stored least significant byte first, regardless of
+// the host's endianness.
+static bool ngfvk_pipeline_cache_header_valid(
+    const void*    data,
+    size_t         size,
+    uint32_t       vendor_id,
+    uint32_t       device_id,
+    const uint8_t* uuid) {
+  const size_t header_size = 4u * sizeof(uint32_t) + VK_UUID_SIZE;
+  if (data == NULL || size < header_size) { return false; }
+
+  const uint8_t* bytes = (const uint8_t*)data;
+  uint32_t       fields[4];
+  for (uint32_t i = 0u; i < 4u; ++i) {
+    const uint8_t* f = &bytes[i * sizeof(uint32_t)];
+    fields[i] = (uint32_t)f[0] | ((uint32_t)f[1] << 8u) | ((uint32_t)f[2] << 16u) |
+                ((uint32_t)f[3] << 24u);
+  }
+  return fields[0] >= header_size && fields[0] <= size &&
+         fields[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && fields[2] == vendor_id &&
+         fields[3] == device_id && memcmp(&bytes[4u * sizeof(uint32_t)], uuid, VK_UUID_SIZE) == 0;
+}
+
+// Destroys the update template of a descriptor set layout, if it has one. Update templates are
+// only used on the host while recording, and are never referenced by command buffers, so this
+// doesn't need to wait for any frames to retire.
+static void ngfvk_destroy_desc_update_template(ngfvk_desc_set_layout* set_layout) {
+  if (set_layout->update_template != VK_NULL_HANDLE) {
+    vkDestroyDescriptorUpdateTemplateKHR(_vk.device, set_layout->update_template, NULL);
+    set_layout->update_template = VK_NULL_HANDLE;
+  }
+  if (set_layout->template_entries) {
+    NGFI_FREEN(set_layout->template_entries, set_layout->ntemplate_entries);
+    set_layout->template_entries = NULL;
+  }
+  set_layout->ntemplate_entries = 0u;
+}
+
+// Creates an update template that writes the first element of every binding in the given set
+// layout, reading from a tightly packed array of ngfvk_desc_template_slot. The bindings must be
+// sorted by binding index.
+static VkResult ngfvk_create_desc_update_template(
+    const SpvReflectDescriptorBinding* bindings,
+    uint32_t                           nbindings,
+    ngfvk_desc_set_layout*             set_layout) {
+  if (nbindings == 0u) { return VK_SUCCESS; }
+  VkDescriptorUpdateTemplateEntry* vk_entries =
+      ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkDescriptorUpdateTemplateEntry) * nbindings);
+  set_layout->template_entries = NGFI_ALLOCN(ngfvk_desc_template_entry, nbindings);
+  if (vk_entries == NULL || set_layout->template_entries == NULL) {
+    return VK_ERROR_OUT_OF_HOST_MEMORY;
+  }
+  set_layout->ntemplate_entries = nbindings;
+  for (uint32_t i = 0u; i < nbindings; ++i) {
+    const ngf_descriptor_type type = ngfvk_get_ngf_descriptor_type(bindings[i].descriptor_type);
+    set_layout->template_entries[i].binding = bindings[i].binding;
+    set_layout->template_entries[i].type    = type;
+    vk_entries[i].dstBinding                = bindings[i].binding;
+    vk_entries[i].dstArrayElement           = 0u;
+    vk_entries[i].descriptorCount           = 1u;
+    vk_entries[i].descriptorType            = get_vk_descriptor_type(type);
+    vk_entries[i].offset                    = i * sizeof(ngfvk_desc_template_slot);
+    vk_entries[i].stride                    = sizeof(ngfvk_desc_template_slot);
+  }
+  const VkDescriptorUpdateTemplateCreateInfo vk_template_info = {
+      .sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,
+      .pNext                      = NULL,
+      .flags                      = 0u,
+      .descriptorUpdateEntryCount = nbindings,
+      .pDescriptorUpdateEntries   = vk_entries,
+      .templateType               = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,
+      .descriptorSetLayout        = set_layout->vk_handle,
+      .pipelineBindPoint          = VK_PIPELINE_BIND_POINT_GRAPHICS,
+      .pipelineLayout             = VK_NULL_HANDLE,
+      .set                        = 0u};
+  return vkCreateDescriptorUpdateTemplateKHR(
+      _vk.device,
+      &vk_template_info,
+      NULL,
+      &set_layout->update_template);
+}
+
+// Unsized arrays of descriptors (e.g. `uniform texture2D textures[]`) are reflected with a count of
+// one, and can only be told apart from single descriptors by their type.
+static bool ngfvk_is_unsized_array_binding(const SpvReflectDescriptorBinding* binding) {
+  return binding->type_description != NULL &&
+         binding->type_description->op == SpvOpTypeRuntimeArray;
+}
+
+// Creates the layout of a set that holds a resource table of the given type. Both pipelines and
+// resource tables create their set layouts with this function, which keeps them compatible.
+static VkResult
+ngfvk_create_resource_table_set_layout(ngf_descriptor_type type, VkDescriptorSetLayout* result) {
+  const VkDescriptorBindingFlagsEXT vk_binding_flags =
+      VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+      VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT_EXT |
+      VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+      VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+  const VkDescriptorSetLayoutBindingFlagsCreateInfoEXT vk_binding_flags_info = {
+      .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT,
+      .pNext         = NULL,
+      .bindingCount  = 1u,
+      .pBindingFlags = &vk_binding_flags};
+  const VkDescriptorSetLayoutBinding vk_binding = {
+      .binding            = 0u,
+      .descriptorType     = get_vk_descriptor_type(type),
+      .descriptorCount    = DEVICE_CAPS.max_resource_table_capacity,
+      .stageFlags         = VK_SHADER_STAGE_ALL,
+      .pImmutableSamplers = NULL};
+  const VkDescriptorSetLayoutCreateInfo vk_ds_info = {
+      .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+      .pNext        = &vk_binding_flags_info,
+      .flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT,
+      .bindingCount = 1u,
+      .pBindings    = &vk_binding};
+  return vkCreateDescriptorSetLayout(_vk.device, &vk_ds_info, NULL, result);
+}
+
+// Initializes the layout of a set that declares an unsized array. Such sets are reserved for
+// binding resource tables, and must consist of a single unsized array of a supported type at
+// binding 0.
+static ngf_error ngfvk_init_resource_table_set_layout(
+    const SpvReflectDescriptorBinding* bindings,
+    uint32_t                           nbindings,
+    ngfvk_desc_set_layout*             set_layout) {
+  const ngf_descriptor_type type = ngfvk_get_ngf_descriptor_type(bindings[0].descriptor_type);
+  if (!DEVICE_CAPS.resource_tables_supported) {
+    NGFI_DIAG_ERROR(
+        "Set %u declares an unsized array, but resource tables are not supported by the device.",
+        bindings[0].set);
+    return NGF_ERROR_OBJECT_CREATION_FAILED;
+  }
+  if (nbindings != 1u || bindings[0].binding != 0u ||
+      (type != NGF_DESCRIPTOR_IMAGE && type != NGF_DESCRIPTOR_STORAGE_BUFFER)) {
+    NGFI_DIAG_ERROR(
+        "Set %u declares an unsized array. It must be the only binding in the set, at binding 0, "
+        "and hold either images or storage buffers.",
+        bindings[0].set);
+    return NGF_ERROR_OBJECT_CREATION_FAILED;
+  }
+  set_layout->resource_table      = true;
+  set_layout->resource_table_type = type;
+  return ngfvk_create_resource_table_set_layout(type, &set_layout->vk_handle) == VK_SUCCESS
+             ? NGF_ERROR_OK
+             : NGF_ERROR_OBJECT_CREATION_FAILED;
+}
+
+// Hands out a slot of the given resource table, preferring previously freed slots.
+static ngf_error ngfvk_resource_table_acquire_slot(ngf_resource_table table, uint32_t* slot) {
+  if (!NGFI_DARRAY_EMPTY(table->free_slots)) {
+    *slot = *NGFI_DARRAY_BACKPTR(table->free_slots);
+    NGFI_DARRAY_POP(table->free_slots);
+    return NGF_ERROR_OK;
+  }
+  if (table->nused_slots < table->capacity) {
+    *slot = table->nused_slots++;
+    return NGF_ERROR_OK;
+  }
+  return NGF_ERROR_OUT_OF_MEM;
+}
+
+// Drops the slots of the given resource table from the retire lists of all the frames of the given
+// context, so that nothing refers to the table after it's destroyed.
+static void ngfvk_forget_retired_table_slots(ngf_context ctx, ngf_resource_table table) {
+  for (uint32_t f = 0u; f < ctx->max_inflight_frames; ++f) {
+    ngfvk_frame_resources* frame_res = &ctx->frame_res[f];
+    uint32_t               nkept     = 0u;
+    NGFI_DARRAY_FOREACH(frame_res->retire_table_slots, s) {
+      const ngfvk_retired_table_slot retired = NGFI_DARRAY_AT(frame_res->retire_table_slots, s);
+      if (retired.table != table) {
+        NGFI_DARRAY_AT(frame_res->retire_table_slots, nkept++) = retired;
+      }
+    }
+    NGFI_DARRAY_RESIZE(frame_res->retire_table_slots, nkept);
+  }
+}
+
+// Drops the ranges of the given query pool from the lists of all the frames of the given context,
+// so that nothing refers to the pool after it's destroyed.
+static void ngfvk_forget_query_pool(ngf_context ctx, ngf_query_pool pool) {
+  for (uint32_t f = 0u; f < ctx->max_inflight_frames; ++f) {
+    ngfvk_frame_resources* frame_res = &ctx->frame_res[f];
+    uint32_t               nkept     = 0u;
+    NGFI_DARRAY_FOREACH(frame_res->written_queries, r) {
+      const ngfvk_query_range range = NGFI_DARRAY_AT(frame_res->written_queries, r);
+      if (range.pool != pool) { NGFI_DARRAY_AT(frame_res->written_queries, nkept++) = range; }
+    }
+    NGFI_DARRAY_RESIZE(frame_res->written_queries, nkept);
+    nkept = 0u;
+    NGFI_DARRAY_FOREACH(frame_res->query_resets, r) {
+      const ngfvk_query_range range = NGFI_DARRAY_AT(frame_res->query_resets, r);
+      if (range.pool != pool) { NGFI_DARRAY_AT(frame_res->query_resets, nkept++) = range; }
+    }
+    NGFI_DARRAY_RESIZE(frame_res->query_resets, nkept);
+  }
+}
+
 ngf_error ngfvk_create_pipeline_layout(
-    const ngf_shader_stage* shader_stages,
-    uint32_t                nshader_stages,
-    ngfvk_generic_pipeline* pipeline_data) {
+    const ngf_shader_stage*     shader_stages,
+    uint32_t                    nshader_stages,
+    const ngf_binding_location* dynamic_uniform_buffers,
+    uint32_t                    ndynamic_uniform_buffers,
+    ngfvk_generic_pipeline*     pipeline_data) {
   NGFI_DARRAY_RESET(pipeline_data->descriptor_set_layouts, 4);
 
   // Extract and dedupe all descriptor bindings.
@@ -2248,6 +3831,26 @@ ngf_error ngfvk_create_pipeline_layout(
     }
   }
 
+  // Uniform buffers requested to have dynamic offsets are reflected as regular uniform buffers.
+  for (uint32_t i = 0u; i < ndynamic_uniform_buffers; ++i) {
+    const ngf_binding_location* loc   = &dynamic_uniform_buffers[i];
+    bool                        found = false;
+    for (uint32_t b = 0u; !found && b < nunique_bindings; ++b) {
+      if (bindings[b].set == loc->set && bindings[b].binding == loc->binding &&
+          bindings[b].descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+        bindings[b].descriptor_type = SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        found                       = true;
+      }
+    }
+    if (!found) {
+      NGFI_DIAG_ERROR(
+          "Binding %u of set %u is not a uniform buffer, and can't have a dynamic offset.",
+          loc->binding,
+          loc->set);
+      return NGF_ERROR_OBJECT_CREATION_FAILED;
+    }
+  }
+
   // Create descriptor set layouts.
   VkDescriptorSetLayout* vk_set_layouts =
       ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkDescriptorSetLayout) * (max_set_id + 1));
@@ -2272,8 +3875,22 @@ ngf_error ngfvk_create_pipeline_layout(
     }
     memset(&set_layout, 0, sizeof(set_layout));
     const uint32_t first_binding_in_set = cur;
-    while (cur < nunique_bindings && current_set_id == bindings[cur].set) cur++;
-    const uint32_t                nbindings_in_set = cur - first_binding_in_set;
+    bool           has_unsized_array    = false;
+    while (cur < nunique_bindings && current_set_id == bindings[cur].set) {
+      has_unsized_array |= ngfvk_is_unsized_array_binding(&bindings[cur++]);
+    }
+    const uint32_t nbindings_in_set = cur - first_binding_in_set;
+    if (has_unsized_array) {
+      const ngf_error err = ngfvk_init_resource_table_set_layout(
+          &bindings[first_binding_in_set],
+          nbindings_in_set,
+          &set_layout);
+      if (err != NGF_ERROR_OK) { return err; }
+      NGFI_DARRAY_APPEND(pipeline_data->descriptor_set_layouts, set_layout);
+      vk_set_layouts[current_set_id] = set_layout.vk_handle;
+      last_set_id                    = current_set_id;
+      continue;
+    }
     VkDescriptorSetLayoutBinding* vk_descriptor_bindings =
         ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkDescriptorSetLayoutBinding) * nbindings_in_set);
     for (uint32_t i = first_binding_in_set; i < cur; ++i) {
@@ -2287,6 +3904,16 @@ ngf_error ngfvk_create_pipeline_layout(
       vk_d->stageFlags         = VK_SHADER_STAGE_ALL;
       vk_d->pImmutableSamplers = NULL;
       set_layout.counts[ngf_desc_type]++;
+      if (ngf_desc_type == NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC) {
+        if (set_layout.ndynamic_bindings >= NGFVK_MAX_DYNAMIC_UNIFORM_BUFFERS_PER_SET) {
+          NGFI_DIAG_ERROR(
+              "Set %u has more than %u dynamic uniform buffers.",
+              current_set_id,
+              NGFVK_MAX_DYNAMIC_UNIFORM_BUFFERS_PER_SET);
+          return NGF_ERROR_OBJECT_CREATION_FAILED;
+        }
+        set_layout.dynamic_bindings[set_layout.ndynamic_bindings++] = d->binding;
+      }
     }
     const VkDescriptorSetLayoutCreateInfo vk_ds_info = {
         .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
@@ -2294,15 +3921,44 @@ ngf_error ngfvk_create_pipeline_layout(
         .flags        = 0u,
         .bindingCount = nbindings_in_set,
         .pBindings    = vk_descriptor_bindings};
-    const VkResult vk_err =
+    VkResult vk_err =
         vkCreateDescriptorSetLayout(_vk.device, &vk_ds_info, NULL, &set_layout.vk_handle);
+    if (vk_err == VK_SUCCESS && _vk.desc_update_templates_enabled) {
+      vk_err = ngfvk_create_desc_update_template(
+          &bindings[first_binding_in_set],
+          nbindings_in_set,
+          &set_layout);
+    }
     NGFI_DARRAY_APPEND(pipeline_data->descriptor_set_layouts, set_layout);
     vk_set_layouts[current_set_id] = set_layout.vk_handle;
     if (vk_err != VK_SUCCESS) { return NGF_ERROR_OBJECT_CREATION_FAILED; }
     last_set_id = current_set_id;
   }
 
+  // Make sure that the push constant blocks declared by the shaders fit into the push constant
+  // range.
+  for (uint32_t i = 0u; i < nshader_stages; ++i) {
+    const SpvReflectShaderModule* spv_module = &shader_stages[i]->spv_reflect_module;
+    for (uint32_t b = 0u; b < spv_module->push_constant_block_count; ++b) {
+      if (spv_module->push_constant_blocks[b].size > NGF_MAX_PUSH_CONSTANTS_SIZE) {
+        NGFI_DIAG_ERROR(
+            "push constant block size (%u bytes) exceeds the maximum (%u bytes)",
+            spv_module->push_constant_blocks[b].size,
+            NGF_MAX_PUSH_CONSTANTS_SIZE);
+        return NGF_ERROR_OBJECT_CREATION_FAILED;
+      }
+    }
+  }
+
   // Pipeline layout.
+  // Every pipeline layout declares the same push constant range, regardless of how much of it the
+  // shaders actually use. Pipeline layouts with differing push constant ranges are incompatible,
+  // and switching between them would disturb the descriptor sets and push constants bound
+  // previously.
+  const VkPushConstantRange vk_push_constant_range = {
+      .stageFlags = VK_SHADER_STAGE_ALL,
+      .offset     = 0u,
+      .size       = NGF_MAX_PUSH_CONSTANTS_SIZE};
   const uint32_t ndescriptor_sets = NGFI_DARRAY_SIZE(pipeline_data->descriptor_set_layouts);
   const VkPipelineLayoutCreateInfo vk_pipeline_layout_info = {
       .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
@@ -2310,8 +3966,8 @@ ngf_error ngfvk_create_pipeline_layout(
       .flags                  = 0u,
       .setLayoutCount         = ndescriptor_sets,
       .pSetLayouts            = vk_set_layouts,
-      .pushConstantRangeCount = 0u,
-      .pPushConstantRanges    = NULL};
+      .pushConstantRangeCount = 1u,
+      .pPushConstantRanges    = &vk_push_constant_range};
   const VkResult vk_err = vkCreatePipelineLayout(
       _vk.device,
       &vk_pipeline_layout_info,
@@ -2326,7 +3982,9 @@ static ngf_error ngfvk_initialize_generic_pipeline_data(
     const ngf_specialization_info*   spec_info,
     VkPipelineShaderStageCreateInfo* vk_shader_stages,
     const ngf_shader_stage*          shader_stages,
-    uint32_t                         nshader_stages) {
+    uint32_t                         nshader_stages,
+    const ngf_binding_location*      dynamic_uniform_buffers,
+    uint32_t                         ndynamic_uniform_buffers) {
   // Build up Vulkan specialization structure, if necessary.
   ngfvk_populate_vk_spec_consts(spec_info, &data->vk_spec_info);
 
@@ -2338,7 +3996,12 @@ static ngf_error ngfvk_initialize_generic_pipeline_data(
       spec_info ? &data->vk_spec_info : NULL);
 
   // Prepare pipeline layout.
-  return ngfvk_create_pipeline_layout(shader_stages, nshader_stages, data);
+  return ngfvk_create_pipeline_layout(
+      shader_stages,
+      nshader_stages,
+      dynamic_uniform_buffers,
+      ndynamic_uniform_buffers,
+      data);
 }
 
 static void
@@ -2350,8 +4013,29 @@ ngfi_destroy_generic_pipeline_data(ngfvk_frame_resources* res, ngfvk_generic_pip
     NGFI_DARRAY_APPEND(res->retire_pipeline_layouts, data->vk_pipeline_layout);
   }
   NGFI_DARRAY_FOREACH(data->descriptor_set_layouts, l) {
-    VkDescriptorSetLayout set_layout = NGFI_DARRAY_AT(data->descriptor_set_layouts, l).vk_handle;
-    NGFI_DARRAY_APPEND(res->retire_dset_layouts, set_layout);
+    ngfvk_desc_set_layout* set_layout = &NGFI_DARRAY_AT(data->descriptor_set_layouts, l);
+    ngfvk_destroy_desc_update_template(set_layout);
+    NGFI_DARRAY_APPEND(res->retire_dset_layouts, set_layout->vk_handle);
+  }
+  NGFI_DARRAY_DESTROY(data->descriptor_set_layouts);
+}
+
+// Destroys the objects of a pipeline that failed to be created. Such a pipeline can't have been
+// used by any command buffer, so there is no need to wait for the current frame to retire. Not
+// touching the per-frame state also keeps pipeline creation safe to call from multiple threads.
+static void ngfvk_destroy_unused_generic_pipeline_data(ngfvk_generic_pipeline* data) {
+  if (data->vk_pipeline != VK_NULL_HANDLE) {
+    vkDestroyPipeline(_vk.device, data->vk_pipeline, NULL);
+  }
+  if (data->vk_pipeline_layout != VK_NULL_HANDLE) {
+    vkDestroyPipelineLayout(_vk.device, data->vk_pipeline_layout, NULL);
+  }
+  NGFI_DARRAY_FOREACH(data->descriptor_set_layouts, l) {
+    ngfvk_desc_set_layout* set_layout = &NGFI_DARRAY_AT(data->descriptor_set_layouts, l);
+    ngfvk_destroy_desc_update_template(set_layout);
+    if (set_layout->vk_handle != VK_NULL_HANDLE) {
+      vkDestroyDescriptorSetLayout(_vk.device, set_layout->vk_handle, NULL);
+    }
   }
   NGFI_DARRAY_DESTROY(data->descriptor_set_layouts);
 }
@@ -2360,29 +4044,99 @@ static void ngfvk_cmd_bind_resources(
     ngf_cmd_buffer              buf,
     const ngf_resource_bind_op* bind_operations,
     uint32_t                    nbind_operations) {
-  for (uint32_t i = 0; i < nbind_operations; ++i) {
-    const ngf_resource_bind_op* bind_op          = &bind_operations[i];
-    ngfvk_bind_op_chunk_list*   pending_bind_ops = &buf->pending_bind_ops;
-    if (!pending_bind_ops->last || pending_bind_ops->last->last_idx >= NGFVK_BIND_OP_CHUNK_SIZE) {
-      ngfvk_bind_op_chunk* prev_last = pending_bind_ops->last;
-      pending_bind_ops->last = ngfi_blkalloc_alloc(CURRENT_CONTEXT->bind_op_chunk_allocator);
-      if (pending_bind_ops->last == NULL) {
-        NGFI_DIAG_ERROR("failed memory allocation while binding resources");
-        return;
-      }
-      pending_bind_ops->last->next     = NULL;
-      pending_bind_ops->last->last_idx = 0;
-      if (prev_last) {
-        prev_last->next = pending_bind_ops->last;
-      } else {
-        pending_bind_ops->first = pending_bind_ops->last;
-      }
-    }
-    pending_bind_ops->last->data[pending_bind_ops->last->last_idx++] = *bind_op;
-    pending_bind_ops->size++;
+  // Bind ops are only copied into the command buffer's arena here. They get processed all at once
+  // before the next draw or dispatch.
+  if (nbind_operations > 0u) {
+    NGFI_DARRAY_APPEND_N(buf->pending_bind_ops, bind_operations, nbind_operations);
   }
 }
 
+static void ngfvk_cmd_push_constants(
+    ngf_cmd_buffer                buf,
+    const ngfvk_generic_pipeline* pipeline,
+    uint32_t                      offset,
+    uint32_t                      size,
+    const void*                   data) {
+  if (pipeline == NULL) {
+    NGFI_DIAG_ERROR("attempt to push constants without a bound pipeline");
+    return;
+  }
+  if ((offset & 3u) != 0u || (size & 3u) != 0u) {
+    NGFI_DIAG_ERROR("push constant offset and size must be multiples of 4");
+    return;
+  }
+  if (offset > NGF_MAX_PUSH_CONSTANTS_SIZE || size > NGF_MAX_PUSH_CONSTANTS_SIZE - offset) {
+    NGFI_DIAG_ERROR("push constant range exceeds the maximum push constant block size");
+    return;
+  }
+  if (size == 0u) { return; }
+  vkCmdPushConstants(
+      buf->vk_cmd_buffer,
+      pipeline->vk_pipeline_layout,
+      VK_SHADER_STAGE_ALL,
+      offset,
+      size,
+      data);
+}
+
+static void ngfvk_cmd_bind_group(
+    ngf_cmd_buffer                buf,
+    const ngfvk_generic_pipeline* pipeline,
+    VkPipelineBindPoint           bind_point,
+    const ngf_bind_group          group) {
+  if (pipeline == NULL) {
+    NGFI_DIAG_ERROR("attempt to bind a bind group without a bound pipeline");
+    return;
+  }
+  if (group->set >= NGFI_DARRAY_SIZE(pipeline->descriptor_set_layouts)) {
+    NGFI_DIAG_ERROR("bind group targets set %u, which the bound pipeline lacks", group->set);
+    return;
+  }
+  // Resources bound earlier are resolved now, so that they don't override the group's set at the
+  // next draw or dispatch.
+  if (!NGFI_DARRAY_EMPTY(buf->pending_bind_ops)) { ngfvk_execute_pending_binds(buf); }
+  vkCmdBindDescriptorSets(
+      buf->vk_cmd_buffer,
+      bind_point,
+      pipeline->vk_pipeline_layout,
+      group->set,
+      1u,
+      &group->vk_set,
+      group->ndynamic_offsets,
+      group->dynamic_offsets);
+}
+
+static void ngfvk_cmd_bind_resource_table(
+    ngf_cmd_buffer                buf,
+    const ngfvk_generic_pipeline* pipeline,
+    VkPipelineBindPoint           bind_point,
+    uint32_t                      set,
+    const ngf_resource_table      table) {
+  if (pipeline == NULL) {
+    NGFI_DIAG_ERROR("attempt to bind a resource table without a bound pipeline");
+    return;
+  }
+  if (set >= NGFI_DARRAY_SIZE(pipeline->descriptor_set_layouts)) {
+    NGFI_DIAG_ERROR("resource table bound to set %u, which the bound pipeline lacks", set);
+    return;
+  }
+  const ngfvk_desc_set_layout* set_layout = &NGFI_DARRAY_AT(pipeline->descriptor_set_layouts, set);
+  if (!set_layout->resource_table || set_layout->resource_table_type != table->type) {
+    NGFI_DIAG_ERROR("set %u of the bound pipeline doesn't match the resource table's type", set);
+    return;
+  }
+  if (!NGFI_DARRAY_EMPTY(buf->pending_bind_ops)) { ngfvk_execute_pending_binds(buf); }
+  vkCmdBindDescriptorSets(
+      buf->vk_cmd_buffer,
+      bind_point,
+      pipeline->vk_pipeline_layout,
+      set,
+      1u,
+      &table->vk_set,
+      0u,
+      NULL);
+}
+
 struct ngfvk_wait_events_params {
   VkEvent*               wait_events;
   VkImageMemoryBarrier*  image_memory_barriers;
@@ -2407,6 +4161,25 @@ enum ngfvk_sync_encoder_type {
   NGFVK_SYNC_XFER_ENCODER
 };
 
+// Populates the subresource range referenced by a sync op, and returns the layout that the
+// referenced subresource is kept in between passes.
+static VkImageLayout
+ngfvk_sync_image_ref_range(const ngf_image_ref* img_ref, VkImageSubresourceRange* range) {
+  const VkFormat image_format = img_ref->image->vkformat;
+  const bool     is_depth     = ngfvk_format_is_depth(image_format);
+  const bool     is_stencil   = ngfvk_format_is_stencil(image_format);
+  range->aspectMask =
+      is_depth ? (VK_IMAGE_ASPECT_DEPTH_BIT | (is_stencil ? VK_IMAGE_ASPECT_STENCIL_BIT : 0))
+               : VK_IMAGE_ASPECT_COLOR_BIT;
+  range->baseArrayLayer = img_ref->layer;
+  range->layerCount     = 1u;
+  range->baseMipLevel   = img_ref->mip_level;
+  range->levelCount     = 1u;
+
+  const bool is_storage_image = img_ref->image->usage_flags & NGF_IMAGE_USAGE_STORAGE;
+  return is_storage_image ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
 static void ngfvk_generate_sync_op_barriers(
     uint32_t                         nsync_resources,
     union ngfvk_sync_resources       sync_resources,
@@ -2465,37 +4238,112 @@ static void ngfvk_generate_sync_op_barriers(
       VkAccessFlags         image_access_flags = get_vk_image_access_flags(img_ref->image);
       VkImageMemoryBarrier* barrier =
           &temp_data->image_memory_barriers[temp_data->nimage_memory_barriers++];
-      barrier->sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-      barrier->pNext                           = NULL;
-      barrier->srcAccessMask                   = image_access_flags & possible_src_access_flag_bits;
-      barrier->dstAccessMask                   = image_access_flags & possible_dst_access_flag_bits;
-      barrier->srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
-      barrier->dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
-      barrier->image                           = (VkImage)img_ref->image->alloc.obj_handle;
-      barrier->subresourceRange.baseArrayLayer = img_ref->layer;
-      barrier->subresourceRange.layerCount     = 1u;
-      barrier->subresourceRange.baseMipLevel   = img_ref->mip_level;
-      barrier->subresourceRange.levelCount     = 1u;
-
-      const bool is_storage_image = img_ref->image->usage_flags & NGF_IMAGE_USAGE_STORAGE;
-
-      barrier->oldLayout =
-          is_storage_image ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-      barrier->newLayout =
-          is_storage_image ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-      const VkFormat image_format = img_ref->image->vkformat;
-      const bool     is_depth     = ngfvk_format_is_depth(image_format);
-      const bool     is_stencil   = ngfvk_format_is_stencil(image_format);
-
-      barrier->subresourceRange.aspectMask =
-          is_depth ? (VK_IMAGE_ASPECT_DEPTH_BIT | (is_stencil ? VK_IMAGE_ASPECT_STENCIL_BIT : 0))
-                   : VK_IMAGE_ASPECT_COLOR_BIT;
+      barrier->sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+      barrier->pNext               = NULL;
+      barrier->srcAccessMask       = image_access_flags & possible_src_access_flag_bits;
+      barrier->dstAccessMask       = image_access_flags & possible_dst_access_flag_bits;
+      barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier->image               = (VkImage)img_ref->image->alloc.obj_handle;
+      barrier->oldLayout = ngfvk_sync_image_ref_range(img_ref, &barrier->subresourceRange);
+      barrier->newLayout = barrier->oldLayout;
     } else {
       assert(false);
     }
   }
 }
 
+// Events can't be waited on across queues, so resources written by compute encoders of cmd buffers
+// executing on the compute queue are handed over to the graphics queue instead. This records the
+// acquire barriers for such resources into the given cmd buffer, and stores the matching release
+// barriers in it, to be recorded on the compute queue at submission time. The remaining resources,
+// which are synchronized with events as usual, are returned in `sync_resources`.
+static ngf_error ngfvk_acquire_from_compute_queue(
+    ngf_cmd_buffer                    cmd_buf,
+    uint32_t*                         nsync_resources,
+    const ngf_sync_compute_resource** sync_resources,
+    VkAccessFlags                     possible_src_access_flag_bits,
+    VkAccessFlags                     possible_dst_access_flag_bits,
+    VkPipelineStageFlags              dst_stage_mask) {
+  uint32_t nacquires = 0u;
+  for (uint32_t i = 0u; i < *nsync_resources; ++i) {
+    const ngf_cmd_buffer src_cmd_buf =
+        (ngf_cmd_buffer)(*sync_resources)[i].encoder.pvt_data_donotuse.d0;
+    if (src_cmd_buf->queue == NGFVK_QUEUE_COMPUTE) { ++nacquires; }
+  }
+  if (nacquires == 0u) { return NGF_ERROR_OK; }
+
+  const uint32_t             nremaining_max = *nsync_resources - nacquires;
+  ngf_sync_compute_resource* remaining =
+      nremaining_max > 0u
+          ? ngfi_sa_alloc(ngfi_tmp_store(), sizeof(ngf_sync_compute_resource) * nremaining_max)
+          : NULL;
+  VkBufferMemoryBarrier* buf_acquires =
+      ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkBufferMemoryBarrier) * nacquires);
+  VkImageMemoryBarrier* img_acquires =
+      ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkImageMemoryBarrier) * nacquires);
+  if ((nremaining_max > 0u && remaining == NULL) || buf_acquires == NULL || img_acquires == NULL) {
+    return NGF_ERROR_OUT_OF_MEM;
+  }
+
+  uint32_t nremaining = 0u, nbuf_acquires = 0u, nimg_acquires = 0u;
+  for (uint32_t i = 0u; i < *nsync_resources; ++i) {
+    const ngf_sync_compute_resource* sync_res = &(*sync_resources)[i];
+    const ngf_cmd_buffer src_cmd_buf = (ngf_cmd_buffer)sync_res->encoder.pvt_data_donotuse.d0;
+    if (src_cmd_buf->queue != NGFVK_QUEUE_COMPUTE) {
+      remaining[nremaining++] = *sync_res;
+    } else if (sync_res->resource.sync_resource_type == NGF_SYNC_RESOURCE_BUFFER) {
+      const ngf_buffer_slice* buf_slice    = &sync_res->resource.resource.buffer_slice;
+      const VkAccessFlags     access_flags = get_vk_buffer_access_flags(buf_slice->buffer);
+      VkBufferMemoryBarrier   release;
+      ngfvk_buffer_ownership_barriers(
+          _vk.compute_family_idx,
+          access_flags & possible_src_access_flag_bits,
+          (VkBuffer)buf_slice->buffer->alloc.obj_handle,
+          buf_slice->offset,
+          buf_slice->range,
+          access_flags & possible_dst_access_flag_bits,
+          &release,
+          &buf_acquires[nbuf_acquires++]);
+      NGFI_DARRAY_APPEND(cmd_buf->ownership_buf_barriers, release);
+    } else {
+      const ngf_image_ref*    img_ref      = &sync_res->resource.resource.image_ref;
+      const VkAccessFlags     access_flags = get_vk_image_access_flags(img_ref->image);
+      VkImageSubresourceRange range;
+      const VkImageLayout     layout = ngfvk_sync_image_ref_range(img_ref, &range);
+      VkImageMemoryBarrier    release;
+      ngfvk_image_ownership_barriers(
+          _vk.compute_family_idx,
+          access_flags & possible_src_access_flag_bits,
+          (VkImage)img_ref->image->alloc.obj_handle,
+          &range,
+          layout,
+          layout,
+          access_flags & possible_dst_access_flag_bits,
+          &release,
+          &img_acquires[nimg_acquires++]);
+      NGFI_DARRAY_APPEND(cmd_buf->ownership_img_barriers, release);
+    }
+  }
+
+  // Ordered after the compute queue's work by a semaphore wait at submission time.
+  vkCmdPipelineBarrier(
+      cmd_buf->vk_cmd_buffer,
+      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+      dst_stage_mask,
+      0u,
+      0u,
+      NULL,
+      nbuf_acquires,
+      buf_acquires,
+      nimg_acquires,
+      img_acquires);
+  cmd_buf->waits_on_compute = true;
+  *nsync_resources          = nremaining;
+  *sync_resources           = remaining;
+  return NGF_ERROR_OK;
+}
+
 static ngf_error ngfvk_execute_sync_op(
     ngf_cmd_buffer                   cmd_buf,
     uint32_t                         nsync_compute_resources,
@@ -2517,6 +4365,20 @@ static ngf_error ngfvk_execute_sync_op(
     return NGF_ERROR_INVALID_OPERATION;
   }
 
+  // Cmd buffers executing on the compute queue may only wait on work done on the same queue.
+  if (_vk.compute_queue != VK_NULL_HANDLE && cmd_buf->queue == NGFVK_QUEUE_COMPUTE) {
+    bool syncs_with_other_queue = nsync_render_resources > 0u || nsync_xfer_resources > 0u;
+    for (uint32_t i = 0u; i < nsync_compute_resources && !syncs_with_other_queue; ++i) {
+      const ngf_cmd_buffer src_cmd_buf =
+          (ngf_cmd_buffer)sync_compute_resources[i].encoder.pvt_data_donotuse.d0;
+      syncs_with_other_queue = src_cmd_buf->queue != NGFVK_QUEUE_COMPUTE;
+    }
+    if (syncs_with_other_queue) {
+      NGFI_DIAG_ERROR("async compute cmd buffers may only sync with other async compute work");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+  }
+
   // Holds pointers to temporarily allocated memory used to store parameters for vkCmdWaitEvents.
   struct ngfvk_wait_events_params temp_data;
   memset(&temp_data, 0, sizeof(temp_data));
@@ -2588,7 +4450,8 @@ static ngf_error ngfvk_execute_sync_op(
     if (temp_data.buffer_memory_barriers == NULL) { return NGF_ERROR_OUT_OF_MEM; }
   }
 
-  // Compute source and destination access flags for memory barriers.
+  // Compute source and destination access flags for memory barriers. These are also used as the
+  // source access flags of compute work, so they must only contain accesses performed by shaders.
   const VkAccessFlagBits possible_compute_access_flag_bits =
       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_UNIFORM_READ_BIT;
 
@@ -2601,12 +4464,29 @@ static ngf_error ngfvk_execute_sync_op(
       VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
       VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
 
+  // Indirect command reads are only supported by the draw indirect stage, which both render and
+  // compute passes wait on, so they're accounted for separately.
+  const VkPipelineStageFlags gfx_stage_mask =
+      NGFVK_GFX_PIPELINE_STAGE_MASK & ~(VkPipelineStageFlags)VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
   const VkAccessFlags possible_dst_access_flag_bits =
       ((dst_stage_mask & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) ? possible_compute_access_flag_bits
                                                                : 0u) |
-      ((dst_stage_mask & NGFVK_GFX_PIPELINE_STAGE_MASK) ? possible_gfx_access_flag_bits : 0u) |
+      ((dst_stage_mask & gfx_stage_mask) ? possible_gfx_access_flag_bits : 0u) |
+      ((dst_stage_mask & VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT) ? VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+                                                              : 0u) |
       ((dst_stage_mask & VK_PIPELINE_STAGE_TRANSFER_BIT) ? possible_xfer_access_flag_bits : 0u);
 
+  if (_vk.compute_queue != VK_NULL_HANDLE && cmd_buf->queue == NGFVK_QUEUE_GFX) {
+    const ngf_error err = ngfvk_acquire_from_compute_queue(
+        cmd_buf,
+        &nsync_compute_resources,
+        &sync_compute_resources,
+        possible_compute_access_flag_bits,
+        possible_dst_access_flag_bits,
+        dst_stage_mask);
+    if (err != NGF_ERROR_OK) { return err; }
+  }
+
   // Generate barrier structs.
   union ngfvk_sync_resources sync_res_union = {.sync_compute_resources = sync_compute_resources};
   ngfvk_generate_sync_op_barriers(
@@ -2619,6 +4499,13 @@ static ngf_error ngfvk_execute_sync_op(
 
   // It only makes sense for compute encoders to sync with render / transfer encoders.
   const bool dst_is_compute = dst_stage_mask & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  for (uint32_t i = 0; dst_is_compute && i < nsync_xfer_resources; ++i) {
+    // Encoders of cmd buffers executing on the transfer queue don't have events to wait on.
+    if ((VkEvent)sync_xfer_resources[i].encoder.pvt_data_donotuse.d1 == VK_NULL_HANDLE) {
+      NGFI_DIAG_ERROR("can't synchronize with a transfer encoder of an async transfer cmd buffer");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+  }
   if (dst_is_compute) {
     sync_res_union.sync_render_resources = sync_render_resources;
     ngfvk_generate_sync_op_barriers(
@@ -2703,71 +4590,614 @@ static bool ngfvk_phys_dev_extension_supported(const char* ext_name) {
   return false;
 }
 
-static ngf_error ngfvk_submit_pending_cmd_buffers(
-    ngfvk_frame_resources* frame_res,
-    VkSemaphore            wait_semaphore,
-    VkFence                signal_fence) {
-  ngf_error err = NGF_ERROR_OK;
+// Hands out an unsignaled semaphore for ordering a submission to one queue after a submission to
+// another queue within the current frame.
+static ngf_error ngfvk_get_queue_semaphore(ngfvk_frame_resources* frame_res, VkSemaphore* result) {
+  if (frame_res->nused_queue_semaphores < NGFI_DARRAY_SIZE(frame_res->queue_semaphores)) {
+    *result = NGFI_DARRAY_AT(frame_res->queue_semaphores, frame_res->nused_queue_semaphores++);
+    return NGF_ERROR_OK;
+  }
+  const VkSemaphoreCreateInfo semaphore_info = {
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+      .pNext = NULL,
+      .flags = 0u,
+  };
+  if (vkCreateSemaphore(_vk.device, &semaphore_info, NULL, result) != VK_SUCCESS) {
+    return NGF_ERROR_OBJECT_CREATION_FAILED;
+  }
+  NGFI_DARRAY_APPEND(frame_res->queue_semaphores, *result);
+  frame_res->nused_queue_semaphores++;
+  return NGF_ERROR_OK;
+}
 
-  bool needs_present = wait_semaphore != VK_NULL_HANDLE;
+// Returns true if the given image has its ownership acquired by any of the given barriers.
+static bool ngfvk_image_acquired_from_xfer_queue(
+    VkImage                     image,
+    const VkImageMemoryBarrier* acquire_barriers,
+    uint32_t                    nacquire_barriers) {
+  for (uint32_t i = 0u; i < nacquire_barriers; ++i) {
+    if (acquire_barriers[i].image == image) { return true; }
+  }
+  return false;
+}
 
-  // Prep a command buffer for pending image barriers if necessary.
-  pthread_mutex_lock(&NGFVK_PENDING_IMG_BARRIER_QUEUE.lock);
-  const uint32_t npending_barriers = NGFI_DARRAY_SIZE(NGFVK_PENDING_IMG_BARRIER_QUEUE.barriers);
-  const bool     have_deferred_barriers = npending_barriers > 0;
+// Submits the given command buffers to the transfer queue, signaling a semaphore that the next
+// submission to the graphics queue waits on. `cmd_bufs[0]` is reserved for a command buffer with
+// the initial layout transitions of the images written by the submission, and is filled in here.
+static ngf_error ngfvk_submit_xfer_cmd_buffers(
+    ngfvk_frame_resources* frame_res,
+    VkCommandBuffer*       cmd_bufs,
+    uint32_t               ncmd_bufs,
+    uint32_t               nfirst_img_acquire) {
+  ngfvk_flush_upload_chunks(frame_res);
+
+  const VkImageMemoryBarrier* img_acquires =
+      &NGFI_DARRAY_AT(frame_res->xfer_acquire_img_barriers, nfirst_img_acquire);
+  const uint32_t nimg_acquires =
+      NGFI_DARRAY_SIZE(frame_res->xfer_acquire_img_barriers) - nfirst_img_acquire;
+
+  // The initial layout transitions of the images written by this submission would discard their
+  // contents if they were performed later on the graphics queue, so they're moved over here.
+  uint32_t                npending_barriers = 0u;
+  ngfi_atomic_stack_node* pending_barrier_nodes =
+      ngfi_atomic_stack_take_all(&NGFVK_PENDING_IMG_BARRIER_QUEUE, &npending_barriers);
+  VkImageMemoryBarrier* xfer_barriers =
+      ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkImageMemoryBarrier) * (npending_barriers + 1u));
+  uint32_t nxfer_barriers = 0u;
+  while (pending_barrier_nodes != NULL) {
+    ngfi_atomic_stack_node*    node            = pending_barrier_nodes;
+    ngfvk_pending_img_barrier* pending_barrier =
+        NGFI_ATOMIC_STACK_CONTAINER_OF(node, ngfvk_pending_img_barrier, node);
+    pending_barrier_nodes = node->next;
+    if (xfer_barriers != NULL && ngfvk_image_acquired_from_xfer_queue(
+                                     pending_barrier->barrier.image,
+                                     img_acquires,
+                                     nimg_acquires)) {
+      VkImageMemoryBarrier* barrier = &xfer_barriers[nxfer_barriers++];
+      *barrier                      = pending_barrier->barrier;
+      barrier->dstAccessMask        = VK_ACCESS_TRANSFER_WRITE_BIT;
+      NGFI_FREE(pending_barrier);
+    } else {
+      ngfi_atomic_stack_push(&NGFVK_PENDING_IMG_BARRIER_QUEUE, node);
+    }
+  }
 
-  if (have_deferred_barriers) {
-    VkCommandPool   pool;
-    VkCommandBuffer buffer;
-    ngfvk_cmd_buffer_allocate_for_frame(CURRENT_CONTEXT->current_frame_token, &pool, &buffer);
+  ngf_error err = ngfvk_cmd_buffer_allocate_for_frame(
+      CURRENT_CONTEXT->current_frame_token,
+      NGFVK_QUEUE_XFER,
+      &cmd_bufs[0]);
+  if (err != NGF_ERROR_OK) { return err; }
+  if (nxfer_barriers > 0u) {
     vkCmdPipelineBarrier(
-        buffer,
+        cmd_bufs[0],
         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-        VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-        0,
-        0,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0u,
+        0u,
         NULL,
-        0,
+        0u,
         NULL,
-        npending_barriers,
-        NGFVK_PENDING_IMG_BARRIER_QUEUE.barriers.data);
-    vkEndCommandBuffer(buffer);
-    NGFI_DARRAY_AT(frame_res->cmd_bufs, 0)  = buffer;
-    NGFI_DARRAY_AT(frame_res->cmd_pools, 0) = pool;
-    NGFI_DARRAY_CLEAR(NGFVK_PENDING_IMG_BARRIER_QUEUE.barriers);
+        nxfer_barriers,
+        xfer_barriers);
   }
-  pthread_mutex_unlock(&NGFVK_PENDING_IMG_BARRIER_QUEUE.lock);
+  vkEndCommandBuffer(cmd_bufs[0]);
 
-  const VkPipelineStageFlags wait_masks[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-  const uint32_t ncmd_bufs = have_deferred_barriers ? NGFI_DARRAY_SIZE(frame_res->cmd_bufs)
-                                                    : NGFI_DARRAY_SIZE(frame_res->cmd_bufs) - 1u;
+  VkSemaphore semaphore = VK_NULL_HANDLE;
+  err                   = ngfvk_get_queue_semaphore(frame_res, &semaphore);
+  if (err != NGF_ERROR_OK) { return err; }
+  NGFI_DARRAY_APPEND(frame_res->gfx_wait_semaphores, semaphore);
 
   const VkSubmitInfo submit_info = {
-      .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-      .pNext = NULL,
-      .pCommandBuffers =
-          have_deferred_barriers ? (frame_res->cmd_bufs.data) : &(frame_res->cmd_bufs.data[1]),
+      .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      .pNext                = NULL,
+      .pCommandBuffers      = cmd_bufs,
+      .commandBufferCount   = ncmd_bufs,
+      .pWaitDstStageMask    = NULL,
+      .pWaitSemaphores      = NULL,
+      .waitSemaphoreCount   = 0u,
+      .pSignalSemaphores    = &semaphore,
+      .signalSemaphoreCount = 1u};
+  const VkResult submit_result = vkQueueSubmit(_vk.xfer_queue, 1u, &submit_info, VK_NULL_HANDLE);
+  return submit_result == VK_SUCCESS ? NGF_ERROR_OK : NGF_ERROR_INVALID_OPERATION;
+}
+
+// Puts the given pending image barriers back into the queue, so that they're recorded by a
+// subsequent submission.
+static void ngfvk_requeue_pending_img_barriers(ngfi_atomic_stack_node* nodes) {
+  while (nodes != NULL) {
+    ngfi_atomic_stack_node* node = nodes;
+    nodes                        = node->next;
+    ngfi_atomic_stack_push(&NGFVK_PENDING_IMG_BARRIER_QUEUE, node);
+  }
+}
+
+// Submits the given command buffers to the compute queue. Their completion is waited on by the
+// frame's last submission to the graphics queue.
+static ngf_error ngfvk_submit_compute_cmd_buffers(
+    ngfvk_frame_resources* frame_res,
+    VkCommandBuffer*       cmd_bufs,
+    uint32_t               ncmd_bufs) {
+  ngfvk_flush_upload_chunks(frame_res);
+
+  VkSubmitInfo submit_infos[2];
+  uint32_t     nsubmit_infos = 0u;
+
+  // Images created since the last submission to the graphics queue may be used by the submitted
+  // work. Images are created with exclusive sharing, so their initial layout transitions are
+  // recorded on the compute queue, ahead of the submitted work, rather than on the graphics queue.
+  // The next submission to the graphics queue waits for the transitions. Images that are only used
+  // by the graphics queue afterwards are taken over without an ownership transfer, which leaves
+  // their contents undefined, same as they were right after creation.
+  VkCommandBuffer         barrier_cmd_buf       = VK_NULL_HANDLE;
+  VkSemaphore             barrier_semaphore     = VK_NULL_HANDLE;
+  uint32_t                npending_barriers     = 0u;
+  ngfi_atomic_stack_node* pending_barrier_nodes =
+      ngfi_atomic_stack_take_all(&NGFVK_PENDING_IMG_BARRIER_QUEUE, &npending_barriers);
+  if (pending_barrier_nodes != NULL) {
+    VkImageMemoryBarrier* pending_barriers =
+        ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkImageMemoryBarrier) * npending_barriers);
+    ngf_error err = pending_barriers != NULL ? NGF_ERROR_OK : NGF_ERROR_OUT_OF_MEM;
+    if (err == NGF_ERROR_OK) { err = ngfvk_get_queue_semaphore(frame_res, &barrier_semaphore); }
+    if (err == NGF_ERROR_OK) {
+      err = ngfvk_cmd_buffer_allocate_for_frame(
+          CURRENT_CONTEXT->current_frame_token,
+          NGFVK_QUEUE_COMPUTE,
+          &barrier_cmd_buf);
+    }
+    if (err != NGF_ERROR_OK) {
+      ngfvk_requeue_pending_img_barriers(pending_barrier_nodes);
+      return err;
+    }
+    for (uint32_t i = 0u; pending_barrier_nodes != NULL; ++i) {
+      ngfvk_pending_img_barrier* pending_barrier = NGFI_ATOMIC_STACK_CONTAINER_OF(
+          pending_barrier_nodes,
+          ngfvk_pending_img_barrier,
+          node);
+      pending_barrier_nodes = pending_barrier_nodes->next;
+      pending_barriers[i]   = pending_barrier->barrier;
+      // Only shader accesses are supported on the compute queue. Subsequent accesses on the
+      // graphics queue are covered by its semaphore wait.
+      pending_barriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+      NGFI_FREE(pending_barrier);
+    }
+    vkCmdPipelineBarrier(
+        barrier_cmd_buf,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0u,
+        0u,
+        NULL,
+        0u,
+        NULL,
+        npending_barriers,
+        pending_barriers);
+    vkEndCommandBuffer(barrier_cmd_buf);
+    NGFI_DARRAY_APPEND(frame_res->gfx_wait_semaphores, barrier_semaphore);
+    submit_infos[nsubmit_infos++] = (VkSubmitInfo){
+        .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext                = NULL,
+        .pCommandBuffers      = &barrier_cmd_buf,
+        .commandBufferCount   = 1u,
+        .pWaitDstStageMask    = NULL,
+        .pWaitSemaphores      = NULL,
+        .waitSemaphoreCount   = 0u,
+        .pSignalSemaphores    = &barrier_semaphore,
+        .signalSemaphoreCount = 1u};
+  }
+
+  submit_infos[nsubmit_infos++] = (VkSubmitInfo){
+      .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      .pNext                = NULL,
+      .pCommandBuffers      = cmd_bufs,
       .commandBufferCount   = ncmd_bufs,
-      .pWaitDstStageMask    = wait_masks,
-      .pWaitSemaphores      = needs_present ? &wait_semaphore : NULL,
-      .waitSemaphoreCount   = needs_present ? 1u : 0u,
+      .pWaitDstStageMask    = NULL,
+      .pWaitSemaphores      = NULL,
+      .waitSemaphoreCount   = 0u,
+      .pSignalSemaphores    = NULL,
+      .signalSemaphoreCount = 0u};
+  const VkResult submit_result =
+      vkQueueSubmit(_vk.compute_queue, nsubmit_infos, submit_infos, VK_NULL_HANDLE);
+  frame_res->compute_work_pending = true;
+  return submit_result == VK_SUCCESS ? NGF_ERROR_OK : NGF_ERROR_INVALID_OPERATION;
+}
+
+// Submits a batch to the compute queue that releases the ownership of the resources acquired by
+// the graphics queue, and signals a semaphore that the graphics queue has to wait on before
+// executing the cmd buffers that acquire them. Does nothing if there's been no work on the
+// compute queue since the last submission to the graphics queue.
+static ngf_error
+ngfvk_submit_compute_releases(ngfvk_frame_resources* frame_res, VkSemaphore* signal_semaphore) {
+  *signal_semaphore                    = VK_NULL_HANDLE;
+  const uint32_t nrelease_buf_barriers = NGFI_DARRAY_SIZE(frame_res->compute_release_buf_barriers);
+  const uint32_t nrelease_img_barriers = NGFI_DARRAY_SIZE(frame_res->compute_release_img_barriers);
+  const bool     have_release_barriers = nrelease_buf_barriers + nrelease_img_barriers > 0u;
+  if (!frame_res->compute_work_pending && !have_release_barriers) { return NGF_ERROR_OK; }
+
+  VkCommandBuffer release_cmd_buf = VK_NULL_HANDLE;
+  if (have_release_barriers) {
+    const ngf_error err = ngfvk_cmd_buffer_allocate_for_frame(
+        CURRENT_CONTEXT->current_frame_token,
+        NGFVK_QUEUE_COMPUTE,
+        &release_cmd_buf);
+    if (err != NGF_ERROR_OK) { return err; }
+    vkCmdPipelineBarrier(
+        release_cmd_buf,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0u,
+        0u,
+        NULL,
+        nrelease_buf_barriers,
+        frame_res->compute_release_buf_barriers.data,
+        nrelease_img_barriers,
+        frame_res->compute_release_img_barriers.data);
+    vkEndCommandBuffer(release_cmd_buf);
+    NGFI_DARRAY_CLEAR(frame_res->compute_release_buf_barriers);
+    NGFI_DARRAY_CLEAR(frame_res->compute_release_img_barriers);
+  }
+
+  const ngf_error err = ngfvk_get_queue_semaphore(frame_res, signal_semaphore);
+  if (err != NGF_ERROR_OK) { return err; }
+  const VkSubmitInfo submit_info = {
+      .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      .pNext                = NULL,
+      .pCommandBuffers      = &release_cmd_buf,
+      .commandBufferCount   = have_release_barriers ? 1u : 0u,
+      .pWaitDstStageMask    = NULL,
+      .pWaitSemaphores      = NULL,
+      .waitSemaphoreCount   = 0u,
+      .pSignalSemaphores    = signal_semaphore,
+      .signalSemaphoreCount = 1u};
+  frame_res->compute_work_pending = false;
+  const VkResult submit_result = vkQueueSubmit(_vk.compute_queue, 1u, &submit_info, VK_NULL_HANDLE);
+  return submit_result == VK_SUCCESS ? NGF_ERROR_OK : NGF_ERROR_INVALID_OPERATION;
+}
+
+// Adds the statistics gathered while recording a cmd buffer to the given ones, and clears them.
+static void ngfvk_merge_stats(ngf_context_stats* dst, ngf_context_stats* src) {
+  dst->descriptor_set_cache_hits += src->descriptor_set_cache_hits;
+  dst->descriptor_set_cache_misses += src->descriptor_set_cache_misses;
+  dst->descriptor_pools_created += src->descriptor_pools_created;
+  dst->cmd_buffer_allocations += src->cmd_buffer_allocations;
+  dst->redundant_state_changes_elided += src->redundant_state_changes_elided;
+  dst->render_pass_cache_hits += src->render_pass_cache_hits;
+  dst->render_pass_cache_misses += src->render_pass_cache_misses;
+  memset(src, 0, sizeof(ngf_context_stats));
+}
+
+static ngfvk_submission* ngfvk_submission_create(void) {
+  ngfvk_submission* sub = NGFI_ALLOC(ngfvk_submission);
+  if (sub == NULL) { return NULL; }
+  sub->node.next        = NULL;
+  sub->vk_cmd_buffer    = VK_NULL_HANDLE;
+  sub->waits_on_compute = false;
+  NGFI_DARRAY_RESET(sub->written_queries, 4u);
+  NGFI_DARRAY_RESET(sub->release_buf_barriers, 4u);
+  NGFI_DARRAY_RESET(sub->release_img_barriers, 4u);
+  NGFI_DARRAY_RESET(sub->events, 4u);
+  memset(&sub->stats, 0, sizeof(sub->stats));
+  return sub;
+}
+
+static void ngfvk_submission_destroy(ngfvk_submission* sub) {
+  NGFI_DARRAY_DESTROY(sub->written_queries);
+  NGFI_DARRAY_DESTROY(sub->release_buf_barriers);
+  NGFI_DARRAY_DESTROY(sub->release_img_barriers);
+  NGFI_DARRAY_DESTROY(sub->events);
+  NGFI_FREE(sub);
+}
+
+// Moves the graphics queue cmd buffers that have been submitted during the given frame, along with
+// everything they hand over to the frame, into the frame's resources. Must be called on the thread
+// that the context is current on.
+static void ngfvk_collect_submissions(ngf_context ctx, ngfvk_frame_resources* frame_res) {
+  uint32_t                nsubmissions = 0u;
+  ngfi_atomic_stack_node* node = ngfi_atomic_stack_take_all(&frame_res->submissions, &nsubmissions);
+  while (node != NULL) {
+    ngfvk_submission* sub = NGFI_ATOMIC_STACK_CONTAINER_OF(node, ngfvk_submission, node);
+    node                  = node->next;
+    if (sub->waits_on_compute && frame_res->compute_wait_cmd_buf_idx == ~0u) {
+      frame_res->compute_wait_cmd_buf_idx = NGFI_DARRAY_SIZE(frame_res->cmd_bufs);
+    }
+    NGFI_DARRAY_APPEND(frame_res->cmd_bufs, sub->vk_cmd_buffer);
+    NGFI_DARRAY_FOREACH(sub->written_queries, r) {
+      const ngfvk_query_range range = NGFI_DARRAY_AT(sub->written_queries, r);
+      NGFI_DARRAY_APPEND(frame_res->written_queries, range);
+      if (range.deferred_reset) { NGFI_DARRAY_APPEND(frame_res->query_resets, range); }
+    }
+    NGFI_DARRAY_FOREACH(sub->release_buf_barriers, b) {
+      NGFI_DARRAY_APPEND(
+          frame_res->compute_release_buf_barriers,
+          NGFI_DARRAY_AT(sub->release_buf_barriers, b));
+    }
+    NGFI_DARRAY_FOREACH(sub->release_img_barriers, b) {
+      NGFI_DARRAY_APPEND(
+          frame_res->compute_release_img_barriers,
+          NGFI_DARRAY_AT(sub->release_img_barriers, b));
+    }
+    NGFI_DARRAY_FOREACH(sub->events, e) {
+      NGFI_DARRAY_APPEND(frame_res->retire_events, NGFI_DARRAY_AT(sub->events, e));
+    }
+    ngfvk_merge_stats(&ctx->stats, &sub->stats);
+    ctx->cmd_buffer_counter++;
+  }
+}
+
+static ngf_error ngfvk_submit_pending_cmd_buffers(
+    ngfvk_frame_resources* frame_res,
+    VkSemaphore            wait_semaphore,
+    VkFence                signal_fence) {
+  ngf_error err = NGF_ERROR_OK;
+
+  bool needs_present = wait_semaphore != VK_NULL_HANDLE;
+
+  ngfvk_collect_submissions(CURRENT_CONTEXT, frame_res);
+  ngfvk_flush_upload_chunks(frame_res);
+
+  // Prep a command buffer for pending image barriers if necessary.
+  uint32_t                npending_barriers = 0u;
+  ngfi_atomic_stack_node* pending_barrier_nodes =
+      ngfi_atomic_stack_take_all(&NGFVK_PENDING_IMG_BARRIER_QUEUE, &npending_barriers);
+  VkImageMemoryBarrier* pending_barriers =
+      npending_barriers > 0u ? NGFI_ALLOCN(VkImageMemoryBarrier, npending_barriers) : NULL;
+  if (npending_barriers > 0u && pending_barriers == NULL) {
+    // The transitions are left for a subsequent submission.
+    NGFI_DIAG_ERROR("Failed to allocate storage for pending image layout transitions.");
+    ngfvk_requeue_pending_img_barriers(pending_barrier_nodes);
+    return NGF_ERROR_OUT_OF_MEM;
+  }
+  const uint32_t nacquire_buf_barriers = NGFI_DARRAY_SIZE(frame_res->xfer_acquire_buf_barriers);
+  const uint32_t nacquire_img_barriers = NGFI_DARRAY_SIZE(frame_res->xfer_acquire_img_barriers);
+  const bool     have_acquire_barriers = nacquire_buf_barriers + nacquire_img_barriers > 0u;
+  const bool     have_query_resets      = !NGFI_DARRAY_EMPTY(frame_res->query_resets);
+  const bool     have_deferred_barriers =
+      pending_barriers != NULL || have_acquire_barriers || have_query_resets;
+
+  if (have_deferred_barriers) {
+    VkCommandBuffer buffer = VK_NULL_HANDLE;
+    err                    = ngfvk_cmd_buffer_allocate_for_frame(
+        CURRENT_CONTEXT->current_frame_token,
+        NGFVK_QUEUE_GFX,
+        &buffer);
+    if (err != NGF_ERROR_OK) {
+      ngfvk_requeue_pending_img_barriers(pending_barrier_nodes);
+      if (pending_barriers != NULL) { NGFI_FREEN(pending_barriers, npending_barriers); }
+      return err;
+    }
+    for (uint32_t i = 0u; pending_barrier_nodes != NULL; ++i) {
+      ngfvk_pending_img_barrier* pending_barrier = NGFI_ATOMIC_STACK_CONTAINER_OF(
+          pending_barrier_nodes,
+          ngfvk_pending_img_barrier,
+          node);
+      pending_barrier_nodes = pending_barrier_nodes->next;
+      pending_barriers[i]   = pending_barrier->barrier;
+      NGFI_FREE(pending_barrier);
+    }
+    if (pending_barriers != NULL) {
+      vkCmdPipelineBarrier(
+          buffer,
+          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+          VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          0,
+          0,
+          NULL,
+          0,
+          NULL,
+          npending_barriers,
+          pending_barriers);
+      NGFI_FREEN(pending_barriers, npending_barriers);
+    }
+    if (have_acquire_barriers) {
+      // Ordered after the transfer queue's work by the semaphore wait below.
+      vkCmdPipelineBarrier(
+          buffer,
+          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+          0,
+          0,
+          NULL,
+          nacquire_buf_barriers,
+          frame_res->xfer_acquire_buf_barriers.data,
+          nacquire_img_barriers,
+          frame_res->xfer_acquire_img_barriers.data);
+      NGFI_DARRAY_CLEAR(frame_res->xfer_acquire_buf_barriers);
+      NGFI_DARRAY_CLEAR(frame_res->xfer_acquire_img_barriers);
+    }
+    NGFI_DARRAY_FOREACH(frame_res->query_resets, r) {
+      const ngfvk_query_range* range = &NGFI_DARRAY_AT(frame_res->query_resets, r);
+      vkCmdResetQueryPool(buffer, range->pool->vk_pool, range->first, range->count);
+    }
+    NGFI_DARRAY_CLEAR(frame_res->query_resets);
+    vkEndCommandBuffer(buffer);
+    NGFI_DARRAY_AT(frame_res->cmd_bufs, 0) = buffer;
+  }
+
+  // Release the resources acquired from the compute queue. Cmd buffers starting with the first one
+  // that acquires them are split off into a separate batch that waits on the release.
+  VkSemaphore compute_semaphore = VK_NULL_HANDLE;
+  err                           = ngfvk_submit_compute_releases(frame_res, &compute_semaphore);
+  if (err != NGF_ERROR_OK) { return err; }
+  const uint32_t first_cmd_buf = have_deferred_barriers ? 0u : 1u;
+  const uint32_t ncmd_bufs     = NGFI_DARRAY_SIZE(frame_res->cmd_bufs);
+  const uint32_t split_cmd_buf = NGFI_MIN(frame_res->compute_wait_cmd_buf_idx, ncmd_bufs);
+  frame_res->compute_wait_cmd_buf_idx = ~0u;
+
+  // The cmd buffers preceding the first one that acquires resources from the compute queue are
+  // submitted in a separate batch, which doesn't wait on the compute queue. The last batch signals
+  // the present semaphore.
+  const bool split_batches = compute_semaphore != VK_NULL_HANDLE && split_cmd_buf > first_cmd_buf;
+
+  // Wait on the swapchain image as well as on any transfer queue submissions made since the last
+  // submission to the graphics queue. When the submission is split, only the first batch waits on
+  // those, and the last batch waits on the first one, in addition to the compute queue.
+  VkSemaphore batch_semaphore = VK_NULL_HANDLE;
+  if (split_batches) {
+    err = ngfvk_get_queue_semaphore(frame_res, &batch_semaphore);
+    if (err != NGF_ERROR_OK) { return err; }
+  }
+  const uint32_t nxfer_semaphores = NGFI_DARRAY_SIZE(frame_res->gfx_wait_semaphores);
+  const uint32_t nwait_semaphores = nxfer_semaphores + (needs_present ? 1u : 0u) +
+                                    (compute_semaphore != VK_NULL_HANDLE ? 1u : 0u);
+  const uint32_t nwait_slots      = nwait_semaphores + (split_batches ? 1u : 0u);
+  VkSemaphore*          wait_semaphores = NULL;
+  VkPipelineStageFlags* wait_masks      = NULL;
+  if (nwait_slots > 0u) {
+    wait_semaphores = ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkSemaphore) * nwait_slots);
+    wait_masks      = ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkPipelineStageFlags) * nwait_slots);
+    if (wait_semaphores == NULL || wait_masks == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  }
+  for (uint32_t i = 0u; i < nxfer_semaphores; ++i) {
+    wait_semaphores[i] = NGFI_DARRAY_AT(frame_res->gfx_wait_semaphores, i);
+    wait_masks[i]      = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  }
+  NGFI_DARRAY_CLEAR(frame_res->gfx_wait_semaphores);
+  if (needs_present) {
+    wait_semaphores[nxfer_semaphores] = wait_semaphore;
+    wait_masks[nxfer_semaphores]      = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+  }
+  if (compute_semaphore != VK_NULL_HANDLE) {
+    wait_semaphores[nwait_semaphores - 1u] = compute_semaphore;
+    wait_masks[nwait_semaphores - 1u]      = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  }
+  if (split_batches) {
+    wait_semaphores[nwait_semaphores] = batch_semaphore;
+    wait_masks[nwait_semaphores]      = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  }
+
+  const uint32_t nfirst_batch_waits = split_batches ? nwait_semaphores - 1u : 0u;
+  const uint32_t last_batch_cmd_buf = split_batches ? split_cmd_buf : first_cmd_buf;
+  VkSubmitInfo   submit_infos[2];
+  uint32_t       nsubmit_infos = 0u;
+  if (split_batches) {
+    submit_infos[nsubmit_infos++] = (VkSubmitInfo){
+        .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext                = NULL,
+        .pCommandBuffers      = &frame_res->cmd_bufs.data[first_cmd_buf],
+        .commandBufferCount   = split_cmd_buf - first_cmd_buf,
+        .pWaitDstStageMask    = wait_masks,
+        .pWaitSemaphores      = wait_semaphores,
+        .waitSemaphoreCount   = nfirst_batch_waits,
+        .pSignalSemaphores    = &batch_semaphore,
+        .signalSemaphoreCount = 1u};
+  }
+  submit_infos[nsubmit_infos++] = (VkSubmitInfo){
+      .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      .pNext                = NULL,
+      .pCommandBuffers      = &frame_res->cmd_bufs.data[last_batch_cmd_buf],
+      .commandBufferCount   = ncmd_bufs - last_batch_cmd_buf,
+      .pWaitDstStageMask    = nwait_slots > 0u ? &wait_masks[nfirst_batch_waits] : NULL,
+      .pWaitSemaphores      = nwait_slots > 0u ? &wait_semaphores[nfirst_batch_waits] : NULL,
+      .waitSemaphoreCount   = nwait_slots - nfirst_batch_waits,
       .pSignalSemaphores    = needs_present ? &(frame_res->semaphore) : NULL,
       .signalSemaphoreCount = needs_present ? 1u : 0u};
 
-  VkResult submit_result = vkQueueSubmit(_vk.gfx_queue, 1, &submit_info, signal_fence);
+  VkResult submit_result = vkQueueSubmit(_vk.gfx_queue, nsubmit_infos, submit_infos, signal_fence);
 
   if (submit_result != VK_SUCCESS) err = NGF_ERROR_INVALID_OPERATION;
 
   return err;
 }
 
-void ngfvk_reset_renderpass_cache(ngf_context ctx) {
-  NGFI_DARRAY_FOREACH(ctx->renderpass_cache, p) {
-    NGFI_DARRAY_APPEND(
-        ctx->frame_res[ctx->frame_id].retire_render_passes,
-        NGFI_DARRAY_AT(ctx->renderpass_cache, p).renderpass);
+static void ngfvk_shadow_state_reset(ngfvk_cmd_shadow_state* shadow) {
+  shadow->valid_mask        = 0u;
+  shadow->valid_attrib_bufs = 0u;
+}
+
+// The ngfvk_shadow_set_* functions below return false if the given value is already known to be
+// set. Otherwise, they update the shadow state and return true, and the caller must record the
+// corresponding command.
+
+static bool ngfvk_shadow_set_gfx_pipeline(ngfvk_cmd_shadow_state* shadow, VkPipeline pipeline) {
+  if ((shadow->valid_mask & NGFVK_SHADOW_GFX_PIPELINE) && shadow->gfx_pipeline == pipeline) {
+    return false;
+  }
+  shadow->gfx_pipeline = pipeline;
+  // Stencil state is not dynamic in nicegraf pipelines, so binding a different pipeline overrides
+  // any values that have been set previously.
+  shadow->valid_mask = (shadow->valid_mask | NGFVK_SHADOW_GFX_PIPELINE) &
+                       ~(uint32_t)(NGFVK_SHADOW_STENCIL_REFERENCE |
+                                   NGFVK_SHADOW_STENCIL_COMPARE_MASK |
+                                   NGFVK_SHADOW_STENCIL_WRITE_MASK);
+  return true;
+}
+
+static bool ngfvk_shadow_set_attrib_buf(
+    ngfvk_cmd_shadow_state* shadow,
+    uint32_t                binding,
+    VkBuffer                buf,
+    VkDeviceSize            offset) {
+  if (binding >= NGFVK_MAX_SHADOWED_ATTRIB_BINDINGS) { return true; }
+  const uint32_t binding_bit = 1u << binding;
+  if ((shadow->valid_attrib_bufs & binding_bit) && shadow->attrib_bufs[binding] == buf &&
+      shadow->attrib_buf_offsets[binding] == offset) {
+    return false;
+  }
+  shadow->attrib_bufs[binding]        = buf;
+  shadow->attrib_buf_offsets[binding] = offset;
+  shadow->valid_attrib_bufs |= binding_bit;
+  return true;
+}
+
+static bool ngfvk_shadow_set_index_buf(
+    ngfvk_cmd_shadow_state* shadow,
+    VkBuffer                buf,
+    VkDeviceSize            offset,
+    VkIndexType             type) {
+  if ((shadow->valid_mask & NGFVK_SHADOW_INDEX_BUFFER) && shadow->index_buf == buf &&
+      shadow->index_buf_offset == offset && shadow->index_type == type) {
+    return false;
+  }
+  shadow->index_buf        = buf;
+  shadow->index_buf_offset = offset;
+  shadow->index_type       = type;
+  shadow->valid_mask |= NGFVK_SHADOW_INDEX_BUFFER;
+  return true;
+}
+
+static bool ngfvk_shadow_set_viewport(ngfvk_cmd_shadow_state* shadow, const VkViewport* viewport) {
+  if ((shadow->valid_mask & NGFVK_SHADOW_VIEWPORT) &&
+      memcmp(&shadow->viewport, viewport, sizeof(VkViewport)) == 0) {
+    return false;
+  }
+  shadow->viewport = *viewport;
+  shadow->valid_mask |= NGFVK_SHADOW_VIEWPORT;
+  return true;
+}
+
+static bool ngfvk_shadow_set_scissor(ngfvk_cmd_shadow_state* shadow, const VkRect2D* scissor) {
+  if ((shadow->valid_mask & NGFVK_SHADOW_SCISSOR) &&
+      memcmp(&shadow->scissor, scissor, sizeof(VkRect2D)) == 0) {
+    return false;
+  }
+  shadow->scissor = *scissor;
+  shadow->valid_mask |= NGFVK_SHADOW_SCISSOR;
+  return true;
+}
+
+static bool ngfvk_shadow_set_stencil_values(
+    ngfvk_cmd_shadow_state* shadow,
+    ngfvk_shadow_state_bit  bit,
+    uint32_t                values[2],
+    uint32_t                front,
+    uint32_t                back) {
+  if ((shadow->valid_mask & bit) && values[0] == front && values[1] == back) { return false; }
+  values[0] = front;
+  values[1] = back;
+  shadow->valid_mask |= bit;
+  return true;
+}
+
+// Destroys all render pass objects held in the given context's cache, along with the cache itself.
+// Must only be called once the device is idle.
+static void ngfvk_destroy_renderpass_cache(ngf_context ctx) {
+  ngfvk_renderpass_cache* cache = &ctx->renderpass_cache;
+  for (uint32_t i = 0u; i < cache->capacity; ++i) {
+    if (cache->slots[i].renderpass != VK_NULL_HANDLE) {
+      vkDestroyRenderPass(_vk.device, cache->slots[i].renderpass, NULL);
+    }
   }
-  NGFI_DARRAY_CLEAR(ctx->renderpass_cache);
+  if (cache->slots) { NGFI_FREEN(cache->slots, cache->capacity); }
+  memset(cache, 0, sizeof(ngfvk_renderpass_cache));
 }
 
 #pragma endregion
@@ -2788,6 +5218,18 @@ ngf_error ngf_get_device_list(const ngf_device** devices, uint32_t* ndevices) {
             vkGetInstanceProcAddr(tmp_instance, "vkGetPhysicalDeviceProperties");
     PFN_vkGetPhysicalDeviceFeatures get_vk_phys_dev_features = (PFN_vkGetPhysicalDeviceFeatures)
         vkGetInstanceProcAddr(tmp_instance, "vkGetPhysicalDeviceFeatures");
+    PFN_vkEnumerateDeviceExtensionProperties enumerate_vk_dev_exts =
+        (PFN_vkEnumerateDeviceExtensionProperties)
+            vkGetInstanceProcAddr(tmp_instance, "vkEnumerateDeviceExtensionProperties");
+    PFN_vkGetPhysicalDeviceFeatures2KHR get_vk_phys_dev_features2 =
+        (PFN_vkGetPhysicalDeviceFeatures2KHR)
+            vkGetInstanceProcAddr(tmp_instance, "vkGetPhysicalDeviceFeatures2KHR");
+    PFN_vkGetPhysicalDeviceProperties2KHR get_vk_phys_dev_properties2 =
+        (PFN_vkGetPhysicalDeviceProperties2KHR)
+            vkGetInstanceProcAddr(tmp_instance, "vkGetPhysicalDeviceProperties2KHR");
+    PFN_vkGetPhysicalDeviceQueueFamilyProperties get_vk_queue_family_properties =
+        (PFN_vkGetPhysicalDeviceQueueFamilyProperties)
+            vkGetInstanceProcAddr(tmp_instance, "vkGetPhysicalDeviceQueueFamilyProperties");
     PFN_vkDestroyInstance destroy_vk_instance =
         (PFN_vkDestroyInstance)vkGetInstanceProcAddr(tmp_instance, "vkDestroyInstance");
     vk_err = enumerate_vk_phys_devs(tmp_instance, &NGFVK_DEVICE_COUNT, NULL);
@@ -2865,6 +5307,99 @@ ngf_error ngf_get_device_list(const ngf_device** devices, uint32_t* ndevices) {
           ngfi_get_highest_sample_count(devcaps->texture_color_sample_counts);
       devcaps->max_supported_texture_depth_sample_count =
           ngfi_get_highest_sample_count(devcaps->texture_depth_sample_counts);
+      devcaps->max_draw_indirect_count =
+          dev_features.multiDrawIndirect ? vkdevlimits->maxDrawIndirectCount : 1u;
+      devcaps->timestamp_queries_supported = vkdevlimits->timestampComputeAndGraphics;
+      devcaps->occlusion_queries_supported = true;
+      devcaps->pipeline_statistics_queries_supported = dev_features.pipelineStatisticsQuery;
+      devcaps->secondary_cmd_buffers_supported       = true;
+
+      uint32_t next_props = 0u;
+      bool     descriptor_indexing_ext_supported = false;
+      bool     maintenance3_ext_supported        = false;
+      devcaps->draw_indirect_count_supported     = false;
+      if (enumerate_vk_dev_exts(phys_devs[i], NULL, &next_props, NULL) == VK_SUCCESS &&
+          next_props > 0u) {
+        VkExtensionProperties* ext_props =
+            ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkExtensionProperties) * next_props);
+        if (ext_props != NULL &&
+            enumerate_vk_dev_exts(phys_devs[i], NULL, &next_props, ext_props) == VK_SUCCESS) {
+          for (uint32_t e = 0u; e < next_props; ++e) {
+            if (strcmp(ext_props[e].extensionName, "VK_KHR_draw_indirect_count") == 0) {
+              devcaps->draw_indirect_count_supported = true;
+            } else if (strcmp(ext_props[e].extensionName, "VK_EXT_descriptor_indexing") == 0) {
+              descriptor_indexing_ext_supported = true;
+            } else if (strcmp(ext_props[e].extensionName, "VK_KHR_maintenance3") == 0) {
+              maintenance3_ext_supported = true;
+            }
+          }
+        }
+      }
+
+      // Resource tables need descriptor indexing, with support for partially bound, variably
+      // sized arrays of sampled images and storage buffers that may be updated after binding.
+      devcaps->resource_tables_supported   = false;
+      devcaps->max_resource_table_capacity = 0u;
+      if (descriptor_indexing_ext_supported && maintenance3_ext_supported &&
+          get_vk_phys_dev_features2 != NULL && get_vk_phys_dev_properties2 != NULL) {
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexing_features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+            .pNext = NULL};
+        VkPhysicalDeviceFeatures2KHR features2 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &indexing_features};
+        get_vk_phys_dev_features2(phys_devs[i], &features2);
+        VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexing_props = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT,
+            .pNext = NULL};
+        VkPhysicalDeviceProperties2KHR props2 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &indexing_props};
+        get_vk_phys_dev_properties2(phys_devs[i], &props2);
+        devcaps->resource_tables_supported =
+            indexing_features.runtimeDescriptorArray &&
+            indexing_features.descriptorBindingPartiallyBound &&
+            indexing_features.descriptorBindingVariableDescriptorCount &&
+            indexing_features.descriptorBindingSampledImageUpdateAfterBind &&
+            indexing_features.descriptorBindingStorageBufferUpdateAfterBind &&
+            indexing_features.descriptorBindingUpdateUnusedWhilePending;
+        if (devcaps->resource_tables_supported) {
+          uint32_t capacity = NGFVK_MAX_RESOURCE_TABLE_CAPACITY;
+          capacity          = NGFI_MIN(
+              capacity,
+              indexing_props.maxPerStageDescriptorUpdateAfterBindSampledImages);
+          capacity = NGFI_MIN(
+              capacity,
+              indexing_props.maxPerStageDescriptorUpdateAfterBindStorageBuffers);
+          // Leave room for binding more than one table at a time.
+          capacity = NGFI_MIN(capacity, indexing_props.maxPerStageUpdateAfterBindResources / 2u);
+          devcaps->max_resource_table_capacity = capacity;
+          devcaps->resource_tables_supported   = capacity > 0u;
+        }
+      }
+
+      // Async transfers need a queue family that does transfers, but not graphics or compute.
+      uint32_t nqueue_families = 0u;
+      get_vk_queue_family_properties(phys_devs[i], &nqueue_families, NULL);
+      VkQueueFamilyProperties* queue_families =
+          ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkQueueFamilyProperties) * nqueue_families);
+      devcaps->async_xfer_supported    = false;
+      devcaps->async_compute_supported = false;
+      if (queue_families != NULL) {
+        get_vk_queue_family_properties(phys_devs[i], &nqueue_families, queue_families);
+        devcaps->async_xfer_supported =
+            ngfvk_find_dedicated_queue_family(
+                queue_families,
+                nqueue_families,
+                VK_QUEUE_TRANSFER_BIT,
+                VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT) != NGFVK_INVALID_IDX;
+        devcaps->async_compute_supported =
+            ngfvk_find_dedicated_queue_family(
+                queue_families,
+                nqueue_families,
+                VK_QUEUE_COMPUTE_BIT,
+                VK_QUEUE_GRAPHICS_BIT) != NGFVK_INVALID_IDX;
+      }
     }
 ngf_enumerate_devices_cleanup:
     if (tmp_instance != VK_NULL_HANDLE) { destroy_vk_instance(tmp_instance, NULL); }
@@ -2977,6 +5512,9 @@ ngf_error ngf_initialize(const ngf_init_info* init_info) {
   _vk.phys_dev = physdevs[vk_device_index];
   VkPhysicalDeviceProperties phys_dev_properties;
   vkGetPhysicalDeviceProperties(_vk.phys_dev, &phys_dev_properties);
+  _vk.device_list_idx = device_idx;
+  memcpy(_vk.pipeline_cache_uuid, phys_dev_properties.pipelineCacheUUID, VK_UUID_SIZE);
+  _vk.timestamp_period = phys_dev_properties.limits.timestampPeriod;
 
   // Obtain a list of queue family properties from the device.
   uint32_t num_queue_families = 0U;
@@ -2985,6 +5523,20 @@ ngf_error ngf_initialize(const ngf_init_info* init_info) {
       NGFI_ALLOCN(VkQueueFamilyProperties, num_queue_families);
   assert(queue_families);
   vkGetPhysicalDeviceQueueFamilyProperties(_vk.phys_dev, &num_queue_families, queue_families);
+  const uint32_t xfer_family_idx =
+      queue_families ? ngfvk_find_dedicated_queue_family(
+                           queue_families,
+                           num_queue_families,
+                           VK_QUEUE_TRANSFER_BIT,
+                           VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)
+                     : NGFVK_INVALID_IDX;
+  const uint32_t compute_family_idx =
+      queue_families ? ngfvk_find_dedicated_queue_family(
+                           queue_families,
+                           num_queue_families,
+                           VK_QUEUE_COMPUTE_BIT,
+                           VK_QUEUE_GRAPHICS_BIT)
+                     : NGFVK_INVALID_IDX;
 
   // Pick suitable queue families for graphics and present, ensuring graphics also supports compute.
   uint32_t gfx_family_idx     = NGFVK_INVALID_IDX;
@@ -2997,6 +5549,16 @@ ngf_error ngf_initialize(const ngf_init_info* init_info) {
     if (gfx_family_idx == NGFVK_INVALID_IDX && is_gfx && is_compute) { gfx_family_idx = q; }
     if (present_family_idx == NGFVK_INVALID_IDX && is_present) { present_family_idx = q; }
   }
+  const uint32_t family_idxs[NGFVK_QUEUE_COUNT] = {
+      [NGFVK_QUEUE_GFX]     = gfx_family_idx,
+      [NGFVK_QUEUE_XFER]    = xfer_family_idx,
+      [NGFVK_QUEUE_COMPUTE] = compute_family_idx};
+  for (uint32_t q = 0u; q < NGFVK_QUEUE_COUNT; ++q) {
+    const uint32_t valid_bits = queue_families && family_idxs[q] != NGFVK_INVALID_IDX
+                                    ? queue_families[family_idxs[q]].timestampValidBits
+                                    : 64u;
+    _vk.timestamp_masks[q] = valid_bits >= 64u ? ~0ull : (1ull << valid_bits) - 1ull;
+  }
   NGFI_FREEN(queue_families, num_queue_families);
   queue_families = NULL;
   if (gfx_family_idx == NGFVK_INVALID_IDX || present_family_idx == NGFVK_INVALID_IDX) {
@@ -3005,40 +5567,70 @@ ngf_error ngf_initialize(const ngf_init_info* init_info) {
   }
   _vk.gfx_family_idx     = gfx_family_idx;
   _vk.present_family_idx = present_family_idx;
+  _vk.xfer_family_idx    = xfer_family_idx;
+  // The present queue is never used for async compute work.
+  _vk.compute_family_idx =
+      compute_family_idx != present_family_idx ? compute_family_idx : NGFVK_INVALID_IDX;
 
   // Create logical device.
-  const float             queue_prio           = 1.0f;
-  const bool              same_gfx_and_present = _vk.gfx_family_idx == _vk.present_family_idx;
-  VkDeviceQueueCreateInfo queue_infos[]        = {
-      {.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-              .pNext            = NULL,
-              .flags            = 0,
-              .queueFamilyIndex = _vk.present_family_idx,
-              .queueCount       = 1,
-              .pQueuePriorities = &queue_prio},
-      {.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-              .pNext            = NULL,
-              .flags            = 0,
-              .queueFamilyIndex = _vk.gfx_family_idx,
-              .queueCount       = 1,
-              .pQueuePriorities = &queue_prio}};
-  const uint32_t num_queue_infos = (same_gfx_and_present ? 1u : 2u);
-  const char*    device_exts[]   = {
-      "VK_KHR_maintenance1",
-      "VK_KHR_swapchain",
-      "VK_KHR_shader_float16_int8"};
-  const uint32_t device_exts_count = sizeof(device_exts) / sizeof(const char*);
+  const float             queue_prio = 1.0f;
+  VkDeviceQueueCreateInfo queue_infos[4];
+  uint32_t                num_queue_infos = 0u;
+  const uint32_t          queue_family_idxs[] = {
+      _vk.gfx_family_idx,
+      _vk.present_family_idx != _vk.gfx_family_idx ? _vk.present_family_idx : NGFVK_INVALID_IDX,
+      _vk.xfer_family_idx,
+      _vk.compute_family_idx};
+  for (uint32_t q = 0u; q < NGFI_ARRAYSIZE(queue_family_idxs); ++q) {
+    if (queue_family_idxs[q] == NGFVK_INVALID_IDX) { continue; }
+    queue_infos[num_queue_infos++] = (VkDeviceQueueCreateInfo){
+        .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        .pNext            = NULL,
+        .flags            = 0,
+        .queueFamilyIndex = queue_family_idxs[q],
+        .queueCount       = 1,
+        .pQueuePriorities = &queue_prio};
+  }
+  const char*    device_exts[7]    = {"VK_KHR_maintenance1", "VK_KHR_swapchain"};
+  uint32_t       device_exts_count = 2u;
   const bool     shader_float16_int8_supported =
       ngfvk_phys_dev_extension_supported("VK_KHR_shader_float16_int8");
+  if (shader_float16_int8_supported) {
+    device_exts[device_exts_count++] = "VK_KHR_shader_float16_int8";
+  }
+  if (NGFVK_DEVICE_LIST[device_idx].capabilities.draw_indirect_count_supported) {
+    device_exts[device_exts_count++] = "VK_KHR_draw_indirect_count";
+  }
+  const bool desc_update_templates_supported =
+      ngfvk_phys_dev_extension_supported("VK_KHR_descriptor_update_template");
+  if (desc_update_templates_supported) {
+    device_exts[device_exts_count++] = "VK_KHR_descriptor_update_template";
+  }
+  const bool resource_tables_supported =
+      NGFVK_DEVICE_LIST[device_idx].capabilities.resource_tables_supported;
+  if (resource_tables_supported) {
+    device_exts[device_exts_count++] = "VK_KHR_maintenance3";
+    device_exts[device_exts_count++] = "VK_EXT_descriptor_indexing";
+  }
 
+  VkPhysicalDeviceFeatures supported_features;
+  vkGetPhysicalDeviceFeatures(_vk.phys_dev, &supported_features);
   const VkBool32 enable_cubemap_arrays =
       NGFVK_DEVICE_LIST[device_idx].capabilities.cubemap_arrays_supported ? VK_TRUE : VK_FALSE;
   const VkPhysicalDeviceFeatures required_features = {
-      .samplerAnisotropy = VK_TRUE,
-      .imageCubeArray    = enable_cubemap_arrays};
+      .samplerAnisotropy         = VK_TRUE,
+      .imageCubeArray            = enable_cubemap_arrays,
+      .multiDrawIndirect         = supported_features.multiDrawIndirect,
+      .drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance,
+      .occlusionQueryPrecise     = supported_features.occlusionQueryPrecise,
+      .pipelineStatisticsQuery   = supported_features.pipelineStatisticsQuery};
+  _vk.precise_occlusion_queries = supported_features.occlusionQueryPrecise;
+  VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexing_features = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+      .pNext = NULL};
   VkPhysicalDeviceShaderFloat16Int8Features sf16_features = {
       .sType         = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES,
-      .pNext         = NULL,
+      .pNext         = resource_tables_supported ? &indexing_features : NULL,
       .shaderFloat16 = false,
       .shaderInt8    = false};
 
@@ -3054,12 +5646,11 @@ ngf_error ngf_initialize(const ngf_init_info* init_info) {
       .pNext                = &sf16_features,
       .flags                = 0,
       .queueCreateInfoCount = num_queue_infos,
-      .pQueueCreateInfos    = &queue_infos[same_gfx_and_present ? 1u : 0u],
+      .pQueueCreateInfos    = queue_infos,
       .enabledLayerCount    = 0,
       .ppEnabledLayerNames  = NULL,
       .pEnabledFeatures     = &required_features,
-      .enabledExtensionCount =
-          shader_float16_int8_supported ? device_exts_count : device_exts_count - 1,
+      .enabledExtensionCount   = device_exts_count,
       .ppEnabledExtensionNames = device_exts};
   vk_err = vkCreateDevice(_vk.phys_dev, &dev_info, NULL, &_vk.device);
   if (vk_err != VK_SUCCESS) {
@@ -3069,14 +5660,21 @@ ngf_error ngf_initialize(const ngf_init_info* init_info) {
 
   // Load device-level entry points.
   vkl_init_device(_vk.device);
+  _vk.desc_update_templates_enabled =
+      desc_update_templates_supported && vkCreateDescriptorUpdateTemplateKHR != NULL &&
+      vkDestroyDescriptorUpdateTemplateKHR != NULL && vkUpdateDescriptorSetWithTemplateKHR != NULL;
 
   // Obtain queue handles.
   vkGetDeviceQueue(_vk.device, _vk.gfx_family_idx, 0, &_vk.gfx_queue);
   vkGetDeviceQueue(_vk.device, _vk.present_family_idx, 0, &_vk.present_queue);
-
-  // Initialize pending image barrier queue.
-  NGFI_DARRAY_RESET(NGFVK_PENDING_IMG_BARRIER_QUEUE.barriers, 10u);
-  pthread_mutex_init(&NGFVK_PENDING_IMG_BARRIER_QUEUE.lock, 0);
+  _vk.xfer_queue = VK_NULL_HANDLE;
+  if (_vk.xfer_family_idx != NGFVK_INVALID_IDX) {
+    vkGetDeviceQueue(_vk.device, _vk.xfer_family_idx, 0, &_vk.xfer_queue);
+  }
+  _vk.compute_queue = VK_NULL_HANDLE;
+  if (_vk.compute_family_idx != NGFVK_INVALID_IDX) {
+    vkGetDeviceQueue(_vk.device, _vk.compute_family_idx, 0, &_vk.compute_queue);
+  }
 
   // Populate device capabilities.
   DEVICE_CAPS = NGFVK_DEVICE_LIST[init_info->device].capabilities;
@@ -3091,6 +5689,17 @@ void ngf_shutdown(void) {
 
   if (CURRENT_CONTEXT != NULL) { NGFI_DIAG_ERROR("Context not destroyed before shutdown.") }
 
+  ngfi_atomic_stack_node* pending_barrier_node =
+      ngfi_atomic_stack_take_all(&NGFVK_PENDING_IMG_BARRIER_QUEUE, NULL);
+  while (pending_barrier_node != NULL) {
+    ngfvk_pending_img_barrier* pending_barrier = NGFI_ATOMIC_STACK_CONTAINER_OF(
+        pending_barrier_node,
+        ngfvk_pending_img_barrier,
+        node);
+    pending_barrier_node = pending_barrier_node->next;
+    NGFI_FREE(pending_barrier);
+  }
+
   vkDestroyDevice(_vk.device, NULL);
   if (_vk.validation_enabled) {
     vkDestroyDebugUtilsMessengerEXT(_vk.instance, _vk.debug_messenger, NULL);
@@ -3122,6 +5731,8 @@ ngf_error ngf_create_context(const ngf_context_info* info, ngf_context* result)
     goto ngf_create_context_cleanup;
   }
   memset(ctx, 0, sizeof(struct ngf_context_t));
+  pthread_mutex_init(&ctx->renderpass_cache_lock, NULL);
+  ngfvk_init_desc_pool_config(info->descriptor_pool_info, &ctx->desc_pool_config);
 
   // Set up VMA.
   VmaVulkanFunctions vma_vk_fns = {
@@ -3321,7 +5932,6 @@ ngf_error ngf_create_context(const ngf_context_info* info, ngf_context* result)
   }
   for (uint32_t f = 0u; f < max_inflight_frames; ++f) {
     NGFI_DARRAY_RESET(ctx->frame_res[f].cmd_bufs, 8u);
-    NGFI_DARRAY_RESET(ctx->frame_res[f].cmd_pools, 8u);
     NGFI_DARRAY_RESET(ctx->frame_res[f].retire_pipelines, 8);
     NGFI_DARRAY_RESET(ctx->frame_res[f].retire_pipeline_layouts, 8);
     NGFI_DARRAY_RESET(ctx->frame_res[f].retire_dset_layouts, 8);
@@ -3330,11 +5940,28 @@ ngf_error ngf_create_context(const ngf_context_info* info, ngf_context* result)
     NGFI_DARRAY_RESET(ctx->frame_res[f].retire_samplers, 8);
     NGFI_DARRAY_RESET(ctx->frame_res[f].retire_image_views, 8);
     NGFI_DARRAY_RESET(ctx->frame_res[f].retire_buffer_views, 8);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].retire_desc_pools, 8);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].retire_query_pools, 8);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].retire_cmd_pools, 8);
     NGFI_DARRAY_RESET(ctx->frame_res[f].retire_events, 8);
     NGFI_DARRAY_RESET(ctx->frame_res[f].real_retire_events, 8);
     NGFI_DARRAY_RESET(ctx->frame_res[f].retire_images, 8);
     NGFI_DARRAY_RESET(ctx->frame_res[f].retire_buffers, 8);
-    NGFI_DARRAY_RESET(ctx->frame_res[f].reset_desc_pools_lists, 8);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].written_queries, 8);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].query_resets, 8);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].retire_table_slots, 8);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].retire_bind_group_sets, 8);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].upload_chunks, 4);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].queue_semaphores, 4);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].gfx_wait_semaphores, 4);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].xfer_acquire_buf_barriers, 8);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].xfer_acquire_img_barriers, 8);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].compute_release_buf_barriers, 8);
+    NGFI_DARRAY_RESET(ctx->frame_res[f].compute_release_img_barriers, 8);
+    ctx->frame_res[f].nused_queue_semaphores   = 0u;
+    ctx->frame_res[f].compute_work_pending     = false;
+    ctx->frame_res[f].compute_wait_cmd_buf_idx = ~0u;
+    ctx->frame_res[f].submissions.head         = NULL;
 
     ctx->frame_res[f].semaphore                = VK_NULL_HANDLE;
     const VkSemaphoreCreateInfo semaphore_info = {
@@ -3364,20 +5991,38 @@ ngf_error ngf_create_context(const ngf_context_info* info, ngf_context* result)
 
   ctx->frame_id = 0u;
 
-  // initialize bind op allocator.
-  ctx->bind_op_chunk_allocator = ngfi_blkalloc_create(sizeof(ngfvk_bind_op_chunk), 256);
-  if (ctx->bind_op_chunk_allocator == NULL) {
-    err = NGF_ERROR_OBJECT_CREATION_FAILED;
-    goto ngf_create_context_cleanup;
+  ctx->current_frame_token = ~0u;
+
+  // Create the pipeline cache if requested.
+  if (info->enable_pipeline_cache) {
+    const VkPipelineCacheCreateInfo vk_pipeline_cache_info = {
+        .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext           = NULL,
+        .flags           = 0u,
+        .initialDataSize = 0u,
+        .pInitialData    = NULL};
+    vk_err =
+        vkCreatePipelineCache(_vk.device, &vk_pipeline_cache_info, NULL, &ctx->pipeline_cache);
+    if (vk_err != VK_SUCCESS) {
+      err = NGF_ERROR_OBJECT_CREATION_FAILED;
+      goto ngf_create_context_cleanup;
+    }
   }
 
-  ctx->current_frame_token = ~0u;
+  // Start the retirement thread if requested.
+  if (info->enable_background_retirement) {
+    ctx->retire_worker = ngfvk_retire_worker_create();
+    if (ctx->retire_worker == NULL) {
+      err = NGF_ERROR_OBJECT_CREATION_FAILED;
+      goto ngf_create_context_cleanup;
+    }
+  }
 
   NGFI_DARRAY_RESET(ctx->command_superpools, 3);
-  NGFI_DARRAY_RESET(ctx->desc_superpools, 3);
-  NGFI_DARRAY_RESET(ctx->renderpass_cache, 8);
+  NGFI_DARRAY_RESET(ctx->bind_group_pools, 4);
 
   ctx->cmd_buffer_counter = 0u;
+  ctx->frame_serial       = 0u;
 
 ngf_create_context_cleanup:
   if (err != NGF_ERROR_OK) { ngf_destroy_context(ctx); }
@@ -3408,8 +6053,15 @@ void ngf_destroy_context(ngf_context ctx) {
       ngf_destroy_render_target(ctx->default_render_target);
     }
 
+    // Flush out everything that was handed off to the retirement thread, the rest is destroyed
+    // inline below.
+    if (ctx->retire_worker != NULL) {
+      ngfvk_retire_worker_destroy(ctx->retire_worker);
+      ctx->retire_worker = NULL;
+    }
+
     for (uint32_t f = 0u; ctx->frame_res != NULL && f < ctx->max_inflight_frames; ++f) {
-      ngfvk_retire_resources(&ctx->frame_res[f]);
+      ngfvk_retire_resources(&ctx->frame_res[f], NULL);
 
       NGFI_DARRAY_FOREACH(ctx->frame_res[f].real_retire_events, s) {
         vkDestroyEvent(_vk.device, NGFI_DARRAY_AT(ctx->frame_res[f].real_retire_events, s), NULL);
@@ -3423,12 +6075,31 @@ void ngf_destroy_context(ngf_context ctx) {
       NGFI_DARRAY_DESTROY(ctx->frame_res[f].retire_samplers);
       NGFI_DARRAY_DESTROY(ctx->frame_res[f].retire_image_views);
       NGFI_DARRAY_DESTROY(ctx->frame_res[f].retire_buffer_views);
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].retire_desc_pools);
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].retire_query_pools);
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].retire_cmd_pools);
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].retire_table_slots);
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].retire_bind_group_sets);
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].written_queries);
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].query_resets);
+      NGFI_DARRAY_FOREACH(ctx->frame_res[f].upload_chunks, c) {
+        ngfvk_destroy_upload_chunk(&NGFI_DARRAY_AT(ctx->frame_res[f].upload_chunks, c));
+      }
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].upload_chunks);
+      NGFI_DARRAY_FOREACH(ctx->frame_res[f].queue_semaphores, s) {
+        vkDestroySemaphore(_vk.device, NGFI_DARRAY_AT(ctx->frame_res[f].queue_semaphores, s), NULL);
+      }
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].queue_semaphores);
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].gfx_wait_semaphores);
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].xfer_acquire_buf_barriers);
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].xfer_acquire_img_barriers);
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].compute_release_buf_barriers);
+      NGFI_DARRAY_DESTROY(ctx->frame_res[f].compute_release_img_barriers);
       NGFI_DARRAY_DESTROY(ctx->frame_res[f].retire_events);
       NGFI_DARRAY_DESTROY(ctx->frame_res[f].real_retire_events);
       NGFI_DARRAY_DESTROY(ctx->frame_res[f].retire_images);
       NGFI_DARRAY_DESTROY(ctx->frame_res[f].retire_buffers);
       NGFI_DARRAY_DESTROY(ctx->frame_res[f].cmd_bufs);
-      NGFI_DARRAY_DESTROY(ctx->frame_res[f].cmd_pools);
       for (uint32_t i = 0u; i < sizeof(ctx->frame_res[f].fences) / sizeof(VkFence); ++i) {
         vkDestroyFence(_vk.device, ctx->frame_res[f].fences[i], NULL);
       }
@@ -3437,22 +6108,25 @@ void ngf_destroy_context(ngf_context ctx) {
       }
     }
 
-    NGFI_DARRAY_FOREACH(ctx->desc_superpools, p) {
-      ngfvk_destroy_desc_superpool(&NGFI_DARRAY_AT(ctx->desc_superpools, p));
-    }
-    NGFI_DARRAY_DESTROY(ctx->desc_superpools);
-
-    ngfvk_reset_renderpass_cache(ctx);
-    NGFI_DARRAY_DESTROY(ctx->renderpass_cache);
+    ngfvk_destroy_renderpass_cache(ctx);
+    pthread_mutex_destroy(&ctx->renderpass_cache_lock);
 
     NGFI_DARRAY_FOREACH(ctx->command_superpools, i) {
       ngfvk_destroy_command_superpool(&ctx->command_superpools.data[i]);
     }
     NGFI_DARRAY_DESTROY(ctx->command_superpools);
 
+    // Destroying the pools frees the sets of any bind groups that are still around.
+    NGFI_DARRAY_FOREACH(ctx->bind_group_pools, p) {
+      vkDestroyDescriptorPool(_vk.device, NGFI_DARRAY_AT(ctx->bind_group_pools, p), NULL);
+    }
+    NGFI_DARRAY_DESTROY(ctx->bind_group_pools);
+
+    if (ctx->pipeline_cache != VK_NULL_HANDLE) {
+      vkDestroyPipelineCache(_vk.device, ctx->pipeline_cache, NULL);
+    }
     if (ctx->allocator != VK_NULL_HANDLE) { vmaDestroyAllocator(ctx->allocator); }
     if (ctx->frame_res != NULL) { NGFI_FREEN(ctx->frame_res, ctx->max_inflight_frames); }
-    if (ctx->bind_op_chunk_allocator) { ngfi_blkalloc_destroy(ctx->bind_op_chunk_allocator); }
 
     if (CURRENT_CONTEXT == ctx) CURRENT_CONTEXT = NULL;
     NGFI_FREE(ctx);
@@ -3464,30 +6138,160 @@ ngf_error ngf_set_context(ngf_context ctx) {
   return NGF_ERROR_OK;
 }
 
+ngf_error ngf_get_context_stats(ngf_context ctx, ngf_context_stats* stats) {
+  assert(ctx);
+  assert(stats);
+  *stats = ctx->stats;
+  pthread_mutex_lock(&ctx->renderpass_cache_lock);
+  stats->render_pass_cache_size = ctx->renderpass_cache.nentries;
+  pthread_mutex_unlock(&ctx->renderpass_cache_lock);
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_load_pipeline_cache(ngf_context ctx, const void* data, size_t size) {
+  assert(ctx);
+  assert(data || size == 0u);
+  if (ctx->pipeline_cache == VK_NULL_HANDLE) { return NGF_ERROR_INVALID_OPERATION; }
+
+  const ngfvk_device_id* devid = &NGFVK_DEVICE_ID_LIST[_vk.device_list_idx];
+  if (!ngfvk_pipeline_cache_header_valid(
+          data,
+          size,
+          devid->vendor_id,
+          devid->device_id,
+          _vk.pipeline_cache_uuid)) {
+    return NGF_ERROR_INVALID_FORMAT;
+  }
+
+  // Pipeline caches can't be re-initialized, so the data is loaded into a temporary cache which is
+  // then merged into the context's cache.
+  const VkPipelineCacheCreateInfo vk_pipeline_cache_info = {
+      .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+      .pNext           = NULL,
+      .flags           = 0u,
+      .initialDataSize = size,
+      .pInitialData    = data};
+  VkPipelineCache loaded_cache = VK_NULL_HANDLE;
+  VkResult        vk_err =
+      vkCreatePipelineCache(_vk.device, &vk_pipeline_cache_info, NULL, &loaded_cache);
+  if (vk_err != VK_SUCCESS) { return NGF_ERROR_OBJECT_CREATION_FAILED; }
+  vk_err = vkMergePipelineCaches(_vk.device, ctx->pipeline_cache, 1u, &loaded_cache);
+  vkDestroyPipelineCache(_vk.device, loaded_cache, NULL);
+  return vk_err == VK_SUCCESS ? NGF_ERROR_OK : NGF_ERROR_OUT_OF_MEM;
+}
+
+ngf_error ngf_get_pipeline_cache_data(ngf_context ctx, void* data, size_t* size) {
+  assert(ctx);
+  assert(size);
+  if (ctx->pipeline_cache == VK_NULL_HANDLE) { return NGF_ERROR_INVALID_OPERATION; }
+  const VkResult vk_err = vkGetPipelineCacheData(_vk.device, ctx->pipeline_cache, size, data);
+  switch (vk_err) {
+  case VK_SUCCESS:
+    return NGF_ERROR_OK;
+  case VK_INCOMPLETE:
+    return NGF_ERROR_INVALID_SIZE;
+  default:
+    return NGF_ERROR_OUT_OF_MEM;
+  }
+}
+
 ngf_error ngf_create_cmd_buffer(const ngf_cmd_buffer_info* info, ngf_cmd_buffer* result) {
   assert(info);
   assert(result);
-  NGFI_IGNORE_VAR(info);
+
+  if ((info->flags & NGF_CMD_BUFFER_ASYNC_XFER) && (info->flags & NGF_CMD_BUFFER_ASYNC_COMPUTE)) {
+    NGFI_DIAG_ERROR("a cmd buffer can't be both an async transfer and an async compute one");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if ((info->flags & NGF_CMD_BUFFER_SECONDARY) && info->flags != NGF_CMD_BUFFER_SECONDARY) {
+    NGFI_DIAG_ERROR("secondary cmd buffers can't be combined with other flags");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
 
   ngf_cmd_buffer cmd_buf = NGFI_ALLOC(ngf_cmd_buffer_t);
   if (cmd_buf == NULL) { return NGF_ERROR_OUT_OF_MEM; }
-  *result                         = cmd_buf;
-  cmd_buf->parent_frame           = ~0u;
-  cmd_buf->state                  = NGFI_CMD_BUFFER_NEW;
-  cmd_buf->active_gfx_pipe        = NULL;
-  cmd_buf->active_compute_pipe    = NULL;
-  cmd_buf->renderpass_active      = false;
-  cmd_buf->compute_pass_active    = false;
-  cmd_buf->active_rt              = NULL;
-  cmd_buf->desc_pools_list        = NULL;
-  cmd_buf->pending_bind_ops.first = NULL;
-  cmd_buf->pending_bind_ops.last  = NULL;
-  cmd_buf->pending_bind_ops.size  = 0u;
-  cmd_buf->vk_cmd_buffer          = VK_NULL_HANDLE;
-  cmd_buf->vk_cmd_pool            = VK_NULL_HANDLE;
+  // Async cmd buffers fall back to the graphics queue if there's no dedicated one.
+  ngfvk_queue queue = NGFVK_QUEUE_GFX;
+  if ((info->flags & NGF_CMD_BUFFER_ASYNC_XFER) && _vk.xfer_queue != VK_NULL_HANDLE) {
+    queue = NGFVK_QUEUE_XFER;
+  } else if ((info->flags & NGF_CMD_BUFFER_ASYNC_COMPUTE) && _vk.compute_queue != VK_NULL_HANDLE) {
+    queue = NGFVK_QUEUE_COMPUTE;
+  }
+  *result                            = cmd_buf;
+  cmd_buf->flags                     = info->flags;
+  cmd_buf->queue                     = queue;
+  cmd_buf->waits_on_compute          = false;
+  cmd_buf->parent_frame              = ~0u;
+  cmd_buf->state                     = NGFI_CMD_BUFFER_NEW;
+  cmd_buf->active_gfx_pipe           = NULL;
+  cmd_buf->active_compute_pipe       = NULL;
+  cmd_buf->renderpass_active         = false;
+  cmd_buf->compute_pass_active       = false;
+  cmd_buf->active_rt                 = NULL;
+  cmd_buf->pass_timestamp_pool       = NULL;
+  cmd_buf->active_pass_end_timestamp = ~0u;
+  cmd_buf->active_query_pool         = NULL;
+  cmd_buf->pending_xfer_dst_stages   = 0u;
+  cmd_buf->pending_copy_src_stages   = 0u;
+  cmd_buf->vk_cmd_buffer             = VK_NULL_HANDLE;
+  cmd_buf->ctx                       = CURRENT_CONTEXT;
+  cmd_buf->frame_serial              = 0u;
+  cmd_buf->parallel_renderpass       = false;
+  cmd_buf->nframe_res                = CURRENT_CONTEXT->max_inflight_frames;
+  NGFI_DARRAY_RESET(cmd_buf->pending_bind_ops, NGFVK_BIND_OP_ARENA_INITIAL_CAPACITY);
+  NGFI_DARRAY_RESET(cmd_buf->written_queries, 4u);
+  NGFI_DARRAY_RESET(cmd_buf->ownership_buf_barriers, 4u);
+  NGFI_DARRAY_RESET(cmd_buf->ownership_img_barriers, 4u);
+  NGFI_DARRAY_RESET(cmd_buf->pending_xfer_buf_barriers, 4u);
+  NGFI_DARRAY_RESET(cmd_buf->pending_xfer_img_barriers, 4u);
+  NGFI_DARRAY_RESET(cmd_buf->xfer_pre_img_barriers, 4u);
+  NGFI_DARRAY_RESET(cmd_buf->xfer_copy_regions, 4u);
+  NGFI_DARRAY_RESET(cmd_buf->pending_buf_copies, 4u);
+  NGFI_DARRAY_RESET(cmd_buf->xfer_pre_buf_barriers, 4u);
+  NGFI_DARRAY_RESET(cmd_buf->events, 4u);
+  ngfvk_shadow_state_reset(&cmd_buf->shadow_state);
+  memset(&cmd_buf->stats, 0, sizeof(cmd_buf->stats));
+  cmd_buf->frame_res = NGFI_ALLOCN(ngfvk_cmd_buffer_frame_res, cmd_buf->nframe_res);
+  if (cmd_buf->frame_res == NULL) {
+    cmd_buf->nframe_res = 0u;
+    ngf_destroy_cmd_buffer(cmd_buf);
+    *result = NULL;
+    return NGF_ERROR_OUT_OF_MEM;
+  }
+  memset(cmd_buf->frame_res, 0, sizeof(ngfvk_cmd_buffer_frame_res) * cmd_buf->nframe_res);
+  const uint32_t family_idx = queue == NGFVK_QUEUE_XFER      ? _vk.xfer_family_idx
+                              : queue == NGFVK_QUEUE_COMPUTE ? _vk.compute_family_idx
+                                                             : _vk.gfx_family_idx;
+  for (uint32_t f = 0u; f < cmd_buf->nframe_res; ++f) {
+    ngfvk_cmd_buffer_frame_res* res = &cmd_buf->frame_res[f];
+    res->desc_pools.config          = CURRENT_CONTEXT->desc_pool_config;
+    NGFI_DARRAY_RESET(res->submissions, 1u);
+    if (ngfvk_initialize_cmd_pools(family_idx, &res->cmd_pool, 1u) != NGF_ERROR_OK) {
+      ngf_destroy_cmd_buffer(cmd_buf);
+      *result = NULL;
+      return NGF_ERROR_OBJECT_CREATION_FAILED;
+    }
+    res->cmd_pool.level = (info->flags & NGF_CMD_BUFFER_SECONDARY)
+                              ? VK_COMMAND_BUFFER_LEVEL_SECONDARY
+                              : VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  }
   return NGF_ERROR_OK;
 }
 
+// Returns the resources that the given cmd buffer shall use for recording during the frame that it
+// is associated with, resetting them if they were last used during an earlier frame. By then, the
+// previous frame with the same id has been retired, so the rendering device is done with them.
+static ngfvk_cmd_buffer_frame_res* ngfvk_cmd_buffer_frame_res_acquire(ngf_cmd_buffer cmd_buf) {
+  ngfvk_cmd_buffer_frame_res* res = &cmd_buf->frame_res[ngfi_frame_id(cmd_buf->parent_frame)];
+  if (res->frame_serial != cmd_buf->frame_serial) {
+    ngfvk_cmd_pool_reset(&res->cmd_pool);
+    ngfvk_desc_pools_list_reset(&res->desc_pools);
+    res->nused_submissions = 0u;
+    res->frame_serial      = cmd_buf->frame_serial;
+  }
+  return res;
+}
+
 ngf_error ngf_cmd_begin_render_pass_simple_with_sync(
     ngf_cmd_buffer                   cmd_buf,
     ngf_render_target                rt,
@@ -3563,26 +6367,38 @@ ngf_error ngf_cmd_begin_render_pass_simple(
       enc);
 }
 
-ngf_error ngf_cmd_begin_render_pass(
+static ngf_error ngfvk_begin_render_pass(
     ngf_cmd_buffer              cmd_buf,
     const ngf_render_pass_info* pass_info,
+    VkSubpassContents           contents,
     ngf_render_encoder*         enc) {
+  if (cmd_buf->flags & (NGF_CMD_BUFFER_ASYNC_XFER | NGF_CMD_BUFFER_ASYNC_COMPUTE)) {
+    NGFI_DIAG_ERROR("render passes may not be recorded into async cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY) {
+    NGFI_DIAG_ERROR("secondary cmd buffers may only record parts of parallel render passes");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
   ngf_error          err         = NGF_ERROR_OK;
   const VkRenderPass render_pass = ngfvk_lookup_renderpass(
+      cmd_buf,
       pass_info->render_target,
       ngfvk_renderpass_ops_key(
           pass_info->render_target,
           pass_info->load_ops,
           pass_info->store_ops));
+  if (render_pass == VK_NULL_HANDLE) { return NGF_ERROR_OBJECT_CREATION_FAILED; }
 
-  const ngfvk_swapchain*  swapchain = &CURRENT_CONTEXT->swapchain;
+  const ngf_context       ctx       = cmd_buf->ctx;
+  const ngfvk_swapchain*  swapchain = &ctx->swapchain;
   const ngf_render_target target    = pass_info->render_target;
 
   const VkFramebuffer fb =
       target->is_default ? swapchain->framebuffers[swapchain->image_idx] : target->frame_buffer;
   const VkExtent2D render_extent = {
-      target->is_default ? CURRENT_CONTEXT->swapchain_info.width : target->width,
-      target->is_default ? CURRENT_CONTEXT->swapchain_info.height : target->height};
+      target->is_default ? ctx->swapchain_info.width : target->width,
+      target->is_default ? ctx->swapchain_info.height : target->height};
 
   const uint32_t clear_value_count = pass_info->clears ? target->nattachments : 0u;
   VkClearValue*  vk_clears =
@@ -3629,25 +6445,55 @@ ngf_error ngf_cmd_begin_render_pass(
     if (err != NGF_ERROR_OK) return err;
   }
 
-  ngfvk_encoder_start(cmd_buf);
+  err = ngfvk_encoder_start(cmd_buf);
   if (err != NGF_ERROR_OK) return err;
 
   err = ngfvk_initialize_generic_encoder(cmd_buf, &enc->pvt_data_donotuse);
   if (err != NGF_ERROR_OK) { return err; }
 
-  cmd_buf->active_rt         = target;
-  cmd_buf->renderpass_active = true;
-  vkCmdBeginRenderPass(cmd_buf->vk_cmd_buffer, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+  cmd_buf->active_rt             = target;
+  cmd_buf->renderpass_active     = true;
+  cmd_buf->active_vk_renderpass  = render_pass;
+  cmd_buf->active_vk_framebuffer = fb;
+  cmd_buf->parallel_renderpass   = contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS;
+  vkCmdBeginRenderPass(cmd_buf->vk_cmd_buffer, &begin_info, contents);
   ngfi_sa_reset(ngfi_tmp_store());
 
   return NGF_ERROR_OK;
 }
 
+ngf_error ngf_cmd_begin_render_pass(
+    ngf_cmd_buffer              cmd_buf,
+    const ngf_render_pass_info* pass_info,
+    ngf_render_encoder*         enc) {
+  return ngfvk_begin_render_pass(cmd_buf, pass_info, VK_SUBPASS_CONTENTS_INLINE, enc);
+}
+
+ngf_error ngf_cmd_begin_parallel_render_pass(
+    ngf_cmd_buffer              cmd_buf,
+    const ngf_render_pass_info* pass_info,
+    ngf_render_encoder*         enc) {
+  return ngfvk_begin_render_pass(
+      cmd_buf,
+      pass_info,
+      VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS,
+      enc);
+}
+
 ngf_error ngf_cmd_begin_xfer_pass(
     ngf_cmd_buffer            cmd_buf,
     const ngf_xfer_pass_info* pass_info,
     ngf_xfer_encoder*         enc) {
   ngf_error err;
+  if (cmd_buf->flags & NGF_CMD_BUFFER_ASYNC_COMPUTE) {
+    NGFI_DIAG_ERROR("transfer passes may not be recorded into async compute cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (pass_info->sync_compute_resources.nsync_resources > 0u &&
+      cmd_buf->queue == NGFVK_QUEUE_XFER) {
+    NGFI_DIAG_ERROR("transfer passes of async transfer cmd buffers can't wait on compute work");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
   if (pass_info->sync_compute_resources.nsync_resources > 0u) {
     err = ngfvk_execute_sync_op(
         cmd_buf,
@@ -3674,6 +6520,10 @@ ngf_error ngf_cmd_begin_compute_pass(
     ngf_cmd_buffer               cmd_buf,
     const ngf_compute_pass_info* pass_info,
     ngf_compute_encoder*         enc) {
+  if (cmd_buf->flags & NGF_CMD_BUFFER_ASYNC_XFER) {
+    NGFI_DIAG_ERROR("compute passes may not be recorded into async transfer cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
   ngf_error err;
   err = ngfvk_execute_sync_op(
       cmd_buf,
@@ -3683,7 +6533,7 @@ ngf_error ngf_cmd_begin_compute_pass(
       pass_info->sync_render_resources.sync_resources,
       pass_info->sync_xfer_resources.nsync_resources,
       pass_info->sync_xfer_resources.sync_resources,
-      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
   if (err != NGF_ERROR_OK) return err;
 
   err = ngfvk_encoder_start(cmd_buf);
@@ -3698,67 +6548,396 @@ ngf_error ngf_cmd_begin_compute_pass(
 
 ngf_error ngf_cmd_end_render_pass(ngf_render_encoder enc) {
   ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
+  if (buf->flags & NGF_CMD_BUFFER_SECONDARY) {
+    NGFI_DIAG_ERROR("secondary render encoders are ended by ngf_cmd_end_secondary_render_pass");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (buf->active_query_pool != NULL) {
+    NGFI_DIAG_ERROR("render pass ended while a query is active, ending the query");
+    ngf_cmd_end_query(enc);
+  }
   vkCmdEndRenderPass(buf->vk_cmd_buffer);
-  buf->renderpass_active = false;
+  buf->renderpass_active   = false;
+  buf->parallel_renderpass = false;
   return ngfvk_encoder_end(buf, &enc.pvt_data_donotuse, NGFVK_GFX_PIPELINE_STAGE_MASK);
 }
 
-ngf_error ngf_cmd_end_xfer_pass(ngf_xfer_encoder enc) {
-  ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
-  return ngfvk_encoder_end(buf, &enc.pvt_data_donotuse, VK_PIPELINE_STAGE_TRANSFER_BIT);
-}
-
-ngf_error ngf_cmd_end_compute_pass(ngf_compute_encoder enc) {
-  ngf_cmd_buffer cmd_buf       = NGFVK_ENC2CMDBUF(enc);
-  cmd_buf->compute_pass_active = false;
-  return ngfvk_encoder_end(cmd_buf, &enc.pvt_data_donotuse, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
-}
-
-ngf_error ngf_start_cmd_buffer(ngf_cmd_buffer cmd_buf, ngf_frame_token token) {
+ngf_error ngf_cmd_begin_secondary_render_pass(
+    ngf_render_encoder  parent_enc,
+    ngf_cmd_buffer      cmd_buf,
+    ngf_render_encoder* enc) {
   assert(cmd_buf);
-
+  assert(enc);
+  const ngf_cmd_buffer parent = NGFVK_ENC2CMDBUF(parent_enc);
+  if (!(cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY)) {
+    NGFI_DIAG_ERROR("only secondary cmd buffers may record parts of parallel render passes");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (!parent->parallel_renderpass) {
+    NGFI_DIAG_ERROR("the parent encoder doesn't belong to a parallel render pass");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (cmd_buf->ctx != parent->ctx) {
+    NGFI_DIAG_ERROR("the secondary cmd buffer was created for a different context");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
   NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_READY);
 
-  cmd_buf->parent_frame    = token;
-  cmd_buf->desc_pools_list = NULL;
-  cmd_buf->active_rt       = NULL;
-  return ngfvk_cmd_buffer_allocate_for_frame(token, &cmd_buf->vk_cmd_pool, &cmd_buf->vk_cmd_buffer);
+  cmd_buf->parent_frame           = parent->parent_frame;
+  cmd_buf->frame_serial           = parent->frame_serial;
+  ngfvk_cmd_buffer_frame_res* res = ngfvk_cmd_buffer_frame_res_acquire(cmd_buf);
+  const ngf_error             err =
+      ngfvk_cmd_pool_acquire(&res->cmd_pool, &cmd_buf->stats, &cmd_buf->vk_cmd_buffer);
+  if (err != NGF_ERROR_OK) { return err; }
+  const VkCommandBufferInheritanceInfo inheritance_info = {
+      .sType                = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+      .pNext                = NULL,
+      .renderPass           = parent->active_vk_renderpass,
+      .subpass              = 0u,
+      .framebuffer          = parent->active_vk_framebuffer,
+      .occlusionQueryEnable = VK_FALSE,
+      .queryFlags           = 0u,
+      .pipelineStatistics   = 0u};
+  const VkCommandBufferBeginInfo begin_info = {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .pNext = NULL,
+      .flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+               VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+      .pInheritanceInfo = &inheritance_info};
+  vkBeginCommandBuffer(cmd_buf->vk_cmd_buffer, &begin_info);
+
+  cmd_buf->active_rt         = parent->active_rt;
+  cmd_buf->active_gfx_pipe   = NULL;
+  cmd_buf->active_query_pool = NULL;
+  ngfvk_shadow_state_reset(&cmd_buf->shadow_state);
+  ngfvk_cleanup_pending_binds(cmd_buf);
+  NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_RECORDING);
+  cmd_buf->renderpass_active = true;
+
+  // Secondary encoders don't signal events, synchronization is done by the parent pass.
+  enc->pvt_data_donotuse.d0 = (uintptr_t)cmd_buf;
+  enc->pvt_data_donotuse.d1 = (uintptr_t)VK_NULL_HANDLE;
+  return NGF_ERROR_OK;
 }
 
-void ngf_destroy_cmd_buffer(ngf_cmd_buffer buffer) {
-  assert(buffer);
-  if (buffer->vk_cmd_buffer != VK_NULL_HANDLE) {
-    vkFreeCommandBuffers(_vk.device, buffer->vk_cmd_pool, 1u, &buffer->vk_cmd_buffer);
+ngf_error ngf_cmd_end_secondary_render_pass(ngf_render_encoder enc) {
+  ngf_cmd_buffer cmd_buf = NGFVK_ENC2CMDBUF(enc);
+  if (!(cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY)) {
+    NGFI_DIAG_ERROR("the encoder doesn't belong to a secondary cmd buffer");
+    return NGF_ERROR_INVALID_OPERATION;
   }
-  ngfvk_cleanup_pending_binds(buffer);
-  NGFI_FREE(buffer);
+  ngfvk_cleanup_pending_binds(cmd_buf);
+  cmd_buf->renderpass_active = false;
+  NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_AWAITING_SUBMIT);
+  vkEndCommandBuffer(cmd_buf->vk_cmd_buffer);
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_execute_secondary_cmd_buffers(
+    ngf_render_encoder parent_enc,
+    uint32_t           nbuffers,
+    ngf_cmd_buffer*    bufs) {
+  ngf_cmd_buffer parent = NGFVK_ENC2CMDBUF(parent_enc);
+  if (!parent->parallel_renderpass) {
+    NGFI_DIAG_ERROR("the parent encoder doesn't belong to a parallel render pass");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (nbuffers == 0u) { return NGF_ERROR_OK; }
+  assert(bufs);
+  for (uint32_t i = 0u; i < nbuffers; ++i) {
+    const ngf_cmd_buffer buf = bufs[i];
+    if (!(buf->flags & NGF_CMD_BUFFER_SECONDARY) || buf->state != NGFI_CMD_BUFFER_AWAITING_SUBMIT) {
+      NGFI_DIAG_ERROR("only finished secondary cmd buffers may be executed");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+    if (buf->frame_serial != parent->frame_serial || buf->active_rt != parent->active_rt) {
+      NGFI_DIAG_ERROR("the secondary cmd buffer was recorded for a different render pass");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+  }
+  VkCommandBuffer* vk_bufs = ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkCommandBuffer) * nbuffers);
+  if (vk_bufs == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  for (uint32_t i = 0u; i < nbuffers; ++i) {
+    NGFI_TRANSITION_CMD_BUF(bufs[i], NGFI_CMD_BUFFER_SUBMITTED);
+    vk_bufs[i] = bufs[i]->vk_cmd_buffer;
+    ngfvk_merge_stats(&parent->stats, &bufs[i]->stats);
+  }
+  vkCmdExecuteCommands(parent->vk_cmd_buffer, nbuffers, vk_bufs);
+  // The bound pipeline and dynamic state of the primary cmd buffer are undefined after executing
+  // secondary ones, so nothing that has been set before may be elided anymore.
+  ngfvk_shadow_state_reset(&parent->shadow_state);
+  parent->active_gfx_pipe = NULL;
+  ngfi_sa_reset(ngfi_tmp_store());
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_end_xfer_pass(ngf_xfer_encoder enc) {
+  ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
+  return ngfvk_encoder_end(buf, &enc.pvt_data_donotuse, VK_PIPELINE_STAGE_TRANSFER_BIT);
+}
+
+ngf_error ngf_cmd_end_compute_pass(ngf_compute_encoder enc) {
+  ngf_cmd_buffer cmd_buf       = NGFVK_ENC2CMDBUF(enc);
+  cmd_buf->compute_pass_active = false;
+  return ngfvk_encoder_end(cmd_buf, &enc.pvt_data_donotuse, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+}
+
+ngf_error ngf_start_cmd_buffer(ngf_cmd_buffer cmd_buf, ngf_frame_token token) {
+  assert(cmd_buf);
+
+  if (cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY) {
+    NGFI_DIAG_ERROR("secondary cmd buffers are started by ngf_cmd_begin_secondary_render_pass");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (token != cmd_buf->ctx->current_frame_token) {
+    NGFI_DIAG_ERROR("starting a command buffer for a frame that isn't being recorded");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  NGFI_TRANSITION_CMD_BUF(cmd_buf, NGFI_CMD_BUFFER_READY);
+
+  cmd_buf->parent_frame = token;
+  cmd_buf->active_rt    = NULL;
+  ngfvk_shadow_state_reset(&cmd_buf->shadow_state);
+  NGFI_DARRAY_CLEAR(cmd_buf->ownership_buf_barriers);
+  NGFI_DARRAY_CLEAR(cmd_buf->ownership_img_barriers);
+  NGFI_DARRAY_CLEAR(cmd_buf->pending_xfer_buf_barriers);
+  NGFI_DARRAY_CLEAR(cmd_buf->pending_xfer_img_barriers);
+  cmd_buf->pending_xfer_dst_stages = 0u;
+  NGFI_DARRAY_CLEAR(cmd_buf->written_queries);
+  cmd_buf->waits_on_compute    = false;
+  cmd_buf->pass_timestamp_pool = NULL;
+  cmd_buf->active_query_pool   = NULL;
+  cmd_buf->parallel_renderpass = false;
+  cmd_buf->frame_serial        = cmd_buf->ctx->frame_serial;
+
+  ngfvk_cmd_buffer_frame_res* res = ngfvk_cmd_buffer_frame_res_acquire(cmd_buf);
+  const ngf_error             err =
+      ngfvk_cmd_pool_acquire(&res->cmd_pool, &cmd_buf->stats, &cmd_buf->vk_cmd_buffer);
+  if (err != NGF_ERROR_OK) { return err; }
+  const VkCommandBufferBeginInfo cmd_buf_begin = {
+      .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .pNext            = NULL,
+      .flags            = 0,
+      .pInheritanceInfo = NULL};
+  vkBeginCommandBuffer(cmd_buf->vk_cmd_buffer, &cmd_buf_begin);
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_write_timestamp(ngf_cmd_buffer cmd_buf, ngf_query_pool pool, uint32_t query) {
+  assert(cmd_buf);
+  assert(pool);
+  const ngf_error err = ngfvk_validate_timestamp_cmd(cmd_buf, pool);
+  if (err != NGF_ERROR_OK) { return err; }
+  if (query >= pool->nqueries) {
+    NGFI_DIAG_ERROR("timestamp query %u is out of the pool's bounds", query);
+    return NGF_ERROR_OUT_OF_BOUNDS;
+  }
+  ngfvk_cmd_write_timestamp(cmd_buf, pool, query, 1u, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_enable_pass_timestamps(
+    ngf_cmd_buffer cmd_buf,
+    ngf_query_pool pool,
+    uint32_t       first_query,
+    uint32_t       nqueries) {
+  assert(cmd_buf);
+  const ngf_error err = ngfvk_validate_timestamp_cmd(cmd_buf, pool);
+  if (err != NGF_ERROR_OK) { return err; }
+  if (pool != NULL && (first_query > pool->nqueries || nqueries > pool->nqueries - first_query)) {
+    NGFI_DIAG_ERROR("pass timestamp queries are out of the pool's bounds");
+    return NGF_ERROR_OUT_OF_BOUNDS;
+  }
+  cmd_buf->pass_timestamp_pool = pool;
+  cmd_buf->next_pass_timestamp = first_query;
+  cmd_buf->pass_timestamps_end = first_query + nqueries;
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_cmd_buffer(ngf_cmd_buffer buffer) {
+  assert(buffer);
+  ngf_context ctx = buffer->ctx;
+  NGFI_DARRAY_DESTROY(buffer->pending_bind_ops);
+  NGFI_DARRAY_DESTROY(buffer->ownership_buf_barriers);
+  NGFI_DARRAY_DESTROY(buffer->ownership_img_barriers);
+  NGFI_DARRAY_DESTROY(buffer->pending_xfer_buf_barriers);
+  NGFI_DARRAY_DESTROY(buffer->pending_xfer_img_barriers);
+  NGFI_DARRAY_DESTROY(buffer->xfer_pre_img_barriers);
+  NGFI_DARRAY_DESTROY(buffer->xfer_copy_regions);
+  NGFI_DARRAY_DESTROY(buffer->pending_buf_copies);
+  NGFI_DARRAY_DESTROY(buffer->xfer_pre_buf_barriers);
+  NGFI_DARRAY_DESTROY(buffer->written_queries);
+  if (buffer->frame_res != NULL) {
+    // The submission records are about to be freed, so the frames must take over their contents.
+    ngfvk_frame_resources* frame_res = &ctx->frame_res[ctx->frame_id];
+    for (uint32_t f = 0u; f < ctx->max_inflight_frames; ++f) {
+      ngfvk_collect_submissions(ctx, &ctx->frame_res[f]);
+    }
+    // Events that have been set by an unsubmitted cmd buffer still need to be destroyed.
+    NGFI_DARRAY_FOREACH(buffer->events, e) {
+      NGFI_DARRAY_APPEND(frame_res->retire_events, NGFI_DARRAY_AT(buffer->events, e));
+    }
+    // The pools may still be in use by frames in flight. Destroying a pool frees all of its command
+    // buffers, including one that has been started but not submitted.
+    for (uint32_t f = 0u; f < buffer->nframe_res; ++f) {
+      ngfvk_cmd_buffer_frame_res* res = &buffer->frame_res[f];
+      NGFI_DARRAY_FOREACH(res->submissions, i) {
+        ngfvk_submission_destroy(NGFI_DARRAY_AT(res->submissions, i));
+      }
+      NGFI_DARRAY_DESTROY(res->submissions);
+      if (res->cmd_pool.vk_pool != VK_NULL_HANDLE) {
+        NGFI_DARRAY_APPEND(frame_res->retire_cmd_pools, res->cmd_pool.vk_pool);
+      }
+      NGFI_DARRAY_DESTROY(res->cmd_pool.cmd_bufs);
+      ngfvk_desc_pool* pool = res->desc_pools.list;
+      while (pool != NULL) {
+        ngfvk_desc_pool* next = pool->next;
+        NGFI_DARRAY_APPEND(frame_res->retire_desc_pools, pool->vk_pool);
+        NGFI_FREE(pool);
+        pool = next;
+      }
+      ngfvk_desc_set_cache_destroy(&res->desc_pools.set_cache);
+    }
+    NGFI_FREEN(buffer->frame_res, buffer->nframe_res);
+  }
+  NGFI_DARRAY_DESTROY(buffer->events);
+  NGFI_FREE(buffer);
+}
+
+// Hands a graphics queue cmd buffer over to the frame it has been recorded for. The cmd buffer is
+// executed when the frame ends.
+static ngf_error ngfvk_submit_gfx_cmd_buffer(ngf_cmd_buffer cmd_buf) {
+  ngfvk_cmd_buffer_frame_res* res = &cmd_buf->frame_res[ngfi_frame_id(cmd_buf->parent_frame)];
+  if (res->nused_submissions == NGFI_DARRAY_SIZE(res->submissions)) {
+    ngfvk_submission* new_sub = ngfvk_submission_create();
+    if (new_sub == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+    NGFI_DARRAY_APPEND(res->submissions, new_sub);
+  }
+  ngfvk_submission* sub = NGFI_DARRAY_AT(res->submissions, res->nused_submissions++);
+  sub->vk_cmd_buffer    = cmd_buf->vk_cmd_buffer;
+  sub->waits_on_compute = cmd_buf->waits_on_compute;
+  NGFI_DARRAY_CLEAR(sub->written_queries);
+  NGFI_DARRAY_CLEAR(sub->release_buf_barriers);
+  NGFI_DARRAY_CLEAR(sub->release_img_barriers);
+  NGFI_DARRAY_CLEAR(sub->events);
+  NGFI_DARRAY_APPEND_N(
+      sub->written_queries,
+      cmd_buf->written_queries.data,
+      NGFI_DARRAY_SIZE(cmd_buf->written_queries));
+  NGFI_DARRAY_APPEND_N(
+      sub->release_buf_barriers,
+      cmd_buf->ownership_buf_barriers.data,
+      NGFI_DARRAY_SIZE(cmd_buf->ownership_buf_barriers));
+  NGFI_DARRAY_APPEND_N(
+      sub->release_img_barriers,
+      cmd_buf->ownership_img_barriers.data,
+      NGFI_DARRAY_SIZE(cmd_buf->ownership_img_barriers));
+  NGFI_DARRAY_APPEND_N(sub->events, cmd_buf->events.data, NGFI_DARRAY_SIZE(cmd_buf->events));
+  ngfvk_merge_stats(&sub->stats, &cmd_buf->stats);
+  ngfi_atomic_stack_push(
+      &cmd_buf->ctx->frame_res[ngfi_frame_id(cmd_buf->parent_frame)].submissions,
+      &sub->node);
+  return NGF_ERROR_OK;
 }
 
 ngf_error ngf_submit_cmd_buffers(uint32_t nbuffers, ngf_cmd_buffer* cmd_bufs) {
   assert(cmd_bufs);
-  uint32_t               frame_id       = CURRENT_CONTEXT->frame_id;
-  ngfvk_frame_resources* frame_res_data = &CURRENT_CONTEXT->frame_res[frame_id];
+  // Cmd buffers for the transfer and compute queues are submitted right away, the transfer ones
+  // after a prologue cmd buffer. Those may only be submitted on the thread that their context is
+  // current on.
+  ngfvk_frame_resources* frame_res_data       = NULL;
+  VkCommandBuffer*       xfer_vk_cmd_bufs     = NULL;
+  uint32_t               nxfer_vk_cmd_bufs    = 1u;
+  VkCommandBuffer*       compute_vk_cmd_bufs  = NULL;
+  uint32_t               ncompute_vk_cmd_bufs = 0u;
+  uint32_t               nfirst_img_acquire   = 0u;
   for (uint32_t i = 0u; i < nbuffers; ++i) {
     ngf_cmd_buffer cmd_buf = cmd_bufs[i];
-    if (cmd_buf->parent_frame != CURRENT_CONTEXT->current_frame_token) {
+    if (cmd_buf->parent_frame != cmd_buf->ctx->current_frame_token) {
       NGFI_DIAG_ERROR("submitting a command buffer for the wrong frame");
       return NGF_ERROR_INVALID_OPERATION;
     }
-    NGFI_TRANSITION_CMD_BUF(cmd_bufs[i], NGFI_CMD_BUFFER_SUBMITTED);
-    if (cmd_buf->desc_pools_list) {
-      NGFI_DARRAY_APPEND(frame_res_data->reset_desc_pools_lists, cmd_buf->desc_pools_list);
+    if (cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY) {
+      NGFI_DIAG_ERROR("secondary cmd buffers may not be submitted directly");
+      return NGF_ERROR_INVALID_OPERATION;
     }
+    if (cmd_buf->queue != NGFVK_QUEUE_GFX) {
+      if (cmd_buf->ctx != CURRENT_CONTEXT) {
+        NGFI_DIAG_ERROR("async cmd buffers may only be submitted on their context's thread");
+        return NGF_ERROR_INVALID_OPERATION;
+      }
+      if (frame_res_data == NULL) {
+        frame_res_data     = &CURRENT_CONTEXT->frame_res[CURRENT_CONTEXT->frame_id];
+        nfirst_img_acquire = NGFI_DARRAY_SIZE(frame_res_data->xfer_acquire_img_barriers);
+      }
+    }
+    NGFI_TRANSITION_CMD_BUF(cmd_bufs[i], NGFI_CMD_BUFFER_SUBMITTED);
+    ngfvk_cleanup_pending_binds(cmd_buf);
     vkEndCommandBuffer(cmd_buf->vk_cmd_buffer);
 
-    NGFI_DARRAY_APPEND(frame_res_data->cmd_bufs, cmd_buf->vk_cmd_buffer);
-    NGFI_DARRAY_APPEND(frame_res_data->cmd_pools, cmd_buf->vk_cmd_pool);
+    if (cmd_buf->queue == NGFVK_QUEUE_GFX) {
+      const ngf_error err = ngfvk_submit_gfx_cmd_buffer(cmd_buf);
+      if (err != NGF_ERROR_OK) { return err; }
+    } else {
+      NGFI_DARRAY_FOREACH(cmd_buf->written_queries, r) {
+        const ngfvk_query_range range = NGFI_DARRAY_AT(cmd_buf->written_queries, r);
+        NGFI_DARRAY_APPEND(frame_res_data->written_queries, range);
+        if (range.deferred_reset) { NGFI_DARRAY_APPEND(frame_res_data->query_resets, range); }
+      }
+      NGFI_DARRAY_FOREACH(cmd_buf->events, e) {
+        NGFI_DARRAY_APPEND(frame_res_data->retire_events, NGFI_DARRAY_AT(cmd_buf->events, e));
+      }
+      ngfvk_merge_stats(&CURRENT_CONTEXT->stats, &cmd_buf->stats);
+      CURRENT_CONTEXT->cmd_buffer_counter++;
+    }
 
+    if (cmd_buf->queue == NGFVK_QUEUE_XFER) {
+      if (xfer_vk_cmd_bufs == NULL) {
+        xfer_vk_cmd_bufs =
+            ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkCommandBuffer) * (nbuffers + 1u));
+        if (xfer_vk_cmd_bufs == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+      }
+      xfer_vk_cmd_bufs[nxfer_vk_cmd_bufs++] = cmd_buf->vk_cmd_buffer;
+      NGFI_DARRAY_FOREACH(cmd_buf->ownership_buf_barriers, b) {
+        NGFI_DARRAY_APPEND(
+            frame_res_data->xfer_acquire_buf_barriers,
+            NGFI_DARRAY_AT(cmd_buf->ownership_buf_barriers, b));
+      }
+      NGFI_DARRAY_FOREACH(cmd_buf->ownership_img_barriers, b) {
+        NGFI_DARRAY_APPEND(
+            frame_res_data->xfer_acquire_img_barriers,
+            NGFI_DARRAY_AT(cmd_buf->ownership_img_barriers, b));
+      }
+    } else if (cmd_buf->queue == NGFVK_QUEUE_COMPUTE) {
+      if (compute_vk_cmd_bufs == NULL) {
+        compute_vk_cmd_bufs = ngfi_sa_alloc(ngfi_tmp_store(), sizeof(VkCommandBuffer) * nbuffers);
+        if (compute_vk_cmd_bufs == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+      }
+      compute_vk_cmd_bufs[ncompute_vk_cmd_bufs++] = cmd_buf->vk_cmd_buffer;
+    }
+
+    NGFI_DARRAY_CLEAR(cmd_buf->written_queries);
+    NGFI_DARRAY_CLEAR(cmd_buf->ownership_buf_barriers);
+    NGFI_DARRAY_CLEAR(cmd_buf->ownership_img_barriers);
+    NGFI_DARRAY_CLEAR(cmd_buf->events);
     cmd_buf->active_gfx_pipe     = NULL;
     cmd_buf->active_compute_pipe = NULL;
     cmd_buf->active_rt           = NULL;
     cmd_buf->vk_cmd_buffer       = VK_NULL_HANDLE;
-    cmd_buf->vk_cmd_pool         = VK_NULL_HANDLE;
-    CURRENT_CONTEXT->cmd_buffer_counter++;
+  }
+  if (xfer_vk_cmd_bufs != NULL) {
+    const ngf_error err = ngfvk_submit_xfer_cmd_buffers(
+        frame_res_data,
+        xfer_vk_cmd_bufs,
+        nxfer_vk_cmd_bufs,
+        nfirst_img_acquire);
+    if (err != NGF_ERROR_OK) { return err; }
+  }
+  if (compute_vk_cmd_bufs != NULL) {
+    return ngfvk_submit_compute_cmd_buffers(
+        frame_res_data,
+        compute_vk_cmd_bufs,
+        ncompute_vk_cmd_bufs);
   }
   return NGF_ERROR_OK;
 }
@@ -3769,6 +6948,7 @@ ngf_error ngf_begin_frame(ngf_frame_token* token) {
   // increment frame id.
   const uint32_t fi = (CURRENT_CONTEXT->frame_id + 1u) % CURRENT_CONTEXT->max_inflight_frames;
   CURRENT_CONTEXT->frame_id = fi;
+  CURRENT_CONTEXT->frame_serial++;
 
   // setup frame capture
   if (_renderdoc.api && _renderdoc.is_capturing_next_frame) {
@@ -3797,11 +6977,11 @@ ngf_error ngf_begin_frame(ngf_frame_token* token) {
 
   // Retire resources.
   ngfvk_frame_resources* next_frame_res = &CURRENT_CONTEXT->frame_res[fi];
-  ngfvk_retire_resources(next_frame_res);
+  ngfvk_retire_resources(next_frame_res, CURRENT_CONTEXT->retire_worker);
+  ngfvk_reset_cmd_pools_for_frame(CURRENT_CONTEXT, fi);
 
-  // Insert placeholders for deferred barriers.
+  // Insert placeholder for deferred barriers.
   NGFI_DARRAY_APPEND(CURRENT_CONTEXT->frame_res[fi].cmd_bufs, VK_NULL_HANDLE);
-  NGFI_DARRAY_APPEND(CURRENT_CONTEXT->frame_res[fi].cmd_pools, VK_NULL_HANDLE);
 
   CURRENT_CONTEXT->current_frame_token = ngfi_encode_frame_token(
       (uint16_t)((uintptr_t)CURRENT_CONTEXT & 0xffff),
@@ -3917,6 +7097,7 @@ ngf_error ngf_create_graphics_pipeline(
     err = NGF_ERROR_OUT_OF_MEM;
     goto ngf_create_graphics_pipeline_cleanup;
   }
+  memset(pipeline, 0, sizeof(ngf_graphics_pipeline_t));
 
   VkPipelineShaderStageCreateInfo vk_shader_stages[5];
   err = ngfvk_initialize_generic_pipeline_data(
@@ -3924,7 +7105,9 @@ ngf_error ngf_create_graphics_pipeline(
       info->spec_info,
       vk_shader_stages,
       info->shader_stages,
-      info->nshader_stages);
+      info->nshader_stages,
+      info->dynamic_uniform_buffers,
+      info->ndynamic_uniform_buffers);
   if (err != NGF_ERROR_OK) { goto ngf_create_graphics_pipeline_cleanup; }
 
   // Prepare vertex input.
@@ -4174,7 +7357,7 @@ ngf_error ngf_create_graphics_pipeline(
       .basePipelineIndex   = -1};
   vk_err = vkCreateGraphicsPipelines(
       _vk.device,
-      VK_NULL_HANDLE,
+      CURRENT_CONTEXT->pipeline_cache,
       1u,
       &vk_pipeline_info,
       NULL,
@@ -4185,7 +7368,89 @@ ngf_error ngf_create_graphics_pipeline(
   }
 
 ngf_create_graphics_pipeline_cleanup:
-  if (err != NGF_ERROR_OK) { ngf_destroy_graphics_pipeline(pipeline); }
+  if (err != NGF_ERROR_OK && pipeline != NULL) {
+    if (pipeline->compatible_render_pass != VK_NULL_HANDLE) {
+      vkDestroyRenderPass(_vk.device, pipeline->compatible_render_pass, NULL);
+    }
+    ngfvk_destroy_unused_generic_pipeline_data(&pipeline->generic_pipeline);
+    NGFI_FREE(pipeline);
+    *result = NULL;
+  }
+  return err;
+}
+
+// State shared by the threads taking part in creating a batch of graphics pipelines.
+typedef struct ngfvk_gfx_pipeline_batch {
+  ngf_context                       ctx;
+  const ngf_graphics_pipeline_info* infos;
+  ngf_graphics_pipeline*            results;
+  ngf_error*                        errors;
+  uint32_t                          npipelines;
+  uint32_t                          next_idx;  // < Index of the next pipeline to be created.
+  pthread_mutex_t                   lock;      // < Protects next_idx.
+} ngfvk_gfx_pipeline_batch;
+
+static void ngfvk_gfx_pipeline_batch_run(ngfvk_gfx_pipeline_batch* batch) {
+  for (;;) {
+    pthread_mutex_lock(&batch->lock);
+    const uint32_t idx = batch->next_idx++;
+    pthread_mutex_unlock(&batch->lock);
+    if (idx >= batch->npipelines) { break; }
+    batch->errors[idx] = ngf_create_graphics_pipeline(&batch->infos[idx], &batch->results[idx]);
+  }
+}
+
+static void* ngfvk_gfx_pipeline_batch_worker(void* arg) {
+  ngfvk_gfx_pipeline_batch* batch = (ngfvk_gfx_pipeline_batch*)arg;
+  CURRENT_CONTEXT                 = batch->ctx;
+  ngfvk_gfx_pipeline_batch_run(batch);
+  ngfi_tmp_store_release();
+  return NULL;
+}
+
+ngf_error ngf_create_graphics_pipelines(
+    const ngf_graphics_pipeline_info* infos,
+    uint32_t                          npipelines,
+    ngf_graphics_pipeline*            results) {
+  assert(infos || npipelines == 0u);
+  assert(results || npipelines == 0u);
+  if (npipelines == 0u) { return NGF_ERROR_OK; }
+
+  ngfvk_gfx_pipeline_batch batch = {
+      .ctx        = CURRENT_CONTEXT,
+      .infos      = infos,
+      .results    = results,
+      .errors     = NGFI_ALLOCN(ngf_error, npipelines),
+      .npipelines = npipelines,
+      .next_idx   = 0u};
+  if (batch.errors == NULL) { return NGF_ERROR_OUT_OF_MEM; }
+  pthread_mutex_init(&batch.lock, 0);
+
+  // The calling thread takes part in the work, so one less worker thread is needed. If a worker
+  // thread fails to start, the remaining threads simply pick up more of the work.
+  const uint32_t nthreads = NGFI_MIN(ngfi_get_hw_thread_count(), npipelines);
+  const uint32_t nworkers = nthreads - 1u;
+  pthread_t*     workers  = nworkers > 0u ? NGFI_ALLOCN(pthread_t, nworkers) : NULL;
+  uint32_t       nstarted = 0u;
+  for (uint32_t i = 0u; workers != NULL && i < nworkers; ++i) {
+    if (pthread_create(&workers[nstarted], NULL, ngfvk_gfx_pipeline_batch_worker, &batch) == 0) {
+      ++nstarted;
+    }
+  }
+  ngfvk_gfx_pipeline_batch_run(&batch);
+  for (uint32_t i = 0u; i < nstarted; ++i) { pthread_join(workers[i], NULL); }
+  if (workers != NULL) { NGFI_FREEN(workers, nworkers); }
+  pthread_mutex_destroy(&batch.lock);
+
+  ngf_error err = NGF_ERROR_OK;
+  for (uint32_t i = 0u; err == NGF_ERROR_OK && i < npipelines; ++i) { err = batch.errors[i]; }
+  if (err != NGF_ERROR_OK) {
+    for (uint32_t i = 0u; i < npipelines; ++i) {
+      ngf_destroy_graphics_pipeline(results[i]);
+      results[i] = NULL;
+    }
+  }
+  NGFI_FREEN(batch.errors, npipelines);
   return err;
 }
 
@@ -4212,13 +7477,17 @@ ngf_create_compute_pipeline(const ngf_compute_pipeline_info* info, ngf_compute_p
     err = NGF_ERROR_OUT_OF_MEM;
     goto ngf_create_compute_pipeline_cleanup;
   }
+  memset(pipeline, 0, sizeof(ngf_compute_pipeline_t));
   VkPipelineShaderStageCreateInfo vk_shader_stage;
   err = ngfvk_initialize_generic_pipeline_data(
       &pipeline->generic_pipeline,
       info->spec_info,
       &vk_shader_stage,
       &info->shader_stage,
-      1);
+      1,
+      info->dynamic_uniform_buffers,
+      info->ndynamic_uniform_buffers);
+  if (err != NGF_ERROR_OK) { goto ngf_create_compute_pipeline_cleanup; }
 
   const VkComputePipelineCreateInfo vk_pipeline_ci = {
       .sType              = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
@@ -4230,14 +7499,18 @@ ngf_create_compute_pipeline(const ngf_compute_pipeline_info* info, ngf_compute_p
       .basePipelineIndex  = -1};
   VkResult vk_err = vkCreateComputePipelines(
       _vk.device,
-      VK_NULL_HANDLE,
+      CURRENT_CONTEXT->pipeline_cache,
       1,
       &vk_pipeline_ci,
       NULL,
       &pipeline->generic_pipeline.vk_pipeline);
   if (vk_err != VK_SUCCESS) { err = NGF_ERROR_OBJECT_CREATION_FAILED; }
 ngf_create_compute_pipeline_cleanup:
-  if (err != NGF_ERROR_OK) { ngf_destroy_compute_pipeline(pipeline); }
+  if (err != NGF_ERROR_OK && pipeline != NULL) {
+    ngfvk_destroy_unused_generic_pipeline_data(&pipeline->generic_pipeline);
+    NGFI_FREE(pipeline);
+    *result = NULL;
+  }
   return err;
 }
 
@@ -4445,12 +7718,14 @@ void ngf_destroy_render_target(ngf_render_target target) {
     }
     NGFI_FREEN(target->attachment_descs, target->nattachments);
     NGFI_FREEN(target->attachment_compat_pass_descs, target->nattachments);
-    NGFI_FREE(target);
 
-    // clear out the entire renderpass cache to make sure the entries associated
-    // with this target don't stick around.
-    // TODO: clear out all caches across all contexts.
-    ngfvk_reset_renderpass_cache(CURRENT_CONTEXT);
+    // Evict the cache entries associated with this target, so that they don't stick around and
+    // don't get matched by a new target allocated at the same address.
+    // TODO: evict from the caches of all contexts.
+    pthread_mutex_lock(&CURRENT_CONTEXT->renderpass_cache_lock);
+    ngfvk_renderpass_cache_evict(&CURRENT_CONTEXT->renderpass_cache, target, res);
+    pthread_mutex_unlock(&CURRENT_CONTEXT->renderpass_cache_lock);
+    NGFI_FREE(target);
   }
 }
 
@@ -4466,6 +7741,51 @@ void ngf_cmd_dispatch(
   vkCmdDispatch(cmd_buf->vk_cmd_buffer, x_threadgroups, y_threadgroups, z_threadgroups);
 }
 
+ngf_error ngf_cmd_begin_query(ngf_render_encoder enc, ngf_query_pool pool, uint32_t query) {
+  ngf_cmd_buffer cmd_buf = NGFVK_ENC2CMDBUF(enc);
+  assert(pool);
+  if (pool->type != NGF_QUERY_TYPE_OCCLUSION && pool->type != NGF_QUERY_TYPE_PIPELINE_STATISTICS) {
+    NGFI_DIAG_ERROR("only occlusion and pipeline statistics queries can be begun");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (query >= pool->nqueries) {
+    NGFI_DIAG_ERROR("query %u is out of the pool's bounds", query);
+    return NGF_ERROR_OUT_OF_BOUNDS;
+  }
+  if (cmd_buf->active_query_pool != NULL) {
+    NGFI_DIAG_ERROR("only one query may be active at a time");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (cmd_buf->parallel_renderpass || (cmd_buf->flags & NGF_CMD_BUFFER_SECONDARY)) {
+    NGFI_DIAG_ERROR("queries are not supported in parallel render passes");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (ngfvk_query_begun(cmd_buf, pool, query)) {
+    NGFI_DIAG_ERROR("query %u may only be begun once per frame", query);
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  const VkQueryControlFlags control =
+      pool->type == NGF_QUERY_TYPE_OCCLUSION && _vk.precise_occlusion_queries
+          ? VK_QUERY_CONTROL_PRECISE_BIT
+          : 0u;
+  vkCmdBeginQuery(cmd_buf->vk_cmd_buffer, pool->vk_pool, query, control);
+  ngfvk_track_query(cmd_buf, pool, query, true);
+  cmd_buf->active_query_pool = pool;
+  cmd_buf->active_query      = query;
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_cmd_end_query(ngf_render_encoder enc) {
+  ngf_cmd_buffer cmd_buf = NGFVK_ENC2CMDBUF(enc);
+  if (cmd_buf->active_query_pool == NULL) {
+    NGFI_DIAG_ERROR("no query is active");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  vkCmdEndQuery(cmd_buf->vk_cmd_buffer, cmd_buf->active_query_pool->vk_pool, cmd_buf->active_query);
+  cmd_buf->active_query_pool = NULL;
+  return NGF_ERROR_OK;
+}
+
 void ngf_cmd_draw(
     ngf_render_encoder enc,
     bool               indexed,
@@ -4485,15 +7805,99 @@ void ngf_cmd_draw(
   }
 }
 
+void ngf_cmd_dispatch_indirect(
+    ngf_compute_encoder enc,
+    const ngf_buffer    args_buf,
+    size_t              offset) {
+  ngf_cmd_buffer cmd_buf = NGFVK_ENC2CMDBUF(enc);
+  ngfvk_execute_pending_binds(cmd_buf);
+
+  vkCmdDispatchIndirect(cmd_buf->vk_cmd_buffer, (VkBuffer)args_buf->alloc.obj_handle, offset);
+}
+
+void ngf_cmd_draw_indirect(
+    ngf_render_encoder enc,
+    bool               indexed,
+    const ngf_buffer   args_buf,
+    size_t             offset,
+    uint32_t           ndraws,
+    uint32_t           stride) {
+  ngf_cmd_buffer cmd_buf = NGFVK_ENC2CMDBUF(enc);
+  if (ndraws > DEVICE_CAPS.max_draw_indirect_count) {
+    NGFI_DIAG_ERROR(
+        "Indirect draw count %u exceeds the device limit of %zu.",
+        ndraws,
+        DEVICE_CAPS.max_draw_indirect_count);
+    return;
+  }
+
+  ngfvk_execute_pending_binds(cmd_buf);
+
+  const VkBuffer vk_args_buf = (VkBuffer)args_buf->alloc.obj_handle;
+  if (indexed) {
+    vkCmdDrawIndexedIndirect(cmd_buf->vk_cmd_buffer, vk_args_buf, offset, ndraws, stride);
+  } else {
+    vkCmdDrawIndirect(cmd_buf->vk_cmd_buffer, vk_args_buf, offset, ndraws, stride);
+  }
+}
+
+void ngf_cmd_draw_indirect_count(
+    ngf_render_encoder enc,
+    bool               indexed,
+    const ngf_buffer   args_buf,
+    size_t             offset,
+    const ngf_buffer   count_buf,
+    size_t             count_offset,
+    uint32_t           max_draws,
+    uint32_t           stride) {
+  ngf_cmd_buffer cmd_buf = NGFVK_ENC2CMDBUF(enc);
+  if (!DEVICE_CAPS.draw_indirect_count_supported || vkCmdDrawIndirectCountKHR == NULL ||
+      vkCmdDrawIndexedIndirectCountKHR == NULL) {
+    NGFI_DIAG_ERROR("Indirect draws with a GPU-sourced count are not supported by the device.");
+    return;
+  }
+
+  ngfvk_execute_pending_binds(cmd_buf);
+
+  const VkBuffer vk_args_buf  = (VkBuffer)args_buf->alloc.obj_handle;
+  const VkBuffer vk_count_buf = (VkBuffer)count_buf->alloc.obj_handle;
+  if (indexed) {
+    vkCmdDrawIndexedIndirectCountKHR(
+        cmd_buf->vk_cmd_buffer,
+        vk_args_buf,
+        offset,
+        vk_count_buf,
+        count_offset,
+        max_draws,
+        stride);
+  } else {
+    vkCmdDrawIndirectCountKHR(
+        cmd_buf->vk_cmd_buffer,
+        vk_args_buf,
+        offset,
+        vk_count_buf,
+        count_offset,
+        max_draws,
+        stride);
+  }
+}
+
 void ngf_cmd_bind_gfx_pipeline(ngf_render_encoder enc, const ngf_graphics_pipeline pipeline) {
   ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
 
   // If we had a pipeline bound for which there have been resources bound, but no draw call
   // executed, commit those resources to actual descriptor sets and bind them so that the next
   // pipeline is able to "see" those resources, provided that it's compatible.
-  if (buf->active_gfx_pipe && buf->pending_bind_ops.size > 0u) { ngfvk_execute_pending_binds(buf); }
+  if (buf->active_gfx_pipe && buf->active_gfx_pipe != pipeline &&
+      !NGFI_DARRAY_EMPTY(buf->pending_bind_ops)) {
+    ngfvk_execute_pending_binds(buf);
+  }
 
   buf->active_gfx_pipe = pipeline;
+  if (!ngfvk_shadow_set_gfx_pipeline(&buf->shadow_state, pipeline->generic_pipeline.vk_pipeline)) {
+    buf->stats.redundant_state_changes_elided++;
+    return;
+  }
   vkCmdBindPipeline(
       buf->vk_cmd_buffer,
       VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -4516,9 +7920,81 @@ void ngf_cmd_bind_compute_resources(
   ngfvk_cmd_bind_resources(buf, bind_operations, nbind_operations);
 }
 
+void ngf_cmd_bind_group(ngf_render_encoder enc, const ngf_bind_group group) {
+  ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
+  ngfvk_cmd_bind_group(
+      buf,
+      buf->active_gfx_pipe ? &buf->active_gfx_pipe->generic_pipeline : NULL,
+      VK_PIPELINE_BIND_POINT_GRAPHICS,
+      group);
+}
+
+void ngf_cmd_bind_compute_group(ngf_compute_encoder enc, const ngf_bind_group group) {
+  ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
+  ngfvk_cmd_bind_group(
+      buf,
+      buf->active_compute_pipe ? &buf->active_compute_pipe->generic_pipeline : NULL,
+      VK_PIPELINE_BIND_POINT_COMPUTE,
+      group);
+}
+
+void ngf_cmd_bind_resource_table(
+    ngf_render_encoder       enc,
+    uint32_t                 set,
+    const ngf_resource_table table) {
+  ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
+  ngfvk_cmd_bind_resource_table(
+      buf,
+      buf->active_gfx_pipe ? &buf->active_gfx_pipe->generic_pipeline : NULL,
+      VK_PIPELINE_BIND_POINT_GRAPHICS,
+      set,
+      table);
+}
+
+void ngf_cmd_bind_compute_resource_table(
+    ngf_compute_encoder      enc,
+    uint32_t                 set,
+    const ngf_resource_table table) {
+  ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
+  ngfvk_cmd_bind_resource_table(
+      buf,
+      buf->active_compute_pipe ? &buf->active_compute_pipe->generic_pipeline : NULL,
+      VK_PIPELINE_BIND_POINT_COMPUTE,
+      set,
+      table);
+}
+
+void ngf_cmd_push_constants(
+    ngf_render_encoder enc,
+    uint32_t           offset,
+    uint32_t           size,
+    const void*        data) {
+  ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
+  ngfvk_cmd_push_constants(
+      buf,
+      buf->active_gfx_pipe ? &buf->active_gfx_pipe->generic_pipeline : NULL,
+      offset,
+      size,
+      data);
+}
+
+void ngf_cmd_push_compute_constants(
+    ngf_compute_encoder enc,
+    uint32_t            offset,
+    uint32_t            size,
+    const void*         data) {
+  ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
+  ngfvk_cmd_push_constants(
+      buf,
+      buf->active_compute_pipe ? &buf->active_compute_pipe->generic_pipeline : NULL,
+      offset,
+      size,
+      data);
+}
+
 void ngf_cmd_bind_compute_pipeline(ngf_compute_encoder enc, const ngf_compute_pipeline pipeline) {
   ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
-  if (buf->active_compute_pipe && buf->pending_bind_ops.size > 0u) {
+  if (buf->active_compute_pipe && !NGFI_DARRAY_EMPTY(buf->pending_bind_ops)) {
     ngfvk_execute_pending_binds(buf);
   }
 
@@ -4538,6 +8014,10 @@ void ngf_cmd_viewport(ngf_render_encoder enc, const ngf_irect2d* r) {
       .height   = NGFI_MAX(1, (float)r->height),
       .minDepth = 0.0f,
       .maxDepth = 1.0f};
+  if (!ngfvk_shadow_set_viewport(&buf->shadow_state, &viewport)) {
+    buf->stats.redundant_state_changes_elided++;
+    return;
+  }
   vkCmdSetViewport(buf->vk_cmd_buffer, 0u, 1u, &viewport);
 }
 
@@ -4545,23 +8025,54 @@ void ngf_cmd_scissor(ngf_render_encoder enc, const ngf_irect2d* r) {
   ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
   assert(buf->active_rt);
   const VkRect2D scissor_rect = {.offset = {r->x, r->y}, .extent = {r->width, r->height}};
+  if (!ngfvk_shadow_set_scissor(&buf->shadow_state, &scissor_rect)) {
+    buf->stats.redundant_state_changes_elided++;
+    return;
+  }
   vkCmdSetScissor(buf->vk_cmd_buffer, 0u, 1u, &scissor_rect);
 }
 
 void ngf_cmd_stencil_reference(ngf_render_encoder enc, uint32_t front, uint32_t back) {
   ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
+  if (!ngfvk_shadow_set_stencil_values(
+          &buf->shadow_state,
+          NGFVK_SHADOW_STENCIL_REFERENCE,
+          buf->shadow_state.stencil_reference,
+          front,
+          back)) {
+    buf->stats.redundant_state_changes_elided++;
+    return;
+  }
   vkCmdSetStencilReference(buf->vk_cmd_buffer, VK_STENCIL_FACE_FRONT_BIT, front);
   vkCmdSetStencilReference(buf->vk_cmd_buffer, VK_STENCIL_FACE_BACK_BIT, back);
 }
 
 void ngf_cmd_stencil_compare_mask(ngf_render_encoder enc, uint32_t front, uint32_t back) {
   ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
+  if (!ngfvk_shadow_set_stencil_values(
+          &buf->shadow_state,
+          NGFVK_SHADOW_STENCIL_COMPARE_MASK,
+          buf->shadow_state.stencil_compare_mask,
+          front,
+          back)) {
+    buf->stats.redundant_state_changes_elided++;
+    return;
+  }
   vkCmdSetStencilCompareMask(buf->vk_cmd_buffer, VK_STENCIL_FACE_FRONT_BIT, front);
   vkCmdSetStencilCompareMask(buf->vk_cmd_buffer, VK_STENCIL_FACE_BACK_BIT, back);
 }
 
 void ngf_cmd_stencil_write_mask(ngf_render_encoder enc, uint32_t front, uint32_t back) {
   ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
+  if (!ngfvk_shadow_set_stencil_values(
+          &buf->shadow_state,
+          NGFVK_SHADOW_STENCIL_WRITE_MASK,
+          buf->shadow_state.stencil_write_mask,
+          front,
+          back)) {
+    buf->stats.redundant_state_changes_elided++;
+    return;
+  }
   vkCmdSetStencilWriteMask(buf->vk_cmd_buffer, VK_STENCIL_FACE_FRONT_BIT, front);
   vkCmdSetStencilWriteMask(buf->vk_cmd_buffer, VK_STENCIL_FACE_BACK_BIT, back);
 }
@@ -4573,6 +8084,14 @@ void ngf_cmd_bind_attrib_buffer(
     uint32_t           offset) {
   ngf_cmd_buffer buf      = NGFVK_ENC2CMDBUF(enc);
   VkDeviceSize   vkoffset = offset;
+  if (!ngfvk_shadow_set_attrib_buf(
+          &buf->shadow_state,
+          binding,
+          (VkBuffer)abuf->alloc.obj_handle,
+          vkoffset)) {
+    buf->stats.redundant_state_changes_elided++;
+    return;
+  }
   vkCmdBindVertexBuffers(
       buf->vk_cmd_buffer,
       binding,
@@ -4589,7 +8108,12 @@ void ngf_cmd_bind_index_buffer(
   ngf_cmd_buffer    buf      = NGFVK_ENC2CMDBUF(enc);
   const VkIndexType idx_type = get_vk_index_type(index_type);
   assert(idx_type == VK_INDEX_TYPE_UINT16 || idx_type == VK_INDEX_TYPE_UINT32);
-  vkCmdBindIndexBuffer(buf->vk_cmd_buffer, (VkBuffer)ibuf->alloc.obj_handle, offset, idx_type);
+  const VkBuffer vk_ibuf = (VkBuffer)ibuf->alloc.obj_handle;
+  if (!ngfvk_shadow_set_index_buf(&buf->shadow_state, vk_ibuf, offset, idx_type)) {
+    buf->stats.redundant_state_changes_elided++;
+    return;
+  }
+  vkCmdBindIndexBuffer(buf->vk_cmd_buffer, vk_ibuf, offset, idx_type);
 }
 
 void ngf_cmd_copy_buffer(
@@ -4601,8 +8125,38 @@ void ngf_cmd_copy_buffer(
     size_t           dst_offset) {
   ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
   assert(buf);
+  if (buf->queue == NGFVK_QUEUE_XFER) {
+    // The destination isn't in use by any pending work, so the copy doesn't need to wait on
+    // anything. Afterwards, the written range is released to the graphics queue.
+    const VkBufferCopy copy_region = {
+        .srcOffset = src_offset,
+        .dstOffset = dst_offset,
+        .size      = size};
+    ngfvk_xfer_sync_buffer(buf, (VkBuffer)src->alloc.obj_handle, src_offset, size);
+    ngfvk_xfer_sync_buffer(buf, (VkBuffer)dst->alloc.obj_handle, dst_offset, size);
+    vkCmdCopyBuffer(
+        buf->vk_cmd_buffer,
+        (VkBuffer)src->alloc.obj_handle,
+        (VkBuffer)dst->alloc.obj_handle,
+        1u,
+        &copy_region);
+    VkBufferMemoryBarrier release_barrier, acquire_barrier;
+    ngfvk_buffer_ownership_barriers(
+        _vk.xfer_family_idx,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        (VkBuffer)dst->alloc.obj_handle,
+        dst_offset,
+        size,
+        get_vk_buffer_access_flags(dst),
+        &release_barrier,
+        &acquire_barrier);
+    NGFI_DARRAY_APPEND(buf->pending_xfer_buf_barriers, release_barrier);
+    buf->pending_xfer_dst_stages |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    NGFI_DARRAY_APPEND(buf->ownership_buf_barriers, acquire_barrier);
+    return;
+  }
   ngfvk_cmd_copy_buffer(
-      buf->vk_cmd_buffer,
+      buf,
       (VkBuffer)src->alloc.obj_handle,
       (VkBuffer)dst->alloc.obj_handle,
       size,
@@ -4612,6 +8166,168 @@ void ngf_cmd_copy_buffer(
       get_vk_buffer_pipeline_stage_flags(dst));
 }
 
+// Records the given image writes without validating them.
+static void ngfvk_cmd_write_images(
+    ngf_cmd_buffer         buf,
+    const ngf_buffer       src,
+    const ngf_image_write* writes,
+    uint32_t               nwrites) {
+  const VkBuffer vk_src        = (VkBuffer)src->alloc.obj_handle;
+  const bool     on_xfer_queue = buf->queue == NGFVK_QUEUE_XFER;
+  // Shader stages aren't supported on the transfer queue, and the destinations aren't in use by
+  // any pending work there anyway.
+  const VkPipelineStageFlags usage_stage_flags =
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+      VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+  ngfvk_flush_buffer_copies(buf);
+  ngfvk_xfer_sync_buffer(buf, vk_src, 0u, VK_WHOLE_SIZE);
+
+  uint32_t first_write = 0u;
+  while (first_write < nwrites) {
+    // Gather the longest run of writes with non-overlapping destinations, so that all of them can
+    // be transitioned for the transfer with a single barrier.
+    NGFI_DARRAY_CLEAR(buf->xfer_pre_img_barriers);
+    uint32_t end_write = first_write;
+    for (; end_write < nwrites; ++end_write) {
+      const ngf_image_write* w   = &writes[end_write];
+      const VkImage          img = (VkImage)w->dst.image->alloc.obj_handle;
+      const uint32_t         dst_layer =
+          w->dst.image->type == NGF_IMAGE_TYPE_CUBE ? 6u * w->dst.layer + w->dst.cubemap_face
+                                                    : w->dst.layer;
+      const VkImageSubresourceRange range = {
+          .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+          .baseMipLevel   = w->dst.mip_level,
+          .levelCount     = 1u,
+          .baseArrayLayer = dst_layer,
+          .layerCount     = w->nlayers};
+      bool overlaps_run = false;
+      NGFI_DARRAY_FOREACH(buf->xfer_pre_img_barriers, b) {
+        const VkImageMemoryBarrier* other = &NGFI_DARRAY_AT(buf->xfer_pre_img_barriers, b);
+        overlaps_run |= other->image == img &&
+                        ngfvk_subresource_ranges_overlap(&other->subresourceRange, &range);
+      }
+      if (overlaps_run) { break; }
+      // Nothing from the current run has been recorded yet, so it's safe to flush here.
+      ngfvk_xfer_sync_image(buf, img, &range);
+      const VkAccessFlags usage_access_flags =
+          get_vk_image_access_flags(w->dst.image) ^ VK_ACCESS_TRANSFER_WRITE_BIT;
+      const VkImageMemoryBarrier pre_xfer_barrier = {
+          .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+          .pNext               = NULL,
+          .srcAccessMask       = on_xfer_queue ? 0u : usage_access_flags,
+          .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+          .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+          .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .image               = img,
+          .subresourceRange    = range};
+      NGFI_DARRAY_APPEND(buf->xfer_pre_img_barriers, pre_xfer_barrier);
+    }
+    vkCmdPipelineBarrier(
+        buf->vk_cmd_buffer,
+        on_xfer_queue ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : usage_stage_flags,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0u,
+        0u,
+        NULL,
+        0u,
+        NULL,
+        NGFI_DARRAY_SIZE(buf->xfer_pre_img_barriers),
+        buf->xfer_pre_img_barriers.data);
+
+    // Consecutive writes into the same image are recorded as a single copy.
+    for (uint32_t i = first_write; i < end_write;) {
+      const ngf_image dst_image = writes[i].dst.image;
+      NGFI_DARRAY_CLEAR(buf->xfer_copy_regions);
+      for (; i < end_write && writes[i].dst.image == dst_image; ++i) {
+        const ngf_image_write*         w     = &writes[i];
+        const VkImageSubresourceRange* range =
+            &NGFI_DARRAY_AT(buf->xfer_pre_img_barriers, i - first_write).subresourceRange;
+        const VkBufferImageCopy copy_op = {
+            .bufferOffset      = w->src_offset,
+            .bufferRowLength   = 0u,
+            .bufferImageHeight = 0u,
+            .imageSubresource =
+                {.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                 .mipLevel       = range->baseMipLevel,
+                 .baseArrayLayer = range->baseArrayLayer,
+                 .layerCount     = range->layerCount},
+            .imageOffset = {.x = w->offset.x, .y = w->offset.y, .z = w->offset.z},
+            .imageExtent =
+                {.width = w->extent.width, .height = w->extent.height, .depth = w->extent.depth}};
+        NGFI_DARRAY_APPEND(buf->xfer_copy_regions, copy_op);
+      }
+      vkCmdCopyBufferToImage(
+          buf->vk_cmd_buffer,
+          vk_src,
+          (VkImage)dst_image->alloc.obj_handle,
+          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+          NGFI_DARRAY_SIZE(buf->xfer_copy_regions),
+          buf->xfer_copy_regions.data);
+    }
+
+    // The barriers that make the writes visible are deferred until the end of the pass.
+    NGFI_DARRAY_FOREACH(buf->xfer_pre_img_barriers, b) {
+      const VkImageMemoryBarrier* pre_xfer_barrier = &NGFI_DARRAY_AT(buf->xfer_pre_img_barriers, b);
+      const ngf_image             dst_image        = writes[first_write + b].dst.image;
+      const VkAccessFlags         usage_access_flags =
+          get_vk_image_access_flags(dst_image) ^ VK_ACCESS_TRANSFER_WRITE_BIT;
+      const VkImageLayout target_layout = (dst_image->usage_flags & NGF_IMAGE_USAGE_STORAGE)
+                                              ? VK_IMAGE_LAYOUT_GENERAL
+                                              : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+      if (on_xfer_queue) {
+        VkImageMemoryBarrier release_barrier, acquire_barrier;
+        ngfvk_image_ownership_barriers(
+            _vk.xfer_family_idx,
+            VK_ACCESS_TRANSFER_WRITE_BIT,
+            pre_xfer_barrier->image,
+            &pre_xfer_barrier->subresourceRange,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            target_layout,
+            usage_access_flags,
+            &release_barrier,
+            &acquire_barrier);
+        NGFI_DARRAY_APPEND(buf->pending_xfer_img_barriers, release_barrier);
+        NGFI_DARRAY_APPEND(buf->ownership_img_barriers, acquire_barrier);
+        buf->pending_xfer_dst_stages |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+      } else {
+        const VkImageMemoryBarrier post_xfer_barrier = {
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext               = NULL,
+            .srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask       = usage_access_flags,
+            .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .newLayout           = target_layout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image               = pre_xfer_barrier->image,
+            .subresourceRange    = pre_xfer_barrier->subresourceRange};
+        NGFI_DARRAY_APPEND(buf->pending_xfer_img_barriers, post_xfer_barrier);
+        buf->pending_xfer_dst_stages |= usage_stage_flags;
+      }
+    }
+    first_write = end_write;
+  }
+}
+
+ngf_error ngf_cmd_write_images(
+    ngf_xfer_encoder       enc,
+    const ngf_buffer       src,
+    const ngf_image_write* writes,
+    uint32_t               nwrites) {
+  ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
+  assert(buf);
+  for (uint32_t i = 0u; i < nwrites; ++i) {
+    if (!(writes[i].dst.image->usage_flags & NGF_IMAGE_USAGE_XFER_DST)) {
+      NGFI_DIAG_ERROR("image written to was created without the NGF_IMAGE_USAGE_XFER_DST flag");
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+  }
+  ngfvk_cmd_write_images(buf, src, writes, nwrites);
+  return NGF_ERROR_OK;
+}
+
 void ngf_cmd_write_image(
     ngf_xfer_encoder enc,
     const ngf_buffer src,
@@ -4620,88 +8336,13 @@ void ngf_cmd_write_image(
     ngf_offset3d     offset,
     ngf_extent3d     extent,
     uint32_t         nlayers) {
-  ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
-  assert(buf);
-  const uint32_t dst_layer =
-      dst.image->type == NGF_IMAGE_TYPE_CUBE ? 6u * dst.layer + dst.cubemap_face : dst.layer;
-  const VkAccessFlags        image_access_flags = get_vk_image_access_flags(dst.image);
-  const VkImageMemoryBarrier pre_xfer_barrier   = {
-        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-        .pNext               = NULL,
-        .srcAccessMask       = image_access_flags ^ VK_ACCESS_TRANSFER_WRITE_BIT,
-        .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
-        .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
-        .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .image               = (VkImage)dst.image->alloc.obj_handle,
-        .subresourceRange    = {
-               .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-               .baseMipLevel   = dst.mip_level,
-               .levelCount     = 1u,
-               .baseArrayLayer = dst_layer,
-               .layerCount     = nlayers}};
-  vkCmdPipelineBarrier(
-      buf->vk_cmd_buffer,
-      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
-          VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-      VK_PIPELINE_STAGE_TRANSFER_BIT,
-      0u,
-      0u,
-      NULL,
-      0u,
-      NULL,
-      1u,
-      &pre_xfer_barrier);
-  const VkBufferImageCopy copy_op = {
-      .bufferOffset      = src_offset,
-      .bufferRowLength   = 0u,
-      .bufferImageHeight = 0u,
-      .imageSubresource =
-          {.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-           .mipLevel       = dst.mip_level,
-           .baseArrayLayer = dst_layer,
-           .layerCount     = nlayers},
-      .imageOffset = {.x = offset.x, .y = offset.y, .z = offset.z},
-      .imageExtent = {.width = extent.width, .height = extent.height, .depth = extent.depth}};
-  vkCmdCopyBufferToImage(
-      buf->vk_cmd_buffer,
-      (VkBuffer)src->alloc.obj_handle,
-      (VkImage)dst.image->alloc.obj_handle,
-      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-      1u,
-      &copy_op);
-  const VkImageLayout        target_layout     = (dst.image->usage_flags & NGF_IMAGE_USAGE_STORAGE)
-                                                     ? VK_IMAGE_LAYOUT_GENERAL
-                                                     : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-  const VkImageMemoryBarrier post_xfer_barrier = {
-      .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-      .pNext               = NULL,
-      .srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
-      .dstAccessMask       = image_access_flags ^ VK_ACCESS_TRANSFER_WRITE_BIT,
-      .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-      .newLayout           = target_layout,
-      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-      .image               = (VkImage)dst.image->alloc.obj_handle,
-      .subresourceRange    = {
-             .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-             .baseMipLevel   = dst.mip_level,
-             .levelCount     = 1u,
-             .baseArrayLayer = dst_layer,
-             .layerCount     = nlayers}};
-  vkCmdPipelineBarrier(
-      buf->vk_cmd_buffer,
-      VK_PIPELINE_STAGE_TRANSFER_BIT,
-      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
-          VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-      0u,
-      0u,
-      NULL,
-      0u,
-      NULL,
-      1u,
-      &post_xfer_barrier);
+  const ngf_image_write write = {
+      .src_offset = src_offset,
+      .dst        = dst,
+      .offset     = offset,
+      .extent     = extent,
+      .nlayers    = nlayers};
+  ngfvk_cmd_write_images(NGFVK_ENC2CMDBUF(enc), src, &write, 1u);
 }
 
 void ngf_cmd_copy_image_to_buffer(
@@ -4714,6 +8355,10 @@ void ngf_cmd_copy_image_to_buffer(
     size_t              dst_offset) {
   ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(enc);
   assert(buf);
+  if (buf->flags & NGF_CMD_BUFFER_ASYNC_XFER) {
+    NGFI_DIAG_ERROR("images can't be read back within async transfer cmd buffers");
+    return;
+  }
   const uint32_t src_layer =
       src.image->type == NGF_IMAGE_TYPE_CUBE ? 6u * src.layer + src.cubemap_face : src.layer;
   const VkImageLayout        src_layout         = (src.image->usage_flags & NGF_IMAGE_USAGE_STORAGE)
@@ -4737,6 +8382,9 @@ void ngf_cmd_copy_image_to_buffer(
                .baseArrayLayer = src_layer,
                .layerCount     = nlayers}};
 
+  ngfvk_flush_buffer_copies(buf);
+  ngfvk_xfer_sync_image(buf, pre_xfer_barrier.image, &pre_xfer_barrier.subresourceRange);
+  ngfvk_xfer_sync_buffer(buf, (VkBuffer)dst->alloc.obj_handle, dst_offset, VK_WHOLE_SIZE);
   vkCmdPipelineBarrier(
       buf->vk_cmd_buffer,
       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
@@ -4787,19 +8435,10 @@ void ngf_cmd_copy_image_to_buffer(
              .levelCount     = 1u,
              .baseArrayLayer = src_layer,
              .layerCount     = nlayers}};
-
-  vkCmdPipelineBarrier(
-      buf->vk_cmd_buffer,
-      VK_PIPELINE_STAGE_TRANSFER_BIT,
+  NGFI_DARRAY_APPEND(buf->pending_xfer_img_barriers, post_xfer_barrier);
+  buf->pending_xfer_dst_stages |=
       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
-          VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-      0u,
-      0u,
-      NULL,
-      0u,
-      NULL,
-      1u,
-      &post_xfer_barrier);
+      VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 }
 
 ngf_error ngf_cmd_generate_mipmaps(ngf_xfer_encoder xfenc, ngf_image img) {
@@ -4811,60 +8450,81 @@ ngf_error ngf_cmd_generate_mipmaps(ngf_xfer_encoder xfenc, ngf_image img) {
 
   ngf_cmd_buffer buf = NGFVK_ENC2CMDBUF(xfenc);
   assert(buf);
+  if (buf->flags & NGF_CMD_BUFFER_ASYNC_XFER) {
+    // Blits are only supported on queues with graphics capabilities.
+    NGFI_DIAG_ERROR("mipmaps can't be generated within async transfer cmd buffers");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
 
   // TODO: ensure the pixel format is valid for mip generation.
 
+  if (img->nlevels < 2u) { return NGF_ERROR_OK; }
   uint32_t src_w = img->extent.width, src_h = img->extent.height, src_d = img->extent.depth,
            dst_w = 0, dst_h = 0, dst_d = 0;
   const uint32_t nlayers = img->nlayers;
-
-  for (uint32_t src_level = 0u; src_level < img->nlevels - 1; ++src_level) {
-    const uint32_t dst_level                       = src_level + 1u;
-    dst_w                                          = src_w > 1u ? (src_w >> 1u) : 1u;
-    dst_h                                          = src_h > 1u ? (src_h >> 1u) : 1u;
-    dst_d                                          = src_d > 1u ? (src_d >> 1u) : 1u;
-    const VkImageMemoryBarrier pre_blit_barriers[] = {
-        {.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-         .pNext               = NULL,
-         .srcAccessMask       = VK_ACCESS_SHADER_READ_BIT,
-         .dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT,
-         .oldLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-         .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-         .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-         .image               = (VkImage)img->alloc.obj_handle,
-         .subresourceRange =
-             {.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-              .baseMipLevel   = src_level,
-              .levelCount     = 1u,
+  const uint32_t nlevels = img->nlevels;
+  const VkImage  vk_img  = (VkImage)img->alloc.obj_handle;
+
+  const VkImageSubresourceRange all_levels = {
+      .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel   = 0u,
+      .levelCount     = nlevels,
+      .baseArrayLayer = 0u,
+      .layerCount     = nlayers};
+  ngfvk_flush_buffer_copies(buf);
+  ngfvk_xfer_sync_image(buf, vk_img, &all_levels);
+
+  // All of the levels are transitioned up front: the base level to be read from, and the rest to
+  // be written to. Each subsequent level becomes a source right after it has been written.
+  const VkImageMemoryBarrier pre_blit_barriers[] = {
+      {.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+       .pNext               = NULL,
+       .srcAccessMask       = VK_ACCESS_SHADER_READ_BIT,
+       .dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT,
+       .oldLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+       .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+       .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+       .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+       .image               = vk_img,
+       .subresourceRange =
+           {.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel   = 0u,
+            .levelCount     = 1u,
+            .baseArrayLayer = 0u,
+            .layerCount     = nlayers}},
+      {.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+       .pNext               = NULL,
+       .srcAccessMask       = VK_ACCESS_SHADER_READ_BIT,
+       .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+       .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+       .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+       .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+       .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+       .image               = vk_img,
+       .subresourceRange    = {
+              .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+              .baseMipLevel   = 1u,
+              .levelCount     = nlevels - 1u,
               .baseArrayLayer = 0u,
-              .layerCount     = nlayers}},
-        {.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-         .pNext               = NULL,
-         .srcAccessMask       = VK_ACCESS_SHADER_READ_BIT,
-         .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
-         .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
-         .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-         .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-         .image               = (VkImage)img->alloc.obj_handle,
-         .subresourceRange    = {
-                .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-                .baseMipLevel   = dst_level,
-                .levelCount     = 1u,
-                .baseArrayLayer = 0u,
-                .layerCount     = nlayers}}};
-    vkCmdPipelineBarrier(
-        buf->vk_cmd_buffer,
-        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        0u,
-        0u,
-        NULL,
-        0u,
-        NULL,
-        2u,
-        pre_blit_barriers);
+              .layerCount     = nlayers}}};
+  vkCmdPipelineBarrier(
+      buf->vk_cmd_buffer,
+      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0u,
+      0u,
+      NULL,
+      0u,
+      NULL,
+      2u,
+      pre_blit_barriers);
+
+  for (uint32_t src_level = 0u; src_level < nlevels - 1u; ++src_level) {
+    const uint32_t dst_level = src_level + 1u;
+    dst_w                    = src_w > 1u ? (src_w >> 1u) : 1u;
+    dst_h                    = src_h > 1u ? (src_h >> 1u) : 1u;
+    dst_d                    = src_d > 1u ? (src_d >> 1u) : 1u;
+
     const VkImageBlit blit_region = {
         .srcSubresource =
             {.mipLevel       = src_level,
@@ -4880,59 +8540,84 @@ ngf_error ngf_cmd_generate_mipmaps(ngf_xfer_encoder xfenc, ngf_image img) {
         .dstOffsets = {{0, 0, 0}, {(int32_t)dst_w, (int32_t)dst_h, (int32_t)dst_d}}};
     vkCmdBlitImage(
         buf->vk_cmd_buffer,
-        (VkImage)img->alloc.obj_handle,
+        vk_img,
         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-        (VkImage)img->alloc.obj_handle,
+        vk_img,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
         1,
         &blit_region,
         VK_FILTER_LINEAR);
-    const VkImageMemoryBarrier post_blit_barriers[] = {
-        {.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-         .pNext               = NULL,
-         .srcAccessMask       = VK_ACCESS_TRANSFER_READ_BIT,
-         .dstAccessMask       = VK_ACCESS_SHADER_READ_BIT,
-         .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-         .newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-         .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-         .image               = (VkImage)img->alloc.obj_handle,
-         .subresourceRange =
-             {.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-              .baseMipLevel   = src_level,
-              .levelCount     = 1u,
-              .baseArrayLayer = 0u,
-              .layerCount     = nlayers}},
-        {.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-         .pNext               = NULL,
-         .srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
-         .dstAccessMask       = VK_ACCESS_SHADER_READ_BIT,
-         .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-         .newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-         .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-         .image               = (VkImage)img->alloc.obj_handle,
-         .subresourceRange    = {
-                .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-                .baseMipLevel   = dst_level,
-                .levelCount     = 1u,
-                .baseArrayLayer = 0u,
-                .layerCount     = nlayers}}};
-    vkCmdPipelineBarrier(
-        buf->vk_cmd_buffer,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-        0u,
-        0u,
-        NULL,
-        0u,
-        NULL,
-        2u,
-        post_blit_barriers);
+    if (dst_level + 1u < nlevels) {
+      const VkImageMemoryBarrier next_src_barrier = {
+          .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+          .pNext               = NULL,
+          .srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+          .dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT,
+          .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+          .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .image               = vk_img,
+          .subresourceRange    = {
+                 .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                 .baseMipLevel   = dst_level,
+                 .levelCount     = 1u,
+                 .baseArrayLayer = 0u,
+                 .layerCount     = nlayers}};
+      vkCmdPipelineBarrier(
+          buf->vk_cmd_buffer,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          0u,
+          0u,
+          NULL,
+          0u,
+          NULL,
+          1u,
+          &next_src_barrier);
+    }
     src_w = dst_w;
     src_h = dst_h;
     src_d = dst_d;
   }
+
+  // All levels but the last one end up as blit sources. Transitioning them back for sampling is
+  // deferred until the end of the pass.
+  const VkImageMemoryBarrier post_blit_barriers[] = {
+      {.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+       .pNext               = NULL,
+       .srcAccessMask       = VK_ACCESS_TRANSFER_READ_BIT,
+       .dstAccessMask       = VK_ACCESS_SHADER_READ_BIT,
+       .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+       .newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+       .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+       .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+       .image               = vk_img,
+       .subresourceRange =
+           {.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel   = 0u,
+            .levelCount     = nlevels - 1u,
+            .baseArrayLayer = 0u,
+            .layerCount     = nlayers}},
+      {.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+       .pNext               = NULL,
+       .srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+       .dstAccessMask       = VK_ACCESS_SHADER_READ_BIT,
+       .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+       .newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+       .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+       .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+       .image               = vk_img,
+       .subresourceRange    = {
+              .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+              .baseMipLevel   = nlevels - 1u,
+              .levelCount     = 1u,
+              .baseArrayLayer = 0u,
+              .layerCount     = nlayers}}};
+  NGFI_DARRAY_APPEND(buf->pending_xfer_img_barriers, post_blit_barriers[0]);
+  NGFI_DARRAY_APPEND(buf->pending_xfer_img_barriers, post_blit_barriers[1]);
+  buf->pending_xfer_dst_stages |=
+      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
   return NGF_ERROR_OK;
 }
 
@@ -4971,6 +8656,396 @@ void ngf_destroy_texel_buffer_view(ngf_texel_buffer_view buf_view) {
   }
 }
 
+// Allocates a descriptor set with the given layout for a bind group from the current context's
+// bind group pools, creating a new pool if none of the existing ones has room left.
+static bool ngfvk_alloc_bind_group_set(
+    const ngfvk_desc_set_layout* set_layout,
+    VkDescriptorPool*            pool,
+    VkDescriptorSet*             set) {
+  VkDescriptorSetAllocateInfo vk_desc_set_info = {
+      .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+      .pNext              = NULL,
+      .descriptorPool     = VK_NULL_HANDLE,
+      .descriptorSetCount = 1u,
+      .pSetLayouts        = &set_layout->vk_handle};
+
+  // Pools run out of space or get fragmented as groups come and go, so every one of them is tried,
+  // starting with the most recently created.
+  for (size_t p = NGFI_DARRAY_SIZE(CURRENT_CONTEXT->bind_group_pools); p > 0u; --p) {
+    vk_desc_set_info.descriptorPool = NGFI_DARRAY_AT(CURRENT_CONTEXT->bind_group_pools, p - 1u);
+    if (vkAllocateDescriptorSets(_vk.device, &vk_desc_set_info, set) == VK_SUCCESS) {
+      *pool = vk_desc_set_info.descriptorPool;
+      return true;
+    }
+  }
+
+  // New pools have room for a fixed number of typical sets, or at least one set with the given
+  // layout.
+  VkDescriptorPoolSize vk_pool_sizes[NGF_DESCRIPTOR_TYPE_COUNT];
+  for (int i = 0; i < NGF_DESCRIPTOR_TYPE_COUNT; ++i) {
+    vk_pool_sizes[i].type = get_vk_descriptor_type((ngf_descriptor_type)i);
+    vk_pool_sizes[i].descriptorCount =
+        NGFI_MAX(set_layout->counts[i], NGFVK_BIND_GROUP_POOL_DESCRIPTORS);
+  }
+  const VkDescriptorPoolCreateInfo vk_pool_ci = {
+      .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+      .pNext         = NULL,
+      .flags         = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
+      .maxSets       = NGFVK_BIND_GROUP_POOL_SETS,
+      .poolSizeCount = NGF_DESCRIPTOR_TYPE_COUNT,
+      .pPoolSizes    = vk_pool_sizes};
+  VkDescriptorPool new_pool = VK_NULL_HANDLE;
+  if (vkCreateDescriptorPool(_vk.device, &vk_pool_ci, NULL, &new_pool) != VK_SUCCESS) {
+    return false;
+  }
+  NGFI_DARRAY_APPEND(CURRENT_CONTEXT->bind_group_pools, new_pool);
+  vk_desc_set_info.descriptorPool = new_pool;
+  if (vkAllocateDescriptorSets(_vk.device, &vk_desc_set_info, set) != VK_SUCCESS) { return false; }
+  *pool = new_pool;
+  return true;
+}
+
+ngf_error ngf_create_bind_group(const ngf_bind_group_info* info, ngf_bind_group* result) {
+  assert(info);
+  assert(result);
+
+  if ((info->gfx_pipeline == NULL) == (info->compute_pipeline == NULL)) {
+    NGFI_DIAG_ERROR("Exactly one pipeline must be specified when creating a bind group.");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  const ngfvk_generic_pipeline* pipeline_data = info->gfx_pipeline
+                                                    ? &info->gfx_pipeline->generic_pipeline
+                                                    : &info->compute_pipeline->generic_pipeline;
+  if (info->set >= NGFI_DARRAY_SIZE(pipeline_data->descriptor_set_layouts)) {
+    NGFI_DIAG_ERROR("Bind group targets set %u, which the pipeline does not have.", info->set);
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  for (uint32_t i = 0u; i < info->nbind_operations; ++i) {
+    if (info->bind_operations[i].target_set != info->set) {
+      NGFI_DIAG_ERROR(
+          "Bind operation %u targets set %u, but the bind group is for set %u.",
+          i,
+          info->bind_operations[i].target_set,
+          info->set);
+      return NGF_ERROR_INVALID_OPERATION;
+    }
+  }
+  const ngfvk_desc_set_layout* set_layout =
+      &NGFI_DARRAY_AT(pipeline_data->descriptor_set_layouts, info->set);
+  if (set_layout->resource_table) {
+    NGFI_DIAG_ERROR("Set %u is reserved for resource tables.", info->set);
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+
+  ngf_bind_group group = NGFI_ALLOC(ngf_bind_group_t);
+  *result              = group;
+  if (group == NULL) return NGF_ERROR_OUT_OF_MEM;
+  group->set              = info->set;
+  group->ndynamic_offsets = set_layout->ndynamic_bindings;
+  memset(group->dynamic_offsets, 0, sizeof(group->dynamic_offsets));
+
+  if (!ngfvk_alloc_bind_group_set(set_layout, &group->vk_pool, &group->vk_set)) {
+    NGFI_FREE(group);
+    *result = NULL;
+    return NGF_ERROR_OBJECT_CREATION_FAILED;
+  }
+
+  // Sort the bind ops by binding. If the same binding is written several times, only the last
+  // write matters.
+  const uint32_t nops = info->nbind_operations;
+  if (nops == 0u) { return NGF_ERROR_OK; }
+  ngfi_sa_reset(ngfi_tmp_store());
+  ngfvk_sorted_bind_op* sorted_ops =
+      ngfi_sa_alloc(ngfi_tmp_store(), nops * sizeof(ngfvk_sorted_bind_op));
+  const ngf_resource_bind_op** write_ops =
+      ngfi_sa_alloc(ngfi_tmp_store(), nops * sizeof(ngf_resource_bind_op*));
+  for (uint32_t i = 0u; i < nops; ++i) {
+    sorted_ops[i].op  = &info->bind_operations[i];
+    sorted_ops[i].seq = i;
+  }
+  qsort(sorted_ops, nops, sizeof(ngfvk_sorted_bind_op), ngfvk_sorted_bind_op_comparator);
+  uint32_t nwrites = 0u;
+  for (uint32_t i = 0u; i < nops; ++i) {
+    const ngf_resource_bind_op* bind_op = sorted_ops[i].op;
+    if (i + 1u < nops && sorted_ops[i + 1u].op->target_binding == bind_op->target_binding) {
+      continue;
+    }
+    write_ops[nwrites++] = bind_op;
+    if (bind_op->type == NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC) {
+      ngfvk_dynamic_offset_for_op(set_layout, bind_op, group->dynamic_offsets);
+    }
+  }
+
+  // The set is written once here, and never touched again for the lifetime of the group.
+  ngfvk_desc_template_slot* payload =
+      set_layout->update_template != VK_NULL_HANDLE
+          ? ngfi_sa_alloc(ngfi_tmp_store(), nwrites * sizeof(ngfvk_desc_template_slot))
+          : NULL;
+  if (payload != NULL &&
+      ngfvk_desc_template_payload_for_ops(set_layout, write_ops, nwrites, payload)) {
+    vkUpdateDescriptorSetWithTemplateKHR(
+        _vk.device,
+        group->vk_set,
+        set_layout->update_template,
+        payload);
+  } else {
+    VkWriteDescriptorSet* vk_writes =
+        ngfi_sa_alloc(ngfi_tmp_store(), nwrites * sizeof(VkWriteDescriptorSet));
+    for (uint32_t w = 0u; w < nwrites; ++w) {
+      ngfvk_write_for_bind_op(write_ops[w], group->vk_set, &vk_writes[w]);
+    }
+    vkUpdateDescriptorSets(_vk.device, nwrites, vk_writes, 0, NULL);
+  }
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_bind_group(ngf_bind_group group) {
+  if (group) {
+    const uint32_t                     fi = CURRENT_CONTEXT->frame_id;
+    const ngfvk_retired_bind_group_set retired =
+        {.vk_pool = group->vk_pool, .vk_set = group->vk_set};
+    NGFI_DARRAY_APPEND(CURRENT_CONTEXT->frame_res[fi].retire_bind_group_sets, retired);
+    NGFI_FREE(group);
+  }
+}
+
+ngf_error ngf_create_resource_table(
+    const ngf_resource_table_info* info,
+    ngf_resource_table*            result) {
+  assert(info);
+  assert(result);
+
+  if (!DEVICE_CAPS.resource_tables_supported) {
+    NGFI_DIAG_ERROR("Resource tables are not supported by the device.");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (info->type != NGF_DESCRIPTOR_IMAGE && info->type != NGF_DESCRIPTOR_STORAGE_BUFFER) {
+    NGFI_DIAG_ERROR("Resource tables may only hold images or storage buffers.");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (info->capacity == 0u || info->capacity > DEVICE_CAPS.max_resource_table_capacity) {
+    NGFI_DIAG_ERROR(
+        "Resource table capacity %u is outside of the supported range [1, %u].",
+        info->capacity,
+        DEVICE_CAPS.max_resource_table_capacity);
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+
+  ngf_resource_table table = NGFI_ALLOC(ngf_resource_table_t);
+  *result                  = table;
+  if (table == NULL) return NGF_ERROR_OUT_OF_MEM;
+  memset(table, 0, sizeof(ngf_resource_table_t));
+  table->type     = info->type;
+  table->capacity = info->capacity;
+  NGFI_DARRAY_RESET(table->free_slots, 8);
+
+  // Like bind groups, each table gets a pool of its own, sized for exactly one set. The set is
+  // updated after it's bound, so both the pool and the layout need to allow that.
+  if (ngfvk_create_resource_table_set_layout(info->type, &table->vk_set_layout) != VK_SUCCESS) {
+    ngf_destroy_resource_table(table);
+    *result = NULL;
+    return NGF_ERROR_OBJECT_CREATION_FAILED;
+  }
+  const VkDescriptorPoolSize vk_pool_size = {
+      .type            = get_vk_descriptor_type(info->type),
+      .descriptorCount = info->capacity};
+  const VkDescriptorPoolCreateInfo vk_pool_ci = {
+      .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+      .pNext         = NULL,
+      .flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT,
+      .maxSets       = 1u,
+      .poolSizeCount = 1u,
+      .pPoolSizes    = &vk_pool_size};
+  if (vkCreateDescriptorPool(_vk.device, &vk_pool_ci, NULL, &table->vk_pool) != VK_SUCCESS) {
+    ngf_destroy_resource_table(table);
+    *result = NULL;
+    return NGF_ERROR_OBJECT_CREATION_FAILED;
+  }
+  const VkDescriptorSetVariableDescriptorCountAllocateInfoEXT vk_variable_count_info = {
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO_EXT,
+      .pNext = NULL,
+      .descriptorSetCount = 1u,
+      .pDescriptorCounts  = &info->capacity};
+  const VkDescriptorSetAllocateInfo vk_desc_set_info = {
+      .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+      .pNext              = &vk_variable_count_info,
+      .descriptorPool     = table->vk_pool,
+      .descriptorSetCount = 1u,
+      .pSetLayouts        = &table->vk_set_layout};
+  if (vkAllocateDescriptorSets(_vk.device, &vk_desc_set_info, &table->vk_set) != VK_SUCCESS) {
+    ngf_destroy_resource_table(table);
+    *result = NULL;
+    return NGF_ERROR_OBJECT_CREATION_FAILED;
+  }
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_resource_table(ngf_resource_table table) {
+  if (table) {
+    ngfvk_forget_retired_table_slots(CURRENT_CONTEXT, table);
+    const uint32_t fi = CURRENT_CONTEXT->frame_id;
+    if (table->vk_pool != VK_NULL_HANDLE) {
+      NGFI_DARRAY_APPEND(CURRENT_CONTEXT->frame_res[fi].retire_desc_pools, table->vk_pool);
+    }
+    if (table->vk_set_layout != VK_NULL_HANDLE) {
+      NGFI_DARRAY_APPEND(CURRENT_CONTEXT->frame_res[fi].retire_dset_layouts, table->vk_set_layout);
+    }
+    NGFI_DARRAY_DESTROY(table->free_slots);
+    NGFI_FREE(table);
+  }
+}
+
+ngf_error ngf_alloc_resource_table_slot(ngf_resource_table table, uint32_t* slot) {
+  assert(table);
+  assert(slot);
+  return ngfvk_resource_table_acquire_slot(table, slot);
+}
+
+void ngf_free_resource_table_slot(ngf_resource_table table, uint32_t slot) {
+  assert(table);
+  if (slot >= table->nused_slots) {
+    NGFI_DIAG_ERROR("Attempt to free resource table slot %u, which was never allocated.", slot);
+    return;
+  }
+  // The slot may still be referenced by commands from the current frame, so it is only returned to
+  // the table once the frame is done executing.
+  const ngfvk_retired_table_slot retired = {.table = table, .slot = slot};
+  const uint32_t                 fi      = CURRENT_CONTEXT->frame_id;
+  NGFI_DARRAY_APPEND(CURRENT_CONTEXT->frame_res[fi].retire_table_slots, retired);
+}
+
+ngf_error ngf_write_resource_table(
+    ngf_resource_table          table,
+    uint32_t                    slot,
+    const ngf_resource_bind_op* resource) {
+  assert(table);
+  assert(resource);
+  if (slot >= table->nused_slots) {
+    NGFI_DIAG_ERROR("Attempt to write resource table slot %u, which was never allocated.", slot);
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (resource->type != table->type) {
+    NGFI_DIAG_ERROR("Resource type doesn't match the type of the resource table.");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  ngfi_sa_reset(ngfi_tmp_store());
+  ngf_resource_bind_op op = *resource;
+  op.target_binding       = 0u;
+  VkWriteDescriptorSet vk_write;
+  ngfvk_write_for_bind_op(&op, table->vk_set, &vk_write);
+  vk_write.dstArrayElement = slot;
+  vkUpdateDescriptorSets(_vk.device, 1u, &vk_write, 0, NULL);
+  return NGF_ERROR_OK;
+}
+
+ngf_error ngf_create_query_pool(const ngf_query_pool_info* info, ngf_query_pool* result) {
+  assert(info);
+  assert(result);
+
+  VkQueryType                   vk_query_type = VK_QUERY_TYPE_TIMESTAMP;
+  VkQueryPipelineStatisticFlags vk_statistics = 0u;
+  bool                          supported     = false;
+  uint32_t                      nvalues       = 1u;
+  switch (info->type) {
+  case NGF_QUERY_TYPE_TIMESTAMP:
+    supported = DEVICE_CAPS.timestamp_queries_supported;
+    break;
+  case NGF_QUERY_TYPE_OCCLUSION:
+    vk_query_type = VK_QUERY_TYPE_OCCLUSION;
+    supported     = DEVICE_CAPS.occlusion_queries_supported;
+    break;
+  case NGF_QUERY_TYPE_PIPELINE_STATISTICS:
+    // Vulkan reports the counters in the order of their bits, which matches ngf_pipeline_statistic.
+    vk_query_type = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    vk_statistics = VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+    supported     = DEVICE_CAPS.pipeline_statistics_queries_supported;
+    nvalues       = NGF_PIPELINE_STATISTIC_COUNT;
+    break;
+  default:
+    NGFI_DIAG_ERROR("Invalid query type.");
+    return NGF_ERROR_INVALID_ENUM;
+  }
+  if (!supported) {
+    NGFI_DIAG_ERROR("The requested type of queries is not supported by the device.");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+  if (info->nqueries == 0u) {
+    NGFI_DIAG_ERROR("Query pools must hold at least one query.");
+    return NGF_ERROR_INVALID_SIZE;
+  }
+
+  ngf_query_pool pool = NGFI_ALLOC(ngf_query_pool_t);
+  *result             = pool;
+  if (pool == NULL) return NGF_ERROR_OUT_OF_MEM;
+  pool->vk_pool  = VK_NULL_HANDLE;
+  pool->type     = info->type;
+  pool->nqueries = info->nqueries;
+  pool->nvalues  = nvalues;
+  pool->results  = NGFI_ALLOCN(uint64_t, info->nqueries * (nvalues + 1u));
+  if (pool->results == NULL) {
+    ngf_destroy_query_pool(pool);
+    *result = NULL;
+    return NGF_ERROR_OUT_OF_MEM;
+  }
+  memset(pool->results, 0, sizeof(uint64_t) * info->nqueries * (nvalues + 1u));
+
+  const VkQueryPoolCreateInfo vk_pool_ci = {
+      .sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+      .pNext              = NULL,
+      .flags              = 0u,
+      .queryType          = vk_query_type,
+      .queryCount         = info->nqueries,
+      .pipelineStatistics = vk_statistics};
+  if (vkCreateQueryPool(_vk.device, &vk_pool_ci, NULL, &pool->vk_pool) != VK_SUCCESS) {
+    ngf_destroy_query_pool(pool);
+    *result = NULL;
+    return NGF_ERROR_OBJECT_CREATION_FAILED;
+  }
+  return NGF_ERROR_OK;
+}
+
+void ngf_destroy_query_pool(ngf_query_pool pool) {
+  if (pool) {
+    ngfvk_forget_query_pool(CURRENT_CONTEXT, pool);
+    if (pool->vk_pool != VK_NULL_HANDLE) {
+      const uint32_t fi = CURRENT_CONTEXT->frame_id;
+      NGFI_DARRAY_APPEND(CURRENT_CONTEXT->frame_res[fi].retire_query_pools, pool->vk_pool);
+    }
+    if (pool->results) { NGFI_FREEN(pool->results, pool->nqueries * (pool->nvalues + 1u)); }
+    NGFI_FREE(pool);
+  }
+}
+
+ngf_error ngf_get_query_results(
+    ngf_query_pool pool,
+    uint32_t       first_query,
+    uint32_t       nqueries,
+    uint64_t*      results) {
+  assert(pool);
+  assert(results);
+  if (first_query > pool->nqueries || nqueries > pool->nqueries - first_query) {
+    NGFI_DIAG_ERROR("Requested query results are out of the pool's bounds.");
+    return NGF_ERROR_OUT_OF_BOUNDS;
+  }
+  // The results have already been read back when their frames were retired, so there's nothing to
+  // wait for here.
+  const uint32_t stride = pool->nvalues + 1u;
+  for (uint32_t q = first_query; q < first_query + nqueries; ++q) {
+    if (pool->results[q * stride + pool->nvalues] == 0u) { return NGF_ERROR_NOT_READY; }
+  }
+  for (uint32_t q = 0u; q < nqueries; ++q) {
+    const uint64_t* values = &pool->results[(first_query + q) * stride];
+    for (uint32_t v = 0u; v < pool->nvalues; ++v) {
+      results[q * pool->nvalues + v] =
+          pool->type == NGF_QUERY_TYPE_TIMESTAMP
+              ? (uint64_t)((double)values[v] * (double)_vk.timestamp_period)
+              : values[v];
+    }
+  }
+  return NGF_ERROR_OK;
+}
+
 ngf_error ngf_create_buffer(const ngf_buffer_info* info, ngf_buffer* result) {
   assert(info);
   assert(result);
@@ -5027,12 +9102,12 @@ ngf_error ngf_create_buffer(const ngf_buffer_info* info, ngf_buffer* result) {
   if (err != NGF_ERROR_OK) {
     NGFI_FREE(buf);
   } else {
-    buf->size = info->size;
+    buf->size          = info->size;
+    buf->mapped_offset = 0u;
+    buf->storage_type  = info->storage_type;
+    buf->usage_flags   = info->buffer_usage;
   }
 
-  buf->storage_type = info->storage_type;
-  buf->usage_flags  = info->buffer_usage;
-
   return err;
 }
 
@@ -5063,6 +9138,45 @@ void ngf_buffer_unmap(ngf_buffer buf) {
   NGFI_IGNORE_VAR(buf);
 }
 
+ngf_error ngf_upload_alloc(size_t size, size_t alignment, ngf_upload_allocation* result) {
+  assert(result);
+  if (size == 0u || alignment == 0u || (alignment & (alignment - 1u)) != 0u) {
+    NGFI_DIAG_ERROR("upload allocation size must be nonzero and alignment a power of two");
+    return NGF_ERROR_INVALID_OPERATION;
+  }
+
+  ngfvk_frame_resources* frame_res = &CURRENT_CONTEXT->frame_res[CURRENT_CONTEXT->frame_id];
+  ngfvk_upload_chunk*    chunk     = NULL;
+  size_t                 offset    = 0u;
+  NGFI_DARRAY_FOREACH(frame_res->upload_chunks, c) {
+    ngfvk_upload_chunk* candidate = &NGFI_DARRAY_AT(frame_res->upload_chunks, c);
+    if (ngfvk_upload_chunk_suballoc(candidate, size, alignment, &offset)) {
+      chunk = candidate;
+      break;
+    }
+  }
+
+  if (chunk == NULL) {
+    const ngf_buffer_info chunk_info = {
+        .size         = NGFI_MAX(size, NGFVK_UPLOAD_CHUNK_SIZE),
+        .storage_type = NGF_BUFFER_STORAGE_HOST_WRITEABLE,
+        .buffer_usage = NGF_BUFFER_USAGE_XFER_SRC | NGF_BUFFER_USAGE_UNIFORM_BUFFER |
+                        NGF_BUFFER_USAGE_VERTEX_BUFFER | NGF_BUFFER_USAGE_INDEX_BUFFER |
+                        NGF_BUFFER_USAGE_STORAGE_BUFFER};
+    ngfvk_upload_chunk new_chunk = {.buffer = NULL, .used = 0u, .flushed = 0u};
+    const ngf_error    err       = ngf_create_buffer(&chunk_info, &new_chunk.buffer);
+    if (err != NGF_ERROR_OK) { return err; }
+    NGFI_DARRAY_APPEND(frame_res->upload_chunks, new_chunk);
+    chunk = NGFI_DARRAY_BACKPTR(frame_res->upload_chunks);
+    ngfvk_upload_chunk_suballoc(chunk, size, alignment, &offset);
+  }
+
+  result->buffer = chunk->buffer;
+  result->offset = offset;
+  result->data   = (uint8_t*)chunk->buffer->alloc.mapped_data + offset;
+  return NGF_ERROR_OK;
+}
+
 ngf_error ngf_create_image(const ngf_image_info* info, ngf_image* result) {
   assert(info);
   assert(result);
@@ -5159,7 +9273,12 @@ ngf_error ngf_create_image(const ngf_image_info* info, ngf_image* result) {
 
   if (err != NGF_ERROR_OK) { goto ngf_create_image_cleanup; }
 
-  const VkImageMemoryBarrier barrier = {
+  ngfvk_pending_img_barrier* pending_barrier = NGFI_ALLOC(ngfvk_pending_img_barrier);
+  if (pending_barrier == NULL) {
+    err = NGF_ERROR_OUT_OF_MEM;
+    goto ngf_create_image_cleanup;
+  }
+  pending_barrier->barrier = (VkImageMemoryBarrier){
       .sType         = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
       .pNext         = NULL,
       .srcAccessMask = 0u,
@@ -5192,9 +9311,7 @@ ngf_error ngf_create_image(const ngf_image_info* info, ngf_image* result) {
   img->nlevels = info->nmips;
   img->nlayers = vk_image_info.arrayLayers;
 
-  pthread_mutex_lock(&NGFVK_PENDING_IMG_BARRIER_QUEUE.lock);
-  NGFI_DARRAY_APPEND(NGFVK_PENDING_IMG_BARRIER_QUEUE.barriers, barrier);
-  pthread_mutex_unlock(&NGFVK_PENDING_IMG_BARRIER_QUEUE.lock);
+  ngfi_atomic_stack_push(&NGFVK_PENDING_IMG_BARRIER_QUEUE, &pending_barrier->node);
 
 ngf_create_image_cleanup:
   if (err != NGF_ERROR_OK) { ngf_destroy_image(img); }
@@ -30,6 +30,54 @@
 #include "ngf-common/dynamic-array.h"
 #include "ngf-common/list.h"
 #include "ngf-common/cmdbuf-state.h"
+#include "ngf-common/atomic-stack.h"
+
+/* atomic stack stress test helpers */
+
+#define atomic_stack_nproducers          (8u)
+#define atomic_stack_nodes_per_producer (20000u)
+
+typedef struct atomic_stack_test_node {
+  ngfi_atomic_stack_node node;
+  uint32_t               producer;
+  uint32_t               seq;
+} atomic_stack_test_node;
+
+typedef struct atomic_stack_test_producer {
+  ngfi_atomic_stack*      stack;
+  atomic_stack_test_node* nodes;
+  uint32_t                id;
+} atomic_stack_test_producer;
+
+static void* atomic_stack_test_produce(void* arg) {
+  atomic_stack_test_producer* producer = (atomic_stack_test_producer*)arg;
+  for (uint32_t i = 0u; i < atomic_stack_nodes_per_producer; ++i) {
+    atomic_stack_test_node* n = &producer->nodes[i];
+    n->producer               = producer->id;
+    n->seq                    = i;
+    ngfi_atomic_stack_push(producer->stack, &n->node);
+  }
+  return NULL;
+}
+
+// Consumes all nodes currently in the stack, checking that each producer's nodes come out in
+// the order they were pushed. Returns false if the order is violated.
+static bool
+atomic_stack_test_consume(ngfi_atomic_stack* stack, uint32_t* next_seq, uint32_t* total) {
+  uint32_t                count = 0u;
+  uint32_t                seen  = 0u;
+  ngfi_atomic_stack_node* node  = ngfi_atomic_stack_take_all(stack, &count);
+  while (node != NULL) {
+    const atomic_stack_test_node* n =
+        NGFI_ATOMIC_STACK_CONTAINER_OF(node, atomic_stack_test_node, node);
+    if (n->seq != next_seq[n->producer]) { return false; }
+    next_seq[n->producer]++;
+    node = node->next;
+    ++seen;
+  }
+  *total += seen;
+  return seen == count;
+}
 
 NT_TESTSUITE {
   /* frame token tests */
@@ -230,6 +278,20 @@ NT_TESTSUITE {
     ngfi_sa_destroy(sa);
   }
 
+  NT_TESTCASE("stack alloc: release per-thread temp storage") {
+    ngfi_sa* tmp = ngfi_tmp_store();
+    NT_ASSERT(tmp != NULL);
+    NT_ASSERT(ngfi_tmp_store() == tmp);
+    NT_ASSERT(ngfi_sa_alloc(tmp, 16u) != NULL);
+
+    ngfi_tmp_store_release();
+    ngfi_tmp_store_release();  // releasing twice is harmless.
+
+    tmp = ngfi_tmp_store();
+    NT_ASSERT(tmp != NULL);
+    NT_ASSERT(tmp->active_block->ptr == tmp->data);
+  }
+
   /* block allocator tests */
 
   typedef struct test_data {
@@ -379,6 +441,38 @@ NT_TESTSUITE {
     NT_ASSERT(prev_i == (int)array_size - 1);
   }
 
+  NT_TESTCASE("dynamic array: append n") {
+    NGFI_DARRAY_OF(point) pt_array;
+    point          check_array[37];
+    const uint32_t array_size = sizeof(check_array) / sizeof(check_array[0]);
+    for (size_t i = 0; i < array_size; ++i) {
+      point p        = {frand(), frand()};
+      check_array[i] = p;
+    }
+    NGFI_DARRAY_RESET(pt_array, 4u);
+    // Append in batches of varying size, some of which exceed twice the current capacity.
+    uint32_t nappended = 0u;
+    for (uint32_t batch = 1u; nappended < array_size; batch *= 3u) {
+      const uint32_t n = batch < array_size - nappended ? batch : array_size - nappended;
+      NGFI_DARRAY_APPEND_N(pt_array, &check_array[nappended], n);
+      nappended += n;
+      NT_ASSERT(NGFI_DARRAY_SIZE(pt_array) == nappended);
+      NT_ASSERT(pt_array.capacity >= nappended);
+    }
+    NGFI_DARRAY_FOREACH(pt_array, i) {
+      NT_ASSERT(NGFI_DARRAY_AT(pt_array, i).x == check_array[i].x);
+      NT_ASSERT(NGFI_DARRAY_AT(pt_array, i).y == check_array[i].y);
+    }
+
+    // Clearing keeps the storage around.
+    const point* old_data = pt_array.data;
+    NGFI_DARRAY_CLEAR(pt_array);
+    NGFI_DARRAY_APPEND_N(pt_array, check_array, 8u);
+    NT_ASSERT(pt_array.data == old_data);
+    NT_ASSERT(NGFI_DARRAY_SIZE(pt_array) == 8u);
+    NGFI_DARRAY_DESTROY(pt_array);
+  }
+
   /* list tests */
 
   typedef struct test_struct {
@@ -517,4 +611,62 @@ NT_TESTSUITE {
 
   }
 
+
+  /* atomic stack tests */
+
+  NT_TESTCASE("atomic stack: push and take all") {
+    ngfi_atomic_stack      stack = {NULL};
+    atomic_stack_test_node nodes[3];
+    uint32_t               count = 0xffu;
+    NT_ASSERT(ngfi_atomic_stack_take_all(&stack, &count) == NULL);
+    NT_ASSERT(count == 0u);
+    for (uint32_t i = 0u; i < 3u; ++i) {
+      nodes[i].seq = i;
+      ngfi_atomic_stack_push(&stack, &nodes[i].node);
+    }
+    ngfi_atomic_stack_node* node = ngfi_atomic_stack_take_all(&stack, &count);
+    NT_ASSERT(count == 3u);
+    NT_ASSERT(stack.head == NULL);
+    for (uint32_t i = 0u; i < 3u; ++i) {
+      NT_ASSERT(node != NULL);
+      NT_ASSERT(NGFI_ATOMIC_STACK_CONTAINER_OF(node, atomic_stack_test_node, node)->seq == i);
+      node = node->next;
+    }
+    NT_ASSERT(node == NULL);
+  }
+
+  NT_TESTCASE("atomic stack: concurrent producers") {
+    ngfi_atomic_stack          stack = {NULL};
+    atomic_stack_test_producer producers[atomic_stack_nproducers];
+    pthread_t                  threads[atomic_stack_nproducers];
+    uint32_t                   next_seq[atomic_stack_nproducers] = {0u};
+    uint32_t                   total                             = 0u;
+    atomic_stack_test_node*    nodes                             = (atomic_stack_test_node*)malloc(
+        sizeof(atomic_stack_test_node) * atomic_stack_nproducers * atomic_stack_nodes_per_producer);
+    NT_ASSERT(nodes != NULL);
+
+    for (uint32_t p = 0u; p < atomic_stack_nproducers; ++p) {
+      producers[p].stack = &stack;
+      producers[p].nodes = &nodes[p * atomic_stack_nodes_per_producer];
+      producers[p].id    = p;
+      NT_ASSERT(pthread_create(&threads[p], NULL, atomic_stack_test_produce, &producers[p]) == 0);
+    }
+
+    // Drain the stack while the producers are still pushing onto it.
+    const uint32_t expected_total = atomic_stack_nproducers * atomic_stack_nodes_per_producer;
+    bool           order_ok       = true;
+    while (order_ok && total < expected_total / 2u) {
+      order_ok = atomic_stack_test_consume(&stack, next_seq, &total);
+    }
+    for (uint32_t p = 0u; p < atomic_stack_nproducers; ++p) { pthread_join(threads[p], NULL); }
+    if (order_ok) { order_ok = atomic_stack_test_consume(&stack, next_seq, &total); }
+
+    NT_ASSERT(order_ok);
+    NT_ASSERT(total == expected_total);
+    for (uint32_t p = 0u; p < atomic_stack_nproducers; ++p) {
+      NT_ASSERT(next_seq[p] == atomic_stack_nodes_per_producer);
+    }
+    NT_ASSERT(stack.head == NULL);
+    free(nodes);
+  }
 }
@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2023 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "nicegraf.h"
+#include "nicetest.h"
+
+#include <stdio.h>
+#include <time.h>
+
+// Microbenchmarks for the CPU overhead of recording commands, run against the null backend.
+// Results are reported on stderr; nothing is asserted about the timings themselves.
+
+static ngf_context null_benchmarks_create_context(void) {
+  const ngf_swapchain_info swapchain_info = {
+      .color_format  = NGF_IMAGE_FORMAT_BGRA8_SRGB,
+      .depth_format  = NGF_IMAGE_FORMAT_DEPTH32,
+      .sample_count  = NGF_SAMPLE_COUNT_1,
+      .capacity_hint = 3u,
+      .width         = 640u,
+      .height        = 480u,
+      .native_handle = 0u,
+      .present_mode  = NGF_PRESENTATION_MODE_FIFO};
+  const ngf_context_info ctx_info = {.swapchain_info = &swapchain_info, .shared_context = NULL};
+  ngf_context            ctx      = NULL;
+  NT_ASSERT(ngf_create_context(&ctx_info, &ctx) == NGF_ERROR_OK);
+  NT_ASSERT(ngf_set_context(ctx) == NGF_ERROR_OK);
+  return ctx;
+}
+
+NT_TESTSUITE {
+  NT_TESTCASE(null_initialize) {
+    const ngf_device* devices  = NULL;
+    uint32_t          ndevices = 0u;
+    NT_ASSERT(ngf_get_device_list(&devices, &ndevices) == NGF_ERROR_OK);
+    NT_ASSERT(ndevices == 1u);
+    const ngf_init_info init_info = {
+        .diag_info            = NULL,
+        .allocation_callbacks = NULL,
+        .device               = devices[0].handle,
+        .renderdoc_info       = NULL};
+    NT_ASSERT(ngf_initialize(&init_info) == NGF_ERROR_OK);
+  }
+
+  NT_TESTCASE(null_bind_and_draw_throughput) {
+    // Records a batch of resource binds before every draw and reports the achieved rate.
+    ngf_context           ctx      = null_benchmarks_create_context();
+    const ngf_buffer_info buf_info = {
+        .size         = 256u,
+        .storage_type = NGF_BUFFER_STORAGE_HOST_WRITEABLE,
+        .buffer_usage = NGF_BUFFER_USAGE_UNIFORM_BUFFER};
+    ngf_buffer ubo = NULL;
+    NT_ASSERT(ngf_create_buffer(&buf_info, &ubo) == NGF_ERROR_OK);
+    ngf_cmd_buffer            cmd_buf      = NULL;
+    const ngf_cmd_buffer_info cmd_buf_info = {0u};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+
+    ngf_resource_bind_op ops[4];
+    for (uint32_t i = 0u; i < 4u; ++i) {
+      ops[i].target_set         = 0u;
+      ops[i].target_binding     = i;
+      ops[i].type               = NGF_DESCRIPTOR_UNIFORM_BUFFER;
+      ops[i].info.buffer.buffer = ubo;
+      ops[i].info.buffer.offset = 0u;
+      ops[i].info.buffer.range  = 256u;
+    }
+
+    const uint32_t nframes          = 4u;
+    const uint32_t ndraws_per_frame = 25000u;
+    const clock_t  start            = clock();
+    for (uint32_t f = 0u; f < nframes; ++f) {
+      ngf_frame_token token;
+      NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+      ngf_render_encoder enc;
+      NT_ASSERT(
+          ngf_cmd_begin_render_pass_simple(
+              cmd_buf,
+              ngf_default_render_target(),
+              0.0f,
+              0.0f,
+              0.0f,
+              0.0f,
+              1.0f,
+              0u,
+              &enc) == NGF_ERROR_OK);
+      for (uint32_t d = 0u; d < ndraws_per_frame; ++d) {
+        ngf_cmd_bind_resources(enc, ops, 4u);
+        ngf_cmd_draw(enc, false, 0u, 3u, 1u);
+      }
+      NT_ASSERT(ngf_cmd_end_render_pass(enc) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    }
+    const double elapsed_s = (double)(clock() - start) / (double)CLOCKS_PER_SEC;
+    const double ndraws    = (double)(nframes * ndraws_per_frame);
+    fprintf(
+        stderr,
+        "%.0f bind+draw sequences in %.3f s (%.2f M/s)\n",
+        ndraws,
+        elapsed_s,
+        elapsed_s > 0.0 ? ndraws / elapsed_s / 1e6 : 0.0);
+
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_buffer(ubo);
+    ngf_destroy_context(ctx);
+  }
+
+  ngf_shutdown();
+}
@@ -0,0 +1,1054 @@
+/**
+ * Copyright (c) 2023 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "nicegraf.h"
+#include "nicetest.h"
+
+#include <pthread.h>
+#include <string.h>
+
+static ngf_context null_tests_create_context(void) {
+  const ngf_swapchain_info swapchain_info = {
+      .color_format  = NGF_IMAGE_FORMAT_BGRA8_SRGB,
+      .depth_format  = NGF_IMAGE_FORMAT_DEPTH32,
+      .sample_count  = NGF_SAMPLE_COUNT_1,
+      .capacity_hint = 3u,
+      .width         = 640u,
+      .height        = 480u,
+      .native_handle = 0u,
+      .present_mode  = NGF_PRESENTATION_MODE_FIFO};
+  const ngf_context_info ctx_info = {.swapchain_info = &swapchain_info, .shared_context = NULL};
+  ngf_context            ctx      = NULL;
+  NT_ASSERT(ngf_create_context(&ctx_info, &ctx) == NGF_ERROR_OK);
+  NT_ASSERT(ngf_set_context(ctx) == NGF_ERROR_OK);
+  return ctx;
+}
+
+/* parallel render pass test helpers */
+
+#define parallel_pass_nthreads (4u)
+
+typedef struct parallel_pass_worker {
+  ngf_render_encoder parent_enc;
+  ngf_cmd_buffer     cmd_buf;
+  uint32_t           ndraws;
+  ngf_error          err;
+} parallel_pass_worker;
+
+// Records a portion of a parallel render pass. Runs on a thread without a current context.
+static void* parallel_pass_record(void* arg) {
+  parallel_pass_worker* worker = (parallel_pass_worker*)arg;
+  ngf_render_encoder    enc;
+  worker->err = ngf_cmd_begin_secondary_render_pass(worker->parent_enc, worker->cmd_buf, &enc);
+  if (worker->err != NGF_ERROR_OK) { return NULL; }
+  const ngf_irect2d viewport = {0, 0, 640u, 480u};
+  ngf_cmd_viewport(enc, &viewport);
+  for (uint32_t d = 0u; d < worker->ndraws; ++d) { ngf_cmd_draw(enc, false, 0u, 3u, 1u); }
+  worker->err = ngf_cmd_end_secondary_render_pass(enc);
+  return NULL;
+}
+
+/* multithreaded recording test helpers */
+
+#define mt_record_nthreads (4u)
+#define mt_record_nsubmits (3u)
+
+typedef struct mt_record_worker {
+  ngf_frame_token             token;
+  ngf_cmd_buffer              cmd_buf;
+  const ngf_render_pass_info* pass_info;
+  ngf_query_pool              query_pool;
+  uint32_t                    first_query;
+  uint32_t                    ndraws;
+  ngf_error                   err;
+} mt_record_worker;
+
+// Records and submits the same primary cmd buffer several times over. Runs on a thread without a
+// current context.
+static void* mt_record(void* arg) {
+  mt_record_worker* worker = (mt_record_worker*)arg;
+  for (uint32_t s = 0u; s < mt_record_nsubmits; ++s) {
+    worker->err = ngf_start_cmd_buffer(worker->cmd_buf, worker->token);
+    if (worker->err != NGF_ERROR_OK) { return NULL; }
+    ngf_render_encoder enc;
+    worker->err = ngf_cmd_begin_render_pass(worker->cmd_buf, worker->pass_info, &enc);
+    if (worker->err != NGF_ERROR_OK) { return NULL; }
+    worker->err = ngf_cmd_begin_query(enc, worker->query_pool, worker->first_query + s);
+    if (worker->err != NGF_ERROR_OK) { return NULL; }
+    for (uint32_t d = 0u; d < worker->ndraws; ++d) { ngf_cmd_draw(enc, false, 0u, 3u, 1u); }
+    worker->err = ngf_cmd_end_query(enc);
+    if (worker->err != NGF_ERROR_OK) { return NULL; }
+    worker->err = ngf_cmd_end_render_pass(enc);
+    if (worker->err != NGF_ERROR_OK) { return NULL; }
+    worker->err = ngf_submit_cmd_buffers(1u, &worker->cmd_buf);
+    if (worker->err != NGF_ERROR_OK) { return NULL; }
+  }
+  return NULL;
+}
+
+NT_TESTSUITE {
+  NT_TESTCASE(null_initialize) {
+    const ngf_device* devices  = NULL;
+    uint32_t          ndevices = 0u;
+    NT_ASSERT(ngf_get_device_list(&devices, &ndevices) == NGF_ERROR_OK);
+    NT_ASSERT(ndevices == 1u);
+    const ngf_init_info init_info = {
+        .diag_info            = NULL,
+        .allocation_callbacks = NULL,
+        .device               = devices[0].handle,
+        .renderdoc_info       = NULL};
+    NT_ASSERT(ngf_initialize(&init_info) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_initialize(&init_info) == NGF_ERROR_INVALID_OPERATION);
+  }
+
+  NT_TESTCASE(null_default_render_target) {
+    ngf_context ctx = null_tests_create_context();
+    NT_ASSERT(ngf_default_render_target() != NULL);
+    const ngf_attachment_descriptions* descs = ngf_default_render_target_attachment_descs();
+    NT_ASSERT(descs != NULL);
+    NT_ASSERT(descs->ndescs == 2u);
+    NT_ASSERT(descs->descs[0].type == NGF_ATTACHMENT_COLOR);
+    NT_ASSERT(descs->descs[1].type == NGF_ATTACHMENT_DEPTH);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_record_and_retire_frames) {
+    ngf_context    ctx     = null_tests_create_context();
+    ngf_cmd_buffer cmd_buf = NULL;
+    const ngf_cmd_buffer_info cmd_buf_info = {0u};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+
+    const ngf_buffer_info buf_info = {
+        .size         = 256u,
+        .storage_type = NGF_BUFFER_STORAGE_HOST_WRITEABLE,
+        .buffer_usage = NGF_BUFFER_USAGE_UNIFORM_BUFFER};
+    ngf_buffer ubo = NULL;
+    NT_ASSERT(ngf_create_buffer(&buf_info, &ubo) == NGF_ERROR_OK);
+
+    for (uint32_t f = 0u; f < 8u; ++f) {
+      ngf_frame_token token;
+      NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+      ngf_render_encoder enc;
+      NT_ASSERT(
+          ngf_cmd_begin_render_pass_simple(
+              cmd_buf,
+              ngf_default_render_target(),
+              0.0f,
+              0.0f,
+              0.0f,
+              0.0f,
+              1.0f,
+              0u,
+              &enc) == NGF_ERROR_OK);
+      for (uint32_t d = 0u; d < 16u; ++d) {
+        const ngf_resource_bind_op op = {
+            .target_set     = 0u,
+            .target_binding = d % 4u,
+            .type           = NGF_DESCRIPTOR_UNIFORM_BUFFER,
+            .info.buffer    = {.buffer = ubo, .offset = 0u, .range = 256u}};
+        ngf_cmd_bind_resources(enc, &op, 1u);
+        ngf_cmd_draw(enc, false, 0u, 3u, 1u);
+      }
+      NT_ASSERT(ngf_cmd_end_render_pass(enc) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    }
+
+    ngf_destroy_buffer(ubo);
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_submit_for_wrong_frame) {
+    ngf_context               ctx          = null_tests_create_context();
+    ngf_cmd_buffer            cmd_buf      = NULL;
+    const ngf_cmd_buffer_info cmd_buf_info = {0u};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+
+    ngf_frame_token token;
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_invalid_cmd_buffer_transitions) {
+    ngf_context               ctx          = null_tests_create_context();
+    ngf_cmd_buffer            cmd_buf      = NULL;
+    const ngf_cmd_buffer_info cmd_buf_info = {0u};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+
+    ngf_frame_token token;
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+    const ngf_xfer_pass_info xfer_pass_info = {.sync_compute_resources = {0u, NULL}};
+    ngf_xfer_encoder         xfer_enc_a, xfer_enc_b;
+    NT_ASSERT(ngf_cmd_begin_xfer_pass(cmd_buf, &xfer_pass_info, &xfer_enc_a) == NGF_ERROR_OK);
+    NT_ASSERT(
+        ngf_cmd_begin_xfer_pass(cmd_buf, &xfer_pass_info, &xfer_enc_b) ==
+        NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(ngf_cmd_end_xfer_pass(xfer_enc_a) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_buffer_map_range) {
+    ngf_context           ctx      = null_tests_create_context();
+    const ngf_buffer_info buf_info = {
+        .size         = 64u,
+        .storage_type = NGF_BUFFER_STORAGE_HOST_READABLE_WRITEABLE,
+        .buffer_usage = NGF_BUFFER_USAGE_XFER_SRC};
+    ngf_buffer buf = NULL;
+    NT_ASSERT(ngf_create_buffer(&buf_info, &buf) == NGF_ERROR_OK);
+    uint8_t* mapped = ngf_buffer_map_range(buf, 16u, 16u);
+    NT_ASSERT(mapped != NULL);
+    memset(mapped, 0xab, 16u);
+    ngf_buffer_flush_range(buf, 0u, 16u);
+    ngf_buffer_unmap(buf);
+    NT_ASSERT((uint8_t*)ngf_buffer_map_range(buf, 0u, 64u) + 16u == mapped);
+    ngf_buffer_unmap(buf);
+    ngf_destroy_buffer(buf);
+
+    const ngf_buffer_info private_buf_info = {
+        .size         = 64u,
+        .storage_type = NGF_BUFFER_STORAGE_PRIVATE,
+        .buffer_usage = NGF_BUFFER_USAGE_XFER_DST};
+    NT_ASSERT(ngf_create_buffer(&private_buf_info, &buf) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_buffer_map_range(buf, 0u, 64u) == NULL);
+    ngf_destroy_buffer(buf);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_generate_mipmaps_requires_usage_flag) {
+    ngf_context          ctx      = null_tests_create_context();
+    const ngf_image_info img_info = {
+        .type         = NGF_IMAGE_TYPE_IMAGE_2D,
+        .extent       = {.width = 256u, .height = 256u, .depth = 1u},
+        .nmips        = 9u,
+        .nlayers      = 1u,
+        .format       = NGF_IMAGE_FORMAT_RGBA8,
+        .sample_count = NGF_SAMPLE_COUNT_1,
+        .usage_hint   = NGF_IMAGE_USAGE_SAMPLE_FROM};
+    ngf_image img = NULL;
+    NT_ASSERT(ngf_create_image(&img_info, &img) == NGF_ERROR_OK);
+
+    ngf_cmd_buffer            cmd_buf      = NULL;
+    const ngf_cmd_buffer_info cmd_buf_info = {0u};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+    ngf_frame_token token;
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+    const ngf_xfer_pass_info xfer_pass_info = {.sync_compute_resources = {0u, NULL}};
+    ngf_xfer_encoder         xfer_enc;
+    NT_ASSERT(ngf_cmd_begin_xfer_pass(cmd_buf, &xfer_pass_info, &xfer_enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_generate_mipmaps(xfer_enc, img) == NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(ngf_cmd_end_xfer_pass(xfer_enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+
+    ngf_destroy_image(img);
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_write_images) {
+    ngf_context    ctx      = null_tests_create_context();
+    ngf_image_info img_info = {
+        .type         = NGF_IMAGE_TYPE_IMAGE_2D,
+        .extent       = {.width = 16u, .height = 16u, .depth = 1u},
+        .nmips        = 5u,
+        .nlayers      = 200u,
+        .format       = NGF_IMAGE_FORMAT_RGBA8,
+        .sample_count = NGF_SAMPLE_COUNT_1,
+        .usage_hint   = NGF_IMAGE_USAGE_SAMPLE_FROM | NGF_IMAGE_USAGE_XFER_DST |
+                      NGF_IMAGE_USAGE_MIPMAP_GENERATION};
+    ngf_image img = NULL, readonly_img = NULL;
+    NT_ASSERT(ngf_create_image(&img_info, &img) == NGF_ERROR_OK);
+    img_info.usage_hint = NGF_IMAGE_USAGE_SAMPLE_FROM;
+    NT_ASSERT(ngf_create_image(&img_info, &readonly_img) == NGF_ERROR_OK);
+    const ngf_buffer_info staging_info = {
+        .size         = 200u * 16u * 16u * 4u,
+        .storage_type = NGF_BUFFER_STORAGE_HOST_WRITEABLE,
+        .buffer_usage = NGF_BUFFER_USAGE_XFER_SRC};
+    ngf_buffer staging = NULL;
+    NT_ASSERT(ngf_create_buffer(&staging_info, &staging) == NGF_ERROR_OK);
+
+    ngf_image_write writes[200];
+    for (uint32_t l = 0u; l < 200u; ++l) {
+      writes[l] = (ngf_image_write){
+          .src_offset = l * 16u * 16u * 4u,
+          .dst        = {.image = img, .mip_level = 0u, .layer = l},
+          .offset     = {0, 0, 0},
+          .extent     = {16u, 16u, 1u},
+          .nlayers    = 1u};
+    }
+
+    ngf_cmd_buffer            cmd_buf      = NULL;
+    const ngf_cmd_buffer_info cmd_buf_info = {0u};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+    ngf_frame_token token;
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+    const ngf_xfer_pass_info xfer_pass_info = {.sync_compute_resources = {0u, NULL}};
+    ngf_xfer_encoder         xfer_enc;
+    NT_ASSERT(ngf_cmd_begin_xfer_pass(cmd_buf, &xfer_pass_info, &xfer_enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_write_images(xfer_enc, staging, writes, 200u) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_write_images(xfer_enc, staging, NULL, 0u) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_generate_mipmaps(xfer_enc, img) == NGF_ERROR_OK);
+
+    // The destination images have to be writeable.
+    writes[199].dst.image = readonly_img;
+    NT_ASSERT(
+        ngf_cmd_write_images(xfer_enc, staging, writes, 200u) == NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(ngf_cmd_end_xfer_pass(xfer_enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_buffer(staging);
+    ngf_destroy_image(readonly_img);
+    ngf_destroy_image(img);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_async_xfer_cmd_buffer) {
+    ngf_context ctx = null_tests_create_context();
+    NT_ASSERT(!ngf_get_device_capabilities()->async_xfer_supported);
+
+    const ngf_buffer_info staging_info = {
+        .size         = 256u,
+        .storage_type = NGF_BUFFER_STORAGE_HOST_WRITEABLE,
+        .buffer_usage = NGF_BUFFER_USAGE_XFER_SRC};
+    const ngf_buffer_info vbuf_info = {
+        .size         = 256u,
+        .storage_type = NGF_BUFFER_STORAGE_PRIVATE,
+        .buffer_usage = NGF_BUFFER_USAGE_XFER_DST | NGF_BUFFER_USAGE_VERTEX_BUFFER};
+    ngf_buffer staging = NULL, vbuf = NULL;
+    NT_ASSERT(ngf_create_buffer(&staging_info, &staging) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_create_buffer(&vbuf_info, &vbuf) == NGF_ERROR_OK);
+
+    ngf_cmd_buffer            cmd_buf      = NULL;
+    const ngf_cmd_buffer_info cmd_buf_info = {.flags = NGF_CMD_BUFFER_ASYNC_XFER};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+    ngf_frame_token token;
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+
+    // Async transfer cmd buffers may only record transfer passes.
+    ngf_render_encoder render_enc;
+    NT_ASSERT(
+        ngf_cmd_begin_render_pass_simple(
+            cmd_buf,
+            ngf_default_render_target(),
+            0.0f,
+            0.0f,
+            0.0f,
+            0.0f,
+            1.0f,
+            0u,
+            &render_enc) == NGF_ERROR_INVALID_OPERATION);
+    const ngf_compute_pass_info compute_pass_info = {
+        .sync_compute_resources = {0u, NULL},
+        .sync_render_resources  = {0u, NULL},
+        .sync_xfer_resources    = {0u, NULL}};
+    ngf_compute_encoder compute_enc;
+    NT_ASSERT(
+        ngf_cmd_begin_compute_pass(cmd_buf, &compute_pass_info, &compute_enc) ==
+        NGF_ERROR_INVALID_OPERATION);
+
+    const ngf_xfer_pass_info xfer_pass_info = {.sync_compute_resources = {0u, NULL}};
+    ngf_xfer_encoder         xfer_enc;
+    NT_ASSERT(ngf_cmd_begin_xfer_pass(cmd_buf, &xfer_pass_info, &xfer_enc) == NGF_ERROR_OK);
+    ngf_cmd_copy_buffer(xfer_enc, staging, vbuf, 256u, 0u, 0u);
+    NT_ASSERT(ngf_cmd_end_xfer_pass(xfer_enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_buffer(vbuf);
+    ngf_destroy_buffer(staging);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_async_compute_cmd_buffer) {
+    ngf_context ctx = null_tests_create_context();
+    NT_ASSERT(!ngf_get_device_capabilities()->async_compute_supported);
+
+    ngf_cmd_buffer            cmd_buf      = NULL;
+    const ngf_cmd_buffer_info invalid_info = {
+        .flags = NGF_CMD_BUFFER_ASYNC_XFER | NGF_CMD_BUFFER_ASYNC_COMPUTE};
+    NT_ASSERT(ngf_create_cmd_buffer(&invalid_info, &cmd_buf) == NGF_ERROR_INVALID_OPERATION);
+    const ngf_cmd_buffer_info cmd_buf_info = {.flags = NGF_CMD_BUFFER_ASYNC_COMPUTE};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+    ngf_frame_token token;
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+
+    // Async compute cmd buffers may only record compute passes.
+    ngf_render_encoder render_enc;
+    NT_ASSERT(
+        ngf_cmd_begin_render_pass_simple(
+            cmd_buf,
+            ngf_default_render_target(),
+            0.0f,
+            0.0f,
+            0.0f,
+            0.0f,
+            1.0f,
+            0u,
+            &render_enc) == NGF_ERROR_INVALID_OPERATION);
+    const ngf_xfer_pass_info xfer_pass_info = {.sync_compute_resources = {0u, NULL}};
+    ngf_xfer_encoder         xfer_enc;
+    NT_ASSERT(
+        ngf_cmd_begin_xfer_pass(cmd_buf, &xfer_pass_info, &xfer_enc) ==
+        NGF_ERROR_INVALID_OPERATION);
+
+    const ngf_compute_pass_info compute_pass_info = {
+        .sync_compute_resources = {0u, NULL},
+        .sync_render_resources  = {0u, NULL},
+        .sync_xfer_resources    = {0u, NULL}};
+    ngf_compute_encoder compute_enc;
+    NT_ASSERT(
+        ngf_cmd_begin_compute_pass(cmd_buf, &compute_pass_info, &compute_enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_end_compute_pass(compute_enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_create_graphics_pipelines) {
+    ngf_context ctx = null_tests_create_context();
+
+    const ngf_shader_stage_info stage_info = {
+        .type             = NGF_STAGE_VERTEX,
+        .content          = "void main() {}",
+        .content_length   = 14u,
+        .debug_name       = NULL,
+        .entry_point_name = "main"};
+    ngf_shader_stage stage = NULL;
+    NT_ASSERT(ngf_create_shader_stage(&stage_info, &stage) == NGF_ERROR_OK);
+
+    ngf_graphics_pipeline_info infos[4];
+    memset(infos, 0, sizeof(infos));
+    for (uint32_t i = 0u; i < 4u; ++i) {
+      infos[i].shader_stages[0] = stage;
+      infos[i].nshader_stages   = 1u;
+    }
+    ngf_graphics_pipeline pipelines[4] = {NULL, NULL, NULL, NULL};
+    NT_ASSERT(ngf_create_graphics_pipelines(infos, 4u, pipelines) == NGF_ERROR_OK);
+    for (uint32_t i = 0u; i < 4u; ++i) {
+      NT_ASSERT(pipelines[i] != NULL);
+      for (uint32_t j = 0u; j < i; ++j) { NT_ASSERT(pipelines[i] != pipelines[j]); }
+    }
+    NT_ASSERT(ngf_create_graphics_pipelines(NULL, 0u, NULL) == NGF_ERROR_OK);
+
+    for (uint32_t i = 0u; i < 4u; ++i) { ngf_destroy_graphics_pipeline(pipelines[i]); }
+    ngf_destroy_shader_stage(stage);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_record_indirect_commands) {
+    ngf_context ctx = null_tests_create_context();
+    NT_ASSERT(ngf_get_device_capabilities()->draw_indirect_count_supported);
+    NT_ASSERT(ngf_get_device_capabilities()->max_draw_indirect_count >= 4u);
+
+    const ngf_buffer_info args_buf_info = {
+        .size         = 4u * sizeof(ngf_draw_indexed_indirect_args),
+        .storage_type = NGF_BUFFER_STORAGE_HOST_WRITEABLE,
+        .buffer_usage = NGF_BUFFER_USAGE_INDIRECT};
+    ngf_buffer args_buf = NULL;
+    NT_ASSERT(ngf_create_buffer(&args_buf_info, &args_buf) == NGF_ERROR_OK);
+    ngf_draw_indexed_indirect_args* args =
+        ngf_buffer_map_range(args_buf, 0u, args_buf_info.size);
+    NT_ASSERT(args != NULL);
+    for (uint32_t i = 0u; i < 4u; ++i) {
+      const ngf_draw_indexed_indirect_args a = {3u, 1u, 3u * i, 0, 0u};
+      args[i]                                   = a;
+    }
+    ngf_buffer_flush_range(args_buf, 0u, args_buf_info.size);
+    ngf_buffer_unmap(args_buf);
+
+    ngf_cmd_buffer            cmd_buf      = NULL;
+    const ngf_cmd_buffer_info cmd_buf_info = {0u};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+    ngf_frame_token token;
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+    ngf_render_encoder enc;
+    NT_ASSERT(
+        ngf_cmd_begin_render_pass_simple(
+            cmd_buf,
+            ngf_default_render_target(),
+            0.0f,
+            0.0f,
+            0.0f,
+            0.0f,
+            1.0f,
+            0u,
+            &enc) == NGF_ERROR_OK);
+    ngf_cmd_draw_indirect(enc, true, args_buf, 0u, 4u, sizeof(ngf_draw_indexed_indirect_args));
+    ngf_cmd_draw_indirect_count(
+        enc,
+        true,
+        args_buf,
+        0u,
+        args_buf,
+        0u,
+        4u,
+        sizeof(ngf_draw_indexed_indirect_args));
+    NT_ASSERT(ngf_cmd_end_render_pass(enc) == NGF_ERROR_OK);
+    const ngf_compute_pass_info compute_pass_info = {.sync_compute_resources = {0u, NULL}};
+    ngf_compute_encoder         compute_enc;
+    NT_ASSERT(
+        ngf_cmd_begin_compute_pass(cmd_buf, &compute_pass_info, &compute_enc) == NGF_ERROR_OK);
+    ngf_cmd_dispatch_indirect(compute_enc, args_buf, 0u);
+    NT_ASSERT(ngf_cmd_end_compute_pass(compute_enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_buffer(args_buf);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_bind_groups) {
+    ngf_context ctx = null_tests_create_context();
+
+    const ngf_shader_stage_info stage_info = {
+        .type             = NGF_STAGE_VERTEX,
+        .content          = "void main() {}",
+        .content_length   = 14u,
+        .debug_name       = NULL,
+        .entry_point_name = "main"};
+    ngf_shader_stage stage = NULL;
+    NT_ASSERT(ngf_create_shader_stage(&stage_info, &stage) == NGF_ERROR_OK);
+    ngf_graphics_pipeline_info pipeline_info;
+    memset(&pipeline_info, 0, sizeof(pipeline_info));
+    pipeline_info.shader_stages[0] = stage;
+    pipeline_info.nshader_stages   = 1u;
+    ngf_graphics_pipeline pipeline = NULL;
+    NT_ASSERT(ngf_create_graphics_pipeline(&pipeline_info, &pipeline) == NGF_ERROR_OK);
+
+    const ngf_buffer_info buf_info = {
+        .size         = 256u,
+        .storage_type = NGF_BUFFER_STORAGE_HOST_WRITEABLE,
+        .buffer_usage = NGF_BUFFER_USAGE_UNIFORM_BUFFER};
+    ngf_buffer ubo = NULL;
+    NT_ASSERT(ngf_create_buffer(&buf_info, &ubo) == NGF_ERROR_OK);
+
+    ngf_resource_bind_op ops[2];
+    for (uint32_t i = 0u; i < 2u; ++i) {
+      ops[i].target_set         = 1u;
+      ops[i].target_binding     = i;
+      ops[i].type               = NGF_DESCRIPTOR_UNIFORM_BUFFER;
+      ops[i].info.buffer.buffer = ubo;
+      ops[i].info.buffer.offset = 128u * i;
+      ops[i].info.buffer.range  = 128u;
+    }
+    ngf_bind_group_info group_info = {
+        .gfx_pipeline     = pipeline,
+        .compute_pipeline = NULL,
+        .set              = 1u,
+        .bind_operations  = ops,
+        .nbind_operations = 2u};
+    ngf_bind_group group = NULL;
+    NT_ASSERT(ngf_create_bind_group(&group_info, &group) == NGF_ERROR_OK);
+    NT_ASSERT(group != NULL);
+
+    // Bind ops have to target the group's set, and exactly one pipeline has to provide the layout.
+    ngf_bind_group bad_group = NULL;
+    group_info.set           = 0u;
+    NT_ASSERT(ngf_create_bind_group(&group_info, &bad_group) == NGF_ERROR_INVALID_OPERATION);
+    group_info.set          = 1u;
+    group_info.gfx_pipeline = NULL;
+    NT_ASSERT(ngf_create_bind_group(&group_info, &bad_group) == NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(bad_group == NULL);
+
+    // The same group is bound across several frames without being rewritten.
+    ngf_cmd_buffer            cmd_buf      = NULL;
+    const ngf_cmd_buffer_info cmd_buf_info = {0u};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+    for (uint32_t f = 0u; f < 4u; ++f) {
+      ngf_frame_token token;
+      NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+      ngf_render_encoder enc;
+      NT_ASSERT(
+          ngf_cmd_begin_render_pass_simple(
+              cmd_buf,
+              ngf_default_render_target(),
+              0.0f,
+              0.0f,
+              0.0f,
+              0.0f,
+              1.0f,
+              0u,
+              &enc) == NGF_ERROR_OK);
+      ngf_cmd_bind_gfx_pipeline(enc, pipeline);
+      ngf_cmd_bind_resources(enc, ops, 1u);
+      ngf_cmd_bind_group(enc, group);
+      ngf_cmd_draw(enc, false, 0u, 3u, 1u);
+      NT_ASSERT(ngf_cmd_end_render_pass(enc) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    }
+
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_bind_group(group);
+    ngf_destroy_buffer(ubo);
+    ngf_destroy_graphics_pipeline(pipeline);
+    ngf_destroy_shader_stage(stage);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_resource_tables) {
+    ngf_context ctx = null_tests_create_context();
+
+    const ngf_device* devices  = NULL;
+    uint32_t          ndevices = 0u;
+    NT_ASSERT(ngf_get_device_list(&devices, &ndevices) == NGF_ERROR_OK);
+    NT_ASSERT(devices[0].capabilities.resource_tables_supported);
+
+    // Only images and storage buffers may be placed into tables.
+    ngf_resource_table_info table_info = {.type = NGF_DESCRIPTOR_UNIFORM_BUFFER, .capacity = 2u};
+    ngf_resource_table      table      = NULL;
+    NT_ASSERT(ngf_create_resource_table(&table_info, &table) == NGF_ERROR_INVALID_OPERATION);
+    table_info.type = NGF_DESCRIPTOR_STORAGE_BUFFER;
+    NT_ASSERT(ngf_create_resource_table(&table_info, &table) == NGF_ERROR_OK);
+
+    const ngf_buffer_info buf_info = {
+        .size         = 256u,
+        .storage_type = NGF_BUFFER_STORAGE_PRIVATE,
+        .buffer_usage = NGF_BUFFER_USAGE_STORAGE_BUFFER};
+    ngf_buffer ssbo = NULL;
+    NT_ASSERT(ngf_create_buffer(&buf_info, &ssbo) == NGF_ERROR_OK);
+    ngf_resource_bind_op write_op;
+    memset(&write_op, 0, sizeof(write_op));
+    write_op.type               = NGF_DESCRIPTOR_STORAGE_BUFFER;
+    write_op.info.buffer.buffer = ssbo;
+    write_op.info.buffer.range  = 256u;
+
+    ngf_frame_token token;
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+    uint32_t slots[2];
+    NT_ASSERT(ngf_alloc_resource_table_slot(table, &slots[0]) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_alloc_resource_table_slot(table, &slots[1]) == NGF_ERROR_OK);
+    NT_ASSERT(slots[0] != slots[1]);
+    NT_ASSERT(ngf_write_resource_table(table, slots[0], &write_op) == NGF_ERROR_OK);
+    write_op.type = NGF_DESCRIPTOR_IMAGE;
+    NT_ASSERT(ngf_write_resource_table(table, slots[1], &write_op) == NGF_ERROR_INVALID_OPERATION);
+
+    // Once the table is full, a freed slot only comes back after its frame has been retired.
+    uint32_t extra_slot = ~0u;
+    NT_ASSERT(ngf_alloc_resource_table_slot(table, &extra_slot) == NGF_ERROR_OUT_OF_MEM);
+    ngf_free_resource_table_slot(table, slots[1]);
+    NT_ASSERT(ngf_alloc_resource_table_slot(table, &extra_slot) == NGF_ERROR_OUT_OF_MEM);
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    uint32_t nframes_until_reuse = 0u;
+    while (ngf_alloc_resource_table_slot(table, &extra_slot) != NGF_ERROR_OK) {
+      NT_ASSERT(++nframes_until_reuse <= 3u);
+      NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    }
+    NT_ASSERT(nframes_until_reuse > 0u);
+    NT_ASSERT(extra_slot == slots[1]);
+
+    // Freed slots that are still waiting to be retired don't outlive their table.
+    ngf_free_resource_table_slot(table, slots[0]);
+    ngf_destroy_resource_table(table);
+    for (uint32_t f = 0u; f < 3u; ++f) {
+      NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    }
+
+    ngf_destroy_buffer(ssbo);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_upload_alloc) {
+    ngf_context     ctx = null_tests_create_context();
+    ngf_frame_token token;
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+
+    ngf_upload_allocation allocs[3];
+    NT_ASSERT(ngf_upload_alloc(16u, 3u, &allocs[0]) == NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(ngf_upload_alloc(0u, 4u, &allocs[0]) == NGF_ERROR_INVALID_OPERATION);
+
+    // Small allocations are carved out of the same buffer at properly aligned offsets.
+    NT_ASSERT(ngf_upload_alloc(100u, 4u, &allocs[0]) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_upload_alloc(64u, 256u, &allocs[1]) == NGF_ERROR_OK);
+    NT_ASSERT(allocs[0].buffer == allocs[1].buffer);
+    NT_ASSERT(allocs[1].offset == 256u);
+    NT_ASSERT((uint8_t*)allocs[1].data == (uint8_t*)allocs[0].data + 256u);
+    memset(allocs[1].data, 0xab, 64u);
+
+    // Requests that don't fit into the existing memory get a buffer of their own.
+    NT_ASSERT(ngf_upload_alloc(1024u * 1024u, 16u, &allocs[2]) == NGF_ERROR_OK);
+    NT_ASSERT(allocs[2].buffer != allocs[0].buffer);
+    NT_ASSERT(allocs[2].offset == 0u);
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+
+    // Once the frame that made the allocations is retired, its memory is handed out again.
+    bool reused = false;
+    for (uint32_t f = 0u; f < 3u && !reused; ++f) {
+      NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+      ngf_upload_allocation alloc;
+      NT_ASSERT(ngf_upload_alloc(32u, 4u, &alloc) == NGF_ERROR_OK);
+      reused = alloc.buffer == allocs[0].buffer && alloc.offset == 0u;
+      NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    }
+    NT_ASSERT(reused);
+
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_timestamp_queries) {
+    ngf_context ctx = null_tests_create_context();
+    NT_ASSERT(ngf_get_device_capabilities()->timestamp_queries_supported);
+
+    ngf_query_pool            pool         = NULL;
+    const ngf_query_pool_info invalid_info = {.type = NGF_QUERY_TYPE_TIMESTAMP, .nqueries = 0u};
+    NT_ASSERT(ngf_create_query_pool(&invalid_info, &pool) == NGF_ERROR_INVALID_SIZE);
+    const ngf_query_pool_info pool_info = {.type = NGF_QUERY_TYPE_TIMESTAMP, .nqueries = 8u};
+    NT_ASSERT(ngf_create_query_pool(&pool_info, &pool) == NGF_ERROR_OK);
+
+    ngf_cmd_buffer            xfer_cmd_buf      = NULL;
+    const ngf_cmd_buffer_info xfer_cmd_buf_info = {.flags = NGF_CMD_BUFFER_ASYNC_XFER};
+    NT_ASSERT(ngf_create_cmd_buffer(&xfer_cmd_buf_info, &xfer_cmd_buf) == NGF_ERROR_OK);
+    ngf_cmd_buffer            cmd_buf      = NULL;
+    const ngf_cmd_buffer_info cmd_buf_info = {0u};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+
+    ngf_frame_token token;
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_start_cmd_buffer(xfer_cmd_buf, token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_write_timestamp(xfer_cmd_buf, pool, 0u) == NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_write_timestamp(cmd_buf, pool, 8u) == NGF_ERROR_OUT_OF_BOUNDS);
+    NT_ASSERT(ngf_cmd_enable_pass_timestamps(cmd_buf, pool, 4u, 5u) == NGF_ERROR_OUT_OF_BOUNDS);
+
+    // Two passes write their timestamps into queries 0-3, the third one doesn't fit in the range.
+    NT_ASSERT(ngf_cmd_write_timestamp(cmd_buf, pool, 6u) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_enable_pass_timestamps(cmd_buf, pool, 0u, 5u) == NGF_ERROR_OK);
+    for (uint32_t p = 0u; p < 3u; ++p) {
+      const ngf_compute_pass_info compute_pass_info = {
+          .sync_compute_resources = {0u, NULL},
+          .sync_render_resources  = {0u, NULL},
+          .sync_xfer_resources    = {0u, NULL}};
+      ngf_compute_encoder enc;
+      NT_ASSERT(ngf_cmd_begin_compute_pass(cmd_buf, &compute_pass_info, &enc) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_cmd_write_timestamp(cmd_buf, pool, 7u) == NGF_ERROR_INVALID_OPERATION);
+      NT_ASSERT(ngf_cmd_end_compute_pass(enc) == NGF_ERROR_OK);
+    }
+    NT_ASSERT(ngf_cmd_write_timestamp(cmd_buf, pool, 7u) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+
+    // Results only become available once the frame that wrote them is retired.
+    uint64_t results[8];
+    NT_ASSERT(ngf_get_query_results(pool, 0u, 4u, results) == NGF_ERROR_NOT_READY);
+    NT_ASSERT(ngf_get_query_results(pool, 4u, 5u, results) == NGF_ERROR_OUT_OF_BOUNDS);
+    uint32_t nframes = 0u;
+    while (ngf_get_query_results(pool, 0u, 4u, results) == NGF_ERROR_NOT_READY) {
+      NT_ASSERT(++nframes <= 3u);
+      NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    }
+    NT_ASSERT(ngf_get_query_results(pool, 4u, 1u, results) == NGF_ERROR_NOT_READY);
+    NT_ASSERT(ngf_get_query_results(pool, 6u, 2u, &results[6]) == NGF_ERROR_OK);
+    NT_ASSERT(results[6] < results[0]);
+    NT_ASSERT(results[0] < results[1] && results[1] < results[2] && results[2] < results[3]);
+    NT_ASSERT(results[3] < results[7]);
+
+    ngf_destroy_cmd_buffer(xfer_cmd_buf);
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_query_pool(pool);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_occlusion_and_statistics_queries) {
+    ngf_context ctx = null_tests_create_context();
+    NT_ASSERT(ngf_get_device_capabilities()->occlusion_queries_supported);
+    NT_ASSERT(ngf_get_device_capabilities()->pipeline_statistics_queries_supported);
+
+    ngf_query_pool            occlusion_pool = NULL;
+    const ngf_query_pool_info occlusion_info = {.type = NGF_QUERY_TYPE_OCCLUSION, .nqueries = 2u};
+    NT_ASSERT(ngf_create_query_pool(&occlusion_info, &occlusion_pool) == NGF_ERROR_OK);
+    ngf_query_pool            stats_pool = NULL;
+    const ngf_query_pool_info stats_info = {
+        .type     = NGF_QUERY_TYPE_PIPELINE_STATISTICS,
+        .nqueries = 1u};
+    NT_ASSERT(ngf_create_query_pool(&stats_info, &stats_pool) == NGF_ERROR_OK);
+    ngf_query_pool            timestamp_pool = NULL;
+    const ngf_query_pool_info timestamp_info = {.type = NGF_QUERY_TYPE_TIMESTAMP, .nqueries = 1u};
+    NT_ASSERT(ngf_create_query_pool(&timestamp_info, &timestamp_pool) == NGF_ERROR_OK);
+
+    ngf_cmd_buffer            cmd_buf      = NULL;
+    const ngf_cmd_buffer_info cmd_buf_info = {0u};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+
+    ngf_frame_token token;
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+    ngf_render_encoder enc;
+    NT_ASSERT(
+        ngf_cmd_begin_render_pass_simple(
+            cmd_buf,
+            ngf_default_render_target(),
+            0.0f,
+            0.0f,
+            0.0f,
+            0.0f,
+            1.0f,
+            0u,
+            &enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_end_query(enc) == NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(ngf_cmd_begin_query(enc, timestamp_pool, 0u) == NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(ngf_cmd_begin_query(enc, occlusion_pool, 2u) == NGF_ERROR_OUT_OF_BOUNDS);
+
+    NT_ASSERT(ngf_cmd_begin_query(enc, occlusion_pool, 0u) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_begin_query(enc, stats_pool, 0u) == NGF_ERROR_INVALID_OPERATION);
+    ngf_cmd_draw(enc, false, 0u, 3u, 2u);
+    NT_ASSERT(ngf_cmd_end_query(enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_begin_query(enc, stats_pool, 0u) == NGF_ERROR_OK);
+    ngf_cmd_draw(enc, true, 0u, 4u, 1u);
+    NT_ASSERT(ngf_cmd_end_query(enc) == NGF_ERROR_OK);
+
+    // A query left active is ended along with the render pass.
+    NT_ASSERT(ngf_cmd_begin_query(enc, occlusion_pool, 1u) == NGF_ERROR_OK);
+    ngf_cmd_draw(enc, false, 0u, 3u, 1u);
+    NT_ASSERT(ngf_cmd_end_render_pass(enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+
+    uint64_t occlusion_results[2];
+    NT_ASSERT(
+        ngf_get_query_results(occlusion_pool, 0u, 2u, occlusion_results) == NGF_ERROR_NOT_READY);
+    uint32_t nframes = 0u;
+    while (ngf_get_query_results(occlusion_pool, 0u, 2u, occlusion_results) ==
+           NGF_ERROR_NOT_READY) {
+      NT_ASSERT(++nframes <= 3u);
+      NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    }
+    NT_ASSERT(occlusion_results[0] == 6u);
+    NT_ASSERT(occlusion_results[1] == 3u);
+    uint64_t stats_results[NGF_PIPELINE_STATISTIC_COUNT];
+    NT_ASSERT(ngf_get_query_results(stats_pool, 0u, 1u, stats_results) == NGF_ERROR_OK);
+    NT_ASSERT(stats_results[NGF_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS] == 4u);
+    NT_ASSERT(stats_results[NGF_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS] == 0u);
+
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_query_pool(timestamp_pool);
+    ngf_destroy_query_pool(stats_pool);
+    ngf_destroy_query_pool(occlusion_pool);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_parallel_render_pass) {
+    ngf_context ctx = null_tests_create_context();
+    NT_ASSERT(ngf_get_device_capabilities()->secondary_cmd_buffers_supported);
+
+    ngf_cmd_buffer            invalid_buf       = NULL;
+    const ngf_cmd_buffer_info invalid_buf_info = {
+        .flags = NGF_CMD_BUFFER_SECONDARY | NGF_CMD_BUFFER_ASYNC_XFER};
+    NT_ASSERT(
+        ngf_create_cmd_buffer(&invalid_buf_info, &invalid_buf) == NGF_ERROR_INVALID_OPERATION);
+
+    ngf_cmd_buffer            cmd_buf      = NULL;
+    const ngf_cmd_buffer_info cmd_buf_info = {0u};
+    NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_buf) == NGF_ERROR_OK);
+    ngf_cmd_buffer            secondaries[parallel_pass_nthreads];
+    const ngf_cmd_buffer_info secondary_info = {.flags = NGF_CMD_BUFFER_SECONDARY};
+    for (uint32_t t = 0u; t < parallel_pass_nthreads; ++t) {
+      NT_ASSERT(ngf_create_cmd_buffer(&secondary_info, &secondaries[t]) == NGF_ERROR_OK);
+    }
+    ngf_query_pool            occlusion_pool = NULL;
+    const ngf_query_pool_info occlusion_info = {.type = NGF_QUERY_TYPE_OCCLUSION, .nqueries = 1u};
+    NT_ASSERT(ngf_create_query_pool(&occlusion_info, &occlusion_pool) == NGF_ERROR_OK);
+
+    const ngf_attachment_load_op  load_ops[2]  = {NGF_LOAD_OP_CLEAR, NGF_LOAD_OP_CLEAR};
+    const ngf_attachment_store_op store_ops[2] = {NGF_STORE_OP_STORE, NGF_STORE_OP_DONTCARE};
+    ngf_clear                     clears[2];
+    memset(clears, 0, sizeof(clears));
+    const ngf_render_pass_info pass_info = {
+        .render_target = ngf_default_render_target(),
+        .load_ops      = load_ops,
+        .store_ops     = store_ops,
+        .clears        = clears};
+
+    // The secondary cmd buffers are reused across frames.
+    for (uint32_t frame = 0u; frame < 4u; ++frame) {
+      ngf_frame_token token;
+      NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_start_cmd_buffer(secondaries[0], token) == NGF_ERROR_INVALID_OPERATION);
+      NT_ASSERT(ngf_start_cmd_buffer(cmd_buf, token) == NGF_ERROR_OK);
+
+      // Secondary cmd buffers can't be part of a regular render pass.
+      ngf_render_encoder enc;
+      ngf_render_encoder secondary_enc;
+      NT_ASSERT(ngf_cmd_begin_render_pass(cmd_buf, &pass_info, &enc) == NGF_ERROR_OK);
+      NT_ASSERT(
+          ngf_cmd_begin_secondary_render_pass(enc, secondaries[0], &secondary_enc) ==
+          NGF_ERROR_INVALID_OPERATION);
+      NT_ASSERT(
+          ngf_cmd_execute_secondary_cmd_buffers(enc, 1u, secondaries) ==
+          NGF_ERROR_INVALID_OPERATION);
+      NT_ASSERT(ngf_cmd_end_render_pass(enc) == NGF_ERROR_OK);
+
+      NT_ASSERT(ngf_cmd_begin_parallel_render_pass(cmd_buf, &pass_info, &enc) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_cmd_begin_query(enc, occlusion_pool, 0u) == NGF_ERROR_INVALID_OPERATION);
+      NT_ASSERT(
+          ngf_cmd_begin_render_pass(secondaries[0], &pass_info, &secondary_enc) ==
+          NGF_ERROR_INVALID_OPERATION);
+      parallel_pass_worker workers[parallel_pass_nthreads];
+      pthread_t            threads[parallel_pass_nthreads];
+      for (uint32_t t = 0u; t < parallel_pass_nthreads; ++t) {
+        workers[t].parent_enc = enc;
+        workers[t].cmd_buf    = secondaries[t];
+        workers[t].ndraws     = 100u * (t + 1u);
+        workers[t].err        = NGF_ERROR_OUT_OF_MEM;
+        NT_ASSERT(pthread_create(&threads[t], NULL, parallel_pass_record, &workers[t]) == 0);
+      }
+      for (uint32_t t = 0u; t < parallel_pass_nthreads; ++t) {
+        pthread_join(threads[t], NULL);
+        NT_ASSERT(workers[t].err == NGF_ERROR_OK);
+      }
+      NT_ASSERT(ngf_submit_cmd_buffers(1u, &secondaries[0]) == NGF_ERROR_INVALID_OPERATION);
+      NT_ASSERT(
+          ngf_cmd_execute_secondary_cmd_buffers(enc, parallel_pass_nthreads, secondaries) ==
+          NGF_ERROR_OK);
+      // Secondary cmd buffers may be executed only once per recording.
+      NT_ASSERT(
+          ngf_cmd_execute_secondary_cmd_buffers(enc, 1u, secondaries) ==
+          NGF_ERROR_INVALID_OPERATION);
+      NT_ASSERT(ngf_cmd_end_render_pass(enc) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_buf) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    }
+
+    ngf_destroy_query_pool(occlusion_pool);
+    for (uint32_t t = 0u; t < parallel_pass_nthreads; ++t) {
+      ngf_destroy_cmd_buffer(secondaries[t]);
+    }
+    ngf_destroy_cmd_buffer(cmd_buf);
+    ngf_destroy_context(ctx);
+  }
+
+  NT_TESTCASE(null_multithreaded_recording) {
+    ngf_context ctx = null_tests_create_context();
+
+    // Cmd buffers are created on the context's thread, and recorded and submitted on others.
+    ngf_cmd_buffer            cmd_bufs[mt_record_nthreads];
+    const ngf_cmd_buffer_info cmd_buf_info = {0u};
+    for (uint32_t t = 0u; t < mt_record_nthreads; ++t) {
+      NT_ASSERT(ngf_create_cmd_buffer(&cmd_buf_info, &cmd_bufs[t]) == NGF_ERROR_OK);
+    }
+    ngf_query_pool            pool      = NULL;
+    const ngf_query_pool_info pool_info = {
+        .type     = NGF_QUERY_TYPE_OCCLUSION,
+        .nqueries = mt_record_nthreads * mt_record_nsubmits};
+    NT_ASSERT(ngf_create_query_pool(&pool_info, &pool) == NGF_ERROR_OK);
+
+    const ngf_attachment_load_op  load_ops[2]  = {NGF_LOAD_OP_CLEAR, NGF_LOAD_OP_CLEAR};
+    const ngf_attachment_store_op store_ops[2] = {NGF_STORE_OP_STORE, NGF_STORE_OP_DONTCARE};
+    ngf_clear                     clears[2];
+    memset(clears, 0, sizeof(clears));
+    const ngf_render_pass_info pass_info = {
+        .render_target = ngf_default_render_target(),
+        .load_ops      = load_ops,
+        .store_ops     = store_ops,
+        .clears        = clears};
+
+    ngf_frame_token stale_token = ~0u;
+    for (uint32_t frame = 0u; frame < 8u; ++frame) {
+      ngf_frame_token token;
+      NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+      // Cmd buffers may only be started for the frame that is currently being recorded.
+      if (frame > 0u) {
+        NT_ASSERT(ngf_start_cmd_buffer(cmd_bufs[0], stale_token) == NGF_ERROR_INVALID_OPERATION);
+      }
+      stale_token = token;
+
+      mt_record_worker workers[mt_record_nthreads];
+      pthread_t        threads[mt_record_nthreads];
+      for (uint32_t t = 0u; t < mt_record_nthreads; ++t) {
+        workers[t].token       = token;
+        workers[t].cmd_buf     = cmd_bufs[t];
+        workers[t].pass_info   = &pass_info;
+        workers[t].query_pool  = pool;
+        workers[t].first_query = t * mt_record_nsubmits;
+        workers[t].ndraws      = 10u * (t + 1u);
+        workers[t].err         = NGF_ERROR_OUT_OF_MEM;
+        NT_ASSERT(pthread_create(&threads[t], NULL, mt_record, &workers[t]) == 0);
+      }
+      for (uint32_t t = 0u; t < mt_record_nthreads; ++t) {
+        pthread_join(threads[t], NULL);
+        NT_ASSERT(workers[t].err == NGF_ERROR_OK);
+      }
+      NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    }
+
+    // Once the frames are retired, every submitted recording has been executed.
+    for (uint32_t frame = 0u; frame < 3u; ++frame) {
+      ngf_frame_token token;
+      NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+      NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+    }
+    uint64_t results[mt_record_nthreads * mt_record_nsubmits];
+    NT_ASSERT(
+        ngf_get_query_results(pool, 0u, mt_record_nthreads * mt_record_nsubmits, results) ==
+        NGF_ERROR_OK);
+    for (uint32_t q = 0u; q < mt_record_nthreads * mt_record_nsubmits; ++q) {
+      NT_ASSERT(results[q] == 30u * (q / mt_record_nsubmits + 1u));
+    }
+
+    // Cmd buffers may be destroyed while their submissions are still in flight.
+    ngf_frame_token token;
+    NT_ASSERT(ngf_begin_frame(&token) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_start_cmd_buffer(cmd_bufs[0], token) == NGF_ERROR_OK);
+    ngf_render_encoder enc;
+    NT_ASSERT(ngf_cmd_begin_render_pass(cmd_bufs[0], &pass_info, &enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_end_render_pass(enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_submit_cmd_buffers(1u, &cmd_bufs[0]) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_start_cmd_buffer(cmd_bufs[1], token) == NGF_ERROR_OK);
+    for (uint32_t t = 0u; t < mt_record_nthreads; ++t) { ngf_destroy_cmd_buffer(cmd_bufs[t]); }
+    NT_ASSERT(ngf_end_frame(token) == NGF_ERROR_OK);
+
+    ngf_destroy_query_pool(pool);
+    ngf_destroy_context(ctx);
+  }
+
+  ngf_shutdown();
+}
@@ -96,7 +96,7 @@ void VKAPI_CALL fake_wait_events(
   }
 
   NT_ASSERT(imageMemoryBarrierCount == expectedParams->expectedImageMemoryBarrierCount);
-  for (uint32_t b = 0u; b < bufferMemoryBarrierCount; ++b) {
+  for (uint32_t b = 0u; b < imageMemoryBarrierCount; ++b) {
     const VkImageMemoryBarrier* b0= &pImageMemoryBarriers[b];
     const VkImageMemoryBarrier* b1 = &expectedParams->expectedImageMemoryBarriers[b];
     NT_ASSERT(b0->sType == b1->sType);
@@ -114,6 +114,191 @@ void VKAPI_CALL fake_wait_events(
   }
 }
 
+/* Records the barriers and copies issued by transfer commands. */
+
+uint32_t fakePipelineBarrierCalls   = 0u;
+uint32_t fakeLastBufBarrierCount    = 0u;
+uint32_t fakeLastImgBarrierCount    = 0u;
+uint32_t fakeCopyBufferToImageCalls = 0u;
+uint32_t fakeCopyRegionCount        = 0u;
+
+void VKAPI_CALL fake_pipeline_barrier(
+    VkCommandBuffer              commandBuffer,
+    VkPipelineStageFlags         srcStageMask,
+    VkPipelineStageFlags         dstStageMask,
+    VkDependencyFlags            dependencyFlags,
+    uint32_t                     memoryBarrierCount,
+    const VkMemoryBarrier*       pMemoryBarriers,
+    uint32_t                     bufferMemoryBarrierCount,
+    const VkBufferMemoryBarrier* pBufferMemoryBarriers,
+    uint32_t                     imageMemoryBarrierCount,
+    const VkImageMemoryBarrier*  pImageMemoryBarriers) {
+  (void)commandBuffer;
+  (void)srcStageMask;
+  (void)dstStageMask;
+  (void)dependencyFlags;
+  (void)memoryBarrierCount;
+  (void)pMemoryBarriers;
+  (void)pBufferMemoryBarriers;
+  (void)pImageMemoryBarriers;
+  ++fakePipelineBarrierCalls;
+  fakeLastBufBarrierCount = bufferMemoryBarrierCount;
+  fakeLastImgBarrierCount = imageMemoryBarrierCount;
+}
+
+void VKAPI_CALL fake_copy_buffer_to_image(
+    VkCommandBuffer          commandBuffer,
+    VkBuffer                 srcBuffer,
+    VkImage                  dstImage,
+    VkImageLayout            dstImageLayout,
+    uint32_t                 regionCount,
+    const VkBufferImageCopy* pRegions) {
+  (void)commandBuffer;
+  (void)srcBuffer;
+  (void)dstImage;
+  (void)dstImageLayout;
+  (void)pRegions;
+  ++fakeCopyBufferToImageCalls;
+  fakeCopyRegionCount += regionCount;
+}
+
+uint32_t fakeCopyBufferCalls = 0u;
+
+void VKAPI_CALL fake_copy_buffer(
+    VkCommandBuffer     commandBuffer,
+    VkBuffer            srcBuffer,
+    VkBuffer            dstBuffer,
+    uint32_t            regionCount,
+    const VkBufferCopy* pRegions) {
+  (void)commandBuffer;
+  (void)srcBuffer;
+  (void)dstBuffer;
+  (void)regionCount;
+  (void)pRegions;
+  ++fakeCopyBufferCalls;
+}
+
+uint32_t fakeExecuteCommandsCalls = 0u;
+uint32_t fakeBindPipelineCalls    = 0u;
+
+void VKAPI_CALL fake_execute_commands(
+    VkCommandBuffer        commandBuffer,
+    uint32_t               commandBufferCount,
+    const VkCommandBuffer* pCommandBuffers) {
+  (void)commandBuffer;
+  (void)commandBufferCount;
+  (void)pCommandBuffers;
+  ++fakeExecuteCommandsCalls;
+}
+
+void VKAPI_CALL fake_bind_pipeline(
+    VkCommandBuffer     commandBuffer,
+    VkPipelineBindPoint pipelineBindPoint,
+    VkPipeline          pipeline) {
+  (void)commandBuffer;
+  (void)pipelineBindPoint;
+  (void)pipeline;
+  ++fakeBindPipelineCalls;
+}
+
+uint32_t fakeBeginQueryCalls = 0u;
+
+void VKAPI_CALL fake_begin_query(
+    VkCommandBuffer     commandBuffer,
+    VkQueryPool         queryPool,
+    uint32_t            query,
+    VkQueryControlFlags flags) {
+  (void)commandBuffer;
+  (void)queryPool;
+  (void)query;
+  (void)flags;
+  ++fakeBeginQueryCalls;
+}
+
+// Reports every query as available, with all bits of its values set.
+VkResult VKAPI_CALL fake_get_query_pool_results(
+    VkDevice           device,
+    VkQueryPool        queryPool,
+    uint32_t           firstQuery,
+    uint32_t           queryCount,
+    size_t             dataSize,
+    void*              pData,
+    VkDeviceSize       stride,
+    VkQueryResultFlags flags) {
+  (void)device;
+  (void)queryPool;
+  (void)firstQuery;
+  (void)dataSize;
+  (void)flags;
+  for (uint32_t q = 0u; q < queryCount; ++q) {
+    uint64_t* values = (uint64_t*)((uint8_t*)pData + q * stride);
+    values[0]        = ~0ull;
+    values[1]        = 1u;
+  }
+  return VK_SUCCESS;
+}
+
+/* Records the batches passed to vkQueueSubmit. */
+
+#define FAKE_QUEUE_SUBMIT_MAX_CALLS   (4u)
+#define FAKE_QUEUE_SUBMIT_MAX_BATCHES (4u)
+#define FAKE_QUEUE_SUBMIT_MAX_WAITS   (8u)
+
+typedef struct fake_submitted_batch {
+  uint32_t    ncmd_bufs;
+  uint32_t    nwaits;
+  VkSemaphore waits[FAKE_QUEUE_SUBMIT_MAX_WAITS];
+  uint32_t    nsignals;
+  VkSemaphore signal;
+} fake_submitted_batch;
+
+typedef struct fake_queue_submit_call {
+  uint32_t             nbatches;
+  fake_submitted_batch batches[FAKE_QUEUE_SUBMIT_MAX_BATCHES];
+} fake_queue_submit_call;
+
+uint32_t               fakeQueueSubmitCalls = 0u;
+fake_queue_submit_call fakeQueueSubmits[FAKE_QUEUE_SUBMIT_MAX_CALLS];
+
+VkResult VKAPI_CALL fake_queue_submit(
+    VkQueue             queue,
+    uint32_t            submitCount,
+    const VkSubmitInfo* pSubmits,
+    VkFence             fence) {
+  (void)queue;
+  (void)fence;
+  NT_ASSERT(fakeQueueSubmitCalls < FAKE_QUEUE_SUBMIT_MAX_CALLS);
+  NT_ASSERT(submitCount <= FAKE_QUEUE_SUBMIT_MAX_BATCHES);
+  fake_queue_submit_call* call = &fakeQueueSubmits[fakeQueueSubmitCalls++];
+  call->nbatches               = submitCount;
+  for (uint32_t s = 0u; s < submitCount; ++s) {
+    fake_submitted_batch* batch = &call->batches[s];
+    NT_ASSERT(pSubmits[s].waitSemaphoreCount <= FAKE_QUEUE_SUBMIT_MAX_WAITS);
+    batch->ncmd_bufs = pSubmits[s].commandBufferCount;
+    batch->nwaits    = pSubmits[s].waitSemaphoreCount;
+    for (uint32_t w = 0u; w < batch->nwaits; ++w) {
+      batch->waits[w] = pSubmits[s].pWaitSemaphores[w];
+    }
+    batch->nsignals = pSubmits[s].signalSemaphoreCount;
+    batch->signal   = batch->nsignals > 0u ? pSubmits[s].pSignalSemaphores[0] : VK_NULL_HANDLE;
+  }
+  return VK_SUCCESS;
+}
+
+static bool fake_batch_waits_on(const fake_submitted_batch* batch, VkSemaphore semaphore) {
+  for (uint32_t w = 0u; w < batch->nwaits; ++w) {
+    if (batch->waits[w] == semaphore) { return true; }
+  }
+  return false;
+}
+
+void VKAPI_CALL
+fake_end_query(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t query) {
+  (void)commandBuffer;
+  (void)queryPool;
+  (void)query;
+}
+
 NT_TESTSUITE {
   vkCmdWaitEvents = fake_wait_events;
 
@@ -548,4 +733,1082 @@ NT_TESTSUITE {
     NT_ASSERT(err == NGF_ERROR_OK);
     NT_ASSERT(vkCmdWaitEventsExpectedNumberOfCalls == 0u);
   }
-}
\ No newline at end of file
+
+  NT_TESTCASE(descSetCacheLookupAndInsert) {
+    ngfvk_desc_set_cache cache;
+    memset(&cache, 0, sizeof(cache));
+    ngf_buffer_t fake_buffers[2];
+    memset(fake_buffers, 0, sizeof(fake_buffers));
+    fake_buffers[0].alloc.obj_handle = 0xb0;
+    fake_buffers[1].alloc.obj_handle = 0xb1;
+    const VkDescriptorSetLayout fake_layouts[2] = {
+        (VkDescriptorSetLayout)0x10,
+        (VkDescriptorSetLayout)0x20};
+    const ngf_resource_bind_op ops[2] = {
+        {.target_set     = 0u,
+         .target_binding = 0u,
+         .type           = NGF_DESCRIPTOR_UNIFORM_BUFFER,
+         .info.buffer    = {.buffer = &fake_buffers[0], .offset = 0u, .range = 64u}},
+        {.target_set     = 0u,
+         .target_binding = 1u,
+         .type           = NGF_DESCRIPTOR_UNIFORM_BUFFER,
+         .info.buffer    = {.buffer = &fake_buffers[1], .offset = 128u, .range = 64u}}};
+    ngfvk_desc_cache_key_entry key[2];
+    ngfvk_desc_cache_key_entry_for_op(&ops[0], &key[0]);
+    ngfvk_desc_cache_key_entry_for_op(&ops[1], &key[1]);
+
+    const uint64_t hash = ngfvk_desc_set_cache_hash(fake_layouts[0], key, 2u);
+    NT_ASSERT(ngfvk_desc_set_cache_lookup(&cache, hash, fake_layouts[0], key, 2u) == VK_NULL_HANDLE);
+    ngfvk_desc_set_cache_insert(&cache, hash, fake_layouts[0], key, 2u, (VkDescriptorSet)0x5e7);
+    NT_ASSERT(
+        ngfvk_desc_set_cache_lookup(&cache, hash, fake_layouts[0], key, 2u) ==
+        (VkDescriptorSet)0x5e7);
+
+    /* same ops, different layout. */
+    const uint64_t other_layout_hash = ngfvk_desc_set_cache_hash(fake_layouts[1], key, 2u);
+    NT_ASSERT(
+        ngfvk_desc_set_cache_lookup(&cache, other_layout_hash, fake_layouts[1], key, 2u) ==
+        VK_NULL_HANDLE);
+
+    /* same layout, different offset. */
+    ngf_resource_bind_op       other_op = ops[1];
+    ngfvk_desc_cache_key_entry other_key[2];
+    other_op.info.buffer.offset = 256u;
+    other_key[0]                = key[0];
+    ngfvk_desc_cache_key_entry_for_op(&other_op, &other_key[1]);
+    const uint64_t other_key_hash = ngfvk_desc_set_cache_hash(fake_layouts[0], other_key, 2u);
+    NT_ASSERT(
+        ngfvk_desc_set_cache_lookup(&cache, other_key_hash, fake_layouts[0], other_key, 2u) ==
+        VK_NULL_HANDLE);
+
+    ngfvk_desc_set_cache_clear(&cache);
+    NT_ASSERT(ngfvk_desc_set_cache_lookup(&cache, hash, fake_layouts[0], key, 2u) == VK_NULL_HANDLE);
+    ngfvk_desc_set_cache_destroy(&cache);
+  }
+
+  NT_TESTCASE(descSetCacheGrow) {
+    ngfvk_desc_set_cache cache;
+    memset(&cache, 0, sizeof(cache));
+    const VkDescriptorSetLayout fake_layout = (VkDescriptorSetLayout)0x10;
+    const uint32_t              nentries    = 4u * NGFVK_DESC_SET_CACHE_INITIAL_CAPACITY;
+    ngf_buffer_t                fake_buffer;
+    memset(&fake_buffer, 0, sizeof(fake_buffer));
+    fake_buffer.alloc.obj_handle = 0xb0;
+    for (uint32_t i = 0u; i < nentries; ++i) {
+      const ngf_resource_bind_op op = {
+          .target_set     = 0u,
+          .target_binding = 0u,
+          .type           = NGF_DESCRIPTOR_UNIFORM_BUFFER,
+          .info.buffer    = {.buffer = &fake_buffer, .offset = 256u * i, .range = 256u}};
+      ngfvk_desc_cache_key_entry key;
+      ngfvk_desc_cache_key_entry_for_op(&op, &key);
+      const uint64_t hash = ngfvk_desc_set_cache_hash(fake_layout, &key, 1u);
+      ngfvk_desc_set_cache_insert(
+          &cache,
+          hash,
+          fake_layout,
+          &key,
+          1u,
+          (VkDescriptorSet)(uintptr_t)(i + 1u));
+    }
+    NT_ASSERT(cache.nentries == nentries);
+    NT_ASSERT(2u * cache.nentries <= cache.capacity);
+    for (uint32_t i = 0u; i < nentries; ++i) {
+      const ngf_resource_bind_op op = {
+          .target_set     = 0u,
+          .target_binding = 0u,
+          .type           = NGF_DESCRIPTOR_UNIFORM_BUFFER,
+          .info.buffer    = {.buffer = &fake_buffer, .offset = 256u * i, .range = 256u}};
+      ngfvk_desc_cache_key_entry key;
+      ngfvk_desc_cache_key_entry_for_op(&op, &key);
+      const uint64_t hash = ngfvk_desc_set_cache_hash(fake_layout, &key, 1u);
+      NT_ASSERT(
+          ngfvk_desc_set_cache_lookup(&cache, hash, fake_layout, &key, 1u) ==
+          (VkDescriptorSet)(uintptr_t)(i + 1u));
+    }
+    ngfvk_desc_set_cache_destroy(&cache);
+  }
+
+  NT_TESTCASE(descPoolCapacityFixed) {
+    const ngf_descriptor_pool_info info = {
+        .initial_sets                 = 8u,
+        .initial_descriptors_per_type = 32u,
+        .adaptive                     = false};
+    ngfvk_desc_pools_list pools;
+    memset(&pools, 0, sizeof(pools));
+    ngfvk_init_desc_pool_config(&info, &pools.config);
+    ngfvk_desc_set_layout layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.counts[NGF_DESCRIPTOR_UNIFORM_BUFFER] = 64u;
+
+    ngfvk_desc_pool_capacity capacity;
+    ngfvk_desc_pool_capacity_for_new_pool(&pools, &layout, &capacity);
+    NT_ASSERT(capacity.sets == 8u);
+    NT_ASSERT(capacity.descriptors[NGF_DESCRIPTOR_UNIFORM_BUFFER] == 64u);
+    NT_ASSERT(capacity.descriptors[NGF_DESCRIPTOR_SAMPLER] == 32u);
+
+    ngfvk_init_desc_pool_config(NULL, &pools.config);
+    ngfvk_desc_pool_capacity_for_new_pool(&pools, &layout, &capacity);
+    NT_ASSERT(capacity.sets == NGFVK_DESC_POOL_DEFAULT_SETS);
+    NT_ASSERT(capacity.descriptors[NGF_DESCRIPTOR_SAMPLER] == NGFVK_DESC_POOL_DEFAULT_DESCRIPTORS);
+  }
+
+  NT_TESTCASE(descPoolCapacityAdaptive) {
+    const ngf_descriptor_pool_info info = {
+        .initial_sets                 = 16u,
+        .initial_descriptors_per_type = 16u,
+        .adaptive                     = true};
+    ngfvk_desc_pools_list pools;
+    memset(&pools, 0, sizeof(pools));
+    ngfvk_init_desc_pool_config(&info, &pools.config);
+    ngfvk_desc_set_layout layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.counts[NGF_DESCRIPTOR_UNIFORM_BUFFER] = 1u;
+
+    // Previous frames used 400 sets, with 2 uniform buffers and 1 texture per set on average.
+    pools.high_water.sets                                       = 400u;
+    pools.high_water.descriptors[NGF_DESCRIPTOR_UNIFORM_BUFFER] = 800u;
+    pools.high_water.descriptors[NGF_DESCRIPTOR_IMAGE]          = 400u;
+
+    ngfvk_desc_pool_capacity capacity;
+    ngfvk_desc_pool_capacity_for_new_pool(&pools, &layout, &capacity);
+    NT_ASSERT(capacity.sets >= 400u);
+    NT_ASSERT(capacity.descriptors[NGF_DESCRIPTOR_UNIFORM_BUFFER] >= 2u * capacity.sets);
+    NT_ASSERT(capacity.descriptors[NGF_DESCRIPTOR_IMAGE] >= capacity.sets);
+    NT_ASSERT(capacity.descriptors[NGF_DESCRIPTOR_SAMPLER] == NGFVK_DESC_POOL_MIN_DESCRIPTORS);
+
+    // When the active pool runs out of space mid-frame, the next one grows geometrically.
+    ngfvk_desc_pool last_pool;
+    memset(&last_pool, 0, sizeof(last_pool));
+    last_pool.capacity         = capacity;
+    last_pool.utilization      = capacity;
+    last_pool.utilization.sets = capacity.sets / 2u;
+    pools.active_pool          = &last_pool;
+    pools.frame_usage          = last_pool.utilization;
+    ngfvk_desc_pool_capacity grown;
+    ngfvk_desc_pool_capacity_for_new_pool(&pools, &layout, &grown);
+    NT_ASSERT(grown.sets == 2u * capacity.sets);
+    NT_ASSERT(
+        grown.descriptors[NGF_DESCRIPTOR_UNIFORM_BUFFER] >=
+        2u * capacity.descriptors[NGF_DESCRIPTOR_UNIFORM_BUFFER]);
+  }
+
+  NT_TESTCASE(pipelineCacheHeaderValidation) {
+    const uint8_t uuid[VK_UUID_SIZE] = {
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+        0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10};
+    uint8_t blob[64];
+    memset(blob, 0xcd, sizeof(blob));
+    const uint32_t fields[4] = {32u, VK_PIPELINE_CACHE_HEADER_VERSION_ONE, 0x10deu, 0x1234u};
+    for (uint32_t i = 0u; i < 4u; ++i) {
+      for (uint32_t b = 0u; b < 4u; ++b) { blob[4u * i + b] = (uint8_t)(fields[i] >> (8u * b)); }
+    }
+    memcpy(&blob[16], uuid, VK_UUID_SIZE);
+
+    NT_ASSERT(ngfvk_pipeline_cache_header_valid(blob, sizeof(blob), 0x10deu, 0x1234u, uuid));
+    NT_ASSERT(!ngfvk_pipeline_cache_header_valid(blob, 31u, 0x10deu, 0x1234u, uuid));
+    NT_ASSERT(!ngfvk_pipeline_cache_header_valid(NULL, 0u, 0x10deu, 0x1234u, uuid));
+    NT_ASSERT(!ngfvk_pipeline_cache_header_valid(blob, sizeof(blob), 0x1002u, 0x1234u, uuid));
+    NT_ASSERT(!ngfvk_pipeline_cache_header_valid(blob, sizeof(blob), 0x10deu, 0x4321u, uuid));
+
+    uint8_t other_uuid[VK_UUID_SIZE];
+    memcpy(other_uuid, uuid, VK_UUID_SIZE);
+    other_uuid[VK_UUID_SIZE - 1u] ^= 0xffu;
+    NT_ASSERT(!ngfvk_pipeline_cache_header_valid(blob, sizeof(blob), 0x10deu, 0x1234u, other_uuid));
+
+    blob[4] = 2u;  // unknown header version.
+    NT_ASSERT(!ngfvk_pipeline_cache_header_valid(blob, sizeof(blob), 0x10deu, 0x1234u, uuid));
+  }
+
+  NT_TESTCASE(renderPassCacheInsertFindEvict) {
+    ngfvk_renderpass_cache cache;
+    memset(&cache, 0, sizeof(cache));
+    ngfvk_frame_resources res;
+    memset(&res, 0, sizeof(res));
+    NGFI_DARRAY_RESET(res.retire_render_passes, 8u);
+
+    ngf_render_target rts[3] = {
+        (ngf_render_target)(uintptr_t)0x1000u,
+        (ngf_render_target)(uintptr_t)0x2000u,
+        (ngf_render_target)(uintptr_t)0x3000u};
+    NT_ASSERT(ngfvk_renderpass_cache_find(&cache, rts[0], 0u) == VK_NULL_HANDLE);
+
+    // Insert enough entries to force the table to grow a few times.
+    const uint32_t nkeys = 3u * NGFVK_RENDERPASS_CACHE_INITIAL_CAPACITY;
+    for (uint32_t r = 0u; r < 3u; ++r) {
+      for (uint32_t k = 0u; k < nkeys; ++k) {
+        const ngfvk_renderpass_cache_entry entry = {
+            .rt         = rts[r],
+            .ops_key    = k,
+            .renderpass = (VkRenderPass)(uintptr_t)(1u + r * nkeys + k)};
+        NT_ASSERT(ngfvk_renderpass_cache_insert(&cache, &entry));
+      }
+    }
+    NT_ASSERT(cache.nentries == 3u * nkeys);
+    NT_ASSERT(2u * cache.nentries <= cache.capacity);
+    for (uint32_t r = 0u; r < 3u; ++r) {
+      for (uint32_t k = 0u; k < nkeys; ++k) {
+        NT_ASSERT(
+            ngfvk_renderpass_cache_find(&cache, rts[r], k) ==
+            (VkRenderPass)(uintptr_t)(1u + r * nkeys + k));
+      }
+    }
+    NT_ASSERT(ngfvk_renderpass_cache_find(&cache, rts[0], nkeys) == VK_NULL_HANDLE);
+
+    // Evicting one target must retire exactly its passes and leave the others reachable.
+    ngfvk_renderpass_cache_evict(&cache, rts[1], &res);
+    NT_ASSERT(cache.nentries == 2u * nkeys);
+    NT_ASSERT(NGFI_DARRAY_SIZE(res.retire_render_passes) == nkeys);
+    NGFI_DARRAY_FOREACH(res.retire_render_passes, i) {
+      const uintptr_t handle = (uintptr_t)NGFI_DARRAY_AT(res.retire_render_passes, i);
+      NT_ASSERT(handle > nkeys && handle <= 2u * nkeys);
+    }
+    for (uint32_t k = 0u; k < nkeys; ++k) {
+      NT_ASSERT(ngfvk_renderpass_cache_find(&cache, rts[1], k) == VK_NULL_HANDLE);
+      NT_ASSERT(
+          ngfvk_renderpass_cache_find(&cache, rts[0], k) == (VkRenderPass)(uintptr_t)(1u + k));
+      NT_ASSERT(
+          ngfvk_renderpass_cache_find(&cache, rts[2], k) ==
+          (VkRenderPass)(uintptr_t)(1u + 2u * nkeys + k));
+    }
+
+    ngfvk_renderpass_cache_evict(&cache, rts[0], &res);
+    ngfvk_renderpass_cache_evict(&cache, rts[2], &res);
+    NT_ASSERT(cache.nentries == 0u);
+    NT_ASSERT(NGFI_DARRAY_SIZE(res.retire_render_passes) == 3u * nkeys);
+
+    NGFI_FREEN(cache.slots, cache.capacity);
+    NGFI_DARRAY_DESTROY(res.retire_render_passes);
+  }
+
+  NT_TESTCASE(retireWorkerHandsOffAndDrains) {
+    ngfvk_retire_worker* worker = ngfvk_retire_worker_create();
+    NT_ASSERT(worker != NULL);
+
+    ngfvk_frame_resources res;
+    memset(&res, 0, sizeof(res));
+    NGFI_DARRAY_RESET(res.retire_pipelines, 8);
+    NGFI_DARRAY_RESET(res.retire_pipeline_layouts, 8);
+    NGFI_DARRAY_RESET(res.retire_dset_layouts, 8);
+    NGFI_DARRAY_RESET(res.retire_framebuffers, 8);
+    NGFI_DARRAY_RESET(res.retire_render_passes, 8);
+    NGFI_DARRAY_RESET(res.retire_samplers, 8);
+    NGFI_DARRAY_RESET(res.retire_image_views, 8);
+    NGFI_DARRAY_RESET(res.retire_buffer_views, 8);
+    NGFI_DARRAY_RESET(res.retire_desc_pools, 8);
+    NGFI_DARRAY_RESET(res.retire_images, 8);
+    NGFI_DARRAY_RESET(res.retire_buffers, 8);
+
+    // Enqueue more batches than the queue can hold, so that the producer has to wait for the
+    // worker at some point. The lists are empty, so no Vulkan calls are made.
+    for (uint32_t i = 0u; i < 4u * NGFVK_RETIRE_QUEUE_CAPACITY; ++i) {
+      void* const old_data = res.retire_pipelines.data;
+      ngfvk_retire_worker_enqueue(worker, &res);
+      NT_ASSERT(res.retire_pipelines.data != NULL);
+      NT_ASSERT(res.retire_pipelines.data != old_data);
+      NT_ASSERT(NGFI_DARRAY_SIZE(res.retire_pipelines) == 0u);
+      NT_ASSERT(NGFI_DARRAY_SIZE(res.retire_buffers) == 0u);
+    }
+
+    pthread_mutex_lock(&worker->lock);
+    NT_ASSERT(worker->nqueued <= NGFVK_RETIRE_QUEUE_CAPACITY);
+    pthread_mutex_unlock(&worker->lock);
+    ngfvk_retire_worker_destroy(worker);
+
+    NGFI_DARRAY_DESTROY(res.retire_pipelines);
+    NGFI_DARRAY_DESTROY(res.retire_pipeline_layouts);
+    NGFI_DARRAY_DESTROY(res.retire_dset_layouts);
+    NGFI_DARRAY_DESTROY(res.retire_framebuffers);
+    NGFI_DARRAY_DESTROY(res.retire_render_passes);
+    NGFI_DARRAY_DESTROY(res.retire_samplers);
+    NGFI_DARRAY_DESTROY(res.retire_image_views);
+    NGFI_DARRAY_DESTROY(res.retire_buffer_views);
+    NGFI_DARRAY_DESTROY(res.retire_desc_pools);
+    NGFI_DARRAY_DESTROY(res.retire_images);
+    NGFI_DARRAY_DESTROY(res.retire_buffers);
+  }
+
+  NT_TESTCASE(cmdPoolRecyclesCommandBuffers) {
+    ngfvk_cmd_pool pool;
+    memset(&pool, 0, sizeof(pool));
+    NGFI_DARRAY_RESET(pool.cmd_bufs, 4u);
+    for (uintptr_t i = 1u; i <= 3u; ++i) {
+      NGFI_DARRAY_APPEND(pool.cmd_bufs, (VkCommandBuffer)i);
+    }
+
+    // Command buffers left over from before the last reset are handed out in order, without
+    // allocating new ones.
+    ngf_context_stats stats;
+    memset(&stats, 0, sizeof(stats));
+    for (uintptr_t i = 1u; i <= 3u; ++i) {
+      VkCommandBuffer cmd_buf = VK_NULL_HANDLE;
+      NT_ASSERT(ngfvk_cmd_pool_acquire(&pool, &stats, &cmd_buf) == NGF_ERROR_OK);
+      NT_ASSERT(cmd_buf == (VkCommandBuffer)i);
+      NT_ASSERT(pool.nused == i);
+    }
+    NT_ASSERT(stats.cmd_buffer_allocations == 0u);
+    NT_ASSERT(NGFI_DARRAY_SIZE(pool.cmd_bufs) == 3u);
+
+    // Resetting a pool that hasn't handed anything out is a no-op.
+    pool.nused = 0u;
+    ngfvk_cmd_pool_reset(&pool);
+    NT_ASSERT(pool.nused == 0u);
+
+    NGFI_DARRAY_DESTROY(pool.cmd_bufs);
+  }
+
+  NT_TESTCASE(redundantStateFilteringSortedDrawList) {
+    // Simulates recording a draw list sorted by pipeline and then by mesh, where the application
+    // sets all of the state for every draw, and counts how many of the resulting commands actually
+    // need to be recorded.
+    ngfvk_cmd_shadow_state shadow;
+    memset(&shadow, 0, sizeof(shadow));
+    ngfvk_shadow_state_reset(&shadow);
+    const VkViewport viewport = {0.0f, 0.0f, 1920.0f, 1080.0f, 0.0f, 1.0f};
+    const VkRect2D   scissor  = {{0, 0}, {1920u, 1080u}};
+    uint32_t         nissued  = 0u;
+    uint32_t         nelided  = 0u;
+    for (uintptr_t pipe = 1u; pipe <= 4u; ++pipe) {
+      for (uintptr_t mesh = 1u; mesh <= 4u; ++mesh) {
+        for (uint32_t material = 0u; material < 8u; ++material) {
+          const bool issued[] = {
+              ngfvk_shadow_set_viewport(&shadow, &viewport),
+              ngfvk_shadow_set_scissor(&shadow, &scissor),
+              ngfvk_shadow_set_gfx_pipeline(&shadow, (VkPipeline)pipe),
+              ngfvk_shadow_set_attrib_buf(&shadow, 0u, (VkBuffer)mesh, 0u),
+              ngfvk_shadow_set_index_buf(&shadow, (VkBuffer)mesh, 0u, VK_INDEX_TYPE_UINT16)};
+          for (uint32_t i = 0u; i < NGFI_ARRAYSIZE(issued); ++i) {
+            if (issued[i]) {
+              ++nissued;
+            } else {
+              ++nelided;
+            }
+          }
+        }
+      }
+    }
+    // One viewport, one scissor, four pipelines and one vertex and index buffer per mesh and
+    // pipeline.
+    NT_ASSERT(nissued == 1u + 1u + 4u + 16u + 16u);
+    NT_ASSERT(nissued + nelided == 4u * 4u * 8u * 5u);
+
+    // Changing only the offset of a buffer is not redundant.
+    NT_ASSERT(ngfvk_shadow_set_attrib_buf(&shadow, 0u, (VkBuffer)4u, 64u));
+    NT_ASSERT(ngfvk_shadow_set_index_buf(&shadow, (VkBuffer)4u, 0u, VK_INDEX_TYPE_UINT32));
+
+    // Bindings outside of the tracked range are always recorded.
+    const uint32_t untracked_binding = NGFVK_MAX_SHADOWED_ATTRIB_BINDINGS;
+    NT_ASSERT(ngfvk_shadow_set_attrib_buf(&shadow, untracked_binding, (VkBuffer)1u, 0u));
+    NT_ASSERT(ngfvk_shadow_set_attrib_buf(&shadow, untracked_binding, (VkBuffer)1u, 0u));
+
+    // Stencil values are invalidated by binding a different pipeline, but not the same one.
+    NT_ASSERT(ngfvk_shadow_set_stencil_values(
+        &shadow,
+        NGFVK_SHADOW_STENCIL_REFERENCE,
+        shadow.stencil_reference,
+        1u,
+        2u));
+    NT_ASSERT(!ngfvk_shadow_set_stencil_values(
+        &shadow,
+        NGFVK_SHADOW_STENCIL_REFERENCE,
+        shadow.stencil_reference,
+        1u,
+        2u));
+    NT_ASSERT(!ngfvk_shadow_set_gfx_pipeline(&shadow, (VkPipeline)4u));
+    NT_ASSERT(!ngfvk_shadow_set_stencil_values(
+        &shadow,
+        NGFVK_SHADOW_STENCIL_REFERENCE,
+        shadow.stencil_reference,
+        1u,
+        2u));
+    NT_ASSERT(ngfvk_shadow_set_gfx_pipeline(&shadow, (VkPipeline)1u));
+    NT_ASSERT(ngfvk_shadow_set_stencil_values(
+        &shadow,
+        NGFVK_SHADOW_STENCIL_REFERENCE,
+        shadow.stencil_reference,
+        1u,
+        2u));
+    NT_ASSERT(!ngfvk_shadow_set_viewport(&shadow, &viewport));
+
+    // Nothing is known after a reset.
+    ngfvk_shadow_state_reset(&shadow);
+    NT_ASSERT(ngfvk_shadow_set_viewport(&shadow, &viewport));
+    NT_ASSERT(ngfvk_shadow_set_gfx_pipeline(&shadow, (VkPipeline)1u));
+    NT_ASSERT(ngfvk_shadow_set_attrib_buf(&shadow, 0u, (VkBuffer)4u, 64u));
+  }
+
+  NT_TESTCASE(descUpdateTemplatePayload) {
+    ngfvk_desc_template_entry entries[] = {
+        {0u, NGF_DESCRIPTOR_UNIFORM_BUFFER},
+        {1u, NGF_DESCRIPTOR_IMAGE_AND_SAMPLER},
+        {3u, NGF_DESCRIPTOR_TEXEL_BUFFER}};
+    ngfvk_desc_set_layout set_layout;
+    memset(&set_layout, 0, sizeof(set_layout));
+    set_layout.template_entries  = entries;
+    set_layout.ntemplate_entries = NGFI_ARRAYSIZE(entries);
+
+    ngf_buffer_t buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.alloc.obj_handle = 0x10u;
+    ngf_image_t img;
+    memset(&img, 0, sizeof(img));
+    img.vkview = (VkImageView)0x20u;
+    ngf_sampler_t sampler;
+    sampler.vksampler = (VkSampler)0x30u;
+    ngf_texel_buffer_view_t texel_view;
+    texel_view.vk_buf_view = (VkBufferView)0x40u;
+
+    ngf_resource_bind_op ops[3];
+    memset(ops, 0, sizeof(ops));
+    ops[0].target_binding     = 0u;
+    ops[0].type               = NGF_DESCRIPTOR_UNIFORM_BUFFER;
+    ops[0].info.buffer.buffer = &buf;
+    ops[0].info.buffer.offset = 256u;
+    ops[0].info.buffer.range  = 64u;
+
+    ops[1].target_binding             = 1u;
+    ops[1].type                       = NGF_DESCRIPTOR_IMAGE_AND_SAMPLER;
+    ops[1].info.image_sampler.image   = &img;
+    ops[1].info.image_sampler.sampler = &sampler;
+
+    ops[2].target_binding         = 3u;
+    ops[2].type                   = NGF_DESCRIPTOR_TEXEL_BUFFER;
+    ops[2].info.texel_buffer_view = &texel_view;
+
+    const ngf_resource_bind_op* op_ptrs[] = {&ops[0], &ops[1], &ops[2]};
+
+    ngfvk_desc_template_slot payload[3];
+    NT_ASSERT(ngfvk_desc_template_payload_for_ops(&set_layout, op_ptrs, 3u, payload));
+    NT_ASSERT(payload[0].buffer.buffer == (VkBuffer)0x10u);
+    NT_ASSERT(payload[0].buffer.offset == 256u);
+    NT_ASSERT(payload[0].buffer.range == 64u);
+    NT_ASSERT(payload[1].image.imageView == (VkImageView)0x20u);
+    NT_ASSERT(payload[1].image.sampler == (VkSampler)0x30u);
+    NT_ASSERT(payload[1].image.imageLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    NT_ASSERT(payload[2].texel_buffer_view == (VkBufferView)0x40u);
+
+    // The template can't be used if some binding is left out, or if the types don't match.
+    NT_ASSERT(!ngfvk_desc_template_payload_for_ops(&set_layout, op_ptrs, 2u, payload));
+    const ngf_resource_bind_op* skipping_op_ptrs[] = {&ops[0], &ops[2], &ops[2]};
+    NT_ASSERT(!ngfvk_desc_template_payload_for_ops(&set_layout, skipping_op_ptrs, 3u, payload));
+    ops[0].type = NGF_DESCRIPTOR_STORAGE_BUFFER;
+    NT_ASSERT(!ngfvk_desc_template_payload_for_ops(&set_layout, op_ptrs, 3u, payload));
+  }
+
+  NT_TESTCASE(resourceTableSlotsAcquireAndForget) {
+    ngf_resource_table_t tables[2];
+    memset(tables, 0, sizeof(tables));
+    for (uint32_t t = 0u; t < 2u; ++t) {
+      tables[t].capacity = 2u;
+      NGFI_DARRAY_RESET(tables[t].free_slots, 8);
+    }
+
+    // Fresh slots are handed out in order until the table is full, after that only freed slots
+    // can be reused.
+    uint32_t slot = ~0u;
+    NT_ASSERT(ngfvk_resource_table_acquire_slot(&tables[0], &slot) == NGF_ERROR_OK);
+    NT_ASSERT(slot == 0u);
+    NT_ASSERT(ngfvk_resource_table_acquire_slot(&tables[0], &slot) == NGF_ERROR_OK);
+    NT_ASSERT(slot == 1u);
+    NT_ASSERT(ngfvk_resource_table_acquire_slot(&tables[0], &slot) == NGF_ERROR_OUT_OF_MEM);
+    NGFI_DARRAY_APPEND(tables[0].free_slots, 1u);
+    NT_ASSERT(ngfvk_resource_table_acquire_slot(&tables[0], &slot) == NGF_ERROR_OK);
+    NT_ASSERT(slot == 1u);
+
+    // Forgetting a table drops its pending slots from every frame, and leaves the others intact.
+    ngfvk_frame_resources frame_res[2];
+    memset(frame_res, 0, sizeof(frame_res));
+    ngf_context_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.frame_res           = frame_res;
+    ctx.max_inflight_frames = 2u;
+    for (uint32_t f = 0u; f < 2u; ++f) {
+      NGFI_DARRAY_RESET(frame_res[f].retire_table_slots, 8);
+      for (uint32_t i = 0u; i < 4u; ++i) {
+        const ngfvk_retired_table_slot retired = {.table = &tables[i % 2u], .slot = i};
+        NGFI_DARRAY_APPEND(frame_res[f].retire_table_slots, retired);
+      }
+    }
+    ngfvk_forget_retired_table_slots(&ctx, &tables[0]);
+    for (uint32_t f = 0u; f < 2u; ++f) {
+      NT_ASSERT(NGFI_DARRAY_SIZE(frame_res[f].retire_table_slots) == 2u);
+      NT_ASSERT(NGFI_DARRAY_AT(frame_res[f].retire_table_slots, 0).table == &tables[1]);
+      NT_ASSERT(NGFI_DARRAY_AT(frame_res[f].retire_table_slots, 0).slot == 1u);
+      NT_ASSERT(NGFI_DARRAY_AT(frame_res[f].retire_table_slots, 1).slot == 3u);
+      NGFI_DARRAY_DESTROY(frame_res[f].retire_table_slots);
+    }
+    for (uint32_t t = 0u; t < 2u; ++t) { NGFI_DARRAY_DESTROY(tables[t].free_slots); }
+  }
+
+  NT_TESTCASE(dynamicUniformBufferOffsets) {
+    ngfvk_desc_set_layout set_layout;
+    memset(&set_layout, 0, sizeof(set_layout));
+    set_layout.dynamic_bindings[0] = 1u;
+    set_layout.dynamic_bindings[1] = 4u;
+    set_layout.ndynamic_bindings   = 2u;
+
+    ngf_buffer_t buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.alloc.obj_handle = 0x10u;
+    ngf_resource_bind_op ops[2];
+    memset(ops, 0, sizeof(ops));
+    for (uint32_t i = 0u; i < 2u; ++i) {
+      ops[i].target_binding     = 4u;
+      ops[i].type               = NGF_DESCRIPTOR_UNIFORM_BUFFER_DYNAMIC;
+      ops[i].info.buffer.buffer = &buf;
+      ops[i].info.buffer.offset = 256u * (i + 1u);
+      ops[i].info.buffer.range  = 64u;
+    }
+
+    // Offsets go into the position of their binding among the set's dynamic bindings.
+    uint32_t offsets[NGFVK_MAX_DYNAMIC_UNIFORM_BUFFERS_PER_SET] = {0u};
+    NT_ASSERT(ngfvk_dynamic_offset_for_op(&set_layout, &ops[1], offsets));
+    NT_ASSERT(offsets[0] == 0u);
+    NT_ASSERT(offsets[1] == 512u);
+    ops[0].target_binding = 2u;
+    NT_ASSERT(!ngfvk_dynamic_offset_for_op(&set_layout, &ops[0], offsets));
+    ops[0].target_binding = 4u;
+
+    // The offset doesn't participate in the cache key, so that the same set can be reused with a
+    // different offset. The descriptor itself always starts at the beginning of the buffer.
+    ngfvk_desc_cache_key_entry keys[2];
+    ngfvk_desc_cache_key_entry_for_op(&ops[0], &keys[0]);
+    ngfvk_desc_cache_key_entry_for_op(&ops[1], &keys[1]);
+    NT_ASSERT(memcmp(&keys[0], &keys[1], sizeof(keys[0])) == 0);
+    VkDescriptorBufferInfo buf_info;
+    ngfvk_desc_buffer_info_for_op(&ops[1], &buf_info);
+    NT_ASSERT(buf_info.offset == 0u);
+    NT_ASSERT(buf_info.range == 64u);
+
+    ops[0].type = ops[1].type = NGF_DESCRIPTOR_UNIFORM_BUFFER;
+    ngfvk_desc_cache_key_entry_for_op(&ops[0], &keys[0]);
+    ngfvk_desc_cache_key_entry_for_op(&ops[1], &keys[1]);
+    NT_ASSERT(memcmp(&keys[0], &keys[1], sizeof(keys[0])) != 0);
+  }
+
+  NT_TESTCASE(uploadChunkSuballocation) {
+    ngf_buffer_t buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.size                 = 1024u;
+    ngfvk_upload_chunk chunk = {.buffer = &buf, .used = 0u, .flushed = 0u};
+
+    size_t offset = ~0u;
+    NT_ASSERT(ngfvk_upload_chunk_suballoc(&chunk, 100u, 16u, &offset));
+    NT_ASSERT(offset == 0u);
+    NT_ASSERT(chunk.used == 100u);
+
+    // Subsequent regions are placed at the next suitably aligned offset.
+    NT_ASSERT(ngfvk_upload_chunk_suballoc(&chunk, 64u, 256u, &offset));
+    NT_ASSERT(offset == 256u);
+    NT_ASSERT(ngfvk_upload_chunk_suballoc(&chunk, 4u, 4u, &offset));
+    NT_ASSERT(offset == 320u);
+
+    // Requests that don't fit leave the chunk untouched.
+    NT_ASSERT(!ngfvk_upload_chunk_suballoc(&chunk, 1024u - 320u, 4u, &offset));
+    NT_ASSERT(offset == 320u);
+    NT_ASSERT(chunk.used == 324u);
+    NT_ASSERT(ngfvk_upload_chunk_suballoc(&chunk, 1024u - 324u, 4u, &offset));
+    NT_ASSERT(chunk.used == 1024u);
+  }
+
+  NT_TESTCASE(findDedicatedQueueFamily) {
+    const VkQueueFamilyProperties families[] = {
+        {.queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT,
+         .queueCount = 16u},
+        {.queueFlags = VK_QUEUE_TRANSFER_BIT | VK_QUEUE_SPARSE_BINDING_BIT, .queueCount = 0u},
+        {.queueFlags = VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT, .queueCount = 8u},
+        {.queueFlags = VK_QUEUE_TRANSFER_BIT | VK_QUEUE_SPARSE_BINDING_BIT, .queueCount = 2u}};
+    const VkQueueFlags gfx_and_compute = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+
+    // Families without any queues are skipped.
+    NT_ASSERT(
+        ngfvk_find_dedicated_queue_family(families, 4u, VK_QUEUE_TRANSFER_BIT, gfx_and_compute) ==
+        3u);
+    NT_ASSERT(
+        ngfvk_find_dedicated_queue_family(families, 3u, VK_QUEUE_TRANSFER_BIT, gfx_and_compute) ==
+        NGFVK_INVALID_IDX);
+    NT_ASSERT(
+        ngfvk_find_dedicated_queue_family(
+            families,
+            4u,
+            VK_QUEUE_COMPUTE_BIT,
+            VK_QUEUE_GRAPHICS_BIT) == 2u);
+  }
+
+  NT_TESTCASE(ownershipBarriers) {
+    _vk.gfx_family_idx = 0u;
+
+    VkBufferMemoryBarrier buf_release, buf_acquire;
+    ngfvk_buffer_ownership_barriers(
+        2u,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        (VkBuffer)0x1u,
+        256u,
+        1024u,
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+        &buf_release,
+        &buf_acquire);
+    NT_ASSERT(buf_release.srcQueueFamilyIndex == 2u && buf_acquire.srcQueueFamilyIndex == 2u);
+    NT_ASSERT(buf_release.dstQueueFamilyIndex == 0u && buf_acquire.dstQueueFamilyIndex == 0u);
+    NT_ASSERT(buf_release.srcAccessMask == VK_ACCESS_TRANSFER_WRITE_BIT);
+    NT_ASSERT(buf_release.dstAccessMask == 0u);
+    NT_ASSERT(buf_acquire.srcAccessMask == 0u);
+    NT_ASSERT(buf_acquire.dstAccessMask == VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+    NT_ASSERT(buf_release.buffer == buf_acquire.buffer);
+    NT_ASSERT(buf_release.offset == 256u && buf_acquire.offset == 256u);
+    NT_ASSERT(buf_release.size == 1024u && buf_acquire.size == 1024u);
+
+    // Both halves of an image ownership transfer have to specify the same layout transition.
+    const VkImageSubresourceRange range = {
+        .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel   = 1u,
+        .levelCount     = 1u,
+        .baseArrayLayer = 0u,
+        .layerCount     = 6u};
+    VkImageMemoryBarrier img_release, img_acquire;
+    ngfvk_image_ownership_barriers(
+        1u,
+        VK_ACCESS_SHADER_WRITE_BIT,
+        (VkImage)0x2u,
+        &range,
+        VK_IMAGE_LAYOUT_GENERAL,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_ACCESS_SHADER_READ_BIT,
+        &img_release,
+        &img_acquire);
+    NT_ASSERT(img_release.srcQueueFamilyIndex == 1u && img_acquire.srcQueueFamilyIndex == 1u);
+    NT_ASSERT(img_release.dstQueueFamilyIndex == 0u && img_acquire.dstQueueFamilyIndex == 0u);
+    NT_ASSERT(img_release.oldLayout == img_acquire.oldLayout);
+    NT_ASSERT(img_release.newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    NT_ASSERT(img_acquire.newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    NT_ASSERT(img_release.srcAccessMask == VK_ACCESS_SHADER_WRITE_BIT);
+    NT_ASSERT(img_release.dstAccessMask == 0u);
+    NT_ASSERT(img_acquire.srcAccessMask == 0u);
+    NT_ASSERT(img_acquire.dstAccessMask == VK_ACCESS_SHADER_READ_BIT);
+    NT_ASSERT(img_acquire.subresourceRange.layerCount == 6u);
+    NT_ASSERT(img_acquire.subresourceRange.baseMipLevel == 1u);
+  }
+
+  NT_TESTCASE(xferBarrierBatching) {
+    PFN_vkCmdPipelineBarrier   real_pipeline_barrier     = vkCmdPipelineBarrier;
+    PFN_vkCmdCopyBufferToImage real_copy_buffer_to_image = vkCmdCopyBufferToImage;
+    vkCmdPipelineBarrier                                 = fake_pipeline_barrier;
+    vkCmdCopyBufferToImage                               = fake_copy_buffer_to_image;
+    fakePipelineBarrierCalls                             = 0u;
+    fakeCopyBufferToImageCalls                           = 0u;
+    fakeCopyRegionCount                                  = 0u;
+
+    ngf_cmd_buffer_t fake_cmd_buf;
+    memset(&fake_cmd_buf, 0, sizeof(fake_cmd_buf));
+    fake_cmd_buf.queue = NGFVK_QUEUE_GFX;
+    NGFI_DARRAY_RESET(fake_cmd_buf.ownership_img_barriers, 4u);
+    NGFI_DARRAY_RESET(fake_cmd_buf.pending_xfer_buf_barriers, 4u);
+    NGFI_DARRAY_RESET(fake_cmd_buf.pending_xfer_img_barriers, 4u);
+    NGFI_DARRAY_RESET(fake_cmd_buf.xfer_pre_img_barriers, 4u);
+    NGFI_DARRAY_RESET(fake_cmd_buf.xfer_copy_regions, 4u);
+    ngf_xfer_encoder enc;
+    enc.pvt_data_donotuse.d0 = (uintptr_t)&fake_cmd_buf;
+
+    ngf_buffer_t staging;
+    memset(&staging, 0, sizeof(staging));
+    staging.alloc.obj_handle = 0x1u;
+    ngf_image_t image_array;
+    memset(&image_array, 0, sizeof(image_array));
+    image_array.alloc.obj_handle = 0x2u;
+    image_array.type             = NGF_IMAGE_TYPE_IMAGE_2D;
+    image_array.usage_flags      = NGF_IMAGE_USAGE_SAMPLE_FROM | NGF_IMAGE_USAGE_XFER_DST;
+    image_array.nlevels          = 1u;
+    image_array.nlayers          = 200u;
+
+    // Uploading every layer of an array at once requires a single barrier before the copies, and
+    // a single one at the end of the pass.
+    ngf_image_write writes[200];
+    for (uint32_t l = 0u; l < 200u; ++l) {
+      writes[l] = (ngf_image_write){
+          .src_offset = 64u * l,
+          .dst        = {.image = &image_array, .mip_level = 0u, .layer = l},
+          .offset     = {0, 0, 0},
+          .extent     = {4u, 4u, 1u},
+          .nlayers    = 1u};
+    }
+    NT_ASSERT(ngf_cmd_write_images(enc, &staging, writes, 200u) == NGF_ERROR_OK);
+    NT_ASSERT(fakePipelineBarrierCalls == 1u && fakeLastImgBarrierCount == 200u);
+    NT_ASSERT(fakeCopyBufferToImageCalls == 1u && fakeCopyRegionCount == 200u);
+    NT_ASSERT(NGFI_DARRAY_SIZE(fake_cmd_buf.pending_xfer_img_barriers) == 200u);
+    ngfvk_flush_xfer_barriers(&fake_cmd_buf);
+    NT_ASSERT(fakePipelineBarrierCalls == 2u && fakeLastImgBarrierCount == 200u);
+    NT_ASSERT(NGFI_DARRAY_SIZE(fake_cmd_buf.pending_xfer_img_barriers) == 0u);
+
+    // Individual writes to distinct layers only add a barrier before each copy.
+    for (uint32_t l = 0u; l < 4u; ++l) {
+      ngf_cmd_write_image(
+          enc,
+          &staging,
+          writes[l].src_offset,
+          writes[l].dst,
+          writes[l].offset,
+          writes[l].extent,
+          1u);
+    }
+    NT_ASSERT(fakePipelineBarrierCalls == 6u && fakeLastImgBarrierCount == 1u);
+    NT_ASSERT(NGFI_DARRAY_SIZE(fake_cmd_buf.pending_xfer_img_barriers) == 4u);
+
+    // Writing a layer that has been written to before flushes the pending barriers first.
+    ngf_cmd_write_image(
+        enc,
+        &staging,
+        writes[2].src_offset,
+        writes[2].dst,
+        writes[2].offset,
+        writes[2].extent,
+        1u);
+    NT_ASSERT(fakePipelineBarrierCalls == 8u && fakeLastImgBarrierCount == 1u);
+    NT_ASSERT(NGFI_DARRAY_SIZE(fake_cmd_buf.pending_xfer_img_barriers) == 1u);
+
+    // Overlapping writes within a batch are split into separate runs.
+    ngfvk_flush_xfer_barriers(&fake_cmd_buf);
+    fakePipelineBarrierCalls   = 0u;
+    fakeCopyBufferToImageCalls = 0u;
+    const ngf_image_write overlapping_writes[3] = {writes[0], writes[1], writes[0]};
+    NT_ASSERT(ngf_cmd_write_images(enc, &staging, overlapping_writes, 3u) == NGF_ERROR_OK);
+    NT_ASSERT(fakePipelineBarrierCalls == 3u && fakeCopyBufferToImageCalls == 2u);
+    NT_ASSERT(NGFI_DARRAY_SIZE(fake_cmd_buf.pending_xfer_img_barriers) == 1u);
+
+    // Images that can't be written to are rejected before anything is recorded.
+    ngfvk_flush_xfer_barriers(&fake_cmd_buf);
+    fakePipelineBarrierCalls = 0u;
+    image_array.usage_flags  = NGF_IMAGE_USAGE_SAMPLE_FROM;
+    NT_ASSERT(ngf_cmd_write_images(enc, &staging, writes, 2u) == NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(fakePipelineBarrierCalls == 0u);
+
+    // Single writes are recorded without validation, same as before batched writes existed.
+    fakeCopyBufferToImageCalls = 0u;
+    ngf_cmd_write_image(
+        enc,
+        &staging,
+        writes[0].src_offset,
+        writes[0].dst,
+        writes[0].offset,
+        writes[0].extent,
+        1u);
+    NT_ASSERT(fakePipelineBarrierCalls == 1u && fakeCopyBufferToImageCalls == 1u);
+
+    NGFI_DARRAY_DESTROY(fake_cmd_buf.ownership_img_barriers);
+    NGFI_DARRAY_DESTROY(fake_cmd_buf.pending_xfer_buf_barriers);
+    NGFI_DARRAY_DESTROY(fake_cmd_buf.pending_xfer_img_barriers);
+    NGFI_DARRAY_DESTROY(fake_cmd_buf.xfer_pre_img_barriers);
+    NGFI_DARRAY_DESTROY(fake_cmd_buf.xfer_copy_regions);
+    vkCmdPipelineBarrier   = real_pipeline_barrier;
+    vkCmdCopyBufferToImage = real_copy_buffer_to_image;
+  }
+
+  NT_TESTCASE(bufferCopyBarrierBatching) {
+    PFN_vkCmdPipelineBarrier real_pipeline_barrier = vkCmdPipelineBarrier;
+    PFN_vkCmdCopyBuffer      real_copy_buffer      = vkCmdCopyBuffer;
+    vkCmdPipelineBarrier                           = fake_pipeline_barrier;
+    vkCmdCopyBuffer                                = fake_copy_buffer;
+    fakePipelineBarrierCalls                       = 0u;
+    fakeCopyBufferCalls                            = 0u;
+
+    ngf_cmd_buffer_t fake_cmd_buf;
+    memset(&fake_cmd_buf, 0, sizeof(fake_cmd_buf));
+    fake_cmd_buf.queue = NGFVK_QUEUE_GFX;
+    NGFI_DARRAY_RESET(fake_cmd_buf.pending_xfer_buf_barriers, 4u);
+    NGFI_DARRAY_RESET(fake_cmd_buf.pending_xfer_img_barriers, 4u);
+    NGFI_DARRAY_RESET(fake_cmd_buf.pending_buf_copies, 4u);
+    NGFI_DARRAY_RESET(fake_cmd_buf.xfer_pre_buf_barriers, 4u);
+    ngf_xfer_encoder enc;
+    enc.pvt_data_donotuse.d0 = (uintptr_t)&fake_cmd_buf;
+
+    ngf_buffer_t staging, vertex_bufs[8];
+    memset(&staging, 0, sizeof(staging));
+    memset(vertex_bufs, 0, sizeof(vertex_bufs));
+    staging.alloc.obj_handle = 0x1u;
+    staging.usage_flags      = NGF_BUFFER_USAGE_XFER_SRC;
+    for (uint32_t b = 0u; b < 8u; ++b) {
+      vertex_bufs[b].alloc.obj_handle = 0x10u + b;
+      vertex_bufs[b].usage_flags = NGF_BUFFER_USAGE_VERTEX_BUFFER | NGF_BUFFER_USAGE_XFER_DST;
+    }
+
+    // Copies into distinct buffers are recorded after a single barrier, when the pending barriers
+    // are flushed.
+    for (uint32_t b = 0u; b < 8u; ++b) {
+      ngf_cmd_copy_buffer(enc, &staging, &vertex_bufs[b], 256u, 256u * b, 0u);
+    }
+    NT_ASSERT(fakePipelineBarrierCalls == 0u && fakeCopyBufferCalls == 0u);
+    ngfvk_flush_xfer_barriers(&fake_cmd_buf);
+    NT_ASSERT(fakeCopyBufferCalls == 8u);
+    NT_ASSERT(fakePipelineBarrierCalls == 2u && fakeLastBufBarrierCount == 8u);
+
+    // Copying into a range that a pending copy has written flushes the pending copies and their
+    // barriers first.
+    fakePipelineBarrierCalls = 0u;
+    fakeCopyBufferCalls      = 0u;
+    ngf_cmd_copy_buffer(enc, &staging, &vertex_bufs[0], 256u, 0u, 0u);
+    ngf_cmd_copy_buffer(enc, &staging, &vertex_bufs[0], 256u, 0u, 128u);
+    NT_ASSERT(fakePipelineBarrierCalls == 2u && fakeCopyBufferCalls == 1u);
+
+    // So does copying into a range that a pending copy reads from.
+    ngfvk_flush_xfer_barriers(&fake_cmd_buf);
+    fakePipelineBarrierCalls = 0u;
+    fakeCopyBufferCalls      = 0u;
+    ngf_cmd_copy_buffer(enc, &vertex_bufs[0], &vertex_bufs[1], 256u, 0u, 0u);
+    ngf_cmd_copy_buffer(enc, &staging, &vertex_bufs[0], 256u, 0u, 0u);
+    NT_ASSERT(fakePipelineBarrierCalls == 1u && fakeCopyBufferCalls == 1u);
+    ngfvk_flush_xfer_barriers(&fake_cmd_buf);
+    NT_ASSERT(fakePipelineBarrierCalls == 3u && fakeCopyBufferCalls == 2u);
+
+    NGFI_DARRAY_DESTROY(fake_cmd_buf.pending_xfer_buf_barriers);
+    NGFI_DARRAY_DESTROY(fake_cmd_buf.pending_xfer_img_barriers);
+    NGFI_DARRAY_DESTROY(fake_cmd_buf.pending_buf_copies);
+    NGFI_DARRAY_DESTROY(fake_cmd_buf.xfer_pre_buf_barriers);
+    vkCmdPipelineBarrier = real_pipeline_barrier;
+    vkCmdCopyBuffer      = real_copy_buffer;
+  }
+
+  NT_TESTCASE(executeSecondaryCmdBuffersInvalidatesState) {
+    PFN_vkCmdExecuteCommands real_execute_commands = vkCmdExecuteCommands;
+    PFN_vkCmdBindPipeline    real_bind_pipeline    = vkCmdBindPipeline;
+    vkCmdExecuteCommands                           = fake_execute_commands;
+    vkCmdBindPipeline                              = fake_bind_pipeline;
+    fakeExecuteCommandsCalls                       = 0u;
+    fakeBindPipelineCalls                          = 0u;
+
+    ngf_graphics_pipeline_t fake_pipeline;
+    memset(&fake_pipeline, 0, sizeof(fake_pipeline));
+    fake_pipeline.generic_pipeline.vk_pipeline = (VkPipeline)0x1u;
+
+    ngf_cmd_buffer_t parent, secondary;
+    memset(&parent, 0, sizeof(parent));
+    memset(&secondary, 0, sizeof(secondary));
+    NGFI_DARRAY_RESET(parent.pending_bind_ops, 4u);
+    parent.state               = NGFI_CMD_BUFFER_RECORDING;
+    parent.renderpass_active   = true;
+    parent.parallel_renderpass = true;
+    ngfvk_shadow_state_reset(&parent.shadow_state);
+    secondary.flags = NGF_CMD_BUFFER_SECONDARY;
+    secondary.state = NGFI_CMD_BUFFER_AWAITING_SUBMIT;
+    ngf_render_encoder enc;
+    enc.pvt_data_donotuse.d0 = (uintptr_t)&parent;
+
+    // Binding the same pipeline twice in a row only records it once.
+    ngf_cmd_bind_gfx_pipeline(enc, &fake_pipeline);
+    ngf_cmd_bind_gfx_pipeline(enc, &fake_pipeline);
+    NT_ASSERT(fakeBindPipelineCalls == 1u);
+
+    // After executing secondary cmd buffers, the pipeline has to be bound again.
+    ngf_cmd_buffer secondary_handle = &secondary;
+    NT_ASSERT(ngf_cmd_execute_secondary_cmd_buffers(enc, 1u, &secondary_handle) == NGF_ERROR_OK);
+    NT_ASSERT(fakeExecuteCommandsCalls == 1u);
+    NT_ASSERT(parent.active_gfx_pipe == NULL);
+    ngf_cmd_bind_gfx_pipeline(enc, &fake_pipeline);
+    NT_ASSERT(fakeBindPipelineCalls == 2u);
+
+    NGFI_DARRAY_DESTROY(parent.pending_bind_ops);
+    vkCmdExecuteCommands = real_execute_commands;
+    vkCmdBindPipeline    = real_bind_pipeline;
+  }
+
+  NT_TESTCASE(executeSyncOpIndirectArgsFromCompute) {
+    ngf_buffer_t     fake_buffer;
+    ngf_cmd_buffer_t fake_cmd_buf;
+    memset(&fake_buffer, 0, sizeof(fake_buffer));
+    memset(&fake_cmd_buf, 0, sizeof(fake_cmd_buf));
+    fake_buffer.usage_flags = NGF_BUFFER_USAGE_STORAGE_BUFFER | NGF_BUFFER_USAGE_INDIRECT;
+    fake_cmd_buf.state      = NGFI_CMD_BUFFER_READY;
+    const ngf_compute_encoder fake_compute_encoder = {
+        .pvt_data_donotuse = {.d0 = 0xffffffff, .d1 = 0xdeadbeef}};
+    const ngf_sync_compute_resource sync_compute_resource = {
+        .encoder = fake_compute_encoder,
+        .resource =
+            {.sync_resource_type = NGF_SYNC_RESOURCE_BUFFER,
+             .resource = {.buffer_slice = {.buffer = &fake_buffer, .offset = 0u, .range = 64u}}}};
+    const VkEvent expected_events[] = {(VkEvent)fake_compute_encoder.pvt_data_donotuse.d1};
+
+    // Indirect command reads may only be waited on by the draw indirect stage, and are never
+    // part of the source access mask of compute work.
+    const VkBufferMemoryBarrier expected_barriers[] = {
+        {.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+         .pNext               = NULL,
+         .buffer              = (VkBuffer)fake_buffer.alloc.obj_handle,
+         .offset              = 0u,
+         .size                = 64u,
+         .srcAccessMask       = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+         .dstAccessMask       = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+         .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED},
+        {.sType         = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+         .pNext         = NULL,
+         .buffer        = (VkBuffer)fake_buffer.alloc.obj_handle,
+         .offset        = 0u,
+         .size          = 64u,
+         .srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+         .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                          VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+         .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED}};
+    const vkCmdWaitEventsExpectedParams expected_params[] = {
+        {.expectedEventCount               = 1u,
+         .expectedEvents                   = expected_events,
+         .expectedSrcStageMask             = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+         .expectedDstStageMask             = NGFVK_GFX_PIPELINE_STAGE_MASK,
+         .expectedBufferMemoryBarrierCount = 1u,
+         .expectedBufferMemoryBarriers     = &expected_barriers[0]},
+        {.expectedEventCount   = 1u,
+         .expectedEvents       = expected_events,
+         .expectedSrcStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+         .expectedDstStageMask =
+             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+         .expectedBufferMemoryBarrierCount = 1u,
+         .expectedBufferMemoryBarriers     = &expected_barriers[1]}};
+    vkCmdWaitEventsExpectedParamsList    = expected_params;
+    vkCmdWaitEventsExpectedNumberOfCalls = 2u;
+
+    // Compute to compute, e.g. for an indirect dispatch.
+    NT_ASSERT(
+        ngfvk_execute_sync_op(
+            &fake_cmd_buf,
+            1u,
+            &sync_compute_resource,
+            0u,
+            NULL,
+            0u,
+            NULL,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT) ==
+        NGF_ERROR_OK);
+    ngfi_sa_reset(ngfi_tmp_store());
+    // Compute to render, e.g. for an indirect draw.
+    NT_ASSERT(
+        ngfvk_execute_sync_op(
+            &fake_cmd_buf,
+            1u,
+            &sync_compute_resource,
+            0u,
+            NULL,
+            0u,
+            NULL,
+            NGFVK_GFX_PIPELINE_STAGE_MASK) == NGF_ERROR_OK);
+    NT_ASSERT(vkCmdWaitEventsExpectedNumberOfCalls == 0u);
+  }
+
+  NT_TESTCASE(beginQueryTwiceInFrame) {
+    PFN_vkCmdBeginQuery real_begin_query = vkCmdBeginQuery;
+    PFN_vkCmdEndQuery   real_end_query   = vkCmdEndQuery;
+    vkCmdBeginQuery                      = fake_begin_query;
+    vkCmdEndQuery                        = fake_end_query;
+    fakeBeginQueryCalls                  = 0u;
+
+    ngf_query_pool_t fake_pool;
+    memset(&fake_pool, 0, sizeof(fake_pool));
+    fake_pool.type     = NGF_QUERY_TYPE_OCCLUSION;
+    fake_pool.nqueries = 4u;
+    ngf_cmd_buffer_t fake_cmd_buf;
+    memset(&fake_cmd_buf, 0, sizeof(fake_cmd_buf));
+    NGFI_DARRAY_RESET(fake_cmd_buf.written_queries, 4u);
+    ngf_render_encoder enc;
+    enc.pvt_data_donotuse.d0 = (uintptr_t)&fake_cmd_buf;
+
+    NT_ASSERT(ngf_cmd_begin_query(enc, &fake_pool, 1u) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_end_query(enc) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_begin_query(enc, &fake_pool, 2u) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_end_query(enc) == NGF_ERROR_OK);
+    NT_ASSERT(fakeBeginQueryCalls == 2u);
+
+    // The queries are only reset once per frame, so they can't be begun again until the next one.
+    NT_ASSERT(ngf_cmd_begin_query(enc, &fake_pool, 1u) == NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(ngf_cmd_begin_query(enc, &fake_pool, 2u) == NGF_ERROR_INVALID_OPERATION);
+    NT_ASSERT(fakeBeginQueryCalls == 2u);
+    NT_ASSERT(ngf_cmd_begin_query(enc, &fake_pool, 3u) == NGF_ERROR_OK);
+    NT_ASSERT(ngf_cmd_end_query(enc) == NGF_ERROR_OK);
+    NT_ASSERT(fakeBeginQueryCalls == 3u);
+
+    NGFI_DARRAY_DESTROY(fake_cmd_buf.written_queries);
+    vkCmdBeginQuery = real_begin_query;
+    vkCmdEndQuery   = real_end_query;
+  }
+
+  NT_TESTCASE(timestampResultsMaskedByValidBits) {
+    PFN_vkGetQueryPoolResults real_get_query_pool_results = vkGetQueryPoolResults;
+    const uint64_t            real_timestamp_mask         = _vk.timestamp_masks[NGFVK_QUEUE_GFX];
+    const float               real_timestamp_period       = _vk.timestamp_period;
+    vkGetQueryPoolResults                                 = fake_get_query_pool_results;
+    _vk.timestamp_masks[NGFVK_QUEUE_GFX]                  = (1ull << 36u) - 1ull;
+    _vk.timestamp_period                                  = 2.0f;
+
+    uint64_t         pool_results[2u * 2u] = {0u};
+    ngf_query_pool_t fake_pool;
+    memset(&fake_pool, 0, sizeof(fake_pool));
+    fake_pool.type     = NGF_QUERY_TYPE_TIMESTAMP;
+    fake_pool.nqueries = 2u;
+    fake_pool.nvalues  = 1u;
+    fake_pool.results  = pool_results;
+    ngfvk_frame_resources fake_frame_res;
+    memset(&fake_frame_res, 0, sizeof(fake_frame_res));
+    NGFI_DARRAY_RESET(fake_frame_res.written_queries, 1u);
+    const ngfvk_query_range range =
+        {.pool = &fake_pool, .first = 0u, .count = 2u, .queue = NGFVK_QUEUE_GFX};
+    NGFI_DARRAY_APPEND(fake_frame_res.written_queries, range);
+
+    // The invalid upper bits are dropped before the ticks are converted to nanoseconds.
+    ngfvk_read_back_query_results(&fake_frame_res);
+    uint64_t results[2];
+    NT_ASSERT(ngf_get_query_results(&fake_pool, 0u, 2u, results) == NGF_ERROR_OK);
+    NT_ASSERT(results[0] == ((1ull << 36u) - 1ull) * 2u);
+    NT_ASSERT(results[1] == ((1ull << 36u) - 1ull) * 2u);
+
+    NGFI_DARRAY_DESTROY(fake_frame_res.written_queries);
+    vkGetQueryPoolResults                = real_get_query_pool_results;
+    _vk.timestamp_masks[NGFVK_QUEUE_GFX] = real_timestamp_mask;
+    _vk.timestamp_period                 = real_timestamp_period;
+  }
+
+  NT_TESTCASE(splitGfxSubmissionWaitsOnSwapchainImage) {
+    PFN_vkQueueSubmit real_queue_submit = vkQueueSubmit;
+    vkQueueSubmit                       = fake_queue_submit;
+    fakeQueueSubmitCalls                = 0u;
+
+    const VkSemaphore     acquire_semaphore = (VkSemaphore)0xa1u;
+    const VkSemaphore     present_semaphore = (VkSemaphore)0xa2u;
+    ngfvk_frame_resources fake_frame_res;
+    memset(&fake_frame_res, 0, sizeof(fake_frame_res));
+    fake_frame_res.semaphore = present_semaphore;
+    NGFI_DARRAY_RESET(fake_frame_res.cmd_bufs, 4u);
+    NGFI_DARRAY_RESET(fake_frame_res.queue_semaphores, 2u);
+    NGFI_DARRAY_APPEND(fake_frame_res.queue_semaphores, (VkSemaphore)0xb1u);
+    NGFI_DARRAY_APPEND(fake_frame_res.queue_semaphores, (VkSemaphore)0xb2u);
+    // Slot 0 is reserved for deferred barriers, which there aren't any of. The third cmd buffer is
+    // the first one that acquires resources from the compute queue.
+    for (uintptr_t c = 0u; c < 4u; ++c) {
+      NGFI_DARRAY_APPEND(fake_frame_res.cmd_bufs, (VkCommandBuffer)(0xc0u + c));
+    }
+    fake_frame_res.compute_wait_cmd_buf_idx = 2u;
+    fake_frame_res.compute_work_pending     = true;
+
+    NT_ASSERT(
+        ngfvk_submit_pending_cmd_buffers(&fake_frame_res, acquire_semaphore, VK_NULL_HANDLE) ==
+        NGF_ERROR_OK);
+
+    // The compute queue signals the release, then the graphics queue work is split in two.
+    NT_ASSERT(fakeQueueSubmitCalls == 2u);
+    const VkSemaphore compute_semaphore = fakeQueueSubmits[0].batches[0].signal;
+    NT_ASSERT(compute_semaphore != VK_NULL_HANDLE);
+    const fake_queue_submit_call* gfx_submit = &fakeQueueSubmits[1];
+    NT_ASSERT(gfx_submit->nbatches == 2u);
+    const fake_submitted_batch* first_batch = &gfx_submit->batches[0];
+    const fake_submitted_batch* last_batch  = &gfx_submit->batches[1];
+    NT_ASSERT(first_batch->ncmd_bufs == 1u && last_batch->ncmd_bufs == 2u);
+
+    // The first batch waits on the swapchain image, the last one on the compute queue and the
+    // first batch, so that it's ordered after the swapchain image acquisition as well.
+    NT_ASSERT(fake_batch_waits_on(first_batch, acquire_semaphore));
+    NT_ASSERT(!fake_batch_waits_on(first_batch, compute_semaphore));
+    NT_ASSERT(first_batch->nsignals == 1u && first_batch->signal != VK_NULL_HANDLE);
+    NT_ASSERT(fake_batch_waits_on(last_batch, compute_semaphore));
+    NT_ASSERT(fake_batch_waits_on(last_batch, first_batch->signal));
+    NT_ASSERT(last_batch->nsignals == 1u && last_batch->signal == present_semaphore);
+
+    NGFI_DARRAY_DESTROY(fake_frame_res.cmd_bufs);
+    NGFI_DARRAY_DESTROY(fake_frame_res.queue_semaphores);
+    vkQueueSubmit = real_queue_submit;
+  }
+}